@@ -0,0 +1,288 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Compares the timing wheel EventProcessor with the multimap queue it
+ * replaced, copied below as MultimapEventProcessor.
+ *
+ * - schedule: events added at random offsets, then run to completion
+ * - cancel: the same, with half of the events aborted before they are due
+ * - update: many processors (one per unit) with a few recurring events each,
+ *   updated every map tick, most of them idle
+ *
+ * Both queues run the same events first, a few and many at once, and must
+ * execute them in the same order at the same times.
+ *
+ * Usage: eventprocessor-bench [events] [processors] [ticks]
+ */
+
+#include "Common.h"
+#include "Utilities/EventProcessor.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // The previous EventProcessor, with its own event class: BasicEvent now links itself into the wheel
+    class MultimapEvent
+    {
+        public:
+            MultimapEvent() : m_aborted(false), m_abortScheduled(false), m_execTime(0) {}
+            virtual ~MultimapEvent() {}
+
+            virtual bool Execute(uint64 /*e_time*/, uint32 /*p_time*/) { return true; }
+            virtual void Abort(uint64 /*e_time*/) {}
+
+            void ScheduleAbort() { m_abortScheduled = true; }
+
+            bool m_aborted;
+            bool m_abortScheduled;
+            uint64 m_execTime;
+    };
+
+    class MultimapEventProcessor
+    {
+        public:
+            MultimapEventProcessor() : m_time(0) {}
+            ~MultimapEventProcessor()
+            {
+                for (auto& event : m_events)
+                    delete event.second;
+            }
+
+            void Update(uint32 p_time)
+            {
+                m_time += p_time;
+
+                std::multimap<uint64, MultimapEvent*>::iterator i;
+                while (((i = m_events.begin()) != m_events.end()) && i->first <= m_time)
+                {
+                    MultimapEvent* event = i->second;
+                    m_events.erase(i);
+
+                    if (!event->m_abortScheduled && !event->m_aborted)
+                    {
+                        if (event->Execute(m_time, p_time))
+                            delete event;
+                        continue;
+                    }
+
+                    if (event->m_abortScheduled)
+                    {
+                        event->Abort(m_time);
+                        event->m_aborted = true;
+                    }
+                    delete event;
+                }
+            }
+
+            uint64 CalculateTime(uint64 t_offset) const { return m_time + t_offset; }
+
+            void AddEvent(MultimapEvent* event, uint64 e_time)
+            {
+                event->m_execTime = e_time;
+                m_events.insert(std::make_pair(e_time, event));
+            }
+
+        private:
+            uint64 m_time;
+            std::multimap<uint64, MultimapEvent*> m_events;
+    };
+
+    struct Execution
+    {
+        uint32 id;
+        uint64 time;
+
+        bool operator!=(Execution const& other) const { return id != other.id || time != other.time; }
+    };
+
+    // Same event for both queues: records its execution, optionally runs again every `period` ms
+    template<class BASE, class PROCESSOR>
+    class BenchEvent : public BASE
+    {
+        public:
+            BenchEvent(PROCESSOR& processor, uint32 id, uint32 period, uint32 repeats, std::vector<Execution>* log) :
+                m_processor(processor), m_id(id), m_period(period), m_repeats(repeats), m_log(log) {}
+
+            bool Execute(uint64 e_time, uint32 /*p_time*/) override
+            {
+                if (m_log)
+                    m_log->push_back({ m_id, e_time });
+                if (!m_repeats)
+                    return true;
+
+                --m_repeats;
+                m_processor.AddEvent(this, m_processor.CalculateTime(m_period));
+                return false;
+            }
+
+        private:
+            PROCESSOR& m_processor;
+            uint32 m_id;
+            uint32 m_period;
+            uint32 m_repeats;
+            std::vector<Execution>* m_log;
+    };
+
+    typedef BenchEvent<BasicEvent, EventProcessor> WheelEvent;
+    typedef BenchEvent<MultimapEvent, MultimapEventProcessor> ListEvent;
+
+    struct Schedule
+    {
+        uint32 offset;
+        uint32 period;
+        uint32 repeats;
+        bool cancel;
+    };
+
+    std::vector<Schedule> MakeSchedule(uint32 count, std::mt19937& rng)
+    {
+        // mostly short timers (spells, auras, AI), some long ones (respawns, despawns)
+        std::uniform_int_distribution<uint32> shortOffset(1, 5000);
+        std::uniform_int_distribution<uint32> longOffset(5000, 30 * MINUTE * IN_MILLISECONDS);
+        std::vector<Schedule> schedule(count);
+        for (Schedule& s : schedule)
+        {
+            s.offset = rng() % 8 ? shortOffset(rng) : longOffset(rng);
+            s.period = 1 + rng() % 2000;
+            s.repeats = rng() % 4 ? 0 : rng() % 5;
+            s.cancel = rng() % 2 == 0;
+        }
+        return schedule;
+    }
+
+    template<class EVENT, class PROCESSOR>
+    double Run(std::vector<Schedule> const& schedule, bool cancel, uint32 tick, std::vector<Execution>* log)
+    {
+        auto const start = std::chrono::steady_clock::now();
+
+        PROCESSOR processor;
+        std::vector<EVENT*> events(schedule.size());
+        for (uint32 i = 0; i < schedule.size(); ++i)
+        {
+            events[i] = new EVENT(processor, i, schedule[i].period, schedule[i].repeats, log);
+            processor.AddEvent(events[i], processor.CalculateTime(schedule[i].offset));
+        }
+
+        // events are still queued after the first tick, whatever their offset
+        processor.Update(0);
+        if (cancel)
+            for (uint32 i = 0; i < schedule.size(); ++i)
+                if (schedule[i].cancel && schedule[i].offset > tick)
+                    events[i]->ScheduleAbort();
+
+        uint64 const end = 31 * MINUTE * IN_MILLISECONDS + 5 * 2000;
+        for (uint64 time = 0; time < end; time += tick)
+            processor.Update(tick);
+
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    bool CheckSameExecutions(std::vector<Schedule> const& schedule, bool cancel, uint32 tick, uint32& executions)
+    {
+        std::vector<Execution> wheelLog;
+        std::vector<Execution> listLog;
+        Run<WheelEvent, EventProcessor>(schedule, cancel, tick, &wheelLog);
+        Run<ListEvent, MultimapEventProcessor>(schedule, cancel, tick, &listLog);
+        if (wheelLog.size() != listLog.size())
+        {
+            printf("%zu executions with the wheel, %zu with the multimap\n", wheelLog.size(), listLog.size());
+            return false;
+        }
+        for (size_t i = 0; i < wheelLog.size(); ++i)
+        {
+            if (wheelLog[i] != listLog[i])
+            {
+                printf("execution %zu differs, event %u at %llu with the wheel, event %u at %llu with the multimap\n",
+                       i, wheelLog[i].id, (unsigned long long)wheelLog[i].time, listLog[i].id, (unsigned long long)listLog[i].time);
+                return false;
+            }
+        }
+        executions += uint32(wheelLog.size());
+        return true;
+    }
+
+    // One processor per unit, a few of them with recurring events
+    template<class EVENT, class PROCESSOR>
+    double RunUnits(uint32 processors, uint32 ticks, std::mt19937 rng)
+    {
+        std::vector<std::unique_ptr<PROCESSOR>> units(processors);
+        for (auto& unit : units)
+        {
+            unit.reset(new PROCESSOR);
+            if (rng() % 10 == 0)
+                for (uint32 i = rng() % 4 + 1; i > 0; --i)
+                    unit->AddEvent(new EVENT(*unit, i, 100 + rng() % 3000, UINT32_MAX, nullptr), unit->CalculateTime(rng() % 3000));
+        }
+
+        auto const start = std::chrono::steady_clock::now();
+        for (uint32 t = 0; t < ticks; ++t)
+            for (auto& unit : units)
+                unit->Update(50);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32 const count = argc > 1 ? std::max(atoi(argv[1]), 1) : 1000000;
+    uint32 const processors = argc > 2 ? std::max(atoi(argv[2]), 1) : 20000;
+    uint32 const ticks = argc > 3 ? std::max(atoi(argv[3]), 1) : 2000;
+    uint32 const tick = 50;
+
+    std::mt19937 rng(12345);
+    std::vector<Schedule> const schedule = MakeSchedule(count, rng);
+
+    // a few events stay in the sorted list, more go to the wheel
+    for (uint32 size : { 3, 8, 9, 20, 100000 })
+    {
+        uint32 executions = 0;
+        for (uint32 first = 0; first + size <= schedule.size() && first < 1000; first += size)
+        {
+            std::vector<Schedule> const checked(schedule.begin() + first, schedule.begin() + first + size);
+            for (bool cancel : { false, true })
+            {
+                if (!CheckSameExecutions(checked, cancel, tick, executions))
+                    return 1;
+            }
+        }
+        printf("%u events: %u executions in the same order\n", size, executions);
+    }
+
+    // first, the freed blocks of a million events would scatter the events of the units
+    {
+        double const listTime = RunUnits<ListEvent, MultimapEventProcessor>(processors, ticks, rng);
+        double const wheelTime = RunUnits<WheelEvent, EventProcessor>(processors, ticks, rng);
+        printf("update   %u processors, %u ticks: multimap %.3f s (%.1f ns per Update), wheel %.3f s (%.1f ns per Update)\n",
+               processors, ticks, listTime, listTime * 1e9 / (double(processors) * ticks), wheelTime, wheelTime * 1e9 / (double(processors) * ticks));
+    }
+
+    printf("%u events, %u ms ticks\n", count, tick);
+    for (bool cancel : { false, true })
+    {
+        double const listTime = Run<ListEvent, MultimapEventProcessor>(schedule, cancel, tick, nullptr);
+        double const wheelTime = Run<WheelEvent, EventProcessor>(schedule, cancel, tick, nullptr);
+        printf("%-8s multimap %.3f s, wheel %.3f s\n", cancel ? "cancel" : "schedule", listTime, wheelTime);
+    }
+    return 0;
+}
@@ -0,0 +1,254 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Compares a range search over grid cells stored as GridRefManager linked
+ * lists (the previous cell storage) and as GridObjectList arrays.
+ *
+ * Objects are allocated one by one in a shuffled order and padded to the size
+ * of a creature, so that reading their position costs what it costs in the
+ * server. The linked list search reads every object, the array search rejects
+ * most of them from the cached positions.
+ *
+ * Before timing, the visits are checked: objects removed (or removing
+ * themselves) during a visit must not make it skip or repeat any other object.
+ *
+ * Usage: gridvisit-bench [objects per cell] [searches] [range]
+ */
+
+#include "GameSystem/GridObjectList.h"
+#include "GameSystem/GridRefManager.h"
+#include "GameSystem/GridReference.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+    float const CELL_SIZE = 533.3333f / 16;
+    uint32 const CELLS_PER_SIDE = 16;                       // one grid
+
+    struct BenchObject
+    {
+        BenchObject(uint32 id_, float x_, float y_, float radius_) : id(id_), x(x_), y(y_), radius(radius_) {}
+
+        bool GetGridPosition(float& outX, float& outY, float& outRadius) const
+        {
+            outX = x;
+            outY = y;
+            outRadius = radius;
+            return true;
+        }
+
+        bool IsWithinDist(float px, float py, float range) const
+        {
+            float const dx = x - px;
+            float const dy = y - py;
+            float const dist = range + radius;
+            return dx * dx + dy * dy < dist * dist;
+        }
+
+        uint32 id;
+        char padding[2048];                                 // rest of a creature
+        float x;
+        float y;
+        float radius;
+        GridReference<BenchObject> ref;
+        GridObjectHandle handle;
+    };
+
+    struct Cells
+    {
+        std::vector<GridRefManager<BenchObject>> lists{CELLS_PER_SIDE * CELLS_PER_SIDE};
+        std::vector<GridObjectList<BenchObject>> arrays{CELLS_PER_SIDE * CELLS_PER_SIDE};
+        std::vector<std::unique_ptr<BenchObject>> objects;
+    };
+
+    uint32 CellIndex(float x, float y)
+    {
+        uint32 const cx = std::min(uint32(x / CELL_SIZE), CELLS_PER_SIDE - 1);
+        uint32 const cy = std::min(uint32(y / CELL_SIZE), CELLS_PER_SIDE - 1);
+        return cx * CELLS_PER_SIDE + cy;
+    }
+
+    void Populate(Cells& cells, uint32 perCell, std::mt19937& rng)
+    {
+        uint32 const count = perCell * CELLS_PER_SIDE * CELLS_PER_SIDE;
+        std::uniform_real_distribution<float> position(0.0f, CELL_SIZE * CELLS_PER_SIDE);
+        std::uniform_real_distribution<float> radius(0.3f, 1.5f);
+
+        std::vector<uint32> order(count);
+        for (uint32 i = 0; i < count; ++i)
+            order[i] = i;
+        std::shuffle(order.begin(), order.end(), rng);
+
+        cells.objects.resize(count);
+        for (uint32 id : order)
+            cells.objects[id].reset(new BenchObject(id, position(rng), position(rng), radius(rng)));
+
+        for (uint32 i = 0; i < count; ++i)
+        {
+            BenchObject* obj = cells.objects[order[i]].get();
+            uint32 const cell = CellIndex(obj->x, obj->y);
+            obj->ref.link(&cells.lists[cell], obj);
+            obj->handle.link(&cells.arrays[cell], obj);
+        }
+    }
+
+    template<class VISIT>
+    void VisitCells(float x, float y, float range, VISIT&& visit)
+    {
+        uint32 const lowX = uint32(std::max(x - range, 0.0f) / CELL_SIZE);
+        uint32 const lowY = uint32(std::max(y - range, 0.0f) / CELL_SIZE);
+        uint32 const highX = std::min(uint32((x + range) / CELL_SIZE), CELLS_PER_SIDE - 1);
+        uint32 const highY = std::min(uint32((y + range) / CELL_SIZE), CELLS_PER_SIDE - 1);
+        for (uint32 cx = lowX; cx <= highX; ++cx)
+            for (uint32 cy = lowY; cy <= highY; ++cy)
+                visit(cx * CELLS_PER_SIDE + cy);
+    }
+
+    // Removes objects from the visited list, before and after the iterator, and the visited object itself
+    bool CheckRemovalDuringVisit(std::mt19937& rng)
+    {
+        for (uint32 round = 0; round < 1000; ++round)
+        {
+            GridObjectList<BenchObject> list;
+            uint32 const count = 1 + rng() % 64;
+            std::vector<std::unique_ptr<BenchObject>> objects;
+            for (uint32 i = 0; i < count; ++i)
+            {
+                objects.emplace_back(new BenchObject(i, 0.0f, 0.0f, 0.0f));
+                objects.back()->handle.link(&list, objects.back().get());
+            }
+
+            std::vector<uint32> visits(count, 0);
+            std::vector<bool> removedBeforeVisit(count, false);
+            for (auto const& iter : list)
+            {
+                BenchObject* obj = iter.getSource();
+                ++visits[obj->id];
+
+                for (uint32 i = rng() % 3; i > 0; --i)
+                {
+                    BenchObject* other = objects[rng() % count].get();
+                    if (!other->handle.isValid())
+                        continue;
+                    if (!visits[other->id])
+                        removedBeforeVisit[other->id] = true;
+                    other->handle.unlink();
+                }
+                if (rng() % 4 == 0)
+                    obj->handle.unlink();
+            }
+
+            uint32 remaining = 0;
+            for (uint32 i = 0; i < count; ++i)
+            {
+                if (visits[i] != (removedBeforeVisit[i] ? 0u : 1u))
+                {
+                    printf("round %u: object %u visited %u times\n", round, i, visits[i]);
+                    return false;
+                }
+                remaining += objects[i]->handle.isValid() ? 1 : 0;
+            }
+
+            // compacted once the iteration is over
+            uint32 listed = 0;
+            for (auto const& iter : list)
+            {
+                if (!iter.getSource()->handle.isValid())
+                    return false;
+                ++listed;
+            }
+            if (listed != remaining || list.getSize() != remaining)
+            {
+                printf("round %u: %u objects listed, %u expected\n", round, listed, remaining);
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32 const perCell = argc > 1 ? std::max(atoi(argv[1]), 1) : 40;
+    uint32 const searches = argc > 2 ? std::max(atoi(argv[2]), 1) : 200000;
+    float const range = argc > 3 ? float(atof(argv[3])) : 10.0f;
+
+    std::mt19937 rng(12345);
+    if (!CheckRemovalDuringVisit(rng))
+    {
+        printf("removal during a visit skipped or repeated objects\n");
+        return 1;
+    }
+    printf("removal during a visit: ok\n");
+
+    Cells cells;
+    Populate(cells, perCell, rng);
+
+    std::uniform_real_distribution<float> position(0.0f, CELL_SIZE * CELLS_PER_SIDE);
+    std::vector<float> points(searches * 2);
+    for (float& p : points)
+        p = position(rng);
+
+    printf("%u objects per cell, %u searches within %.1f yards\n", perCell, searches, range);
+
+    uint64 listFound = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32 i = 0; i < searches; ++i)
+    {
+        float const x = points[2 * i];
+        float const y = points[2 * i + 1];
+        VisitCells(x, y, range, [&](uint32 cell)
+        {
+            for (GridReference<BenchObject>* ref = cells.lists[cell].getFirst(); ref; ref = ref->next())
+                if (ref->getSource()->IsWithinDist(x, y, range))
+                    ++listFound;
+        });
+    }
+    double const listTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64 arrayFound = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32 i = 0; i < searches; ++i)
+    {
+        float const x = points[2 * i];
+        float const y = points[2 * i + 1];
+        VisitCells(x, y, range, [&](uint32 cell)
+        {
+            GridObjectList<BenchObject>& list = cells.arrays[cell];
+            for (GridObjectList<BenchObject>::iterator itr = list.begin(); itr != list.end(); ++itr)
+                if (list.MayBeWithinDist(itr, x, y, 0.0f, range) && itr->getSource()->IsWithinDist(x, y, range))
+                    ++arrayFound;
+        });
+    }
+    double const arrayTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("linked list %.3f s, %.0f searches/s, %llu found\n", listTime, searches / listTime, (unsigned long long)listFound);
+    printf("array       %.3f s, %.0f searches/s, %llu found\n", arrayTime, searches / arrayTime, (unsigned long long)arrayFound);
+    if (listFound != arrayFound)
+    {
+        printf("the searches found different objects\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,122 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Compares the scalar and the batched vmap line of sight queries.
+ *
+ * Loads the vmap tiles around a position, casts random rays between points
+ * standing on the vmap geometry (or at a random height where there is none)
+ * one by one and in batches, checks that both give the same answer for every
+ * ray, and reports the throughput of each.
+ *
+ * Usage: los-bench <data dir> <map> <x> <y> [radius] [rays] [batch size]
+ */
+
+#include "Common.h"
+#include "GridDefines.h"
+#include "VMapManager2.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    if (argc < 5)
+    {
+        printf("Usage: %s <data dir> <map> <x> <y> [radius] [rays] [batch size]\n", argv[0]);
+        return 1;
+    }
+
+    std::string const vmapsDir = std::string(argv[1]) + "/vmaps";
+    uint32 const mapId = atoi(argv[2]);
+    float const centerX = float(atof(argv[3]));
+    float const centerY = float(atof(argv[4]));
+    float const radius = argc > 5 ? float(atof(argv[5])) : 100.0f;
+    uint32 const count = argc > 6 ? std::max(atoi(argv[6]), 1) : 1000000;
+    uint32 const batchSize = argc > 7 ? std::max(atoi(argv[7]), 1) : 64;
+
+    VMAP::VMapManager2 manager;
+    manager.setEnableLineOfSightCalc(true);
+    manager.setEnableHeightCalc(true);
+
+    // tiles of the square around the position, numbered as in Map::EnsureGridCreated
+    uint32 loaded = 0;
+    GridPair const low = MaNGOS::ComputeGridPair(centerX - radius, centerY - radius);
+    GridPair const high = MaNGOS::ComputeGridPair(centerX + radius, centerY + radius);
+    for (uint32 x = std::min(low.x_coord, high.x_coord); x <= std::max(low.x_coord, high.x_coord); ++x)
+        for (uint32 y = std::min(low.y_coord, high.y_coord); y <= std::max(low.y_coord, high.y_coord); ++y)
+            if (manager.loadMap(vmapsDir.c_str(), mapId, (MAX_NUMBER_OF_GRIDS - 1) - x, (MAX_NUMBER_OF_GRIDS - 1) - y) == VMAP::VMAP_LOAD_RESULT_OK)
+                ++loaded;
+
+    if (!loaded)
+    {
+        printf("No vmap tile of map %u loaded from '%s'\n", mapId, vmapsDir.c_str());
+        return 1;
+    }
+
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> offset(-radius, radius);
+    std::uniform_real_distribution<float> altitude(-50.0f, 300.0f);
+    auto randomPoint = [&](float& x, float& y, float& z)
+    {
+        x = centerX + offset(rng);
+        y = centerY + offset(rng);
+        z = manager.getHeight(mapId, x, y, 1000.0f, 2000.0f);
+        z = z > VMAP_INVALID_HEIGHT ? z + 2.0f : altitude(rng);
+    };
+
+    std::vector<VMAP::LineOfSightQuery> rays(count);
+    for (VMAP::LineOfSightQuery& ray : rays)
+    {
+        randomPoint(ray.x1, ray.y1, ray.z1);
+        randomPoint(ray.x2, ray.y2, ray.z2);
+    }
+    printf("%u vmap tiles, %u rays within %.0f yards of (%.1f, %.1f), batches of %u\n", loaded, count, radius, centerX, centerY, batchSize);
+
+    std::unique_ptr<bool[]> scalar(new bool[count]);
+    std::unique_ptr<bool[]> batched(new bool[count]);
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32 i = 0; i < count; ++i)
+        scalar[i] = manager.isInLineOfSight(mapId, rays[i].x1, rays[i].y1, rays[i].z1, rays[i].x2, rays[i].y2, rays[i].z2);
+    double const scalarTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (uint32 first = 0; first < count; first += batchSize)
+        manager.isInLineOfSight(mapId, rays.data() + first, std::min(batchSize, count - first), batched.get() + first);
+    double const batchedTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint32 visible = 0;
+    uint32 mismatches = 0;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        visible += scalar[i] ? 1 : 0;
+        if (scalar[i] != batched[i] && ++mismatches <= 10)
+            printf("mismatch for ray %u: (%f, %f, %f) -> (%f, %f, %f) scalar %u batched %u\n", i,
+                   rays[i].x1, rays[i].y1, rays[i].z1, rays[i].x2, rays[i].y2, rays[i].z2, uint32(scalar[i]), uint32(batched[i]));
+    }
+
+    printf("%u rays in line of sight (%.1f%%)\n", visible, 100.0 * visible / count);
+    printf("scalar  %.3f s, %.0f rays/s\n", scalarTime, count / scalarTime);
+    printf("batched %.3f s, %.0f rays/s\n", batchedTime, count / batchedTime);
+    printf("%u mismatches\n", mismatches);
+    return mismatches ? 1 : 0;
+}
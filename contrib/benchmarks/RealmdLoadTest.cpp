@@ -0,0 +1,474 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Load test of the realmd logon handshake.
+ *
+ * Every client thread logs on as many times as asked, one connection per
+ * logon: logon challenge, SRP6 proof of the account password, check of the
+ * server proof, realm list. Reports the logons per second and the latency
+ * percentiles of the whole handshake.
+ *
+ * The accounts must exist and must not require a PIN. An account name
+ * containing %u is formatted with the client number (from 0), to spread the
+ * clients over several accounts. StrictVersionCheck must be disabled, the
+ * client files are not hashed.
+ *
+ * Before connecting, the client SRP6 math is checked against the server side
+ * equations with a random verifier.
+ *
+ * Usage: realmd-loadtest <host> <port> <account> <password> [clients] [logons per client] [build]
+ */
+
+#include "Common.h"
+#include "ByteBuffer.h"
+#include "Auth/BigNumber.h"
+#include "Auth/Sha1.h"
+#include "AuthCodes.h"
+
+#include <ace/INET_Addr.h>
+#include <ace/SOCK_Connector.h>
+#include <ace/SOCK_Stream.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    enum LogonStep
+    {
+        STEP_CONNECT,
+        STEP_CHALLENGE,
+        STEP_PROOF,
+        STEP_REALM_LIST,
+        STEP_COUNT
+    };
+
+    char const* const StepNames[STEP_COUNT] = { "connect", "logon challenge", "logon proof", "realm list" };
+
+    struct Account
+    {
+        std::string name;                                   // upper case, as sent by the client
+        uint8 passwordHash[SHA_DIGEST_LENGTH];              // sha1(NAME:PASSWORD), the sha_pass_hash of the account table
+    };
+
+    struct Results
+    {
+        std::mutex lock;
+        std::vector<double> latencies;                      // ms, of the successful logons
+        uint32 failures[STEP_COUNT] = {};
+        uint32 lastError[STEP_COUNT] = {};                  // AuthResult sent by the server, if any
+    };
+
+    std::string Upper(std::string text)
+    {
+        for (char& c : text)
+            if (c >= 'a' && c <= 'z')
+                c -= 'a' - 'A';
+        return text;
+    }
+
+    Account MakeAccount(std::string const& name, std::string const& password)
+    {
+        Account account;
+        account.name = Upper(name);
+
+        Sha1Hash sha;
+        sha.UpdateData(account.name + ":" + Upper(password));
+        sha.Finalize();
+        memcpy(account.passwordHash, sha.GetDigest(), SHA_DIGEST_LENGTH);
+        return account;
+    }
+
+    // x = sha1(s, sha1(NAME:PASSWORD)), as in ComputeLogonChallenge of realmd
+    BigNumber PrivateKey(BigNumber s, uint8 const* passwordHash)
+    {
+        Sha1Hash sha;
+        sha.UpdateData(s.AsByteArray());
+        sha.UpdateData(passwordHash, SHA_DIGEST_LENGTH);
+        sha.Finalize();
+        BigNumber x;
+        x.SetBinary(sha.GetDigest(), sha.GetLength());
+        return x;
+    }
+
+    struct ClientProof
+    {
+        BigNumber A;
+        BigNumber S;
+        BigNumber K;
+        BigNumber M1;
+        uint8 M2[SHA_DIGEST_LENGTH];                        // expected server proof
+    };
+
+    // Client side of SRP6 (the server side is ComputeLogonProof of realmd)
+    ClientProof ComputeClientProof(Account const& account, BigNumber N, BigNumber g, BigNumber s, BigNumber B, BigNumber a)
+    {
+        ClientProof proof;
+        proof.A = g.ModExp(a, N);
+
+        Sha1Hash sha;
+        sha.UpdateBigNumbers(&proof.A, &B, nullptr);
+        sha.Finalize();
+        BigNumber u;
+        u.SetBinary(sha.GetDigest(), 20);
+
+        // S = (B - 3 * g^x) ^ (a + u * x), kept positive before the exponentiation
+        BigNumber x = PrivateKey(s, account.passwordHash);
+        BigNumber k(3);
+        BigNumber base = (B + N * k - (g.ModExp(x, N) * k) % N) % N;
+        proof.S = base.ModExp(a + u * x, N);
+
+        // K interleaves the hashes of the even and odd bytes of S
+        uint8 t[32];
+        uint8 t1[16];
+        uint8 vK[40];
+        memcpy(t, proof.S.AsByteArray(32).data(), 32);
+        for (int half = 0; half < 2; ++half)
+        {
+            for (int i = 0; i < 16; ++i)
+                t1[i] = t[i * 2 + half];
+            sha.Initialize();
+            sha.UpdateData(t1, 16);
+            sha.Finalize();
+            for (int i = 0; i < 20; ++i)
+                vK[i * 2 + half] = sha.GetDigest()[i];
+        }
+        proof.K.SetBinary(vK, 40);
+
+        // M1 = sha1(sha1(N) ^ sha1(g), sha1(NAME), s, A, B, K)
+        uint8 hash[20];
+        sha.Initialize();
+        sha.UpdateBigNumbers(&N, nullptr);
+        sha.Finalize();
+        memcpy(hash, sha.GetDigest(), 20);
+        sha.Initialize();
+        sha.UpdateBigNumbers(&g, nullptr);
+        sha.Finalize();
+        for (int i = 0; i < 20; ++i)
+            hash[i] ^= sha.GetDigest()[i];
+        BigNumber t3;
+        t3.SetBinary(hash, 20);
+
+        sha.Initialize();
+        sha.UpdateData(account.name);
+        sha.Finalize();
+        uint8 t4[SHA_DIGEST_LENGTH];
+        memcpy(t4, sha.GetDigest(), SHA_DIGEST_LENGTH);
+
+        sha.Initialize();
+        sha.UpdateBigNumbers(&t3, nullptr);
+        sha.UpdateData(t4, SHA_DIGEST_LENGTH);
+        sha.UpdateBigNumbers(&s, &proof.A, &B, &proof.K, nullptr);
+        sha.Finalize();
+        proof.M1.SetBinary(sha.GetDigest(), 20);
+
+        // M2 = sha1(A, M1, K)
+        sha.Initialize();
+        sha.UpdateBigNumbers(&proof.A, &proof.M1, &proof.K, nullptr);
+        sha.Finalize();
+        memcpy(proof.M2, sha.GetDigest(), SHA_DIGEST_LENGTH);
+        return proof;
+    }
+
+    // Computes S on both sides, from a random salt and the verifier realmd would save
+    bool CheckClientMath(BigNumber N, BigNumber g)
+    {
+        Account const account = MakeAccount("loadtest", "loadtest");
+        for (int round = 0; round < 20; ++round)
+        {
+            BigNumber s, a, b;
+            s.SetRand(32 * 8);
+            a.SetRand(19 * 8);
+            b.SetRand(19 * 8);
+
+            BigNumber v = g.ModExp(PrivateKey(s, account.passwordHash), N);
+            BigNumber B = ((v * 3) + g.ModExp(b, N)) % N;
+            ClientProof proof = ComputeClientProof(account, N, g, s, B, a);
+
+            Sha1Hash sha;
+            sha.UpdateBigNumbers(&proof.A, &B, nullptr);
+            sha.Finalize();
+            BigNumber u;
+            u.SetBinary(sha.GetDigest(), 20);
+            BigNumber serverS = (proof.A * (v.ModExp(u, N))).ModExp(b, N);
+
+            if (serverS.AsByteArray(32) != proof.S.AsByteArray(32))
+                return false;
+        }
+        return true;
+    }
+
+    class LogonClient
+    {
+        public:
+            LogonClient(ACE_INET_Addr const& address, Account const& account, uint16 build, uint32 timeout) :
+                m_address(address), m_account(account), m_build(build), m_timeout(timeout), m_error(0) {}
+
+            /// Runs one handshake, returns the failed step or STEP_COUNT
+            LogonStep Logon()
+            {
+                m_error = 0;
+                ACE_SOCK_Connector connector;
+                ACE_Time_Value timeout(m_timeout);
+                if (connector.connect(m_stream, m_address, &timeout) == -1)
+                    return STEP_CONNECT;
+
+                LogonStep failed = STEP_COUNT;
+                if (!Challenge())
+                    failed = STEP_CHALLENGE;
+                else if (!Proof())
+                    failed = STEP_PROOF;
+                else if (!RealmList())
+                    failed = STEP_REALM_LIST;
+
+                m_stream.close();
+                return failed;
+            }
+
+            /// AuthResult of the last failed step, 0 if the server did not send any
+            uint32 GetError() const { return m_error; }
+
+        private:
+            bool Send(ByteBuffer const& pkt)
+            {
+                ACE_Time_Value timeout(m_timeout);
+                return m_stream.send_n(pkt.contents(), pkt.size(), &timeout) == ssize_t(pkt.size());
+            }
+
+            bool Receive(void* data, size_t size)
+            {
+                ACE_Time_Value timeout(m_timeout);
+                return m_stream.recv_n(data, size, &timeout) == ssize_t(size);
+            }
+
+            bool Challenge()
+            {
+                // the client identifies itself as an english windows client
+                ByteBuffer pkt;
+                pkt << uint8(CMD_AUTH_LOGON_CHALLENGE);
+                pkt << uint8(3);
+                pkt << uint16(30 + m_account.name.size());
+                pkt.append("WoW", 4);
+                pkt << uint8(1) << uint8(12) << uint8(1);
+                pkt << uint16(m_build);
+                pkt.append("68x", 4);
+                pkt.append("niW", 4);
+                pkt.append("SUne", 4);
+                pkt << uint32(0);                           // timezone bias
+                pkt << uint32(0x0100007F);                  // local address
+                pkt << uint8(m_account.name.size());
+                pkt.append(m_account.name.c_str(), m_account.name.size());
+                if (!Send(pkt))
+                    return false;
+
+                uint8 header[3];
+                if (!Receive(header, sizeof(header)) || header[0] != CMD_AUTH_LOGON_CHALLENGE)
+                    return false;
+                if (header[2] != WOW_SUCCESS)
+                {
+                    m_error = header[2];
+                    return false;
+                }
+
+                uint8 B[32];
+                uint8 length;
+                uint8 g[255];
+                uint8 N[255];
+                uint8 s[32];
+                uint8 versionChallenge[16];
+                if (!Receive(B, sizeof(B)) || !Receive(&length, 1) || !Receive(g, length))
+                    return false;
+                m_g.SetBinary(g, length);
+                if (!Receive(&length, 1) || !Receive(N, length))
+                    return false;
+                m_N.SetBinary(N, length);
+                if (!Receive(s, sizeof(s)) || !Receive(versionChallenge, sizeof(versionChallenge)))
+                    return false;
+                m_B.SetBinary(B, sizeof(B));
+                m_s.SetBinary(s, sizeof(s));
+
+                if (m_build >= 5428)                        // version 1.11.0 or later
+                {
+                    uint8 securityFlags;
+                    if (!Receive(&securityFlags, 1) || securityFlags)
+                        return false;                       // PIN grid, not supported
+                }
+                return true;
+            }
+
+            bool Proof()
+            {
+                BigNumber a;
+                a.SetRand(19 * 8);
+                ClientProof proof = ComputeClientProof(m_account, m_N, m_g, m_s, m_B, a);
+
+                uint8 crcHash[20] = {};
+                ByteBuffer pkt;
+                pkt << uint8(CMD_AUTH_LOGON_PROOF);
+                pkt.append(proof.A.AsByteArray(32));
+                pkt.append(proof.M1.AsByteArray(20));
+                pkt.append(crcHash, sizeof(crcHash));
+                pkt << uint8(0);                            // number of keys
+                if (m_build >= 5428)
+                    pkt << uint8(0);                        // security flags
+                if (!Send(pkt))
+                    return false;
+
+                uint8 header[2];
+                if (!Receive(header, sizeof(header)) || header[0] != CMD_AUTH_LOGON_PROOF)
+                    return false;
+                if (header[1] != WOW_SUCCESS)
+                {
+                    m_error = header[1];
+                    return false;
+                }
+
+                // M2, survey id, and the login and account flags of the later builds
+                uint8 reply[20 + 4 + 2 + 4];
+                size_t const size = m_build < 6299 ? 24 : m_build < 8089 ? 26 : 30;
+                if (!Receive(reply, size))
+                    return false;
+                return !memcmp(reply, proof.M2, sizeof(proof.M2));
+            }
+
+            bool RealmList()
+            {
+                ByteBuffer pkt;
+                pkt << uint8(CMD_REALM_LIST);
+                pkt << uint32(0);
+                if (!Send(pkt))
+                    return false;
+
+                uint8 header[3];
+                if (!Receive(header, sizeof(header)) || header[0] != CMD_REALM_LIST)
+                    return false;
+                std::vector<uint8> realms(header[1] | (header[2] << 8));
+                return realms.empty() || Receive(realms.data(), realms.size());
+            }
+
+            ACE_INET_Addr const& m_address;
+            Account const m_account;
+            uint16 const m_build;
+            uint32 const m_timeout;                         // seconds
+            uint32 m_error;
+
+            ACE_SOCK_Stream m_stream;
+            BigNumber m_N, m_g, m_s, m_B;
+    };
+
+    void RunClient(ACE_INET_Addr const& address, Account const& account, uint16 build, uint32 logons, Results& results)
+    {
+        LogonClient client(address, account, build, 30);
+        std::vector<double> latencies;
+        latencies.reserve(logons);
+        uint32 failures[STEP_COUNT] = {};
+        uint32 lastError[STEP_COUNT] = {};
+
+        for (uint32 i = 0; i < logons; ++i)
+        {
+            auto const start = std::chrono::steady_clock::now();
+            LogonStep const failed = client.Logon();
+            if (failed != STEP_COUNT)
+            {
+                ++failures[failed];
+                if (client.GetError())
+                    lastError[failed] = client.GetError();
+                continue;
+            }
+            latencies.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        std::lock_guard<std::mutex> guard(results.lock);
+        results.latencies.insert(results.latencies.end(), latencies.begin(), latencies.end());
+        for (int step = 0; step < STEP_COUNT; ++step)
+        {
+            results.failures[step] += failures[step];
+            if (lastError[step])
+                results.lastError[step] = lastError[step];
+        }
+    }
+
+    double Percentile(std::vector<double> const& sorted, double percent)
+    {
+        return sorted[std::min(size_t(sorted.size() * percent / 100.0), sorted.size() - 1)];
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 5)
+    {
+        printf("Usage: %s <host> <port> <account> <password> [clients] [logons per client] [build]\n", argv[0]);
+        return 1;
+    }
+
+    uint32 const clients = argc > 5 ? std::max(atoi(argv[5]), 1) : 50;
+    uint32 const logons = argc > 6 ? std::max(atoi(argv[6]), 1) : 20;
+    uint16 const build = argc > 7 ? uint16(atoi(argv[7])) : 5875;
+
+    BigNumber N, g;
+    N.SetHexStr("894B645E89E1535BBDAD5B8B290650530801B18EBFBF5E8FAB3C82872A3E9BB7");
+    g.SetDword(7);
+    if (!CheckClientMath(N, g))
+    {
+        printf("the client and server SRP6 session keys differ\n");
+        return 1;
+    }
+
+    ACE_INET_Addr address(uint16(atoi(argv[2])), argv[1]);
+    std::vector<Account> accounts(clients);
+    for (uint32 i = 0; i < clients; ++i)
+    {
+        std::string name = argv[3];
+        size_t const number = name.find("%u");
+        if (number != std::string::npos)
+            name.replace(number, 2, std::to_string(i));
+        accounts[i] = MakeAccount(name, argv[4]);
+    }
+
+    printf("%u clients, %u logons each, build %u, to %s:%s\n", clients, logons, uint32(build), argv[1], argv[2]);
+
+    Results results;
+    std::vector<std::thread> threads;
+    auto const start = std::chrono::steady_clock::now();
+    for (uint32 i = 0; i < clients; ++i)
+        threads.emplace_back(RunClient, std::cref(address), std::cref(accounts[i]), build, logons, std::ref(results));
+    for (std::thread& thread : threads)
+        thread.join();
+    double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<double>& latencies = results.latencies;
+    std::sort(latencies.begin(), latencies.end());
+    printf("%zu/%u logons in %.3f s, %.1f logons/s\n", latencies.size(), clients * logons, seconds, latencies.size() / seconds);
+    if (!latencies.empty())
+        printf("latency ms: p50 %.2f, p90 %.2f, p99 %.2f, max %.2f\n",
+               Percentile(latencies, 50), Percentile(latencies, 90), Percentile(latencies, 99), latencies.back());
+
+    for (int step = 0; step < STEP_COUNT; ++step)
+        if (results.failures[step])
+            printf("%u failed at %s (last error %u)\n", results.failures[step], StepNames[step], results.lastError[step]);
+
+    return latencies.size() == clients * logons ? 0 : 1;
+}
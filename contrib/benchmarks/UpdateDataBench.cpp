@@ -0,0 +1,225 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Replays recorded update traffic through UpdateData::BuildPacket.
+ *
+ * The traffic is read from a world packet log (WorldLogFile in mangosd.conf):
+ * every SMSG_UPDATE_OBJECT and SMSG_COMPRESSED_UPDATE_OBJECT sent by the
+ * server is decompressed if needed, and its blocks are added again to an
+ * UpdateData. The blocks are kept as one opaque block per packet, so only the
+ * block count of the header differs from the recorded packet.
+ *
+ * Usage: updatedata-bench <world.log> [iterations] [compression level]
+ */
+
+#include "Common.h"
+#include "UpdateData.h"
+#include "WorldPacket.h"
+#include "World.h"
+#include "Opcodes.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+namespace
+{
+    std::atomic<bool> s_counting(false);
+    std::atomic<uint64> s_allocations(0);
+    std::atomic<uint64> s_allocatedBytes(0);
+
+    struct RecordedPacket
+    {
+        bool hasTransport;
+        ByteBuffer blocks;
+    };
+
+    // Parses the hex lines following "DATA:" up to the blank line ending the packet
+    bool ReadHexData(std::ifstream& file, std::vector<uint8>& data)
+    {
+        std::string line;
+        while (std::getline(file, line) && !line.empty())
+        {
+            char const* p = line.c_str();
+            while (*p)
+            {
+                char* end;
+                unsigned long byte = strtoul(p, &end, 16);
+                if (end == p)
+                    break;
+                data.push_back(uint8(byte));
+                p = end;
+            }
+        }
+        return !data.empty();
+    }
+
+    bool LoadWorldLog(char const* fileName, std::vector<RecordedPacket>& packets)
+    {
+        std::ifstream file(fileName);
+        if (!file)
+            return false;
+
+        std::string line;
+        bool server = false;
+        uint32 opcode = 0;
+        while (std::getline(file, line))
+        {
+            if (line == "SERVER:" || line == "CLIENT:")
+            {
+                server = line == "SERVER:";
+                opcode = 0;
+            }
+            else if (line.compare(0, 8, "OPCODE: ") == 0)
+            {
+                size_t pos = line.rfind("(0x");
+                opcode = pos != std::string::npos ? strtoul(line.c_str() + pos + 3, nullptr, 16) : 0;
+            }
+            else if (line == "DATA:" && server && (opcode == SMSG_UPDATE_OBJECT || opcode == SMSG_COMPRESSED_UPDATE_OBJECT))
+            {
+                std::vector<uint8> data;
+                if (!ReadHexData(file, data))
+                    continue;
+
+                if (opcode == SMSG_COMPRESSED_UPDATE_OBJECT)
+                {
+                    if (data.size() < sizeof(uint32))
+                        continue;
+                    uLongf size;
+                    uint32 rawSize;
+                    memcpy(&rawSize, data.data(), sizeof(uint32));
+                    size = rawSize;
+                    std::vector<uint8> raw(size);
+                    if (uncompress(raw.data(), &size, data.data() + sizeof(uint32), uLong(data.size() - sizeof(uint32))) != Z_OK)
+                        continue;
+                    raw.resize(size);
+                    data.swap(raw);
+                }
+
+                // uint32 block count, uint8 has transport, blocks
+                if (data.size() <= 5)
+                    continue;
+
+                packets.emplace_back();
+                RecordedPacket& packet = packets.back();
+                packet.hasTransport = data[4] != 0;
+                packet.blocks.append(data.data() + 5, data.size() - 5);
+            }
+        }
+        return true;
+    }
+}
+
+void* operator new(size_t size)
+{
+    if (s_counting.load(std::memory_order_relaxed))
+    {
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+        s_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    if (void* p = malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s <world.log> [iterations] [compression level]\n", argv[0]);
+        return 1;
+    }
+
+    uint32 const iterations = argc > 2 ? std::max(atoi(argv[2]), 1) : 10;
+    uint32 const level = argc > 3 ? std::min(std::max(atoi(argv[3]), 1), 9) : 1;
+    sWorld.setConfig(CONFIG_UINT32_COMPRESSION, level);
+
+    std::vector<RecordedPacket> packets;
+    if (!LoadWorldLog(argv[1], packets))
+    {
+        printf("Can not read '%s'\n", argv[1]);
+        return 1;
+    }
+    if (packets.empty())
+    {
+        printf("No update packet found in '%s', is it a WorldLogFile?\n", argv[1]);
+        return 1;
+    }
+
+    uint64 inputBytes = 0;
+    for (RecordedPacket const& packet : packets)
+        inputBytes += packet.blocks.wpos();
+    printf("%zu update packets, %.2f MB of blocks, %u iterations, compression level %u\n",
+           packets.size(), inputBytes / 1048576.0, iterations, level);
+
+    // warm up: the per thread zlib stream is created by the first compressed packet
+    for (RecordedPacket const& packet : packets)
+    {
+        UpdateData data;
+        data.AddUpdateBlock(packet.blocks);
+        WorldPacket result;
+        data.BuildPacket(&result, packet.hasTransport);
+    }
+
+    uint64 outputBytes = 0;
+    uint64 built = 0;
+    s_allocations = 0;
+    s_allocatedBytes = 0;
+    s_counting = true;
+    auto const start = std::chrono::steady_clock::now();
+    for (uint32 i = 0; i < iterations; ++i)
+    {
+        for (RecordedPacket const& packet : packets)
+        {
+            UpdateData data;
+            data.AddUpdateBlock(packet.blocks);
+            WorldPacket result;
+            if (data.BuildPacket(&result, packet.hasTransport))
+            {
+                outputBytes += result.size();
+                ++built;
+            }
+        }
+    }
+    auto const elapsed = std::chrono::steady_clock::now() - start;
+    s_counting = false;
+
+    double const seconds = std::chrono::duration<double>(elapsed).count();
+    uint64 const replayed = uint64(packets.size()) * iterations;
+    printf("built %llu/%llu packets in %.3f s\n", (unsigned long long)built, (unsigned long long)replayed, seconds);
+    printf("input  %.2f MB/s, %.0f packets/s\n", inputBytes * iterations / 1048576.0 / seconds, replayed / seconds);
+    printf("output %.2f MB, ratio %.3f\n", outputBytes / 1048576.0, double(outputBytes) / (inputBytes * iterations));
+    printf("allocations per packet %.2f (%.0f bytes)\n", double(s_allocations) / replayed, double(s_allocatedBytes) / replayed);
+    return 0;
+}
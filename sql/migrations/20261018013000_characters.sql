@@ -0,0 +1,67 @@
+DROP PROCEDURE IF EXISTS add_migration;
+delimiter ??
+CREATE PROCEDURE `add_migration`()
+BEGIN
+DECLARE v INT DEFAULT 1;
+SET v = (SELECT COUNT(*) FROM `migrations` WHERE `id`='20261018013000');
+IF v=0 THEN
+INSERT INTO `migrations` VALUES ('20261018013000');
+
+-- Async writes are committed in batches, which a rollback can only undo on transactional tables.
+ALTER TABLE `auction` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `bugreport` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `characters` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `characters_guid_delete` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `characters_item_delete` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `character_action` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `character_battleground_data` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `character_bgqueue` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `character_duplicate_account` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `character_forgotten_skills` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `character_gifts` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `character_homebind` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `character_honor_cp` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `character_instance` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `character_inventory` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `character_pet` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `character_queststatus` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `character_reputation` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `character_skills` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `character_social` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `character_spell` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `character_spell_cooldown` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `character_stats` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `character_ticket` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `character_tutorial` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `corpse` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `game_event_status` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `gm_subsurveys` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `gm_surveys` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `gm_tickets` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `groups` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `group_instance` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `group_member` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `guild` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `guild_eventlog` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `guild_member` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `guild_rank` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `instance` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `instance_reset` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `item_loot` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `item_text` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `mail_items` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `migrations` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `petition` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `petition_sign` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `pet_spell` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `pet_spell_cooldown` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `playerbot` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `saved_variables` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `world` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+ALTER TABLE `worldstates` ENGINE=InnoDB ROW_FORMAT=DEFAULT;
+
+END IF;
+END??
+delimiter ; 
+CALL add_migration();
+DROP PROCEDURE IF EXISTS add_migration;
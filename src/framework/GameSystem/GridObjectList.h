@@ -0,0 +1,308 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_GRIDOBJECTLIST_H
+#define MANGOS_GRIDOBJECTLIST_H
+
+#include "Platform/Define.h"
+
+#include <atomic>
+#include <vector>
+#include <limits>
+
+class GridObjectListBase;
+template<class OBJECT> class GridObjectList;
+
+/**
+ * @brief Slot of an object in the list of its grid cell. Lives inside the
+ *  object, the list keeps the index up to date when other objects leave.
+ */
+class GridObjectHandle
+{
+    friend class GridObjectListBase;
+
+    public:
+        GridObjectHandle() : m_list(nullptr), m_index(0) {}
+        ~GridObjectHandle() { unlink(); }
+
+        GridObjectHandle(GridObjectHandle const&) = delete;
+        GridObjectHandle& operator=(GridObjectHandle const&) = delete;
+
+        bool isValid() const { return m_list != nullptr; }
+
+        template<class OBJECT>
+        void link(GridObjectList<OBJECT>* list, OBJECT* obj)
+        {
+            unlink();
+            list->add(obj, this);
+        }
+
+        inline void unlink();
+
+        /// Refreshes the position cached by the list, see GridObjectList::MayBeWithinDist.
+        inline void SetPosition(float x, float y, float radius);
+
+    private:
+        GridObjectListBase* m_list;
+        uint32 m_index;
+};
+
+/**
+ * @brief Dense arrays shared by the lists of every object type: the objects,
+ *  their handles and a copy of their 2D position and bounding radius (structure
+ *  of arrays), so that a visitor can reject objects by distance without touching them.
+ *  Removal moves the last object into the freed slot. While the list is iterated
+ *  it only empties the slot instead, the last iterator to go away compacts the list.
+ */
+class GridObjectListBase
+{
+    friend class GridObjectHandle;
+
+    public:
+        uint32 getSize() const { return getSlotCount() - m_holes; }
+        bool isEmpty() const { return getSize() == 0; }
+
+        /// False only if the object at `index` can not be within `dist` (bounding radii
+        /// included, as in WorldObject::IsWithinDistInMap) of a point with the given radius.
+        bool MayBeWithinDist(uint32 index, float x, float y, float radius, float dist) const
+        {
+            float const maxDist = dist + radius + m_radius[index];
+            if (maxDist < 0.0f)
+                return true;
+            float const dx = m_x[index] - x;
+            float const dy = m_y[index] - y;
+            return dx * dx + dy * dy < maxDist * maxDist;
+        }
+
+    protected:
+        GridObjectListBase() = default;
+        ~GridObjectListBase()
+        {
+            for (GridObjectHandle* handle : m_handles)
+                if (handle)
+                    handle->m_list = nullptr;
+        }
+
+        GridObjectListBase(GridObjectListBase const&) = delete;
+        GridObjectListBase& operator=(GridObjectListBase const&) = delete;
+
+        uint32 getSlotCount() const { return uint32(m_objects.size()); }
+
+        // Iterators may run concurrently on several threads (visibility updates),
+        // they never do while the list is modified
+        void addIterator() { m_iterators.fetch_add(1, std::memory_order_relaxed); }
+        void removeIterator()
+        {
+            if (m_iterators.fetch_sub(1, std::memory_order_relaxed) == 1 && m_holes)
+                compact();
+        }
+
+        void addSlot(void* obj, GridObjectHandle* handle, float x, float y, float radius)
+        {
+            handle->m_list = this;
+            handle->m_index = getSlotCount();
+            m_objects.push_back(obj);
+            m_handles.push_back(handle);
+            m_x.push_back(x);
+            m_y.push_back(y);
+            m_radius.push_back(radius);
+        }
+
+        void removeSlot(uint32 index)
+        {
+            m_handles[index]->m_list = nullptr;
+
+            // moving the last object could move it before an iterator, which would skip it
+            if (m_iterators.load(std::memory_order_relaxed))
+            {
+                m_objects[index] = nullptr;
+                m_handles[index] = nullptr;
+                ++m_holes;
+                return;
+            }
+
+            uint32 const last = getSlotCount() - 1;
+            if (index != last)
+            {
+                m_objects[index] = m_objects[last];
+                m_handles[index] = m_handles[last];
+                m_x[index] = m_x[last];
+                m_y[index] = m_y[last];
+                m_radius[index] = m_radius[last];
+                m_handles[index]->m_index = index;
+            }
+            m_objects.pop_back();
+            m_handles.pop_back();
+            m_x.pop_back();
+            m_y.pop_back();
+            m_radius.pop_back();
+        }
+
+        // Removes the slots emptied during the iteration, keeping the order of the others
+        void compact()
+        {
+            uint32 kept = 0;
+            for (uint32 index = 0; index < getSlotCount(); ++index)
+            {
+                if (!m_objects[index])
+                    continue;
+                if (kept != index)
+                {
+                    m_objects[kept] = m_objects[index];
+                    m_handles[kept] = m_handles[index];
+                    m_x[kept] = m_x[index];
+                    m_y[kept] = m_y[index];
+                    m_radius[kept] = m_radius[index];
+                    m_handles[kept]->m_index = kept;
+                }
+                ++kept;
+            }
+            m_objects.resize(kept);
+            m_handles.resize(kept);
+            m_x.resize(kept);
+            m_y.resize(kept);
+            m_radius.resize(kept);
+            m_holes = 0;
+        }
+
+        std::atomic<uint32> m_iterators{0};
+        uint32 m_holes = 0;                                 // slots emptied while iterating
+        std::vector<void*> m_objects;
+        std::vector<GridObjectHandle*> m_handles;
+        std::vector<float> m_x;
+        std::vector<float> m_y;
+        std::vector<float> m_radius;
+};
+
+/**
+ * @brief Objects of one type in a grid cell.
+ *  OBJECT has to provide `bool GetGridPosition(float& x, float& y, float& radius) const`,
+ *  objects returning false are never rejected by MayBeWithinDist.
+ *
+ *  Iterating while objects join or leave the list is safe: objects added during
+ *  the iteration are not visited, objects removed before their turn are not visited,
+ *  every other object is visited once.
+ */
+template<class OBJECT>
+class GridObjectList : public GridObjectListBase
+{
+    friend class GridObjectHandle;
+
+    public:
+        class iterator
+        {
+            public:
+                iterator(GridObjectList* list, uint32 index, uint32 end) : m_list(list), m_index(index), m_end(end)
+                {
+                    if (m_list)
+                    {
+                        m_list->addIterator();
+                        skipHoles();
+                    }
+                }
+                iterator(iterator const& other) : m_list(other.m_list), m_index(other.m_index), m_end(other.m_end)
+                {
+                    if (m_list)
+                        m_list->addIterator();
+                }
+                ~iterator()
+                {
+                    if (m_list)
+                        m_list->removeIterator();
+                }
+
+                iterator& operator=(iterator const& other)
+                {
+                    if (other.m_list)
+                        other.m_list->addIterator();
+                    if (m_list)
+                        m_list->removeIterator();
+                    m_list = other.m_list;
+                    m_index = other.m_index;
+                    m_end = other.m_end;
+                    return *this;
+                }
+
+                OBJECT* getSource() const { return static_cast<OBJECT*>(m_list->m_objects[m_index]); }
+                uint32 getIndex() const { return m_index; }
+
+                // the iterator stands for the element, for `iter->getSource()` and `for (auto& iter : list)`
+                iterator const& operator*() const { return *this; }
+                iterator const* operator->() const { return this; }
+
+                iterator& operator++()
+                {
+                    ++m_index;
+                    skipHoles();
+                    return *this;
+                }
+
+                bool operator==(iterator const& other) const
+                {
+                    bool const atEnd = isEnd();
+                    bool const otherAtEnd = other.isEnd();
+                    return (atEnd || otherAtEnd) ? atEnd == otherAtEnd : m_index == other.m_index;
+                }
+                bool operator!=(iterator const& other) const { return !(*this == other); }
+
+            private:
+                // the slots are neither moved nor freed while an iterator exists
+                bool isEnd() const { return m_index >= m_end; }
+                void skipHoles()
+                {
+                    while (m_index < m_end && !m_list->m_objects[m_index])
+                        ++m_index;
+                }
+
+                GridObjectList* m_list;
+                uint32 m_index;
+                uint32 m_end;
+        };
+
+        iterator begin() { return iterator(this, 0, getSlotCount()); }
+        iterator end() { return iterator(nullptr, 0, 0); }
+
+        bool MayBeWithinDist(iterator const& itr, float x, float y, float radius, float dist) const
+        {
+            return GridObjectListBase::MayBeWithinDist(itr.getIndex(), x, y, radius, dist);
+        }
+
+    private:
+        void add(OBJECT* obj, GridObjectHandle* handle)
+        {
+            float x = 0.0f, y = 0.0f, radius = 0.0f;
+            if (!obj->GetGridPosition(x, y, radius))
+                radius = std::numeric_limits<float>::infinity();
+            addSlot(obj, handle, x, y, radius);
+        }
+};
+
+inline void GridObjectHandle::unlink()
+{
+    if (m_list)
+        m_list->removeSlot(m_index);
+}
+
+inline void GridObjectHandle::SetPosition(float x, float y, float radius)
+{
+    if (!m_list)
+        return;
+    m_list->m_x[m_index] = x;
+    m_list->m_y[m_index] = y;
+    m_list->m_radius[m_index] = radius;
+}
+
+#endif
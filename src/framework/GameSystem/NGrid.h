@@ -27,6 +27,7 @@
 
 #include "GameSystem/Grid.h"
 #include "GameSystem/GridReference.h"
+#include "GameSystem/GridRefManager.h"
 #include "Timer.h"
 
 #include <cassert>
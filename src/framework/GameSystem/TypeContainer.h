@@ -33,7 +33,7 @@
 #include <unordered_map>
 #include "Platform/Define.h"
 #include "Utilities/TypeList.h"
-#include "GameSystem/GridRefManager.h"
+#include "GameSystem/GridObjectList.h"
 
 template<class OBJECT, class KEY_TYPE>
 struct ContainerUnorderedMap
@@ -184,7 +184,7 @@ class TypeUnorderedMapContainer
 template<class OBJECT>
 struct ContainerMapList
 {
-    GridRefManager<OBJECT> _element;
+    GridObjectList<OBJECT> _element;
 };
 
 template<>
@@ -9,18 +9,19 @@
 #include <ace/SOCK_Connector.h>
 #include <ace/Acceptor.h>
 #include <ace/Connector.h>
-#include <ace/Unbounded_Queue.h>
 #include <ace/Message_Block.h>
 #include <mutex>
+#include <deque>
+#include <memory>
 
 #if !defined (ACE_LACKS_PRAGMA_ONCE)
 #pragma once
 #endif /* ACE_LACKS_PRAGMA_ONCE */
 
 #include "Common.h"
+#include "WorldPacket.h"
 
 class ACE_Message_Block;
-class WorldPacket;
 class WorldSession;
 
 
@@ -61,7 +62,9 @@ typedef ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH> WorldHandler;
  *
  * For output the class uses one buffer (64K usually) and
  * a queue where it stores packet if there is no place on
- * the queue. The reason this is done, is because the server
+ * the buffer. Queued packets get their header encrypted when
+ * queued and are written straight from the queue with writev,
+ * after the buffer. The reason this is done, is because the server
  * does really a lot of small-size writes to it, and it doesn't
  * scale well to allocate memory for every. When something is
  * written to the output buffer the socket is not immediately
@@ -105,8 +108,17 @@ class MangosSocket : public WorldHandler
         using LockType = std::mutex;
         typedef std::unique_lock<LockType> GuardType;
 
+        /// Packet for which there was no space in the output buffer.
+        /// The header is encrypted when queuing, to keep the cipher in wire order.
+        /// The payload may be shared with other sockets (broadcasts).
+        struct QueuedPacket
+        {
+            ServerPktHeader header;
+            std::shared_ptr<WorldPacket const> packet;
+        };
+
         /// Queue for storing packets for which there is no space.
-        typedef ACE_Unbounded_Queue<WorldPacket*> PacketQueueT;
+        typedef std::deque<QueuedPacket> PacketQueueT;
 
         /// Check if socket is closed.
         bool IsClosed() const { return closing_; }
@@ -128,6 +140,10 @@ class MangosSocket : public WorldHandler
         /// @return -1 of failure
         int SendPacket (const WorldPacket& pct);
 
+        /// Same as above for a payload sent to many sockets: if it has to be
+        /// queued, the queue keeps a reference instead of a copy.
+        int SendPacket (std::shared_ptr<WorldPacket const> const& pct);
+
         /// Add reference to this object.
         long AddReference() { return static_cast<long>(add_reference()); }
 
@@ -170,14 +186,12 @@ class MangosSocket : public WorldHandler
         int schedule_wakeup_output (GuardType& g);
 
         /// Try to write WorldPacket to m_OutBuffer ,return -1 if no space
+        /// or if packets are already queued.
         /// Need to be called with m_OutBufferLock lock held
         int iSendPacket (const WorldPacket& pct);
 
-        /// Flush m_PacketQueue if there are packets in it
-        /// Need to be called with m_OutBufferLock lock held
-        /// @return true if it wrote to the buffer ( AKA you need
-        /// to mark the socket for output ).
-        bool iFlushPacketQueue ();
+        /// Build and encrypt the header of a packet.
+        void BuildHeader (const WorldPacket& pct, ServerPktHeader& header);
 
         /// Time in which the last ping was received
         ACE_Time_Value m_LastPingTime;
@@ -221,6 +235,9 @@ class MangosSocket : public WorldHandler
         /// this allows not-to kick player if its buffer is overflowed.
         PacketQueueT m_PacketQueue;
 
+        /// Bytes of the first queued packet (header included) already sent.
+        size_t m_QueueSentBytes;
+
         /// True if the socket is registered with the reactor for output
         bool m_OutActive;
 
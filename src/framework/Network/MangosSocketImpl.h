@@ -5,6 +5,7 @@
 #include <ace/os_include/netinet/os_tcp.h>
 #include <ace/os_include/sys/os_types.h>
 #include <ace/os_include/sys/os_socket.h>
+#include <ace/os_include/sys/os_uio.h>
 #include <ace/OS_NS_string.h>
 #include <ace/Reactor.h>
 
@@ -34,6 +35,7 @@ MangosSocket<SessionType, SocketName, Crypt>::MangosSocket() :
     m_Header(sizeof(ClientPktHeader)),
     m_OutBuffer(0),
     m_OutBufferSize(65536),
+    m_QueueSentBytes(0),
     m_OutActive(false),
     m_Seed(static_cast<uint32>(rand32())),
     m_isServerSocket(true)
@@ -52,10 +54,6 @@ MangosSocket<SessionType, SocketName, Crypt>::~MangosSocket(void)
     closing_ = true;
 
     peer().close();
-
-    WorldPacket* pct;
-    while (m_PacketQueue.dequeue_head(pct) == 0)
-        delete pct;
 }
 
 template <typename SessionType, typename SocketName, typename Crypt>
@@ -88,18 +86,31 @@ int MangosSocket<SessionType, SocketName, Crypt>::SendPacket(const WorldPacket&
 
     if (((SocketName*)this)->iSendPacket(pct) == -1)
     {
-        WorldPacket* npct;
-
-        ACE_NEW_RETURN(npct, WorldPacket(pct), -1);
-
         // NOTE maybe check of the size of the queue can be good ?
         // to make it bounded instead of unbounded
-        if (m_PacketQueue.enqueue_tail(npct) == -1)
-        {
-            delete npct;
-            sLog.outError("MangosSocket<SessionType, SocketName, Crypt>::SendPacket: m_PacketQueue.enqueue_tail failed");
-            return -1;
-        }
+        m_PacketQueue.emplace_back();
+        QueuedPacket& queued = m_PacketQueue.back();
+        queued.packet = std::make_shared<WorldPacket const>(pct);
+        BuildHeader(*queued.packet, queued.header);
+    }
+
+    return 0;
+}
+
+template <typename SessionType, typename SocketName, typename Crypt>
+int MangosSocket<SessionType, SocketName, Crypt>::SendPacket(std::shared_ptr<WorldPacket const> const& pct)
+{
+    GuardType lock(m_OutBufferLock);
+
+    if (closing_)
+        return -1;
+
+    if (((SocketName*)this)->iSendPacket(*pct) == -1)
+    {
+        m_PacketQueue.emplace_back();
+        QueuedPacket& queued = m_PacketQueue.back();
+        queued.packet = pct;
+        BuildHeader(*pct, queued.header);
     }
 
     return 0;
@@ -211,13 +222,52 @@ int MangosSocket<SessionType, SocketName, Crypt>::handle_output(ACE_HANDLE)
 
     const size_t send_len = m_OutBuffer->length();
 
-    if (send_len == 0)
+    if (send_len == 0 && m_PacketQueue.empty())
         return cancel_wakeup_output(lock);
 
+    // Gather the buffer and the queued packets (header, payload) in a single call
+    const int MAX_QUEUED_PACKETS_PER_SEND = 64;
+    iovec iov[1 + 2 * MAX_QUEUED_PACKETS_PER_SEND];
+    int iovcnt = 0;
+
+    if (send_len)
+    {
+        iov[iovcnt].iov_base = m_OutBuffer->rd_ptr();
+        iov[iovcnt].iov_len = send_len;
+        ++iovcnt;
+    }
+
+    size_t skip = m_QueueSentBytes;
+    int packets = 0;
+    for (typename PacketQueueT::iterator itr = m_PacketQueue.begin(); itr != m_PacketQueue.end() && packets < MAX_QUEUED_PACKETS_PER_SEND; ++itr, ++packets)
+    {
+        if (skip < sizeof(ServerPktHeader))
+        {
+            iov[iovcnt].iov_base = (char*) &itr->header + skip;
+            iov[iovcnt].iov_len = sizeof(ServerPktHeader) - skip;
+            ++iovcnt;
+            skip = 0;
+        }
+        else
+            skip -= sizeof(ServerPktHeader);
+
+        if (itr->packet->size() > skip)
+        {
+            iov[iovcnt].iov_base = (char*) itr->packet->contents() + skip;
+            iov[iovcnt].iov_len = itr->packet->size() - skip;
+            ++iovcnt;
+        }
+        skip = 0;
+    }
+
 #ifdef MSG_NOSIGNAL
-    ssize_t n = peer().send(m_OutBuffer->rd_ptr(), send_len, MSG_NOSIGNAL);
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
+    ssize_t n = ::sendmsg(get_handle(), &msg, MSG_NOSIGNAL);
 #else
-    ssize_t n = peer().send(m_OutBuffer->rd_ptr(), send_len);
+    ssize_t n = peer().sendv(iov, iovcnt);
 #endif // MSG_NOSIGNAL
 
     if (n == 0)
@@ -229,26 +279,39 @@ int MangosSocket<SessionType, SocketName, Crypt>::handle_output(ACE_HANDLE)
 
         return -1;
     }
-    else if (n < (ssize_t)send_len) //now n > 0
-    {
-        m_OutBuffer->rd_ptr(static_cast<size_t>(n));
 
-        // move the data to the base of the buffer
-        m_OutBuffer->crunch();
+    size_t written = static_cast<size_t>(n);
 
-        return schedule_wakeup_output(lock);
-    }
-    else //now n == send_len
+    if (send_len)
     {
-        m_OutBuffer->reset();
+        const size_t from_buffer = written < send_len ? written : send_len;
+        m_OutBuffer->rd_ptr(from_buffer);
+        written -= from_buffer;
 
-        if (!iFlushPacketQueue())
-            return cancel_wakeup_output(lock);
+        if (m_OutBuffer->length() == 0)
+            m_OutBuffer->reset();
         else
-            return schedule_wakeup_output(lock);
+            m_OutBuffer->crunch();                          // move the data to the base of the buffer
+    }
+
+    while (written > 0 && !m_PacketQueue.empty())
+    {
+        const size_t left = sizeof(ServerPktHeader) + m_PacketQueue.front().packet->size() - m_QueueSentBytes;
+        if (written < left)
+        {
+            m_QueueSentBytes += written;
+            break;
+        }
+
+        written -= left;
+        m_QueueSentBytes = 0;
+        m_PacketQueue.pop_front();
     }
 
-    ACE_NOTREACHED(return 0);
+    if (m_OutBuffer->length() == 0 && m_PacketQueue.empty())
+        return cancel_wakeup_output(lock);
+
+    return schedule_wakeup_output(lock);
 }
 
 template <typename SessionType, typename SocketName, typename Crypt>
@@ -281,8 +344,12 @@ int MangosSocket<SessionType, SocketName, Crypt>::Update(void)
     if (closing_)
         return -1;
 
-    if (m_OutActive || m_OutBuffer->length() == 0)
-        return 0;
+    {
+        GuardType lock(m_OutBufferLock);
+
+        if (m_OutActive || (m_OutBuffer->length() == 0 && m_PacketQueue.empty()))
+            return 0;
+    }
 
     return handle_output(get_handle());
 }
@@ -481,16 +548,8 @@ int MangosSocket<SessionType, SocketName, Crypt>::schedule_wakeup_output(GuardTy
 }
 
 template <typename SessionType, typename SocketName, typename Crypt>
-int MangosSocket<SessionType, SocketName, Crypt>::iSendPacket(const WorldPacket& pct)
+void MangosSocket<SessionType, SocketName, Crypt>::BuildHeader(const WorldPacket& pct, ServerPktHeader& header)
 {
-    if (m_OutBuffer->space() < pct.size() + sizeof(ServerPktHeader))
-    {
-        errno = ENOBUFS;
-        return -1;
-    }
-
-    ServerPktHeader header;
-
     header.cmd = pct.GetOpcode();
 
     header.size = (uint16) pct.size() + 2;
@@ -499,6 +558,20 @@ int MangosSocket<SessionType, SocketName, Crypt>::iSendPacket(const WorldPacket&
     EndianConvert(header.cmd);
 
     m_Crypt.EncryptSend((uint8*) & header, sizeof(header));
+}
+
+template <typename SessionType, typename SocketName, typename Crypt>
+int MangosSocket<SessionType, SocketName, Crypt>::iSendPacket(const WorldPacket& pct)
+{
+    // Queued packets already have their header encrypted, they must go first
+    if (!m_PacketQueue.empty() || m_OutBuffer->space() < pct.size() + sizeof(ServerPktHeader))
+    {
+        errno = ENOBUFS;
+        return -1;
+    }
+
+    ServerPktHeader header;
+    BuildHeader(pct, header);
 
     if (m_OutBuffer->copy((char*) & header, sizeof(header)) == -1)
         ACE_ASSERT(false);
@@ -509,32 +582,3 @@ int MangosSocket<SessionType, SocketName, Crypt>::iSendPacket(const WorldPacket&
 
     return 0;
 }
-
-template <typename SessionType, typename SocketName, typename Crypt>
-bool MangosSocket<SessionType, SocketName, Crypt>::iFlushPacketQueue()
-{
-    WorldPacket *pct;
-    bool haveone = false;
-
-    while (m_PacketQueue.dequeue_head(pct) == 0)
-    {
-        if (((SocketName*)this)->iSendPacket(*pct) == -1)
-        {
-            if (m_PacketQueue.enqueue_head(pct) == -1)
-            {
-                delete pct;
-                sLog.outError("MangosSocket<SessionType, SocketName, Crypt>::iFlushPacketQueue m_PacketQueue->enqueue_head");
-                return false;
-            }
-
-            break;
-        }
-        else
-        {
-            haveone = true;
-            delete pct;
-        }
-    }
-
-    return haveone;
-}
@@ -20,12 +20,89 @@
 
 #include "EventProcessor.h"
 #include "Log.h" // Zerix: For MANGOS_ASSERT. No idea.
+#include "PooledAllocator.h"
+
+#include <algorithm>
+#include <new>
+
+#if COMPILER == COMPILER_MICROSOFT
+#  include <intrin.h>
+#endif
+
+namespace
+{
+    uint32 const WHEEL_LEVELS = 4;
+    uint32 const WHEEL_SLOT_BITS = 6;
+    uint32 const WHEEL_SLOTS = 1 << WHEEL_SLOT_BITS;
+    uint8 const OVERFLOW_LEVEL = WHEEL_LEVELS;
+    uint8 const SORTED_LIST_LEVEL = WHEEL_LEVELS + 1;
+
+    // Below this many events a sorted list is cheaper than the slots (2 KB each processor,
+    // cold in cache when thousands of units only hold a few timers)
+    uint32 const SORTED_LIST_MAX_EVENTS = 8;
+
+    // covers the common events (spells, lambdas with a few captures), bigger ones use the global allocator
+    size_t const POOLED_EVENT_SIZE = 128;
+
+    uint8 SlotOf(uint64 time, uint32 level)
+    {
+        return uint8((time >> (level * WHEEL_SLOT_BITS)) & (WHEEL_SLOTS - 1));
+    }
+
+    uint32 LowestBit(uint64 bits)
+    {
+#if COMPILER == COMPILER_MICROSOFT
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return uint32(index);
+#else
+        return uint32(__builtin_ctzll(bits));
+#endif
+    }
+}
+
+struct EventWheel
+{
+    BasicEvent* slots[WHEEL_LEVELS][WHEEL_SLOTS];           // circular lists, head is the oldest event
+    uint64 occupied[WHEEL_LEVELS];                          // one bit per non empty slot
+    BasicEvent* overflow;
+};
+
+static PooledAllocator& GetEventAllocator()
+{
+    static PooledAllocator* allocator = new PooledAllocator("BasicEvent", POOLED_EVENT_SIZE);
+    return *allocator;
+}
+
+static PooledAllocator& GetWheelAllocator()
+{
+    static PooledAllocator* allocator = new PooledAllocator("EventWheel", sizeof(EventWheel));
+    return *allocator;
+}
+
+void* BasicEvent::operator new(size_t size)
+{
+    return GetEventAllocator().allocate(size);
+}
+
+void BasicEvent::operator delete(void* pointer)
+{
+    GetEventAllocator().deallocate(pointer);
+}
 
 void BasicEvent::ScheduleAbort()
 {
     MANGOS_ASSERT(IsRunning()
            && "Tried to scheduled the abortion of an event twice!");
     m_abortState = AbortState::STATE_ABORT_SCHEDULED;
+
+    // move it to the current tick, it would otherwise only be aborted at its execution time
+    if (EventProcessor* owner = m_owner)
+    {
+        owner->UnlinkEvent(this);
+        m_execTime = owner->m_time;
+        owner->LinkEvent(this);
+    }
 }
 
 void BasicEvent::SetAborted()
@@ -38,21 +115,224 @@ void BasicEvent::SetAborted()
 EventProcessor::~EventProcessor()
 {
     KillAllEvents(true);
+    ReleaseWheel();
 }
 
-void EventProcessor::Update(uint32 p_time)
+BasicEvent*& EventProcessor::GetListHead(uint8 level, uint8 slot)
 {
-    // update time
-    m_time += p_time;
+    if (level == SORTED_LIST_LEVEL)
+        return m_sortedList;
+    return level == OVERFLOW_LEVEL ? m_wheel->overflow : m_wheel->slots[level][slot];
+}
 
-    // main event loop
-    EventList::iterator i;
-    while (((i = m_events.begin()) != m_events.end()) && i->first <= m_time)
+void EventProcessor::LinkSorted(BasicEvent* event)
+{
+    // after the events of the same time, searched from the end: new events are usually the last ones
+    if (BasicEvent* head = m_sortedList)
     {
-        // get and remove event from queue
-        BasicEvent* event = i->second;
-        m_events.erase(i);
+        BasicEvent* prev = head->m_prev;
+        while (prev->m_execTime > event->m_execTime && prev != head)
+            prev = prev->m_prev;
 
+        bool const first = prev->m_execTime > event->m_execTime;
+        if (first)
+            prev = head->m_prev;
+
+        event->m_prev = prev;
+        event->m_next = prev->m_next;
+        prev->m_next->m_prev = event;
+        prev->m_next = event;
+        if (first)
+            m_sortedList = event;
+    }
+    else
+    {
+        m_sortedList = event;
+        event->m_next = event;
+        event->m_prev = event;
+    }
+
+    event->m_owner = this;
+    event->m_level = SORTED_LIST_LEVEL;
+    event->m_slot = 0;
+    ++m_eventCount;
+}
+
+void EventProcessor::LinkEvent(BasicEvent* event)
+{
+    if (!m_wheel)
+    {
+        if (m_eventCount < SORTED_LIST_MAX_EVENTS)
+        {
+            m_nextDueTime = std::min(m_nextDueTime, event->m_execTime);
+            LinkSorted(event);
+            return;
+        }
+
+        m_wheel = new (GetWheelAllocator().allocate(sizeof(EventWheel))) EventWheel();
+        m_wheelTime = m_time;
+        m_nextDueTime = m_time;
+
+        // in their order, the events of a slot stay ordered as they were added
+        BasicEvent* list = m_sortedList;
+        m_sortedList = nullptr;
+        RelinkList(list);
+    }
+
+    // the level is given by the highest bits that differ from the wheel time
+    uint64 const time = std::max(event->m_execTime, m_wheelTime);
+    m_nextDueTime = std::min(m_nextDueTime, time);
+    uint64 const diff = time ^ m_wheelTime;
+    uint8 level = 0;
+    while (level < WHEEL_LEVELS && (diff >> ((level + 1) * WHEEL_SLOT_BITS)))
+        ++level;
+
+    uint8 const slot = level == OVERFLOW_LEVEL ? 0 : SlotOf(time, level);
+    BasicEvent*& head = GetListHead(level, slot);
+    if (!head)
+    {
+        head = event;
+        event->m_next = event;
+        event->m_prev = event;
+        if (level < WHEEL_LEVELS)
+            m_wheel->occupied[level] |= uint64(1) << slot;
+    }
+    else
+    {
+        event->m_next = head;
+        event->m_prev = head->m_prev;
+        head->m_prev->m_next = event;
+        head->m_prev = event;
+    }
+
+    event->m_owner = this;
+    event->m_level = level;
+    event->m_slot = slot;
+    ++m_eventCount;
+}
+
+void EventProcessor::UnlinkEvent(BasicEvent* event)
+{
+    BasicEvent*& head = GetListHead(event->m_level, event->m_slot);
+    if (event->m_next == event)
+    {
+        head = nullptr;
+        if (event->m_level < WHEEL_LEVELS)
+            m_wheel->occupied[event->m_level] &= ~(uint64(1) << event->m_slot);
+    }
+    else
+    {
+        event->m_prev->m_next = event->m_next;
+        event->m_next->m_prev = event->m_prev;
+        if (head == event)
+            head = event->m_next;
+    }
+
+    event->m_owner = nullptr;
+    event->m_next = nullptr;
+    event->m_prev = nullptr;
+    --m_eventCount;
+}
+
+void EventProcessor::RelinkList(BasicEvent* head)
+{
+    // detached list, relinked relative to the new wheel time in the same order
+    BasicEvent* event = head;
+    head->m_prev->m_next = nullptr;
+    while (event)
+    {
+        BasicEvent* next = event->m_next;
+        --m_eventCount;
+        LinkEvent(event);
+        event = next;
+    }
+}
+
+BasicEvent* EventProcessor::PopDueEvent()
+{
+    if (!m_wheel)
+    {
+        BasicEvent* event = m_sortedList;
+        if (!event)
+            return nullptr;
+
+        if (event->m_execTime > m_time)
+        {
+            m_nextDueTime = event->m_execTime;
+            return nullptr;
+        }
+
+        UnlinkEvent(event);
+        return event;
+    }
+
+    for (;;)
+    {
+        // level 0 slots are single milliseconds after the wheel time
+        if (uint64 const bits = m_wheel->occupied[0])
+        {
+            uint8 const slot = uint8(LowestBit(bits));
+            uint64 const time = (m_wheelTime & ~uint64(WHEEL_SLOTS - 1)) | slot;
+            if (time > m_time)
+            {
+                m_nextDueTime = time;
+                return nullptr;
+            }
+
+            m_wheelTime = time;
+            BasicEvent* event = m_wheel->slots[0][slot];
+            UnlinkEvent(event);
+            return event;
+        }
+
+        // nothing left in level 0, spread the first slot of the next non empty level
+        uint32 level = 1;
+        while (level < WHEEL_LEVELS && !m_wheel->occupied[level])
+            ++level;
+
+        uint64 start;
+        BasicEvent** head;
+        if (level < WHEEL_LEVELS)
+        {
+            uint32 const shift = level * WHEEL_SLOT_BITS;
+            uint8 const slot = uint8(LowestBit(m_wheel->occupied[level]));
+            start = ((m_wheelTime >> (shift + WHEEL_SLOT_BITS)) << (shift + WHEEL_SLOT_BITS)) | (uint64(slot) << shift);
+            head = &m_wheel->slots[level][slot];
+        }
+        else if (m_wheel->overflow)
+        {
+            uint64 first = m_wheel->overflow->m_execTime;
+            for (BasicEvent* event = m_wheel->overflow->m_next; event != m_wheel->overflow; event = event->m_next)
+                first = std::min(first, event->m_execTime);
+            uint32 const shift = WHEEL_LEVELS * WHEEL_SLOT_BITS;
+            start = (first >> shift) << shift;
+            head = &m_wheel->overflow;
+        }
+        else
+            return nullptr;
+
+        // the higher levels and the overflow list only hold later events
+        if (start > m_time)
+        {
+            m_nextDueTime = start;
+            return nullptr;
+        }
+
+        m_wheelTime = start;
+        BasicEvent* list = *head;
+        *head = nullptr;
+        if (level < WHEEL_LEVELS)
+            m_wheel->occupied[level] &= ~(uint64(1) << list->m_slot);
+        RelinkList(list);
+    }
+}
+
+void EventProcessor::ExecuteDueEvents(uint32 p_time)
+{
+    // main event loop
+    m_updating = true;
+    while (BasicEvent* event = PopDueEvent())
+    {
         if (event->IsRunning())
         {
             if (event->Execute(m_time, p_time))
@@ -80,37 +360,94 @@ void EventProcessor::Update(uint32 p_time)
         // the next update tick
         AddEvent(event, CalculateTime(1), false);
     }
+    m_updating = false;
+
+    // every event left is after m_time, the slots stay valid from there
+    m_wheelTime = m_time;
+
+    if (!m_eventCount)
+        ReleaseWheel();
 }
 
-void EventProcessor::KillAllEvents(bool force)
+void EventProcessor::CollectEvents(std::vector<BasicEvent*>& events) const
 {
-    for (auto itr = m_events.begin(); itr != m_events.end();)
+    events.reserve(m_eventCount);
+    auto collectList = [&events](BasicEvent* head)
     {
-        // Abort events which weren't aborted already
-        if (!itr->second->IsAborted())
+        if (BasicEvent* event = head)
         {
-            itr->second->SetAborted();
-            itr->second->Abort(m_time);
+            do
+            {
+                events.push_back(event);
+                event = event->m_next;
+            }
+            while (event != head);
         }
+    };
 
-        // Skip non-deletable events when we are
-        // not forcing the event cancellation.
-        if (!force && !itr->second->IsDeletable())
+    if (!m_wheel)
+    {
+        collectList(m_sortedList);
+        return;
+    }
+
+    // by time, except in the overflow list
+    for (uint32 level = 0; level < WHEEL_LEVELS; ++level)
+    {
+        for (uint32 i = 0; i < WHEEL_SLOTS; ++i)
         {
-            ++itr;
-            continue;
+            uint32 const slot = (SlotOf(m_wheelTime, level) + i) & (WHEEL_SLOTS - 1);
+            collectList(m_wheel->slots[level][slot]);
         }
+    }
+    collectList(m_wheel->overflow);
+}
+
+void EventProcessor::KillAllEvents(bool force)
+{
+    // events added by Abort() are killed too when forcing
+    do
+    {
+        std::vector<BasicEvent*> events;
+        CollectEvents(events);
+        for (BasicEvent* event : events)
+            UnlinkEvent(event);
 
-        delete itr->second;
+        for (BasicEvent* event : events)
+        {
+            // Abort events which weren't aborted already
+            if (!event->IsAborted())
+            {
+                event->SetAborted();
+                event->Abort(m_time);
+            }
 
-        if (force)
-            ++itr; // Clear the whole container when forcing
-        else
-            itr = m_events.erase(itr);
+            // Keep non-deletable events when we are
+            // not forcing the event cancellation.
+            if (!force && !event->IsDeletable())
+            {
+                LinkEvent(event);
+                continue;
+            }
+
+            delete event;
+        }
     }
+    while (force && m_eventCount);
+
+    if (!m_eventCount && !m_updating)
+        ReleaseWheel();
+}
+
+void EventProcessor::ReleaseWheel()
+{
+    if (!m_wheel)
+        return;
 
-    if (force)
-        m_events.clear();
+    MANGOS_ASSERT(!m_eventCount);
+    m_wheel->~EventWheel();
+    GetWheelAllocator().deallocate(m_wheel);
+    m_wheel = nullptr;
 }
 
 void EventProcessor::AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime)
@@ -118,7 +455,7 @@ void EventProcessor::AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime
     if (set_addtime)
         Event->m_addTime = m_time;
     Event->m_execTime = e_time;
-    m_events.insert(std::pair<uint64, BasicEvent*>(e_time, Event));
+    LinkEvent(Event);
 }
 
 uint64 EventProcessor::CalculateTime(uint64 t_offset) const
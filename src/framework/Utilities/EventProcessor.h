@@ -22,9 +22,11 @@
 #define __EVENTPROCESSOR_H
 
 #include "Platform/Define.h"
-#include <map>
+#include <cstddef>
+#include <vector>
 
 class EventProcessor;
+struct EventWheel;
 
 // Note. All times are in milliseconds here.
 
@@ -41,7 +43,8 @@ class BasicEvent
 
     public:
         BasicEvent()
-          : m_abortState(AbortState::STATE_RUNNING), m_addTime(0), m_execTime(0) { }
+          : m_abortState(AbortState::STATE_RUNNING), m_addTime(0), m_execTime(0),
+            m_owner(nullptr), m_next(nullptr), m_prev(nullptr), m_level(0), m_slot(0) { }
 
         virtual ~BasicEvent() { }                           // override destructor to perform some actions on event removal
 
@@ -57,6 +60,10 @@ class BasicEvent
         // Aborts the event at the next update tick
         void ScheduleAbort();
 
+        // pooled per thread, see PooledAllocator
+        static void* operator new(size_t size);
+        static void operator delete(void* pointer);
+
     private:
         void SetAborted();
         bool IsRunning() const { return (m_abortState == AbortState::STATE_RUNNING); }
@@ -68,6 +75,13 @@ class BasicEvent
         // these can be used for time offset control
         uint64 m_addTime;                                   // time when the event was added to queue, filled by event handler
         uint64 m_execTime;                                  // planned time of next execution, filled by event handler
+
+        // position in the timing wheel of the owner, set while the event is queued
+        EventProcessor* m_owner;
+        BasicEvent* m_next;
+        BasicEvent* m_prev;
+        uint8 m_level;
+        uint8 m_slot;
 };
 
 template<typename T>
@@ -87,15 +101,36 @@ private:
     T _callback;
 };
 
-typedef std::multimap<uint64, BasicEvent*> EventList;
-
+/**
+ * @brief Queue of timed events, as a hierarchical timing wheel: 4 levels of
+ *  64 slots of 1, 64, 4096 and 262144 ms, events further than ~4.6 hours in an
+ *  overflow list. An event is linked in the slot of its execution time (no
+ *  allocation, O(1) to add and to remove), the events of a higher level slot
+ *  are spread over the lower levels once the time reaches that slot.
+ *  Events are executed by time, then in the order they were added. Events added
+ *  with a time already reached run at the current update tick.
+ *  Up to 8 events are kept in a sorted list instead, the slots are only
+ *  allocated once there are more, until the processor has no event left.
+ */
 class EventProcessor
 {
+        friend class BasicEvent;
+
     public:
-        EventProcessor() : m_time(0) { }
+        EventProcessor() : m_time(0), m_wheelTime(0), m_nextDueTime(0), m_wheel(nullptr), m_sortedList(nullptr), m_eventCount(0), m_updating(false) { }
         ~EventProcessor();
 
-        void Update(uint32 p_time);
+        EventProcessor(EventProcessor const&) = delete;
+        EventProcessor& operator=(EventProcessor const&) = delete;
+
+        void Update(uint32 p_time)
+        {
+            m_time += p_time;
+
+            // nothing due yet, the usual case of units with a few long timers
+            if (m_eventCount && m_time >= m_nextDueTime)
+                ExecuteDueEvents(p_time);
+        }
         void KillAllEvents(bool force);
         uint64 CalculateTime(uint64 t_offset) const;
 
@@ -108,12 +143,37 @@ class EventProcessor
         void AddLambdaEventAtOffset(T&& event, uint32 offset) { AddEventAtOffset(new LambdaBasicEvent<T>(std::move(event)), offset); }
 
         // Zerix: Nostalrius compatibility. Figure a better way to handle this.
-        bool HasScheduledEvent() const { return m_events.empty() ? false : true; }
-        EventList const& GetEvents() const { return m_events; }
+        bool HasScheduledEvent() const { return m_eventCount != 0; }
+
+        // Calls `visitor(BasicEvent*)` for every queued event. The events are
+        // collected first, the visitor may add or abort events.
+        template<typename F>
+        void ForEachEvent(F&& visitor) const
+        {
+            std::vector<BasicEvent*> events;
+            CollectEvents(events);
+            for (BasicEvent* event : events)
+                visitor(event);
+        }
 
     protected:
+        void ExecuteDueEvents(uint32 p_time);
+        void LinkEvent(BasicEvent* event);
+        void LinkSorted(BasicEvent* event);
+        void UnlinkEvent(BasicEvent* event);
+        void RelinkList(BasicEvent* head);
+        BasicEvent* PopDueEvent();
+        BasicEvent*& GetListHead(uint8 level, uint8 slot);
+        void CollectEvents(std::vector<BasicEvent*>& events) const;
+        void ReleaseWheel();
+
         uint64 m_time;
-        EventList m_events;
+        uint64 m_wheelTime;                                 // time the slots are relative to, never after m_time
+        uint64 m_nextDueTime;                               // no event is due before, Update skips the wheel until then
+        EventWheel* m_wheel;
+        BasicEvent* m_sortedList;                           // events by time while there are only a few and no wheel
+        uint32 m_eventCount;
+        bool m_updating;
 };
 
 #endif
\ No newline at end of file
@@ -41,17 +41,11 @@ INSTANTIATE_SINGLETON_1(AuctionHouseMgr);
 
 bool AuctionHouseObject::RemoveAuction(AuctionEntry* entry)
 {
-    // Clean up multimaps before final erasure
-    auto bounds = OrderedAuctionMap.equal_range(entry->buyout);
-    for (AuctionMultiMap::iterator itr = bounds.first; itr != bounds.second; ++itr)
-    {
-        if (itr->second->Id == entry->Id) {
-            OrderedAuctionMap.erase(itr);
-            break;
-        }
-    }
+    // Clean up ordered maps before final erasure
+    OrderedAuctionMap.erase(GetSortKey(entry));
+    RemoveFromIndexes(entry);
 
-    bounds = AccountAuctionMap.equal_range(entry->ownerAccount);
+    auto bounds = AccountAuctionMap.equal_range(entry->ownerAccount);
     for (AuctionMultiMap::iterator itr = bounds.first; itr != bounds.second; ++itr)
     {
         if (itr->second->Id == entry->Id) {
@@ -72,8 +66,131 @@ void AuctionHouseObject::AddAuction(AuctionEntry* ah)
 {
     MANGOS_ASSERT(ah);
     AuctionsMap[ah->Id] = ah;
-    OrderedAuctionMap.insert(std::pair<uint32, AuctionEntry*>(ah->buyout, ah));
+    OrderedAuctionMap[GetSortKey(ah)] = ah;
     AccountAuctionMap.insert(std::pair<uint32, AuctionEntry*>(ah->ownerAccount, ah));
+    AddToIndexes(ah);
+}
+
+namespace
+{
+    // Packs every run of 3 characters of `name` (21 bits each, enough for any code point)
+    void BuildNameTrigrams(std::wstring const& name, std::vector<uint64>& trigrams)
+    {
+        for (size_t i = 0; i + 3 <= name.size(); ++i)
+            trigrams.push_back((uint64(name[i] & 0x1FFFFF) << 42) | (uint64(name[i + 1] & 0x1FFFFF) << 21) | uint64(name[i + 2] & 0x1FFFFF));
+    }
+
+    size_t GetBucketSize(AuctionHouseObject::AuctionIndex const& index, uint32 key)
+    {
+        auto itr = index.find(key);
+        return itr == index.end() ? 0 : itr->second.size();
+    }
+
+    void AddToIndex(AuctionHouseObject::AuctionIndex& index, uint32 key, AuctionHouseObject::AuctionSortKey const& sortKey, AuctionEntry* entry)
+    {
+        index[key][sortKey] = entry;
+    }
+
+    void RemoveFromIndex(AuctionHouseObject::AuctionIndex& index, uint32 key, AuctionHouseObject::AuctionSortKey const& sortKey)
+    {
+        auto itr = index.find(key);
+        if (itr == index.end())
+            return;
+        itr->second.erase(sortKey);
+        if (itr->second.empty())
+            index.erase(itr);
+    }
+}
+
+void AuctionHouseObject::AddToIndexes(AuctionEntry* entry)
+{
+    ItemPrototype const* proto = ObjectMgr::GetItemPrototype(entry->itemTemplate);
+    if (!proto)
+        return;
+
+    AuctionSortKey const key = GetSortKey(entry);
+    AddToIndex(m_classIndex, proto->Class, key, entry);
+    AddToIndex(m_subClassIndex, (proto->Class << 16) | proto->SubClass, key, entry);
+    AddToIndex(m_inventoryTypeIndex, proto->InventoryType, key, entry);
+    AddToIndex(m_qualityIndex, proto->Quality, key, entry);
+    AddToIndex(m_requiredLevelIndex, proto->RequiredLevel, key, entry);
+    AddToNameIndex(entry, proto);
+}
+
+void AuctionHouseObject::RemoveFromIndexes(AuctionEntry* entry)
+{
+    ItemPrototype const* proto = ObjectMgr::GetItemPrototype(entry->itemTemplate);
+    if (!proto)
+        return;
+
+    AuctionSortKey const key = GetSortKey(entry);
+    RemoveFromIndex(m_classIndex, proto->Class, key);
+    RemoveFromIndex(m_subClassIndex, (proto->Class << 16) | proto->SubClass, key);
+    RemoveFromIndex(m_inventoryTypeIndex, proto->InventoryType, key);
+    RemoveFromIndex(m_qualityIndex, proto->Quality, key);
+    RemoveFromIndex(m_requiredLevelIndex, proto->RequiredLevel, key);
+    RemoveFromNameIndex(entry);
+}
+
+void AuctionHouseObject::AddToNameIndex(AuctionEntry* entry, ItemPrototype const* proto)
+{
+    // Same early exit as the name filter of BuildListAuctionItems
+    if (!proto->Name1 || !*proto->Name1)
+        return;
+
+    ItemRandomPropertiesEntry const* randomProperty = nullptr;
+    if (Item* item = sAuctionMgr.GetAItem(entry->itemGuidLow))
+    {
+        int32 propertyId = item->GetItemRandomPropertyId();
+        if (propertyId > 0)
+            randomProperty = sItemRandomPropertiesStore.LookupEntry(static_cast<uint32>(propertyId));
+    }
+
+    int dbLocales = 0;
+    if (ItemLocale const* il = sObjectMgr.GetItemLocale(proto->ItemId))
+        dbLocales = int(il->Name.size());
+    // The suffix only depends on the dbc locale when there is one
+    int const dbcLocales = randomProperty ? MAX_DBC_LOCALE : 1;
+
+    std::vector<uint64>& trigrams = m_nameIndexKeys[entry->Id];
+    std::string name;
+    std::wstring wname;
+    for (int dbLocale = -1; dbLocale < dbLocales; ++dbLocale)
+    {
+        for (int dbcLocale = 0; dbcLocale < dbcLocales; ++dbcLocale)
+        {
+            name = proto->Name1;
+            Item::GetLocalizedNameWithSuffix(name, proto, randomProperty, dbLocale, LocaleConstant(dbcLocale));
+            if (!Utf8toWStr(name, wname))
+                continue;
+            wstrToLower(wname);
+            BuildNameTrigrams(wname, trigrams);
+        }
+    }
+
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    for (uint64 trigram : trigrams)
+        m_nameIndex[trigram].insert(entry->Id);
+}
+
+void AuctionHouseObject::RemoveFromNameIndex(AuctionEntry* entry)
+{
+    // The item may already be gone, so use the trigrams stored on insertion
+    auto keys = m_nameIndexKeys.find(entry->Id);
+    if (keys == m_nameIndexKeys.end())
+        return;
+
+    for (uint64 trigram : keys->second)
+    {
+        auto itr = m_nameIndex.find(trigram);
+        if (itr == m_nameIndex.end())
+            continue;
+        itr->second.erase(entry->Id);
+        if (itr->second.empty())
+            m_nameIndex.erase(itr);
+    }
+    m_nameIndexKeys.erase(keys);
 }
 
 AuctionHouseMgr::AuctionHouseMgr()
@@ -757,77 +874,262 @@ void AuctionHouseObject::BuildListAuctionItems(WorldPacket& data, Player* player
         return;
     }
 
-    int loc_idx = player->GetSession()->GetSessionDbLocaleIndex();
-    LocaleConstant dbc_loc = player->GetSession()->GetSessionDbcLocale();
+    bool exactBucket = false;
+    std::vector<AuctionEntry*> candidates;
+    AuctionOrderedMap const* bucket = SelectCandidates(query, candidates, exactBucket);
+
+    // Every auction of the bucket matches: build the page without checking each one
+    if (bucket && exactBucket)
+    {
+        totalcount = bucket->size();
+        if (query.listfrom < totalcount)
+        {
+            auto itr = bucket->cbegin();
+            std::advance(itr, query.listfrom);
+            for (; itr != bucket->cend(); ++itr)
+            {
+                if (!itr->second->IsAvailableFor(player))
+                    continue;
+
+                itr->second->BuildAuctionInfo(data);
+                if ((++count) >= 50)
+                    break;
+            }
+        }
+        return;
+    }
 
     // Micro opt on name/suffix initialization
     std::string name;
     name.reserve(140);
 
-    for (const auto& itr : OrderedAuctionMap)
+    auto checkAuction = [&](AuctionEntry* auctionEntry)
     {
-        AuctionEntry* auctionEntry = itr.second;
-        Item *item = sAuctionMgr.GetAItem(auctionEntry->itemGuidLow);
-        if (!item)
-            continue;
+        if (!MatchesQuery(auctionEntry, player, query, name))
+            return;
 
+        if (count < 50 && totalcount >= query.listfrom)
         {
-            ItemPrototype const* proto = item->GetProto();
+            ++count;
+            auctionEntry->BuildAuctionInfo(data);
+        }
+        ++totalcount;
+    };
 
-            if (query.auctionMainCategory != 0xffffffff && proto->Class != query.auctionMainCategory)
-                continue;
+    if (bucket)
+    {
+        for (const auto& itr : *bucket)
+            checkAuction(itr.second);
+    }
+    else
+    {
+        for (AuctionEntry* auctionEntry : candidates)
+            checkAuction(auctionEntry);
+    }
+}
 
-            if (query.auctionSubCategory != 0xffffffff && proto->SubClass != query.auctionSubCategory)
-                continue;
+AuctionHouseObject::AuctionOrderedMap const* AuctionHouseObject::SelectCandidates(AuctionHouseClientQuery const& query,
+        std::vector<AuctionEntry*>& candidates, bool& exactBucket) const
+{
+    // Pick the most selective index, every filter is checked again afterwards
+    enum CandidateSource
+    {
+        SOURCE_ALL,
+        SOURCE_CLASS,
+        SOURCE_SUBCLASS,
+        SOURCE_INVENTORY_TYPE,
+        SOURCE_QUALITY,
+        SOURCE_LEVEL,
+        SOURCE_NAME,
+    };
+
+    CandidateSource source = SOURCE_ALL;
+    size_t estimate = OrderedAuctionMap.size();
+    auto consider = [&](CandidateSource candidate, size_t size)
+    {
+        if (size < estimate)
+        {
+            source = candidate;
+            estimate = size;
+        }
+    };
+
+    bool const hasClass = query.auctionMainCategory != 0xffffffff;
+    bool const hasSubClass = query.auctionSubCategory != 0xffffffff;
+    bool const hasSlot = query.auctionSlotID != 0xffffffff;
+    bool const hasQuality = query.quality != 0xffffffff;
+    bool const hasLevel = query.levelmin != 0x00;
+    bool const hasName = query.wsearchedname.size() >= 3;
+
+    uint32 const subClassKey = (query.auctionMainCategory << 16) | query.auctionSubCategory;
+    if (hasClass)
+        consider(SOURCE_CLASS, GetBucketSize(m_classIndex, query.auctionMainCategory));
+    if (hasClass && hasSubClass)
+        consider(SOURCE_SUBCLASS, GetBucketSize(m_subClassIndex, subClassKey));
+    if (hasSlot)
+    {
+        size_t size = GetBucketSize(m_inventoryTypeIndex, query.auctionSlotID);
+        if (query.auctionSlotID == INVTYPE_CHEST)
+            size += GetBucketSize(m_inventoryTypeIndex, INVTYPE_ROBE);
+        consider(SOURCE_INVENTORY_TYPE, size);
+    }
+    if (hasQuality)
+    {
+        size_t size = 0;
+        for (const auto& itr : m_qualityIndex)
+            if (itr.first >= query.quality)
+                size += itr.second.size();
+        consider(SOURCE_QUALITY, size);
+    }
+    if (hasLevel)
+    {
+        size_t size = 0;
+        for (const auto& itr : m_requiredLevelIndex)
+            if (itr.first >= query.levelmin && (query.levelmax == 0x00 || itr.first <= query.levelmax))
+                size += itr.second.size();
+        consider(SOURCE_LEVEL, size);
+    }
 
-            if (query.auctionSlotID != 0xffffffff && proto->InventoryType != query.auctionSlotID &&
-                    (query.auctionSlotID != INVTYPE_CHEST || (query.auctionSlotID == INVTYPE_CHEST && proto->InventoryType != INVTYPE_ROBE)))
-                continue;
+    std::vector<std::unordered_set<uint32> const*> postings;
+    if (hasName)
+    {
+        std::vector<uint64> trigrams;
+        BuildNameTrigrams(query.wsearchedname, trigrams);
+        for (uint64 trigram : trigrams)
+        {
+            auto itr = m_nameIndex.find(trigram);
+            // No auction has this part of the name in any locale
+            if (itr == m_nameIndex.end())
+                return nullptr;
+            postings.push_back(&itr->second);
+        }
+        std::sort(postings.begin(), postings.end(),
+            [](std::unordered_set<uint32> const* a, std::unordered_set<uint32> const* b) { return a->size() < b->size(); });
+        consider(SOURCE_NAME, postings.front()->size());
+    }
 
-            if (query.quality != 0xffffffff && proto->Quality < query.quality)
-                continue;
+    switch (source)
+    {
+        case SOURCE_ALL:
+        case SOURCE_CLASS:
+        case SOURCE_SUBCLASS:
+        {
+            AuctionOrderedMap const* bucket = &OrderedAuctionMap;
+            if (source != SOURCE_ALL)
+            {
+                AuctionIndex const& index = source == SOURCE_CLASS ? m_classIndex : m_subClassIndex;
+                auto itr = index.find(source == SOURCE_CLASS ? query.auctionMainCategory : subClassKey);
+                if (itr == index.end())
+                    return nullptr;
+                bucket = &itr->second;
+            }
+            exactBucket = !hasSlot && !hasQuality && !hasLevel && query.usable == 0x00 && query.wsearchedname.empty() &&
+                (source == SOURCE_SUBCLASS || (source == SOURCE_CLASS && !hasSubClass));
+            return bucket;
+        }
+        case SOURCE_INVENTORY_TYPE:
+        case SOURCE_QUALITY:
+        case SOURCE_LEVEL:
+        {
+            AuctionIndex const& index = source == SOURCE_INVENTORY_TYPE ? m_inventoryTypeIndex :
+                                        source == SOURCE_QUALITY ? m_qualityIndex : m_requiredLevelIndex;
+            candidates.reserve(estimate);
+            for (const auto& itr : index)
+            {
+                bool selected;
+                if (source == SOURCE_INVENTORY_TYPE)
+                    selected = itr.first == query.auctionSlotID || (query.auctionSlotID == INVTYPE_CHEST && itr.first == INVTYPE_ROBE);
+                else if (source == SOURCE_QUALITY)
+                    selected = itr.first >= query.quality;
+                else
+                    selected = itr.first >= query.levelmin && (query.levelmax == 0x00 || itr.first <= query.levelmax);
+
+                if (selected)
+                    for (const auto& auction : itr.second)
+                        candidates.push_back(auction.second);
+            }
+            break;
+        }
+        case SOURCE_NAME:
+        {
+            candidates.reserve(estimate);
+            for (uint32 auctionId : *postings.front())
+            {
+                bool inAll = true;
+                for (size_t i = 1; i < postings.size() && inAll; ++i)
+                    inAll = postings[i]->count(auctionId) != 0;
+                if (!inAll)
+                    continue;
 
-            if (query.levelmin != 0x00 && (proto->RequiredLevel < query.levelmin || (query.levelmax != 0x00 && proto->RequiredLevel > query.levelmax)))
-                continue;
+                auto itr = AuctionsMap.find(auctionId);
+                if (itr != AuctionsMap.end())
+                    candidates.push_back(itr->second);
+            }
+            break;
+        }
+    }
 
-            if (query.usable != 0x00 && player->CanUseItem(item) != EQUIP_ERR_OK)
-                continue;
+    // Same order as OrderedAuctionMap
+    std::sort(candidates.begin(), candidates.end(),
+        [](AuctionEntry const* a, AuctionEntry const* b) { return GetSortKey(a) < GetSortKey(b); });
+    return nullptr;
+}
 
-            if (query.usable != 0x00 && proto->Class == ITEM_CLASS_RECIPE)
-                if (SpellEntry const* spell = sSpellMgr.GetSpellEntry(proto->Spells[0].SpellId))
-                    if (player->HasSpell(spell->EffectTriggerSpell[EFFECT_INDEX_0]))
-                        continue;
+bool AuctionHouseObject::MatchesQuery(AuctionEntry* auctionEntry, Player* player, AuctionHouseClientQuery const& query, std::string& name) const
+{
+    Item *item = sAuctionMgr.GetAItem(auctionEntry->itemGuidLow);
+    if (!item)
+        return false;
 
-            // IP locked auction
-            if (!auctionEntry->IsAvailableFor(player))
-                continue;
+    ItemPrototype const* proto = item->GetProto();
 
-            if (!query.wsearchedname.empty())
-            {
-                name = proto->Name1;
-                if (name.empty())
-                    continue;
+    if (query.auctionMainCategory != 0xffffffff && proto->Class != query.auctionMainCategory)
+        return false;
 
-                int32 propertyId = item->GetItemRandomPropertyId();
-                ItemRandomPropertiesEntry const* randomProperty = nullptr;
-                if (propertyId > 0)
-                     randomProperty = sItemRandomPropertiesStore.LookupEntry(static_cast<uint32>(propertyId));
+    if (query.auctionSubCategory != 0xffffffff && proto->SubClass != query.auctionSubCategory)
+        return false;
 
-                Item::GetLocalizedNameWithSuffix(name, proto, randomProperty, loc_idx, dbc_loc);
+    if (query.auctionSlotID != 0xffffffff && proto->InventoryType != query.auctionSlotID &&
+            (query.auctionSlotID != INVTYPE_CHEST || (query.auctionSlotID == INVTYPE_CHEST && proto->InventoryType != INVTYPE_ROBE)))
+        return false;
 
-                if (!Utf8FitTo(name, query.wsearchedname))
-                    continue;
-            }
+    if (query.quality != 0xffffffff && proto->Quality < query.quality)
+        return false;
 
-            if (count < 50 && totalcount >= query.listfrom)
-            {
-                ++count;
-                auctionEntry->BuildAuctionInfo(data);
-            }
-        }
+    if (query.levelmin != 0x00 && (proto->RequiredLevel < query.levelmin || (query.levelmax != 0x00 && proto->RequiredLevel > query.levelmax)))
+        return false;
 
-        ++totalcount;
+    if (query.usable != 0x00 && player->CanUseItem(item) != EQUIP_ERR_OK)
+        return false;
+
+    if (query.usable != 0x00 && proto->Class == ITEM_CLASS_RECIPE)
+        if (SpellEntry const* spell = sSpellMgr.GetSpellEntry(proto->Spells[0].SpellId))
+            if (player->HasSpell(spell->EffectTriggerSpell[EFFECT_INDEX_0]))
+                return false;
+
+    // IP locked auction
+    if (!auctionEntry->IsAvailableFor(player))
+        return false;
+
+    if (!query.wsearchedname.empty())
+    {
+        name = proto->Name1;
+        if (name.empty())
+            return false;
+
+        int32 propertyId = item->GetItemRandomPropertyId();
+        ItemRandomPropertiesEntry const* randomProperty = nullptr;
+        if (propertyId > 0)
+             randomProperty = sItemRandomPropertiesStore.LookupEntry(static_cast<uint32>(propertyId));
+
+        Item::GetLocalizedNameWithSuffix(name, proto, randomProperty,
+            player->GetSession()->GetSessionDbLocaleIndex(), player->GetSession()->GetSessionDbcLocale());
+
+        if (!Utf8FitTo(name, query.wsearchedname))
+            return false;
     }
+
+    return true;
 }
 
 // this function inserts to WorldPacket auction's data
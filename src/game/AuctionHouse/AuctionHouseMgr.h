@@ -24,6 +24,7 @@
 
 #include <vector>
 #include <memory>
+#include <unordered_set>
 
 #include "Common.h"
 #include "SharedDefines.h"
@@ -34,6 +35,7 @@ class Item;
 class Player;
 class Unit;
 class WorldPacket;
+struct ItemPrototype;
 
 #define MIN_AUCTION_TIME (2*HOUR)
 
@@ -117,6 +119,10 @@ class AuctionHouseObject
 
         typedef std::map<uint32, AuctionEntry*> AuctionEntryMap;
         typedef std::multimap<uint32, AuctionEntry*> AuctionMultiMap;
+        // (buyout, id): auctions listed by buyout price, ties broken by age
+        typedef std::pair<uint32, uint32> AuctionSortKey;
+        typedef std::map<AuctionSortKey, AuctionEntry*> AuctionOrderedMap;
+        typedef std::unordered_map<uint32, AuctionOrderedMap> AuctionIndex;
 
         uint32 GetCount() { return AuctionsMap.size(); }
 
@@ -141,12 +147,34 @@ class AuctionHouseObject
             uint32& count, uint32& totalcount);
         uint32 GetAccountAuctionCount(uint32 accountId) { return AccountAuctionMap.count(accountId); }
     private:
+        static AuctionSortKey GetSortKey(AuctionEntry const* entry) { return AuctionSortKey(entry->buyout, entry->Id); }
+
+        void AddToIndexes(AuctionEntry* entry);
+        void RemoveFromIndexes(AuctionEntry* entry);
+        void AddToNameIndex(AuctionEntry* entry, ItemPrototype const* proto);
+        void RemoveFromNameIndex(AuctionEntry* entry);
+        AuctionOrderedMap const* SelectCandidates(AuctionHouseClientQuery const& query, std::vector<AuctionEntry*>& candidates, bool& exactBucket) const;
+        bool MatchesQuery(AuctionEntry* entry, Player* player, AuctionHouseClientQuery const& query, std::string& name) const;
+
         // Map BUYOUT prices to entry for pre-sorted results. We maintain it in
         // a map rather than build the list on query for performance reasons.
         // Similarly, maintain a map of account ID -> auction entry
-        AuctionMultiMap OrderedAuctionMap;
+        AuctionOrderedMap OrderedAuctionMap;
         AuctionMultiMap AccountAuctionMap;
         AuctionEntryMap AuctionsMap;
+
+        // Secondary indexes for filtered searches, all sorted like OrderedAuctionMap.
+        // Item prototype fields never change, so entries are only touched in AddAuction/RemoveAuction.
+        AuctionIndex m_classIndex;                          // ItemPrototype::Class
+        AuctionIndex m_subClassIndex;                       // (Class << 16) | SubClass
+        AuctionIndex m_inventoryTypeIndex;                  // ItemPrototype::InventoryType
+        AuctionIndex m_qualityIndex;                        // ItemPrototype::Quality
+        AuctionIndex m_requiredLevelIndex;                  // ItemPrototype::RequiredLevel
+
+        // Trigrams of the lower case item names in every loaded locale -> auction ids.
+        // Only narrows the candidates, the name of the searching player's locale is still checked.
+        std::unordered_map<uint64, std::unordered_set<uint32>> m_nameIndex;
+        std::unordered_map<uint32, std::vector<uint64>> m_nameIndexKeys;
 };
 
 class AuctionHouseMgr
@@ -73,10 +73,12 @@ class Camera
         void UpdateForCurrentViewPoint();
 
     public:
-        GridReference<Camera>& GetGridRef() { return m_gridRef; }
+        GridObjectHandle& GetGridRef() { return m_gridRef; }
+        // follows the view point without being told when it moves inside its cell
+        bool GetGridPosition(float& /*x*/, float& /*y*/, float& /*radius*/) const { return false; }
         bool isActiveObject() const { return false; }
     private:
-        GridReference<Camera> m_gridRef;
+        GridObjectHandle m_gridRef;
 };
 
 /// Object-observer, notifies farsight object state to cameras that attached to it
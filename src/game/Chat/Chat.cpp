@@ -331,6 +331,11 @@ ChatCommand * ChatHandler::getCommandTable()
         { "faceme",         SEC_GAMEMASTER,     false, &ChatHandler::HandleDebugFaceMeCommand,              "", nullptr },
         { "assert",         SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugAssertFalseCommand,         "", nullptr },
         { "pvpcredit",      SEC_DEVELOPER,      false, &ChatHandler::HandleDebugPvPCreditCommand,           "", nullptr },
+        { "procstats",      SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugProcStatsCommand,           "", nullptr },
+        { "allocstats",     SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugAllocStatsCommand,          "", nullptr },
+        { "gridpreload",    SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugGridPreloadCommand,         "", nullptr },
+        { "opcodes",        SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugOpcodesCommand,             "", nullptr },
+        { "tickprofile",    SEC_ADMINISTRATOR,  true,  &ChatHandler::HandleDebugTickProfileCommand,         "", nullptr },
         { "unitstate",      SEC_GAMEMASTER,     false, &ChatHandler::HandleUnitStatCommand,                 "", nullptr },
         { "control",        SEC_GAMEMASTER,     false, &ChatHandler::HandleDebugControlCommand,             "", nullptr },
         { "monster",        SEC_GAMEMASTER,     false, &ChatHandler::HandleDebugMonsterChatCommand,         "", nullptr },
@@ -463,6 +463,11 @@ class ChatHandler
         bool HandleDebugSpellModsCommand(char* args);
         bool HandleDebugUpdateWorldStateCommand(char* args);
         bool HandleDebugOverflowCommand(char* args);
+        bool HandleDebugProcStatsCommand(char* args);
+        bool HandleDebugAllocStatsCommand(char* args);
+        bool HandleDebugGridPreloadCommand(char* args);
+        bool HandleDebugOpcodesCommand(char* args);
+        bool HandleDebugTickProfileCommand(char* args);
         bool HandleDebugChatFreezeCommand(char* args);
 
         bool HandleDebugPlayCinematicCommand(char* args);
@@ -49,6 +49,10 @@
 #include "CellImpl.h"
 #include "MoveSplineInit.h"
 #include "MoveSpline.h"
+#include "PooledAllocator.h"
+#include "GridPreloader.h"
+#include "OpcodeProfiler.h"
+#include "TickProfiler.h"
 
 bool ChatHandler::HandleSpellIconFixCommand(char *args)
 {
@@ -1609,6 +1613,143 @@ bool ChatHandler::HandleDebugChatFreezeCommand(char* args)
     return true;
 }
 
+bool ChatHandler::HandleDebugProcStatsCommand(char* args)
+{
+    bool reset = ExtractLiteralArg(&args, "reset") != nullptr;
+    Unit::ProcScanStats stats = Unit::GetProcScanStats(reset);
+
+    PSendSysMessage("Proc passes: " UI64FMTD, stats.calls);
+    PSendSysMessage("Holders present: " UI64FMTD ", candidates scanned: " UI64FMTD ", procs fired: " UI64FMTD, stats.holders, stats.scanned, stats.fired);
+    if (stats.calls)
+        PSendSysMessage("Per pass: %.2f holders, %.2f scanned, %.2f fired", double(stats.holders) / stats.calls, double(stats.scanned) / stats.calls, double(stats.fired) / stats.calls);
+    if (reset)
+        SendSysMessage("Counters reset.");
+    return true;
+}
+
+bool ChatHandler::HandleDebugAllocStatsCommand(char* /*args*/)
+{
+    for (auto const& stats : PooledAllocator::getAllStats())
+    {
+        PSendSysMessage("%s (%u bytes): " UI64FMTD " in use, " UI64FMTD " blocks in " UI64FMTD " chunks, %u thread caches",
+                        stats.name.c_str(), uint32(stats.blockSize), stats.inUse, stats.capacity, stats.chunks, stats.caches);
+        PSendSysMessage("  " UI64FMTD " allocations, " UI64FMTD " freed by another thread, " UI64FMTD " too big for the pool",
+                        stats.allocations, stats.remoteFrees, stats.oversized);
+    }
+    return true;
+}
+
+bool ChatHandler::HandleDebugGridPreloadCommand(char* /*args*/)
+{
+    GridPreloader::Stats const& stats = GridPreloader::GetStats();
+    uint64 const preloaded = stats.hits + stats.stale;
+    uint64 const loads = preloaded + stats.late + stats.misses;
+
+    PSendSysMessage("Grids preloaded: " UI64FMTD ", waiting for the map: " SI64FMTD ", expired unused: " UI64FMTD,
+                    uint64(stats.requested), int64(stats.ready), uint64(stats.expired));
+    PSendSysMessage("Grid loads: " UI64FMTD " preloaded (" UI64FMTD " with changed spawns), " UI64FMTD " still loading, " UI64FMTD " not predicted",
+                    preloaded, uint64(stats.stale), uint64(stats.late), uint64(stats.misses));
+    if (loads)
+        PSendSysMessage("Hit rate: %.1f%%", 100.0 * preloaded / loads);
+    return true;
+}
+
+bool ChatHandler::HandleDebugOpcodesCommand(char* args)
+{
+    static char const* const processingNames[PACKET_PROCESS_MAX_TYPE] = { "world", "map", "spells", "movement", "dbquery", "mastersafe" };
+
+    if (ExtractLiteralArg(&args, "reset"))
+    {
+        sOpcodeProfiler.Reset();
+        SendSysMessage("Opcode counters reset.");
+        return true;
+    }
+
+    if (ExtractLiteralArg(&args, "threads"))
+    {
+        for (auto const& stats : sOpcodeProfiler.GetThreadStats())
+        {
+            std::string processing;
+            for (uint32 i = 0; i < PACKET_PROCESS_MAX_TYPE; ++i)
+            {
+                if (stats.processingMask & (1 << i))
+                    processing += processing.empty() ? processingNames[i] : std::string(",") + processingNames[i];
+            }
+            PSendSysMessage("Thread #%u (%s)%s: " UI64FMTD " packets, " UI64FMTD "ms, most time in %s (" UI64FMTD "ms)",
+                            stats.index, processing.c_str(), stats.active ? "" : " exited", stats.calls, stats.totalTime / 1000,
+                            LookupOpcodeName(stats.topOpcode), stats.topOpcodeTime / 1000);
+        }
+        return true;
+    }
+
+    OpcodeProfiler::SortOrder order = OpcodeProfiler::SORT_BY_TOTAL_TIME;
+    if (ExtractLiteralArg(&args, "max"))
+        order = OpcodeProfiler::SORT_BY_MAX_TIME;
+    else if (ExtractLiteralArg(&args, "calls"))
+        order = OpcodeProfiler::SORT_BY_CALLS;
+    else if (ExtractLiteralArg(&args, "bytes"))
+        order = OpcodeProfiler::SORT_BY_BYTES;
+    else
+        ExtractLiteralArg(&args, "time");
+
+    uint32 count;
+    if (!ExtractOptUInt32(&args, count, 10))
+        return false;
+
+    if (!sOpcodeProfiler.IsEnabled())
+        SendSysMessage("The opcode profiler is disabled (OpcodeProfiler.Enable), the counters do not change.");
+
+    std::vector<OpcodeProfiler::OpcodeStats> stats = sOpcodeProfiler.GetOpcodeStats(order);
+    for (uint32 i = 0; i < count && i < stats.size(); ++i)
+    {
+        OpcodeProfiler::OpcodeStats const& s = stats[i];
+        PSendSysMessage("%s: " UI64FMTD " calls, " UI64FMTD "ms total, " UI64FMTD "us avg, " UI64FMTD "us max, " UI64FMTD " bytes (" UI64FMTD " max)",
+                        LookupOpcodeName(s.opcode), s.calls, s.totalTime / 1000, s.totalTime / s.calls, s.maxTime, s.bytes, s.maxSize);
+    }
+    return true;
+}
+
+bool ChatHandler::HandleDebugTickProfileCommand(char* args)
+{
+    if (ExtractLiteralArg(&args, "on"))
+    {
+        TickProfiler::SetRecording(true);
+        SendSysMessage("Tick profiler recording.");
+        return true;
+    }
+
+    if (ExtractLiteralArg(&args, "off"))
+    {
+        TickProfiler::SetRecording(false);
+        SendSysMessage("Tick profiler stopped.");
+        return true;
+    }
+
+    if (ExtractLiteralArg(&args, "dump"))
+    {
+        uint32 window;
+        if (!ExtractOptUInt32(&args, window, 2000))
+            return false;
+
+        std::string const fileName = sLog.GetLogsDir() + "tickprofile_" + Log::GetTimestampStr() + ".json";
+        int64 const events = TickProfiler::ExportChromeTrace(fileName, window);
+        if (events < 0)
+        {
+            PSendSysMessage("Can not write %s.", fileName.c_str());
+            SetSentErrorMessage(true);
+            return false;
+        }
+
+        PSendSysMessage("Wrote " SI64FMTD " events of the last %ums to %s.", events, window, fileName.c_str());
+        if (!TickProfiler::IsRecording())
+            SendSysMessage("The tick profiler is not recording, use \".debug tickprofile on\" first.");
+        return true;
+    }
+
+    PSendSysMessage("Tick profiler: %s. Usage: .debug tickprofile on|off|dump [#milliseconds]", TickProfiler::IsRecording() ? "recording" : "stopped");
+    return true;
+}
+
 bool ChatHandler::HandleDebugOverflowCommand(char* args)
 {
     std::string name("\360\222\214\245\360\222\221\243\360\222\221\251\360\223\213\215\360\223\213\210\360\223\211\241\360\222\214\245\360\222\221\243\360\222\221\251\360\223\213\215\360\223\213\210\360\223\211\241");
@@ -2581,6 +2722,9 @@ bool ChatHandler::HandleMmapStatsCommand(char* /*args*/)
     PSendSysMessage(" %u triangles (%u vertices)", triCount, triVertCount);
     PSendSysMessage(" %.2f MB of data (not including pointers)", ((float)dataSize / sizeof(unsigned char)) / 1048576);
 
+    if (MMAP::PathCorridorCache const* corridors = manager->GetCorridorCache(m_session->GetPlayer()->GetMapId()))
+        PSendSysMessage(" corridor cache: %u hits, %u misses", corridors->GetHits(), corridors->GetMisses());
+
     return true;
 }
 
@@ -831,6 +831,11 @@ bool ChatHandler::HandleInstanceStatsCommand(char* /*args*/)
     PSendSysMessage("instance saves: %d", numSaves);
     PSendSysMessage("players bound: %d", numBoundPlayers);
     PSendSysMessage("groups bound: %d", numBoundGroups);
+
+    MapUpdateStats const& stats = sMapMgr.GetLastUpdateStats();
+    PSendSysMessage("last map update: %ums, %u continents, %u instances", stats.tickTime, stats.continents, stats.instances);
+    PSendSysMessage("scheduler tasks: %u, stolen: %u, helped: %u", stats.executed, stats.stolen, stats.helped);
+    PSendSysMessage("critical path: map %u instance %u (%ums)", stats.criticalMapId, stats.criticalInstanceId, stats.criticalMapTime);
     return true;
 }
 
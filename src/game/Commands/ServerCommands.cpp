@@ -326,6 +326,14 @@ bool ChatHandler::HandleServerInfoCommand(char* /*args*/)
     PSendSysMessage("Players online: %i (%i queued). Max online: %i (%i queued).", activeClientsNum, queuedClientsNum, maxActiveClientsNum, maxQueuedClientsNum);
     PSendSysMessage(LANG_UPTIME, str.c_str());
 
+    World::CharacterSaveStats const saveStats = sWorld.GetCharacterSaveStats();
+    if (saveStats.saves)
+    {
+        PSendSysMessage("Character saves: " UI64FMTD " (" UI64FMTD " full), %.1f statements and " UI64FMTD " bytes per save on average.",
+            saveStats.saves, saveStats.fullSaves, float(saveStats.statements) / saveStats.saves, saveStats.bytes / saveStats.saves);
+        PSendSysMessage("Largest character save: %u bytes (character %u).", saveStats.largestBytes, saveStats.largestGuid);
+    }
+
     return true;
 }
 
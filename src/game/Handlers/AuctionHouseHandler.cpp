@@ -398,9 +398,10 @@ void WorldSession::HandleAuctionSellItem(WorldPacket& recv_data)
     data.parts[1].money = buyout;
     sWorld.LogTransaction(data);
 
+    // Item first: the auction indexes read its random property
+    sAuctionMgr.AddAItem(it);
     auctionHouse->AddAuction(AH);
 
-    sAuctionMgr.AddAItem(it);
     pl->MoveItemFromInventory(it->GetBagSlot(), it->GetSlot(), true);
 
     CharacterDatabase.BeginTransaction(pl->GetGUIDLow());
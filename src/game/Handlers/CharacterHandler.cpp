@@ -44,6 +44,9 @@
 #include "MasterPlayer.h"
 #include "PlayerBroadcaster.h"
 
+#include <mutex>
+#include <unordered_map>
+
 // config option SkipCinematics supported values
 enum CinematicsSkipMode
 {
@@ -114,6 +117,187 @@ bool LoginQueryHolder::Initialize()
     return res;
 }
 
+// Login query results of recently logged out characters. Once the logout save
+// is in the database (the prefetch holder is queued on the serial queue of the
+// character, after the save), the queries on the tables only written by the
+// character itself while online are run again and kept for a short while, so
+// that logging back in only has to run the other ones. Every entry is used at
+// most once, and a login always drops the entry of the character, even one
+// still waiting for its results.
+class LoginQueryCache
+{
+public:
+    void Prefetch(ObjectGuid guid);
+    void Invalidate(ObjectGuid guid);
+    // moves the cached results into the holder, the holder then only runs the other queries
+    bool Apply(LoginQueryHolder* holder);
+
+    void HandlePrefetchCallback(QueryResult* /*dummy*/, SqlQueryHolder* holder, uint32 generation);
+
+    static bool IsCacheable(size_t index);
+
+private:
+    struct Entry
+    {
+        uint32 generation;
+        time_t expireTime;
+        LoginQueryHolder* results;                          // nullptr until the prefetch is done
+    };
+
+    void RemoveExpired(time_t now);
+
+    std::mutex m_lock;
+    std::unordered_map<uint32, Entry> m_entries;
+    uint32 m_generation = 0;
+} loginQueryCache;
+
+bool LoginQueryCache::IsCacheable(size_t index)
+{
+    switch (index)
+    {
+        // the character row, groups, instance binds, honor, friends, guilds and
+        // mails can change while the character is offline: always loaded
+        case PLAYER_LOGIN_QUERY_LOADAURAS:
+        case PLAYER_LOGIN_QUERY_LOADSPELLS:
+        case PLAYER_LOGIN_QUERY_LOADQUESTSTATUS:
+        case PLAYER_LOGIN_QUERY_LOADREPUTATION:
+        case PLAYER_LOGIN_QUERY_LOADINVENTORY:
+        case PLAYER_LOGIN_QUERY_LOADITEMLOOT:
+        case PLAYER_LOGIN_QUERY_LOADACTIONS:
+        case PLAYER_LOGIN_QUERY_LOADHOMEBIND:
+        case PLAYER_LOGIN_QUERY_LOADSPELLCOOLDOWNS:
+        case PLAYER_LOGIN_QUERY_LOADSKILLS:
+        case PLAYER_LOGIN_QUERY_FORGOTTEN_SKILLS:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void LoginQueryCache::RemoveExpired(time_t now)
+{
+    for (auto itr = m_entries.begin(); itr != m_entries.end();)
+    {
+        if (itr->second.expireTime <= now)
+        {
+            delete itr->second.results;
+            itr = m_entries.erase(itr);
+        }
+        else
+            ++itr;
+    }
+}
+
+void LoginQueryCache::Prefetch(ObjectGuid guid)
+{
+    uint32 const cacheTime = sWorld.getConfig(CONFIG_UINT32_LOGIN_CACHE_TIME);
+    if (!cacheTime)
+        return;
+
+    LoginQueryHolder* holder = new LoginQueryHolder(0, guid);
+    if (!holder->Initialize())
+    {
+        delete holder;
+        return;
+    }
+
+    // drop the other queries, GetResult frees their text
+    for (size_t i = 0; i < MAX_PLAYER_LOGIN_QUERY; ++i)
+        if (!IsCacheable(i))
+            holder->GetResult(i);
+
+    uint32 generation;
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        time_t const now = time(nullptr);
+        RemoveExpired(now);
+
+        Entry& entry = m_entries[guid.GetCounter()];
+        delete entry.results;
+        entry.generation = generation = ++m_generation;
+        entry.expireTime = now + cacheTime;
+        entry.results = nullptr;
+    }
+
+    CharacterDatabase.DelayQueryHolder(this, &LoginQueryCache::HandlePrefetchCallback, (SqlQueryHolder*)holder, generation);
+}
+
+void LoginQueryCache::HandlePrefetchCallback(QueryResult* /*dummy*/, SqlQueryHolder* holder, uint32 generation)
+{
+    if (!holder)
+        return;
+
+    LoginQueryHolder* results = static_cast<LoginQueryHolder*>(holder);
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        auto itr = m_entries.find(results->GetGuid().GetCounter());
+        if (itr != m_entries.end() && itr->second.generation == generation && !itr->second.results)
+        {
+            itr->second.results = results;
+            return;
+        }
+    }
+
+    // the character logged in (or was deleted) in the meantime
+    delete results;
+}
+
+void LoginQueryCache::Invalidate(ObjectGuid guid)
+{
+    LoginQueryHolder* results = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        auto itr = m_entries.find(guid.GetCounter());
+        if (itr == m_entries.end())
+            return;
+        results = itr->second.results;
+        m_entries.erase(itr);
+    }
+    delete results;
+}
+
+bool LoginQueryCache::Apply(LoginQueryHolder* holder)
+{
+    LoginQueryHolder* results = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        auto itr = m_entries.find(holder->GetGuid().GetCounter());
+        if (itr == m_entries.end())
+            return false;
+        if (itr->second.expireTime > time(nullptr))
+            results = itr->second.results;
+        else
+            delete itr->second.results;
+        m_entries.erase(itr);
+    }
+
+    if (!results)
+        return false;
+
+    for (size_t i = 0; i < MAX_PLAYER_LOGIN_QUERY; ++i)
+    {
+        if (!IsCacheable(i))
+            continue;
+
+        // GetResult frees the query text of the login holder, it is not run anymore
+        holder->GetResult(i);
+        holder->SetResult(i, results->GetResult(i));
+        results->SetResult(i, nullptr);
+    }
+    delete results;
+    return true;
+}
+
+void WorldSession::PrefetchLoginQueries(ObjectGuid guid)
+{
+    loginQueryCache.Prefetch(guid);
+}
+
+void WorldSession::ForgetPrefetchedLogin(ObjectGuid guid)
+{
+    loginQueryCache.Invalidate(guid);
+}
+
 // don't call WorldSession directly
 // it may get deleted before the query callbacks get executed
 // instead pass an account id to this handler
@@ -459,6 +643,7 @@ void WorldSession::HandlePlayerLoginOpcode(WorldPacket& recv_data)
         delete holder;                                      // delete all unprocessed queries
         return;
     }
+    loginQueryCache.Apply(holder);
     m_playerLoading = true;
     CharacterDatabase.DelayQueryHolderUnsafe(&chrHandler, &CharacterHandler::HandlePlayerLoginCallback, holder);
 }
@@ -472,6 +657,7 @@ void WorldSession::LoginPlayer(ObjectGuid loginPlayerGuid)
         delete holder;                                      // delete all unprocessed queries
         return;
     }
+    loginQueryCache.Apply(holder);
     m_playerLoading = true;
     CharacterDatabase.DelayQueryHolderUnsafe(&chrHandler, &CharacterHandler::HandlePlayerLoginCallback, holder);
 }
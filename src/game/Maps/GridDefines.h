@@ -64,12 +64,12 @@ typedef TYPELIST_4(Player, Creature/*pets*/, Corpse/*resurrectable*/, Camera)
 typedef TYPELIST_4(GameObject, Creature/*except pets*/, DynamicObject, Corpse/*Bones*/) AllGridObjectTypes;
 typedef TYPELIST_4(Creature, Pet, GameObject, DynamicObject)                            AllMapStoredObjectTypes;
 
-typedef GridRefManager<Camera>          CameraMapType;
-typedef GridRefManager<Corpse>          CorpseMapType;
-typedef GridRefManager<Creature>        CreatureMapType;
-typedef GridRefManager<DynamicObject>   DynamicObjectMapType;
-typedef GridRefManager<GameObject>      GameObjectMapType;
-typedef GridRefManager<Player>          PlayerMapType;
+typedef GridObjectList<Camera>         CameraMapType;
+typedef GridObjectList<Corpse>         CorpseMapType;
+typedef GridObjectList<Creature>       CreatureMapType;
+typedef GridObjectList<DynamicObject>  DynamicObjectMapType;
+typedef GridObjectList<GameObject>     GameObjectMapType;
+typedef GridObjectList<Player>         PlayerMapType;
 
 typedef Grid<Player, AllWorldObjectTypes,AllGridObjectTypes> GridType;
 typedef NGrid<MAX_NUMBER_OF_CELLS, Player, AllWorldObjectTypes, AllGridObjectTypes> NGridType;
@@ -25,12 +25,20 @@
 #include "DBCStores.h"
 #include "GridMap.h"
 #include "VMapFactory.h"
+#include "MapTree.h"
 #include "MoveMap.h"
 #include "World.h"
 #include "Policies/SingletonImp.h"
 #include "Util.h"
 #include "SQLStorages.h"
 
+#if PLATFORM != PLATFORM_WINDOWS
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 char const* MAP_MAGIC         = "MAPS";
 char const* MAP_VERSION_MAGIC = "z1.4";
 char const* MAP_AREA_MAGIC    = "AREA";
@@ -75,6 +83,12 @@ bool GridMap::loadData(char const* filename)
     // Unload old data if exist
     unloadData();
 
+    // Anything the mapping can not serve as is (missing, outdated or misaligned file)
+    // goes through the regular path below, which also reports the errors
+    if (sWorld.getConfig(CONFIG_BOOL_TERRAIN_MEMORY_MAPPED) && loadMappedData(filename))
+        return true;
+    unloadData();
+
     GridMapFileHeader header;
     // Not return error if file not found
     FILE* in = fopen(filename, "rb");
@@ -120,12 +134,23 @@ bool GridMap::loadData(char const* filename)
 
 void GridMap::unloadData()
 {
-    delete[] m_area_map;
-    delete[] m_V9;
-    delete[] m_V8;
-    delete[] m_liquidEntry;
-    delete[] m_liquidFlags;
-    delete[] m_liquid_map;
+    if (m_mappedFile)
+    {
+#if PLATFORM != PLATFORM_WINDOWS
+        munmap(m_mappedFile, m_mappedSize);
+#endif
+        m_mappedFile = nullptr;
+        m_mappedSize = 0;
+    }
+    else
+    {
+        delete[] m_area_map;
+        delete[] m_V9;
+        delete[] m_V8;
+        delete[] m_liquidEntry;
+        delete[] m_liquidFlags;
+        delete[] m_liquid_map;
+    }
 
     m_area_map = nullptr;
     m_V9 = nullptr;
@@ -232,6 +257,142 @@ bool GridMap::loadGridMapLiquidData(FILE* in, uint32 offset, uint32 /*size*/)
     return true;
 }
 
+bool GridMap::loadMappedData(char const* filename)
+{
+#if PLATFORM != PLATFORM_WINDOWS
+    int const fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || size_t(fileStat.st_size) < sizeof(GridMapFileHeader))
+    {
+        close(fd);
+        return false;
+    }
+
+    // Shared read-only pages: instant load, only the parts of the grid actually
+    // queried get faulted in, and every process of the host shares the page cache
+    void* data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    m_mappedFile = data;
+    m_mappedSize = fileStat.st_size;
+
+    GridMapFileHeader header;
+    memcpy(&header, m_mappedFile, sizeof(header));
+    if (header.mapMagic != *((uint32 const*)(MAP_MAGIC)) ||
+            header.versionMagic != *((uint32 const*)(MAP_VERSION_MAGIC)))
+        return false;
+
+    return (!header.areaMapOffset || loadMappedAreaData(header.areaMapOffset)) &&
+           (!header.heightMapOffset || loadMappedHeightData(header.heightMapOffset)) &&
+           (!header.liquidMapOffset || loadMappedLiquidData(header.liquidMapOffset));
+#else
+    return false;
+#endif
+}
+
+template<typename T>
+T* GridMap::getMappedArray(size_t offset, size_t count) const
+{
+    if (offset + count * sizeof(T) > m_mappedSize || offset % alignof(T))
+        return nullptr;
+
+    // never written to, the pages are mapped read-only
+    return reinterpret_cast<T*>(static_cast<uint8*>(m_mappedFile) + offset);
+}
+
+bool GridMap::loadMappedAreaData(uint32 offset)
+{
+    GridMapAreaHeader header;
+    if (offset + sizeof(header) > m_mappedSize)
+        return false;
+    memcpy(&header, static_cast<uint8*>(m_mappedFile) + offset, sizeof(header));
+    if (header.fourcc != *((uint32 const*)(MAP_AREA_MAGIC)))
+        return false;
+
+    m_gridArea = header.gridArea;
+    if (!(header.flags & MAP_AREA_NO_AREA))
+        if (!(m_area_map = getMappedArray<uint16>(offset + sizeof(header), 16 * 16)))
+            return false;
+
+    return true;
+}
+
+bool GridMap::loadMappedHeightData(uint32 offset)
+{
+    GridMapHeightHeader header;
+    if (offset + sizeof(header) > m_mappedSize)
+        return false;
+    memcpy(&header, static_cast<uint8*>(m_mappedFile) + offset, sizeof(header));
+    if (header.fourcc != *((uint32 const*)(MAP_HEIGHT_MAGIC)))
+        return false;
+
+    m_gridHeight = header.gridHeight;
+    size_t const v9Offset = offset + sizeof(header);
+    if (header.flags & MAP_HEIGHT_NO_HEIGHT)
+        m_gridGetHeight = &GridMap::getHeightFromFlat;
+    else if (header.flags & MAP_HEIGHT_AS_INT16)
+    {
+        m_uint16_V9 = getMappedArray<uint16>(v9Offset, 129 * 129);
+        m_uint16_V8 = getMappedArray<uint16>(v9Offset + 129 * 129 * sizeof(uint16), 128 * 128);
+        m_gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 65535;
+        m_gridGetHeight = &GridMap::getHeightFromUint16;
+    }
+    else if (header.flags & MAP_HEIGHT_AS_INT8)
+    {
+        m_uint8_V9 = getMappedArray<uint8>(v9Offset, 129 * 129);
+        m_uint8_V8 = getMappedArray<uint8>(v9Offset + 129 * 129 * sizeof(uint8), 128 * 128);
+        m_gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 255;
+        m_gridGetHeight = &GridMap::getHeightFromUint8;
+    }
+    else
+    {
+        m_V9 = getMappedArray<float>(v9Offset, 129 * 129);
+        m_V8 = getMappedArray<float>(v9Offset + 129 * 129 * sizeof(float), 128 * 128);
+        m_gridGetHeight = &GridMap::getHeightFromFloat;
+    }
+
+    return (header.flags & MAP_HEIGHT_NO_HEIGHT) || (m_V9 && m_V8);
+}
+
+bool GridMap::loadMappedLiquidData(uint32 offset)
+{
+    GridMapLiquidHeader header;
+    if (offset + sizeof(header) > m_mappedSize)
+        return false;
+    memcpy(&header, static_cast<uint8*>(m_mappedFile) + offset, sizeof(header));
+    if (header.fourcc != *((uint32 const*)(MAP_LIQUID_MAGIC)))
+        return false;
+
+    m_liquidGlobalEntry = header.liquidType;
+    m_liquidGlobalFlags = header.liquidFlags;
+    m_liquid_offX   = header.offsetX;
+    m_liquid_offY   = header.offsetY;
+    m_liquid_width  = header.width;
+    m_liquid_height = header.height;
+    m_liquidLevel   = header.liquidLevel;
+
+    size_t dataOffset = offset + sizeof(header);
+    if (!(header.flags & MAP_LIQUID_NO_TYPE))
+    {
+        m_liquidEntry = getMappedArray<uint16>(dataOffset, 16 * 16);
+        m_liquidFlags = getMappedArray<uint8>(dataOffset + 16 * 16 * sizeof(uint16), 16 * 16);
+        if (!m_liquidEntry || !m_liquidFlags)
+            return false;
+        dataOffset += 16 * 16 * (sizeof(uint16) + sizeof(uint8));
+    }
+
+    if (!(header.flags & MAP_LIQUID_NO_HEIGHT))
+        if (!(m_liquid_map = getMappedArray<float>(dataOffset, m_liquid_width * m_liquid_height)))
+            return false;
+
+    return true;
+}
+
 uint16 GridMap::getArea(float x, float y) const
 {
     if (!m_area_map)
@@ -702,6 +863,12 @@ GridMap* TerrainInfo::Load(uint32 const x, uint32 const y)
     return pMap;
 }
 
+GridMap* TerrainInfo::LoadAsync(uint32 const x, uint32 const y)
+{
+    std::shared_lock<std::shared_timed_mutex> lock(m_asyncLoadLock);
+    return Load(x, y);
+}
+
 // schedule lazy GridMap object cleanup
 void TerrainInfo::Unload(uint32 const x, uint32 const y)
 {
@@ -725,6 +892,11 @@ void TerrainInfo::CleanUpGrids(uint32 const diff)
     if (!i_timer.Passed())
         return;
 
+    // a grid preloader is referencing a grid, try again on next update
+    std::unique_lock<std::shared_timed_mutex> lock(m_asyncLoadLock, std::try_to_lock);
+    if (!lock.owns_lock())
+        return;
+
     for (int y = 0; y < MAX_NUMBER_OF_GRIDS; ++y)
     {
         for (int x = 0; x < MAX_NUMBER_OF_GRIDS; ++x)
@@ -1136,51 +1308,62 @@ GridMap* TerrainInfo::GetGrid(float const x, float const y)
 GridMap* TerrainInfo::LoadMapAndVMap(uint32 const x, uint32 const y)
 {
     // double checked lock pattern
-    if (!m_GridMaps[x][y])
+    if (m_GridMaps[x][y])
+        return m_GridMaps[x][y];
+
+    // read the files first, without the lock: the map thread does not wait for
+    // a grid preloader reading another grid, only for the data to be published
+    GridMap* map = new GridMap();
+
+    // map file name
+    int len = sWorld.GetDataPath().length() + strlen("maps/%03u%02u%02u.map") + 1;
+    char* tmp = new char[len];
+    snprintf(tmp, len, (char*)(sWorld.GetDataPath() + "maps/%03u%02u%02u.map").c_str(), m_mapId, y, x);
+
+    if (!map->loadData(tmp))
     {
-        LOCK_GUARD lock(m_mutex);
+        sLog.outError("Error load map file: \n %s\n", tmp);
+        // ASSERT(false);
+    }
 
-        if (!m_GridMaps[x][y])
-        {
-            GridMap* map = new GridMap();
+    delete[] tmp;
 
-            // map file name
-            int len = sWorld.GetDataPath().length() + strlen("maps/%03u%02u%02u.map") + 1;
-            char* tmp = new char[len];
-            snprintf(tmp, len, (char*)(sWorld.GetDataPath() + "maps/%03u%02u%02u.map").c_str(), m_mapId, y, x);
+    std::string const vmapPath = sWorld.GetDataPath() + "vmaps";
+    VMAP::StaticMapTile vmapTile;
+    VMAP::VMapFactory::createOrGetVMapManager()->readMapTile(vmapPath.c_str(), m_mapId, x, y, vmapTile);
 
-            if (!map->loadData(tmp))
-            {
-                sLog.outError("Error load map file: \n %s\n", tmp);
-                // ASSERT(false);
-            }
+    // load navmesh, the mmap manager has its own lock and skips the tiles already loaded
+    MMAP::MMapFactory::createOrGetMMapManager()->loadMap(m_mapId, x, y);
 
-            delete[] tmp;
-            m_GridMaps[x][y] = map;
+    LOCK_GUARD lock(m_mutex);
 
-            // load VMAPs for current map/grid...
-            MapEntry const* i_mapEntry = sMapStorage.LookupEntry<MapEntry>(m_mapId);
-            char const* mapName = i_mapEntry ? i_mapEntry->name : "UNNAMEDMAP\x0";
+    // loaded by another thread meanwhile
+    if (m_GridMaps[x][y])
+    {
+        delete map;
+        return m_GridMaps[x][y];
+    }
 
-            int vmapLoadResult = VMAP::VMapFactory::createOrGetVMapManager()->loadMap((sWorld.GetDataPath() + "vmaps").c_str(),  m_mapId, x, y);
-            switch (vmapLoadResult)
-            {
-                case VMAP::VMAP_LOAD_RESULT_OK:
-                    break;
-                case VMAP::VMAP_LOAD_RESULT_ERROR:
-                    DEBUG_LOG("Could not load VMAP name:%s, id:%d, x:%d, y:%d (vmap rep.: x:%d, y:%d)", mapName, m_mapId, x, y, x, y);
-                    break;
-                case VMAP::VMAP_LOAD_RESULT_IGNORED:
-                    DEBUG_LOG("Ignored VMAP name:%s, id:%d, x:%d, y:%d (vmap rep.: x:%d, y:%d)", mapName, m_mapId, x, y, x, y);
-                    break;
-            }
+    m_GridMaps[x][y] = map;
 
-            // load navmesh
-            MMAP::MMapFactory::createOrGetMMapManager()->loadMap(m_mapId, x, y);
-        }
+    // load VMAPs for current map/grid...
+    MapEntry const* i_mapEntry = sMapStorage.LookupEntry<MapEntry>(m_mapId);
+    char const* mapName = i_mapEntry ? i_mapEntry->name : "UNNAMEDMAP\x0";
+
+    int vmapLoadResult = VMAP::VMapFactory::createOrGetVMapManager()->loadMap(vmapPath.c_str(), m_mapId, x, y, vmapTile);
+    switch (vmapLoadResult)
+    {
+        case VMAP::VMAP_LOAD_RESULT_OK:
+            break;
+        case VMAP::VMAP_LOAD_RESULT_ERROR:
+            DEBUG_LOG("Could not load VMAP name:%s, id:%d, x:%d, y:%d (vmap rep.: x:%d, y:%d)", mapName, m_mapId, x, y, x, y);
+            break;
+        case VMAP::VMAP_LOAD_RESULT_IGNORED:
+            DEBUG_LOG("Ignored VMAP name:%s, id:%d, x:%d, y:%d (vmap rep.: x:%d, y:%d)", mapName, m_mapId, x, y, x, y);
+            break;
     }
 
-    return  m_GridMaps[x][y];
+    return map;
 }
 
 float TerrainInfo::GetWaterLevel(float x, float y, float z, float* pGround /*= nullptr*/) const
@@ -30,6 +30,7 @@
 #include <bitset>
 #include <list>
 #include <atomic>
+#include <shared_mutex>
 
 
 #define MAX_HEIGHT            100000.0f                     // can be use for find ground height at surface
@@ -86,10 +87,20 @@ class GridMap
         uint8* m_liquidFlags = nullptr;
         float* m_liquid_map = nullptr;
 
+        // Read-only mapping of the whole .map file when the arrays above point directly into it
+        void* m_mappedFile = nullptr;
+        size_t m_mappedSize = 0;
+
         bool loadAreaData(FILE* in, uint32 offset, uint32 size);
         bool loadHeightData(FILE* in, uint32 offset, uint32 size);
         bool loadGridMapLiquidData(FILE* in, uint32 offset, uint32 size);
 
+        bool loadMappedData(char const* filename);
+        bool loadMappedAreaData(uint32 offset);
+        bool loadMappedHeightData(uint32 offset);
+        bool loadMappedLiquidData(uint32 offset);
+        template<typename T> T* getMappedArray(size_t offset, size_t count) const;
+
         // Get height functions and pointers
         typedef float(GridMap::*pGetHeightPtr)(float x, float y) const;
         pGetHeightPtr m_gridGetHeight = &GridMap::getHeightFromFlat;
@@ -176,9 +187,12 @@ class TerrainInfo : public Referencable<AtomicLong>
 
     protected:
         friend class Map;
+        friend class GridPreloader;
         // load/unload terrain data
         GridMap* Load(uint32 const x, uint32 const y);
         void Unload(uint32 const x, uint32 const y);
+        // Load from a thread that may run with CleanUpGrids
+        GridMap* LoadAsync(uint32 const x, uint32 const y);
 
     private:
         TerrainInfo(TerrainInfo const&);
@@ -202,6 +216,7 @@ class TerrainInfo : public Referencable<AtomicLong>
         using LOCK_GUARD = std::unique_lock<LOCK_TYPE>;
         LOCK_TYPE m_mutex;
         LOCK_TYPE m_refMutex;
+        std::shared_timed_mutex m_asyncLoadLock;            // CleanUpGrids waits for no LoadAsync
 };
 
 class TerrainManager : public MaNGOS::Singleton<TerrainManager, MaNGOS::ClassLevelLockable<TerrainManager, std::mutex> >
@@ -32,6 +32,7 @@
 #include "MovementBroadcaster.h"
 #include "PlayerBroadcaster.h"
 #include "World.h"
+#include "TickProfiler.h"
 
 using namespace MaNGOS;
 
@@ -45,6 +46,7 @@ VisibleChangesNotifier::Visit(CameraMapType& m)
 void
 VisibleNotifier::Notify()
 {
+    TICK_PROFILE_SCOPE("VisibleNotifier::Notify");
     Player& player = *i_camera.GetOwner();
     // at this moment i_clientGUIDs have guids that not iterate at grid level checks
     // but exist one case when this possible and object not out of range: transports
@@ -197,9 +199,13 @@ ObjectMessageDistDeliverer::Visit(CameraMapType& m)
 }
 
 template<class T> void
-ObjectUpdater::Visit(GridRefManager<T>& m)
+ObjectUpdater::Visit(GridObjectList<T>& m)
 {
-    for (typename GridRefManager<T>::iterator iter = m.begin(); iter != m.end(); ++iter)
+    if (m.isEmpty())
+        return;
+
+    TICK_PROFILE_SCOPE_ARG("ObjectUpdater::Visit", "objects", m.getSize());
+    for (typename GridObjectList<T>::iterator iter = m.begin(); iter != m.end(); ++iter)
     {
         WorldObject::UpdateHelper helper(iter->getSource());
         helper.UpdateRealTime(i_now, i_timeDiff);
@@ -48,7 +48,7 @@ namespace MaNGOS
         std::set<WorldObject*> i_visibleNow;
 
         explicit VisibleNotifier(Camera &c) : i_camera(c), i_clientGUIDs(c.GetOwner()->m_visibleGUIDs) {}
-        template<class T> void Visit(GridRefManager<T>& m);
+        template<class T> void Visit(GridObjectList<T>& m);
         void Visit(CameraMapType&) {}
         void Notify(void);
     };
@@ -58,7 +58,7 @@ namespace MaNGOS
         WorldObject &i_object;
 
         explicit VisibleChangesNotifier(WorldObject &object) : i_object(object) {}
-        template<class T> void Visit(GridRefManager<T>&) {}
+        template<class T> void Visit(GridObjectList<T>&) {}
         void Visit(CameraMapType&);
     };
 
@@ -69,7 +69,7 @@ namespace MaNGOS
         bool i_toSelf;
         MessageDeliverer(Player const& pl, WorldPacket* msg, bool to_self) : i_player(pl), i_message(msg), i_toSelf(to_self) {}
         void Visit(CameraMapType& m);
-        template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
+        template<class SKIP> void Visit(GridObjectList<SKIP>&) {}
     };
 
     struct MessageDelivererExcept
@@ -81,7 +81,7 @@ namespace MaNGOS
             : i_message(msg), i_skipped_receiver(skipped) {}
 
         void Visit(CameraMapType& m);
-        template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
+        template<class SKIP> void Visit(GridObjectList<SKIP>&) {}
     };
 
     struct ObjectMessageDeliverer
@@ -89,7 +89,7 @@ namespace MaNGOS
         WorldPacket* i_message;
         explicit ObjectMessageDeliverer(WorldPacket* msg) : i_message(msg) {}
         void Visit(CameraMapType& m);
-        template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
+        template<class SKIP> void Visit(GridObjectList<SKIP>&) {}
     };
 
     struct MessageDistDeliverer
@@ -103,7 +103,7 @@ namespace MaNGOS
         MessageDistDeliverer(Player const& pl, WorldPacket* msg, float dist, bool to_self, bool ownTeamOnly)
             : i_player(pl), i_message(msg), i_toSelf(to_self), i_ownTeamOnly(ownTeamOnly), i_dist(dist) {}
         void Visit(CameraMapType& m);
-        template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
+        template<class SKIP> void Visit(GridObjectList<SKIP>&) {}
     };
 
     struct ObjectMessageDistDeliverer
@@ -113,7 +113,7 @@ namespace MaNGOS
         float i_dist;
         ObjectMessageDistDeliverer(WorldObject const& obj, WorldPacket* msg, float dist) : i_object(obj), i_message(msg), i_dist(dist) {}
         void Visit(CameraMapType& m);
-        template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
+        template<class SKIP> void Visit(GridObjectList<SKIP>&) {}
     };
 
     struct ObjectUpdater
@@ -121,7 +121,7 @@ namespace MaNGOS
         uint32 i_timeDiff;
         uint32 i_now;
         explicit ObjectUpdater(uint32 const& diff, uint32 now) : i_timeDiff(diff), i_now(now) {}
-        template<class T> void Visit(GridRefManager<T>& m);
+        template<class T> void Visit(GridObjectList<T>& m);
         void Visit(PlayerMapType&) {}
         void Visit(CorpseMapType&) {}
         void Visit(CameraMapType&) {}
@@ -132,7 +132,7 @@ namespace MaNGOS
     {
         Player &i_player;
         PlayerRelocationNotifier(Player &pl) : i_player(pl) {}
-        template<class T> void Visit(GridRefManager<T>&) {}
+        template<class T> void Visit(GridObjectList<T>&) {}
         void Visit(CreatureMapType&);
     };
 
@@ -140,7 +140,7 @@ namespace MaNGOS
     {
         Creature &i_creature;
         CreatureRelocationNotifier(Creature &c) : i_creature(c) {}
-        template<class T> void Visit(GridRefManager<T>&) {}
+        template<class T> void Visit(GridObjectList<T>&) {}
         #ifdef _MSC_VER
         template<> void Visit(PlayerMapType&);
         #endif
@@ -159,7 +159,7 @@ namespace MaNGOS
                 i_check = owner;
         }
 
-        template<class T> inline void Visit(GridRefManager<T>&) {}
+        template<class T> inline void Visit(GridObjectList<T>&) {}
         #ifdef _MSC_VER
         template<> inline void Visit<Player>(PlayerMapType&);
         template<> inline void Visit<Creature>(CreatureMapType&);
@@ -196,7 +196,7 @@ namespace MaNGOS
             }
         }
 
-        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
+        template<class NOT_INTERESTED> void Visit(GridObjectList<NOT_INTERESTED>&) {}
     };
     */
 
@@ -216,7 +216,7 @@ namespace MaNGOS
         void Visit(CorpseMapType& m);
         void Visit(DynamicObjectMapType& m);
 
-        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
+        template<class NOT_INTERESTED> void Visit(GridObjectList<NOT_INTERESTED>&) {}
     };
 
     template<class Check>
@@ -233,7 +233,7 @@ namespace MaNGOS
         void Visit(GameObjectMapType& m);
         void Visit(DynamicObjectMapType& m);
 
-        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
+        template<class NOT_INTERESTED> void Visit(GridObjectList<NOT_INTERESTED>&) {}
     };
 
     template<class Do>
@@ -272,7 +272,7 @@ namespace MaNGOS
                 i_do(itr.getSource());
         }
 
-        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
+        template<class NOT_INTERESTED> void Visit(GridObjectList<NOT_INTERESTED>&) {}
     };
 
     // Gameobject searchers
@@ -287,7 +287,7 @@ namespace MaNGOS
 
         void Visit(GameObjectMapType& m);
 
-        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
+        template<class NOT_INTERESTED> void Visit(GridObjectList<NOT_INTERESTED>&) {}
     };
 
     // Last accepted by Check GO if any (Check can change requirements at each call)
@@ -301,7 +301,7 @@ namespace MaNGOS
 
         void Visit(GameObjectMapType& m);
 
-        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
+        template<class NOT_INTERESTED> void Visit(GridObjectList<NOT_INTERESTED>&) {}
     };
 
     template<class Check>
@@ -314,9 +314,47 @@ namespace MaNGOS
 
         void Visit(GameObjectMapType& m);
 
-        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
+        template<class NOT_INTERESTED> void Visit(GridObjectList<NOT_INTERESTED>&) {}
     };
 
+    // Circle outside of which a check accepts no object. The searchers skip the
+    // objects outside of it from the position cached by the cell (GridObjectList),
+    // without reading the objects themselves.
+    struct RangeFilter
+    {
+        RangeFilter() : enabled(false), x(0.0f), y(0.0f), radius(0.0f), dist(0.0f) {}
+        // same distance as center->IsWithinDistInMap(obj, dist)
+        RangeFilter(WorldObject const* center, float dist_) : enabled(true),
+            x(center->GetPositionX()), y(center->GetPositionY()), radius(center->GetObjectBoundingRadius()), dist(dist_) {}
+        // same distance as obj->IsWithinDist3d(x, y, z, dist)
+        RangeFilter(float x_, float y_, float dist_) : enabled(true), x(x_), y(y_), radius(0.0f), dist(dist_) {}
+
+        template<class T>
+        bool MayPass(GridObjectList<T> const& m, typename GridObjectList<T>::iterator const& itr) const
+        {
+            return !enabled || m.MayBeWithinDist(itr, x, y, radius, dist);
+        }
+
+        bool enabled;
+        float x;
+        float y;
+        float radius;
+        float dist;
+    };
+
+    // checks may provide RangeFilter GetRangeFilter() const
+    template<class Check>
+    inline auto GetRangeFilter(Check const& check, int) -> decltype(check.GetRangeFilter())
+    {
+        return check.GetRangeFilter();
+    }
+
+    template<class Check>
+    inline RangeFilter GetRangeFilter(Check const& /*check*/, long)
+    {
+        return RangeFilter();
+    }
+
     // Unit searchers
 
     // First accepted by Check Unit if any
@@ -331,7 +369,7 @@ namespace MaNGOS
         void Visit(CreatureMapType& m);
         void Visit(PlayerMapType& m);
 
-        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
+        template<class NOT_INTERESTED> void Visit(GridObjectList<NOT_INTERESTED>&) {}
     };
 
     template<class Do>
@@ -353,7 +391,7 @@ namespace MaNGOS
                 i_do(itr->getSource());
         }
 
-        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
+        template<class NOT_INTERESTED> void Visit(GridObjectList<NOT_INTERESTED>&) {}
     };
 
     // Last accepted by Check Unit if any (Check can change requirements at each call)
@@ -368,7 +406,7 @@ namespace MaNGOS
         void Visit(CreatureMapType& m);
         void Visit(PlayerMapType& m);
 
-        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
+        template<class NOT_INTERESTED> void Visit(GridObjectList<NOT_INTERESTED>&) {}
     };
 
     // All accepted by Check units if any
@@ -383,7 +421,7 @@ namespace MaNGOS
         void Visit(PlayerMapType& m);
         void Visit(CreatureMapType& m);
 
-        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
+        template<class NOT_INTERESTED> void Visit(GridObjectList<NOT_INTERESTED>&) {}
     };
 
     // Creature searchers
@@ -398,7 +436,7 @@ namespace MaNGOS
 
         void Visit(CreatureMapType& m);
 
-        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
+        template<class NOT_INTERESTED> void Visit(GridObjectList<NOT_INTERESTED>&) {}
     };
 
     // Last accepted by Check Creature if any (Check can change requirements at each call)
@@ -412,7 +450,7 @@ namespace MaNGOS
 
         void Visit(CreatureMapType& m);
 
-        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
+        template<class NOT_INTERESTED> void Visit(GridObjectList<NOT_INTERESTED>&) {}
     };
 
     template<class Check>
@@ -425,7 +463,7 @@ namespace MaNGOS
 
         void Visit(CreatureMapType& m);
 
-        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
+        template<class NOT_INTERESTED> void Visit(GridObjectList<NOT_INTERESTED>&) {}
     };
 
     template<class Do>
@@ -441,7 +479,7 @@ namespace MaNGOS
                 i_do(itr.getSource());
         }
 
-        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
+        template<class NOT_INTERESTED> void Visit(GridObjectList<NOT_INTERESTED>&) {}
     };
 
     // Player searchers
@@ -456,7 +494,7 @@ namespace MaNGOS
 
         void Visit(PlayerMapType& m);
 
-        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
+        template<class NOT_INTERESTED> void Visit(GridObjectList<NOT_INTERESTED>&) {}
     };
 
     template<class Check>
@@ -469,7 +507,7 @@ namespace MaNGOS
 
         void Visit(PlayerMapType& m);
 
-        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
+        template<class NOT_INTERESTED> void Visit(GridObjectList<NOT_INTERESTED>&) {}
     };
 
     template<class Check>
@@ -483,7 +521,7 @@ namespace MaNGOS
 
         void Visit(PlayerMapType& m);
 
-        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
+        template<class NOT_INTERESTED> void Visit(GridObjectList<NOT_INTERESTED>&) {}
     };
 
     template<class Do>
@@ -499,7 +537,7 @@ namespace MaNGOS
                 i_do(itr.getSource());
         }
 
-        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
+        template<class NOT_INTERESTED> void Visit(GridObjectList<NOT_INTERESTED>&) {}
     };
 
     template<class Do>
@@ -521,7 +559,7 @@ namespace MaNGOS
                     i_do(camera->GetOwner());
             }
         }
-        template<class NOT_INTERESTED> void Visit(GridRefManager<NOT_INTERESTED>&) {}
+        template<class NOT_INTERESTED> void Visit(GridObjectList<NOT_INTERESTED>&) {}
     };
 
     // CHECKS && DO classes
@@ -805,6 +843,7 @@ namespace MaNGOS
         public:
             AnyUnfriendlyUnitInObjectRangeCheck(WorldObject const* obj, Unit const* funit, float range) : i_obj(obj), i_funit(funit), i_range(range) {}
             WorldObject const& GetFocusObject() const { return *i_obj; }
+            RangeFilter GetRangeFilter() const { return RangeFilter(i_obj, i_range); }
             bool operator()(Unit* u)
             {
                 if (!i_funit->CanSeeInWorld(u))
@@ -823,6 +862,7 @@ namespace MaNGOS
             AnyUnfriendlyVisibleUnitInObjectRangeCheck(WorldObject const* obj, Unit const* funit, float range)
                 : i_obj(obj), i_funit(funit), i_range(range) {}
             WorldObject const& GetFocusObject() const { return *i_obj; }
+            RangeFilter GetRangeFilter() const { return RangeFilter(i_obj, i_range); }
             bool operator()(Unit* u)
             {
                 return u->IsAlive()
@@ -841,6 +881,7 @@ namespace MaNGOS
         public:
             AnyFriendlyUnitInObjectRangeCheck(SpellCaster const* obj, float range) : i_obj(obj), i_range(range) {}
             WorldObject const& GetFocusObject() const { return *i_obj; }
+            RangeFilter GetRangeFilter() const { return RangeFilter(i_obj, i_range); }
             bool operator()(Unit* u)
             {
                 return u->IsAlive() && i_obj->IsWithinDistInMap(u, i_range) && i_obj->IsFriendlyTo(u) && u->CanSeeInWorld(i_obj);
@@ -855,6 +896,7 @@ namespace MaNGOS
         public:
             AnyUnitInObjectRangeCheck(WorldObject const* obj, float range) : i_obj(obj), i_range(range) {}
             WorldObject const& GetFocusObject() const { return *i_obj; }
+            RangeFilter GetRangeFilter() const { return RangeFilter(i_obj, i_range); }
             bool operator()(Unit* u)
             {
                 return u->IsAlive() && i_obj->IsWithinDistInMap(u, i_range) && u->CanSeeInWorld(i_obj);
@@ -870,6 +912,7 @@ namespace MaNGOS
         public:
             NearestAttackableUnitInObjectRangeCheck(WorldObject const* obj, Unit const* funit, Unit const* owner, float range) : i_obj(obj), i_funit(funit), i_owner(owner), i_range(range) {}
             WorldObject const& GetFocusObject() const { return *i_obj; }
+            RangeFilter GetRangeFilter() const { return RangeFilter(i_obj, i_range); }
             bool operator()(Unit* u)
             {
                 if (i_owner && i_owner->IsPlayer() && u->IsPlayer() && !i_owner->IsPvP() && !i_owner->ToPlayer()->IsInDuelWith(u->ToPlayer()))
@@ -902,6 +945,7 @@ namespace MaNGOS
             {
             }
             WorldObject const& GetFocusObject() const { return *i_obj; }
+            RangeFilter GetRangeFilter() const { return RangeFilter(i_obj, i_range); }
             bool operator()(Unit* u)
             {
                 // ignore totems as AoE targets
@@ -934,6 +978,7 @@ namespace MaNGOS
             {
             }
             WorldObject const& GetFocusObject() const { return *i_obj; }
+            RangeFilter GetRangeFilter() const { return RangeFilter(i_obj, i_range); }
             bool operator()(Unit* u)
             {
                 // ignore totems as AoE targets
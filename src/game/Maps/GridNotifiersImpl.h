@@ -33,11 +33,12 @@
 #include "DBCEnums.h"
 #include "Spell.h"
 #include "SpellMgr.h"
+#include "TickProfiler.h"
 
 template<class T>
-inline void MaNGOS::VisibleNotifier::Visit(GridRefManager<T>& m)
+inline void MaNGOS::VisibleNotifier::Visit(GridObjectList<T>& m)
 {
-    for(typename GridRefManager<T>::iterator iter = m.begin(); iter != m.end(); ++iter)
+    for(typename GridObjectList<T>::iterator iter = m.begin(); iter != m.end(); ++iter)
     {
         i_camera.UpdateVisibilityOf(iter->getSource(), i_data, i_visibleNow);
         i_clientGUIDs.erase(iter->getSource()->GetObjectGuid());
@@ -46,6 +47,10 @@ inline void MaNGOS::VisibleNotifier::Visit(GridRefManager<T>& m)
 
 inline void MaNGOS::ObjectUpdater::Visit(CreatureMapType& m)
 {
+    if (m.isEmpty())
+        return;
+
+    TICK_PROFILE_SCOPE_ARG("ObjectUpdater::Visit<Creature>", "creatures", m.getSize());
     std::vector<Creature*> creaturesToUpdate;
     for (const auto& iter : m)
         creaturesToUpdate.push_back(iter.getSource());
@@ -449,9 +454,10 @@ void MaNGOS::UnitSearcher<Check>::Visit(CreatureMapType& m)
     if (i_object)
         return;
 
+    RangeFilter const filter = GetRangeFilter(i_check, 0);
     for(auto & itr : m)
     {
-        if (i_check(itr.getSource()))
+        if (filter.MayPass(m, itr) && i_check(itr.getSource()))
         {
             i_object = itr.getSource();
             return;
@@ -466,9 +472,10 @@ void MaNGOS::UnitSearcher<Check>::Visit(PlayerMapType& m)
     if (i_object)
         return;
 
+    RangeFilter const filter = GetRangeFilter(i_check, 0);
     for(PlayerMapType::iterator itr = m.begin(); itr != m.end(); ++itr)
     {
-        if (i_check(itr->getSource()))
+        if (filter.MayPass(m, itr) && i_check(itr->getSource()))
         {
             i_object = itr->getSource();
             return;
@@ -479,9 +486,10 @@ void MaNGOS::UnitSearcher<Check>::Visit(PlayerMapType& m)
 template<class Check>
 void MaNGOS::UnitLastSearcher<Check>::Visit(CreatureMapType& m)
 {
+    RangeFilter const filter = GetRangeFilter(i_check, 0);
     for(auto & itr : m)
     {
-        if (i_check(itr.getSource()))
+        if (filter.MayPass(m, itr) && i_check(itr.getSource()))
             i_object = itr.getSource();
     }
 }
@@ -489,9 +497,10 @@ void MaNGOS::UnitLastSearcher<Check>::Visit(CreatureMapType& m)
 template<class Check>
 void MaNGOS::UnitLastSearcher<Check>::Visit(PlayerMapType& m)
 {
+    RangeFilter const filter = GetRangeFilter(i_check, 0);
     for(auto & itr : m)
     {
-        if (i_check(itr.getSource()))
+        if (filter.MayPass(m, itr) && i_check(itr.getSource()))
             i_object = itr.getSource();
     }
 }
@@ -499,16 +508,18 @@ void MaNGOS::UnitLastSearcher<Check>::Visit(PlayerMapType& m)
 template<class Check>
 void MaNGOS::UnitListSearcher<Check>::Visit(PlayerMapType& m)
 {
+    RangeFilter const filter = GetRangeFilter(i_check, 0);
     for(auto & itr : m)
-        if (i_check(itr.getSource()))
+        if (filter.MayPass(m, itr) && i_check(itr.getSource()))
             i_objects.push_back(itr.getSource());
 }
 
 template<class Check>
 void MaNGOS::UnitListSearcher<Check>::Visit(CreatureMapType& m)
 {
+    RangeFilter const filter = GetRangeFilter(i_check, 0);
     for(auto & itr : m)
-        if (i_check(itr.getSource()))
+        if (filter.MayPass(m, itr) && i_check(itr.getSource()))
             i_objects.push_back(itr.getSource());
 }
 
@@ -0,0 +1,349 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "GridPreloader.h"
+#include "Map.h"
+#include "MapManager.h"
+#include "GridMap.h"
+#include "ObjectMgr.h"
+#include "Player.h"
+#include "Transport.h"
+#include "WaypointMovementGenerator.h"
+#include "World.h"
+#include "Timer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // speed of the taxi flights, see FlightPathMovementGenerator
+    float const TAXI_FLIGHT_SPEED = 32.0f;
+
+    // anything faster between two passes is a teleport, not a movement
+    float const MAX_PREDICTED_SPEED = 60.0f;
+
+    // results nobody asked for are dropped after that time (ms)
+    uint32 const PRELOAD_KEEP_TIME = 60 * IN_MILLISECONDS;
+
+    typedef std::vector<std::pair<float, float>> PredictedPath;
+
+    // sample the segment often enough not to jump over a grid
+    void AddSegment(PredictedPath& path, float x0, float y0, float x1, float y1)
+    {
+        float const length = std::sqrt((x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0));
+        uint32 const steps = uint32(length / (SIZE_OF_GRIDS / 2)) + 1;
+        for (uint32 i = 1; i <= steps; ++i)
+        {
+            float const f = float(i) / steps;
+            path.emplace_back(x0 + (x1 - x0) * f, y0 + (y1 - y0) * f);
+        }
+    }
+}
+
+GridPreloader::Stats GridPreloader::m_stats;
+
+GridPreloader::PreloadedGrid::PreloadedGrid(TerrainInfo* terrain, GridPair const& p) :
+    terrain(terrain), pair(p), terrainLoaded(false), hasSpawns(false), spawnsVersion(0), readyTime(0)
+{
+}
+
+GridPreloader::PreloadedGrid::~PreloadedGrid()
+{
+    // the map took its own reference if it used the grid
+    if (terrainLoaded)
+        ReleaseTerrain(terrain, pair);
+}
+
+GridPreloader::GridPreloader(Map& map) :
+    m_map(map), m_terrain(map.m_TerrainData),
+    m_timer(0), m_pass(0), m_stopping(false),
+    m_tasks(*sMapMgr.GetGridPreloadScheduler())
+{
+}
+
+GridPreloader::~GridPreloader()
+{
+    // tasks not started yet only give their grid back
+    m_stopping = true;
+    m_tasks.wait();
+
+    m_stats.ready -= int64(m_ready.size());
+}
+
+void GridPreloader::ReleaseTerrain(TerrainInfo* terrain, GridPair const& p)
+{
+    terrain->Unload((MAX_NUMBER_OF_GRIDS - 1) - p.x_coord, (MAX_NUMBER_OF_GRIDS - 1) - p.y_coord);
+}
+
+void GridPreloader::Update(uint32 diff)
+{
+    if (m_timer > diff)
+    {
+        m_timer -= diff;
+        return;
+    }
+    m_timer = sWorld.getConfig(CONFIG_UINT32_GRID_PRELOAD_INTERVAL);
+
+    uint32 const now = WorldTimer::getMSTime();
+    ++m_pass;
+
+    PredictedPath path;
+    float const radius = m_map.GetGridActivationDistance();
+    for (auto const& ref : m_map.GetPlayers())
+    {
+        Player* player = ref.getSource();
+        if (!player || !player->IsInWorld())
+            continue;
+
+        path.clear();
+        PredictPath(player, now, path);
+        for (auto const& point : path)
+            RequestAround(point.first, point.second, radius);
+    }
+
+    // players who left the map
+    for (auto itr = m_tracked.begin(); itr != m_tracked.end();)
+    {
+        if (itr->second.pass != m_pass)
+            itr = m_tracked.erase(itr);
+        else
+            ++itr;
+    }
+
+    ExpireReady(now);
+}
+
+void GridPreloader::PredictPath(Player* player, uint32 now, PredictedPath& path)
+{
+    uint32 const lookAheadMs = sWorld.getConfig(CONFIG_UINT32_GRID_PRELOAD_LOOKAHEAD);
+    float const lookAhead = float(lookAheadMs) / IN_MILLISECONDS;
+    float const x = player->GetPositionX();
+    float const y = player->GetPositionY();
+
+    // velocity measured since the previous pass
+    float vx = 0.0f, vy = 0.0f;
+    auto tracked = m_tracked.find(player->GetObjectGuid());
+    if (tracked != m_tracked.end() && tracked->second.pass + 1 == m_pass)
+    {
+        float const elapsed = float(WorldTimer::getMSTimeDiff(tracked->second.time, now)) / IN_MILLISECONDS;
+        if (elapsed > 0.0f)
+        {
+            vx = (x - tracked->second.x) / elapsed;
+            vy = (y - tracked->second.y) / elapsed;
+            if (vx * vx + vy * vy > MAX_PREDICTED_SPEED * MAX_PREDICTED_SPEED)
+                vx = vy = 0.0f;
+        }
+    }
+    m_tracked[player->GetObjectGuid()] = { x, y, now, m_pass };
+
+    if (player->IsTaxiFlying() && player->GetMotionMaster()->GetCurrentMovementGeneratorType() == FLIGHT_MOTION_TYPE)
+    {
+        // next nodes of the flight, as far as the flight goes during the look ahead time
+        auto const* flight = static_cast<FlightPathMovementGenerator const*>(player->GetMotionMaster()->GetCurrent());
+        TaxiPathNodeList const& nodes = flight->GetPath();
+        float budget = TAXI_FLIGHT_SPEED * lookAhead;
+        float px = x, py = y;
+        for (uint32 i = flight->GetCurrentNode(); i < nodes.size() && budget > 0.0f; ++i)
+        {
+            TaxiPathNodeEntry const& node = nodes[i];
+            if (node.mapid != m_map.GetId())
+                break;
+
+            float const dist = std::sqrt((node.x - px) * (node.x - px) + (node.y - py) * (node.y - py));
+            float const f = dist > budget ? budget / dist : 1.0f;
+            AddSegment(path, px, py, px + (node.x - px) * f, py + (node.y - py) * f);
+            budget -= dist;
+            px = node.x;
+            py = node.y;
+        }
+        return;
+    }
+
+    if (Transport* transport = player->GetTransport())
+    {
+        // key frames the transport reaches during the look ahead time
+        KeyFrameVec const& frames = transport->GetKeyFrames();
+        uint32 const period = transport->GetPeriod();
+        if (!period || frames.empty())
+            return;
+
+        uint32 const progress = transport->GetPathProgress();
+        auto next = std::upper_bound(frames.begin(), frames.end(), progress,
+            [](uint32 time, KeyFrame const& frame) { return time < frame.ArriveTime; });
+        size_t const first = next - frames.begin();
+
+        float px = x, py = y;
+        for (size_t i = 0; i < frames.size(); ++i)
+        {
+            KeyFrame const& frame = frames[(first + i) % frames.size()];
+            if ((frame.ArriveTime + period - progress) % period > lookAheadMs)
+                break;
+            if (frame.Node->mapid != m_map.GetId())
+                break;
+
+            AddSegment(path, px, py, frame.Node->x, frame.Node->y);
+            px = frame.Node->x;
+            py = frame.Node->y;
+        }
+        return;
+    }
+
+    if (vx != 0.0f || vy != 0.0f)
+        AddSegment(path, x, y, x + vx * lookAhead, y + vy * lookAhead);
+}
+
+void GridPreloader::RequestAround(float x, float y, float radius)
+{
+    // grids the player would load there, see WorldObject::LoadMapCellsAround
+    float x0 = x - radius, y0 = y - radius;
+    float x1 = x + radius, y1 = y + radius;
+    MaNGOS::NormalizeMapCoord(x0);
+    MaNGOS::NormalizeMapCoord(y0);
+    MaNGOS::NormalizeMapCoord(x1);
+    MaNGOS::NormalizeMapCoord(y1);
+
+    GridPair const low = MaNGOS::ComputeGridPair(x0, y0);
+    GridPair const high = MaNGOS::ComputeGridPair(x1, y1);
+    for (uint32 gx = std::min(low.x_coord, high.x_coord); gx <= std::max(low.x_coord, high.x_coord); ++gx)
+        for (uint32 gy = std::min(low.y_coord, high.y_coord); gy <= std::max(low.y_coord, high.y_coord); ++gy)
+            Request(GridPair(gx, gy));
+}
+
+void GridPreloader::Request(GridPair const& p)
+{
+    if (m_map.loaded(p))
+        return;
+
+    uint32 const id = GridId(p);
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (m_loading.find(id) != m_loading.end() || m_ready.find(id) != m_ready.end())
+            return;
+        m_loading[id] = false;
+    }
+
+    ++m_stats.requested;
+    PreloadedGrid* grid = new PreloadedGrid(m_terrain, p);
+    m_tasks.run([this, grid]() { Load(std::unique_ptr<PreloadedGrid>(grid)); }, false);
+}
+
+void GridPreloader::Load(std::unique_ptr<PreloadedGrid> grid)
+{
+    if (!m_stopping)
+    {
+        // terrain, vmap and mmap tiles, the reference keeps them until the map takes its own
+        m_terrain->LoadAsync((MAX_NUMBER_OF_GRIDS - 1) - grid->pair.x_coord, (MAX_NUMBER_OF_GRIDS - 1) - grid->pair.y_coord);
+        grid->terrainLoaded = true;
+
+        // static spawns of every cell, ObjectGridLoader still filters them for the map instance
+        grid->spawnsVersion = sObjectMgr.GetCellObjectGuidsVersion();
+        CellGuidSet creatures, gameobjects;
+        for (uint32 cx = 0; cx < MAX_NUMBER_OF_CELLS; ++cx)
+        {
+            for (uint32 cy = 0; cy < MAX_NUMBER_OF_CELLS; ++cy)
+            {
+                uint32 const x = grid->pair.x_coord * MAX_NUMBER_OF_CELLS + cx;
+                uint32 const y = grid->pair.y_coord * MAX_NUMBER_OF_CELLS + cy;
+                uint32 const cellId = y * TOTAL_NUMBER_OF_CELLS_PER_MAP + x;
+
+                sObjectMgr.CopyCellObjectGuids(m_map.GetId(), cellId, creatures, gameobjects);
+                grid->spawns.creatures[cx][cy].assign(creatures.begin(), creatures.end());
+                grid->spawns.gameobjects[cx][cy].assign(gameobjects.begin(), gameobjects.end());
+            }
+        }
+        grid->hasSpawns = true;
+    }
+    grid->readyTime = WorldTimer::getMSTime();
+
+    uint32 const id = GridId(grid->pair);
+    std::lock_guard<std::mutex> guard(m_lock);
+    auto itr = m_loading.find(id);
+    bool const abandoned = itr == m_loading.end() || itr->second;
+    if (itr != m_loading.end())
+        m_loading.erase(itr);
+
+    // the map loaded the grid without waiting, the terrain is released with `grid`
+    if (m_stopping || abandoned)
+        return;
+
+    m_ready[id] = std::move(grid);
+    ++m_stats.ready;
+}
+
+std::unique_ptr<GridPreloader::PreloadedGrid> GridPreloader::Take(GridPair const& p)
+{
+    uint32 const id = GridId(p);
+    std::unique_ptr<PreloadedGrid> grid;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        auto ready = m_ready.find(id);
+        if (ready != m_ready.end())
+        {
+            grid = std::move(ready->second);
+            m_ready.erase(ready);
+            --m_stats.ready;
+        }
+        else
+        {
+            auto loading = m_loading.find(id);
+            if (loading != m_loading.end())
+            {
+                loading->second = true;
+                ++m_stats.late;
+                return nullptr;
+            }
+        }
+    }
+
+    if (!grid)
+    {
+        ++m_stats.misses;
+        return nullptr;
+    }
+
+    // a spawn was added or removed since the copy, only the terrain is still good
+    if (grid->spawnsVersion != sObjectMgr.GetCellObjectGuidsVersion())
+    {
+        grid->hasSpawns = false;
+        ++m_stats.stale;
+    }
+    else
+        ++m_stats.hits;
+
+    return grid;
+}
+
+void GridPreloader::ExpireReady(uint32 now)
+{
+    std::vector<std::unique_ptr<PreloadedGrid>> expired;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        for (auto itr = m_ready.begin(); itr != m_ready.end();)
+        {
+            if (WorldTimer::getMSTimeDiff(itr->second->readyTime, now) > PRELOAD_KEEP_TIME)
+            {
+                expired.push_back(std::move(itr->second));
+                itr = m_ready.erase(itr);
+            }
+            else
+                ++itr;
+        }
+    }
+
+    m_stats.expired += expired.size();
+    m_stats.ready -= int64(expired.size());
+}
@@ -0,0 +1,125 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_GRIDPRELOADER_H
+#define MANGOS_GRIDPRELOADER_H
+
+#include "Common.h"
+#include "GridDefines.h"
+#include "ObjectGuid.h"
+#include "WorkStealingPool.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class Map;
+class Player;
+class TerrainInfo;
+
+/// Static spawns of a grid, per cell, copied from ObjectMgr
+struct GridSpawnLists
+{
+    std::vector<uint32> creatures[MAX_NUMBER_OF_CELLS][MAX_NUMBER_OF_CELLS];
+    std::vector<uint32> gameobjects[MAX_NUMBER_OF_CELLS][MAX_NUMBER_OF_CELLS];
+};
+
+/**
+ * @brief Loads ahead of time the grids players are about to enter.
+ *  The grids are predicted from the taxi path of flying players, the route of
+ *  the transport they stand on, or else the velocity measured between two passes.
+ *  A worker of the MapManager preload scheduler then loads the terrain, vmap
+ *  and mmap tiles and copies the static spawn lists of the grid, so that
+ *  Map::EnsureGridLoaded only has to create the objects.
+ *  Unused results expire and give their terrain reference back.
+ */
+class GridPreloader
+{
+    public:
+        struct PreloadedGrid
+        {
+            PreloadedGrid(TerrainInfo* terrain, GridPair const& p);
+            ~PreloadedGrid();
+
+            TerrainInfo* terrain;
+            GridPair pair;
+            bool terrainLoaded;
+            bool hasSpawns;                                 // false if only the terrain may be used
+            uint32 spawnsVersion;                           // ObjectMgr::GetCellObjectGuidsVersion when copied
+            uint32 readyTime;
+            GridSpawnLists spawns;
+        };
+
+        struct Stats
+        {
+            std::atomic<uint64> requested{0};
+            std::atomic<uint64> hits{0};                    // grid ready when the map needed it
+            std::atomic<uint64> late{0};                    // still loading when the map needed it
+            std::atomic<uint64> misses{0};                  // grid not predicted
+            std::atomic<uint64> stale{0};                   // spawns changed after the copy, only the terrain was used
+            std::atomic<uint64> expired{0};                 // never used
+            std::atomic<int64> ready{0};
+        };
+
+        explicit GridPreloader(Map& map);
+        ~GridPreloader();
+
+        GridPreloader(GridPreloader const&) = delete;
+        GridPreloader& operator=(GridPreloader const&) = delete;
+
+        /// Predicts the grids of every player and queues their loading, map thread only.
+        void Update(uint32 diff);
+
+        /// Called when the map loads the objects of a grid, returns the preloaded data if ready.
+        std::unique_ptr<PreloadedGrid> Take(GridPair const& p);
+
+        static Stats const& GetStats() { return m_stats; }
+
+    private:
+        struct TrackedPlayer
+        {
+            float x, y;
+            uint32 time;
+            uint32 pass;
+        };
+
+        static uint32 GridId(GridPair const& p) { return p.x_coord * MAX_NUMBER_OF_GRIDS + p.y_coord; }
+        static void ReleaseTerrain(TerrainInfo* terrain, GridPair const& p);
+
+        void PredictPath(Player* player, uint32 now, std::vector<std::pair<float, float>>& path);
+        void RequestAround(float x, float y, float radius);
+        void Request(GridPair const& p);
+        void Load(std::unique_ptr<PreloadedGrid> grid);
+        void ExpireReady(uint32 now);
+
+        Map& m_map;
+        TerrainInfo* m_terrain;
+        uint32 m_timer;
+        uint32 m_pass;
+        std::unordered_map<ObjectGuid, TrackedPlayer> m_tracked;
+
+        std::atomic<bool> m_stopping;
+        std::mutex m_lock;
+        std::unordered_map<uint32, bool> m_loading;         // true once the map loaded the grid without waiting
+        std::unordered_map<uint32, std::unique_ptr<PreloadedGrid>> m_ready;
+        WorkStealingPool::TaskGroup m_tasks;
+
+        static Stats m_stats;
+};
+
+#endif
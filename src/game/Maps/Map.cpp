@@ -50,12 +50,17 @@
 #include "MovementBroadcaster.h"
 #include "PlayerBroadcaster.h"
 #include "GridSearchers.h"
-#include "ThreadPool.h"
+#include "WorkStealingPool.h"
+#include "GridPreloader.h"
+#include "TickProfiler.h"
 #include "AuraRemovalMgr.h"
 #include "world/world_event_wareffort.h"
 
 Map::~Map()
 {
+    // pending preloads reference the terrain and the map
+    m_gridPreloader.reset();
+
     UnloadAll(true);
 
     if (!m_scriptSchedule.empty())
@@ -128,17 +133,8 @@ Map::Map(uint32 id, time_t expiry, uint32 InstanceId)
     m_persistentState->SetUsedByMapState(this);
     m_weatherSystem = new WeatherSystem(this);
 
-    if (IsContinent())
-    {
-        m_motionThreads.reset(new ThreadPool(sWorld.getConfig(CONFIG_UINT32_CONTINENTS_MOTIONUPDATE_THREADS)));
-        m_objectThreads.reset(new ThreadPool(std::max((int)sWorld.getConfig(CONFIG_UINT32_MAP_OBJECTSUPDATE_THREADS) -1,0)));
-        m_visibilityThreads.reset(new ThreadPool(std::max((int)sWorld.getConfig(CONFIG_UINT32_MAP_VISIBILITYUPDATE_THREADS) -1,0)));
-        m_cellThreads.reset(new ThreadPool(std::max((int)sWorld.getConfig(CONFIG_UINT32_MTCELLS_THREADS) - 1, 0)));
-        m_visibilityThreads->start<ThreadPool::MySQL<ThreadPool::MultiQueue>>();
-        m_cellThreads->start();
-        m_motionThreads->start();
-        m_objectThreads->start<ThreadPool::MySQL<ThreadPool::MultiQueue>>();
-    }
+    if (IsContinent() && sMapMgr.GetGridPreloadScheduler())
+        m_gridPreloader.reset(new GridPreloader(*this));
 }
 
 // Nostalrius
@@ -339,7 +335,13 @@ bool Map::EnsureGridLoaded(Cell const& cell)
         //summons some active object B, while B added to map grid loading called again and so on..
         ASSERT(!m_unloading && "Trying to load grid while unloading the whole map !");
         setGridObjectDataLoaded(true, cell.GridX(), cell.GridY());
-        ObjectGridLoader loader(*grid, this, cell);
+
+        // terrain reference of the preloaded grid is released once the map holds its own
+        std::unique_ptr<GridPreloader::PreloadedGrid> preloaded;
+        if (m_gridPreloader)
+            preloaded = m_gridPreloader->Take(GridPair(cell.GridX(), cell.GridY()));
+
+        ObjectGridLoader loader(*grid, this, cell, preloaded && preloaded->hasSpawns ? &preloaded->spawns : nullptr);
         loader.LoadN();
 
         // Add resurrectable corpses to world object list in grid
@@ -579,6 +581,7 @@ bool Map::loaded(GridPair const& p) const
 
 void Map::UpdateSync(uint32 const diff)
 {
+    TICK_PROFILE_SCOPE_ARG("Map::UpdateSync", "map", GetId());
     // Needs to be updated here.
     // Can lead to map <-> map teleports
     for (_transportsUpdateIter = _transports.begin(); _transportsUpdateIter != _transports.end();)
@@ -598,6 +601,7 @@ inline void Map::UpdateCellsAroundObject(uint32 now, uint32 diff, WorldObject co
     if (!object || !object->IsInWorld() || !object->IsPositionValid())
         return;
 
+    TICK_PROFILE_SCOPE("Map::UpdateCellsAroundObject");
     MaNGOS::ObjectUpdater updater(diff, now);
     TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > grid_object_update(updater);
     TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer > world_object_update(updater);
@@ -643,21 +647,16 @@ inline void Map::MarkCellsAroundObject(WorldObject const* object)
 }
 
 
-inline void Map::UpdateActiveCellsCallback(uint32 diff, uint32 now, uint32 threadId, uint32 totalThreads, uint32 step)
+inline void Map::UpdateActiveCellsStripe(uint32 diff, uint32 now, uint32 firstRow, uint32 lastRow)
 {
+    TICK_PROFILE_SCOPE_ARG("Map::UpdateActiveCellsStripe", "row", firstRow);
     MaNGOS::ObjectUpdater updater(diff, now);
     TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > grid_object_update(updater);
     TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer > world_object_update(updater);
 
-    int safeDistCells = sWorld.getConfig(CONFIG_UINT32_MTCELLS_SAFEDISTANCE) / SIZE_OF_GRID_CELL + 1;
-    totalThreads *= 2;
-    threadId = 2 * threadId + step;
-    for (int y = 0; y < TOTAL_NUMBER_OF_CELLS_PER_MAP; ++y)
+    for (uint32 y = firstRow; y < lastRow; ++y)
     {
-        // Skip grids not for this thread
-        if ((y / safeDistCells) % totalThreads != threadId)
-            continue;
-        for (int x = 0; x < TOTAL_NUMBER_OF_CELLS_PER_MAP; ++x)
+        for (uint32 x = 0; x < TOTAL_NUMBER_OF_CELLS_PER_MAP; ++x)
         {
             uint32 cellId = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
             if (!isCellMarked(cellId))
@@ -682,17 +681,29 @@ inline void Map::UpdateActiveCellsAsynch(uint32 now, uint32 diff)
     for (m_activeNonPlayersIter = m_activeNonPlayers.begin(); m_activeNonPlayersIter != m_activeNonPlayers.end(); ++m_activeNonPlayersIter)
         MarkCellsAroundObject(*m_activeNonPlayersIter);
 
-    const int nthreads = m_cellThreads->size();
-    for (int step = 0; step < 2; step++)
+    // Cells are cut in rows of stripes at least SafeDistance wide. Even stripes
+    // are updated first, then odd ones: two neighbour stripes never run together.
+    // MTCells.Threads caps the sub-tasks of a step, each one taking every
+    // tasks-th stripe of that step.
+    uint32 const stripeRows = sWorld.getConfig(CONFIG_UINT32_MTCELLS_SAFEDISTANCE) / SIZE_OF_GRID_CELL + 1;
+    uint32 const maxTasks = sWorld.getConfig(CONFIG_UINT32_MTCELLS_THREADS);
+    for (uint32 step = 0; step < 2; ++step)
     {
-        for (int i = 0; i < nthreads; ++i)
-            m_cellThreads << [this, diff, now, i, nthreads](){
-                UpdateActiveCellsCallback(diff, now, i, nthreads+1, 0);
-            };
-        std::future<void> job = m_cellThreads->processWorkload();
-        UpdateActiveCellsCallback(diff, now, nthreads, nthreads+1, 0);
-        if (job.valid())
-            job.wait();
+        uint32 const firstStripeRow = step * stripeRows;
+        if (firstStripeRow >= TOTAL_NUMBER_OF_CELLS_PER_MAP)
+            break;
+        uint32 const stripes = (TOTAL_NUMBER_OF_CELLS_PER_MAP - firstStripeRow + 2 * stripeRows - 1) / (2 * stripeRows);
+        uint32 const tasks = std::min(maxTasks, stripes);
+
+        WorkStealingPool::TaskGroup cellsUpdate(sMapMgr.GetUpdateScheduler());
+        for (uint32 task = 0; task < tasks; ++task)
+        {
+            cellsUpdate.run([this, diff, now, stripeRows, firstStripeRow, task, tasks]() {
+                for (uint32 firstRow = firstStripeRow + task * 2 * stripeRows; firstRow < TOTAL_NUMBER_OF_CELLS_PER_MAP; firstRow += tasks * 2 * stripeRows)
+                    UpdateActiveCellsStripe(diff, now, firstRow, std::min<uint32>(firstRow + stripeRows, TOTAL_NUMBER_OF_CELLS_PER_MAP));
+            });
+        }
+        cellsUpdate.wait();
     }
 }
 
@@ -729,20 +740,31 @@ inline void Map::UpdateCells(uint32 map_diff)
         return;
     _lastCellsUpdate = now;
 
+    TICK_PROFILE_SCOPE_ARG("Map::UpdateCells", "map", GetId());
+
     /// update active cells around players and active objects
-    if (IsContinent() && m_cellThreads->status() == ThreadPool::Status::READY)
+    if (IsContinent() && sWorld.getConfig(CONFIG_UINT32_MTCELLS_THREADS) > 1)
         UpdateActiveCellsAsynch(now, diff);
     else
         UpdateActiveCellsSynch(now, diff);
 
-    if (IsContinent() && m_motionThreads->status() == ThreadPool::Status::READY && !unitsMvtUpdate.empty())
+    if (IsContinent() && sWorld.getConfig(CONFIG_UINT32_CONTINENTS_MOTIONUPDATE_THREADS) && !unitsMvtUpdate.empty())
     {
-        for (std::set<Unit*>::iterator it = unitsMvtUpdate.begin(); it != unitsMvtUpdate.end(); it++)
-            m_motionThreads << [it,diff](){
-                 if ((*it)->IsInWorld())
-                    (*it)->GetMotionMaster()->UpdateMotionAsync(diff);
-            };
-        m_motionThreads->processWorkload().wait();
+        // Path generation cost varies a lot between units, keep batches small so they balance well
+        static uint32 const MOTION_UPDATE_BATCH = 16;
+        std::vector<Unit*> units(unitsMvtUpdate.begin(), unitsMvtUpdate.end());
+        WorkStealingPool::TaskGroup motionUpdate(sMapMgr.GetUpdateScheduler());
+        for (size_t first = 0; first < units.size(); first += MOTION_UPDATE_BATCH)
+        {
+            size_t const last = std::min<size_t>(first + MOTION_UPDATE_BATCH, units.size());
+            motionUpdate.run([&units, first, last, diff]() {
+                TICK_PROFILE_SCOPE("Map::UpdateMotionAsync");
+                for (size_t i = first; i < last; ++i)
+                    if (units[i]->IsInWorld())
+                        units[i]->GetMotionMaster()->UpdateMotionAsync(diff);
+            });
+        }
+        motionUpdate.wait();
     }
     unitsMvtUpdate.clear();
 }
@@ -750,6 +772,7 @@ inline void Map::UpdateCells(uint32 map_diff)
 
 void Map::ProcessSessionPackets(PacketProcessing type)
 {
+    TICK_PROFILE_SCOPE_ARG("Map::ProcessSessionPackets", "type", type);
     uint32 beginTime = WorldTimer::getMSTime();
     /// update worldsessions for existing players
     for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
@@ -789,6 +812,7 @@ void Map::UpdatePlayers()
     if (diff < sWorld.getConfig(CONFIG_UINT32_MAPUPDATE_UPDATE_PLAYERS_DIFF))
         return;
 
+    TICK_PROFILE_SCOPE_ARG("Map::UpdatePlayers", "map", GetId());
     ++_inactivePlayersSkippedUpdates;
     bool updateInactivePlayers = _inactivePlayersSkippedUpdates > sWorld.getConfig(CONFIG_UINT32_INACTIVE_PLAYERS_SKIP_UPDATES);
     if (!IsContinent())
@@ -826,6 +850,7 @@ void Map::DoUpdate(uint32 maxDiff)
 
 void Map::Update(uint32 t_diff)
 {
+    TICK_PROFILE_SCOPE_ARG("Map::Update", "map", GetId());
     uint32 updateMapTime = WorldTimer::getMSTime();
     _dynamicTree.update(t_diff);
 
@@ -846,7 +871,7 @@ void Map::Update(uint32 t_diff)
     uint32 sessionsUpdateTime = WorldTimer::getMSTimeDiffToNow(updateMapTime);
 
     /// update players at tick
-    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    WorkStealingPool::Clock::time_point deadline = WorkStealingPool::Clock::now() + std::chrono::milliseconds(sWorld.getConfig(CONFIG_UINT32_INTERVAL_MAPUPDATE));
     UpdateSessionsMovementAndSpellsIfNeeded();
     UpdatePlayers();
     uint32 playersUpdateTime = WorldTimer::getMSTimeDiffToNow(updateMapTime) - sessionsUpdateTime;
@@ -868,17 +893,23 @@ void Map::Update(uint32 t_diff)
     RemoveCorpses();
     RemoveOldBones(t_diff);
 
+    if (m_gridPreloader)
+        m_gridPreloader->Update(t_diff);
+
     updateMapTime = WorldTimer::getMSTimeDiffToNow(updateMapTime);
+    m_lastUpdateTime = updateMapTime;
 
     uint32 additionnalWaitTime = 0;
     uint32 additionnalUpdateCounts = 0;
     if (!Instanceable())
     {
+        TICK_PROFILE_SCOPE_ARG("Map::WaitContinents", "map", GetId());
         additionnalWaitTime = WorldTimer::getMSTime();
         sMapMgr.MarkContinentUpdateFinished();
-        while (!sMapMgr.waitContinentUpdateFinishedUntil(start + std::chrono::milliseconds(sWorld.getConfig(CONFIG_UINT32_INTERVAL_MAPUPDATE))))
+        // Lend a hand to the other maps while waiting for the slowest continent
+        while (!sMapMgr.GetUpdateScheduler().helpUntil(deadline, []() { return sMapMgr.IsContinentUpdateFinished(); }))
         {
-            start = std::chrono::high_resolution_clock::now();
+            deadline = WorkStealingPool::Clock::now() + std::chrono::milliseconds(sWorld.getConfig(CONFIG_UINT32_INTERVAL_MAPUPDATE));
             UpdateSessionsMovementAndSpellsIfNeeded();
             UpdatePlayers();
             ++additionnalUpdateCounts;
@@ -889,6 +920,7 @@ void Map::Update(uint32 t_diff)
     // This isn't really bother us, since as soon as we have instanced BG-s, the whole map unloads as the BG gets ended
     if (!IsBattleGround())
     {
+        TICK_PROFILE_SCOPE("Map::UpdateGridStates");
         for (GridRefManager<NGridType>::iterator i = GridRefManager<NGridType>::begin(); i != GridRefManager<NGridType>::end();)
         {
             NGridType* grid = i->getSource();
@@ -902,6 +934,7 @@ void Map::Update(uint32 t_diff)
     ///- Process necessary scripts
     if (m_uiScriptedEventsTimer <= t_diff)
     {
+        TICK_PROFILE_SCOPE("Map::UpdateScriptedEvents");
         UpdateScriptedEvents();
         m_uiScriptedEventsTimer = 1000u;
     }
@@ -911,7 +944,10 @@ void Map::Update(uint32 t_diff)
     ScriptsProcess();
 
     if (i_data)
+    {
+        TICK_PROFILE_SCOPE("InstanceData::Update");
         i_data->Update(t_diff);
+    }
 
     m_weatherSystem->UpdateWeathers(t_diff);
 
@@ -2433,6 +2469,8 @@ void Map::ScriptsProcess()
     if (m_scriptSchedule.empty())
         return;
 
+    TICK_PROFILE_SCOPE("Map::ScriptsProcess");
+
     ///- Process overdue queued scripts
     ScriptScheduleMap::iterator iter = m_scriptSchedule.begin();
     // ok as multimap is a *sorted* associative container
@@ -2662,12 +2700,13 @@ void Map::SendObjectUpdates()
     uint32 objectsCount = i_objectsToClientUpdate.size();
     if (!objectsCount)
         return;
+    TICK_PROFILE_SCOPE_ARG("Map::SendObjectUpdates", "objects", objectsCount);
     _processingSendObjUpdates = true;
 
-    // Compute maximum number of threads
+    // Compute maximum number of parallel tasks
     uint32 threads = 1;
     if (IsContinent())
-        threads = m_objectThreads->size() +1;
+        threads = sWorld.getConfig(CONFIG_UINT32_MAP_OBJECTSUPDATE_THREADS);
     if (!_objUpdatesThreads)
         _objUpdatesThreads = 1;
     if (threads < _objUpdatesThreads)
@@ -2685,12 +2724,19 @@ void Map::SendObjectUpdates()
         t.push_back(it);
     std::atomic<int> ait(0);
     uint32 timeout = sWorld.getConfig(CONFIG_UINT32_MAP_OBJECTSUPDATE_TIMEOUT);
-    auto f = [&t, &ait, beginTime=now, timeout](){
+    // objects with changes not sent to every observer yet (interest tiers)
+    std::vector<Object*> deferred;
+    std::mutex deferredLock;
+    auto f = [&t, &ait, &deferred, &deferredLock, beginTime=now, timeout](){
+        TICK_PROFILE_SCOPE("Map::BuildObjectUpdates");
         UpdateDataMapType update_players; // Player -> UpdateData
+        std::vector<Object*> localDeferred;
         int it = ait++;
         while (it < t.size())
         {
             (*t[it])->BuildUpdateData(update_players);
+            if ((*t[it])->HasDeferredUpdate())
+                localDeferred.push_back(*t[it]);
             if (WorldTimer::getMSTimeDiffToNow(beginTime) > timeout)
                 break;
             it = ait++;
@@ -2698,20 +2744,27 @@ void Map::SendObjectUpdates()
 
         for (UpdateDataMapType::iterator iter = update_players.begin(); iter != update_players.end(); ++iter)
             iter->second.Send(iter->first->GetSession());
+
+        if (!localDeferred.empty())
+        {
+            std::lock_guard<std::mutex> guard(deferredLock);
+            deferred.insert(deferred.end(), localDeferred.begin(), localDeferred.end());
+        }
     };
-    std::future<void> job;
-    if (m_objectThreads)
-         job = m_objectThreads->processWorkload();
+    WorkStealingPool::TaskGroup objectsUpdate(sMapMgr.GetUpdateScheduler());
+    for (uint32 i = 0; i < threads - 1; ++i)
+        objectsUpdate.run(f);
     f();
-    if (job.valid())
-        job.wait();
+    objectsUpdate.wait();
     if (ait >= i_objectsToClientUpdate.size()) //ait is increased before checks, so max value is `objectsCount + threads`
         i_objectsToClientUpdate.clear();
     else
         i_objectsToClientUpdate.erase(t.front(), t[ait]);
 
     // If we timeout, use more threads !
-    if (!i_objectsToClientUpdate.empty())
+    bool const timedOut = !i_objectsToClientUpdate.empty();
+    i_objectsToClientUpdate.insert(deferred.begin(), deferred.end());
+    if (timedOut)
         ++_objUpdatesThreads;
     else
         --_objUpdatesThreads;
@@ -2733,12 +2786,13 @@ void Map::UpdateVisibilityForRelocations()
     uint32 objectsCount = i_unitsRelocated.size();
     if (!objectsCount)
         return;
+    TICK_PROFILE_SCOPE_ARG("Map::UpdateVisibilityForRelocations", "units", objectsCount);
     _processingUnitsRelocation = true;
 
-    // Compute number of threads to spawn
+    // Compute number of parallel tasks to spawn
     uint32 threads = 1;
     if (IsContinent())
-        threads = m_visibilityThreads->size() + 1;
+        threads = sWorld.getConfig(CONFIG_UINT32_MAP_VISIBILITYUPDATE_THREADS);
     if (!_unitRelocationThreads)
         _unitRelocationThreads = 1;
     if (threads < _unitRelocationThreads)
@@ -2756,6 +2810,7 @@ void Map::UpdateVisibilityForRelocations()
     std::atomic<int> ait(0);
     uint32 timeout = sWorld.getConfig(CONFIG_UINT32_MAP_VISIBILITYUPDATE_TIMEOUT);
     auto f = [&t, &ait, beginTime=now, timeout](){
+        TICK_PROFILE_SCOPE("Map::ProcessRelocationVisibilityUpdates");
         int it = ait++;
         while (it < t.size())
         {
@@ -2765,16 +2820,12 @@ void Map::UpdateVisibilityForRelocations()
             it = ait++;
         }
     };
-    for (uint32 i = 0; i < threads -1; ++i)
-        m_visibilityThreads << f;
-
-    std::future<void> job;
-    if (m_visibilityThreads)
-        job = m_visibilityThreads->processWorkload();
+    WorkStealingPool::TaskGroup visibilityUpdate(sMapMgr.GetUpdateScheduler());
+    for (uint32 i = 0; i < threads - 1; ++i)
+        visibilityUpdate.run(f);
 
     f();
-    if (job.valid())
-        job.wait();
+    visibilityUpdate.wait();
     if (ait >= i_unitsRelocated.size()) //ait is increased before checks, so max value is `objectsCount + threads`
         i_unitsRelocated.clear();
     else
@@ -2942,6 +2993,16 @@ bool Map::isInLineOfSight(float x1, float y1, float z1, float x2, float y2, floa
     && (!checkDynLos || CheckDynamicTreeLoS(x1, y1, z1, x2, y2, z2));
 }
 
+void Map::isInLineOfSight(VMAP::LineOfSightQuery const* rays, uint32 count, bool* results, bool checkDynLos) const
+{
+    VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), rays, count, results);
+
+    if (checkDynLos)
+        for (uint32 i = 0; i < count; ++i)
+            if (results[i])
+                results[i] = CheckDynamicTreeLoS(rays[i].x1, rays[i].y1, rays[i].z1, rays[i].x2, rays[i].y2, rays[i].z2);
+}
+
 bool Map::GetLosHitPosition(float srcX, float srcY, float srcZ, float& destX, float& destY, float& destZ, float modifyDist) const
 {
     ASSERT(MaNGOS::IsValidMapCoord(srcX, srcY, srcZ));
@@ -41,6 +41,7 @@
 
 #include <bitset>
 #include <list>
+#include <memory>
 #include <set>
 #include <mutex>
 #include <shared_mutex>
@@ -60,11 +61,13 @@ class BattleGroundPersistentState;
 class ChatHandler;
 class BattleGround;
 class WeatherSystem;
+class GridPreloader;
 class Transport;
 
 namespace VMAP
 {
     class ModelInstance;
+    struct LineOfSightQuery;
 };
 
 // GCC have alternative #pragma pack(N) syntax and old gcc version not support pack(push,N), also any gcc version not support it at some platform
@@ -312,13 +315,12 @@ struct ScriptedEvent
     ScriptedEvent(ScriptedEvent const&) = delete;
 };
 
-class ThreadPool;
-
 class Map : public GridRefManager<NGridType>
 {
     friend class MapReference;
     friend class ObjectGridLoader;
     friend class ObjectWorldLoader;
+    friend class GridPreloader;
 
     protected:
         Map(uint32 id, time_t, uint32 InstanceId);
@@ -350,7 +352,7 @@ class Map : public GridRefManager<NGridType>
         inline void UpdateActiveCellsSynch(uint32 now, uint32 diff);
         inline void MarkCellsAroundObject(WorldObject const* object);
         inline void UpdateActiveCellsAsynch(uint32 now, uint32 diff);
-        inline void UpdateActiveCellsCallback(uint32 diff, uint32 now, uint32 threadId, uint32 totalThreads, uint32 step);
+        inline void UpdateActiveCellsStripe(uint32 diff, uint32 now, uint32 firstRow, uint32 lastRow);
         inline void UpdateCells(uint32 diff);
         void UpdateSync(uint32 const);
         void UpdatePlayers();
@@ -544,6 +546,8 @@ class Map : public GridRefManager<NGridType>
         // GameObjectCollision
         float GetHeight(float x, float y, float z, bool vmap = true, float maxSearchDist = DEFAULT_HEIGHT_SEARCH) const;
         bool isInLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, bool checkDynLos = true) const;
+        // isInLineOfSight for count rays at once, results[i] is the answer for rays[i]
+        void isInLineOfSight(VMAP::LineOfSightQuery const* rays, uint32 count, bool* results, bool checkDynLos = true) const;
         // First collision with object
         bool GetLosHitPosition(float srcX, float srcY, float srcZ, float& destX, float& destY, float& destZ, float modifyDist) const;
         // Use navemesh to walk
@@ -565,6 +569,8 @@ class Map : public GridRefManager<NGridType>
         void CrashUnload();
         bool IsUpdateFinished() const { return m_updateFinished; }
         void MarkNotUpdated() { m_updateFinished = false; }
+        // Duration of the last update, waiting for other continents excluded (critical path of this map)
+        uint32 GetLastUpdateTime() const { return m_lastUpdateTime; }
         void SetUpdateDiffMod(int32 d) { m_updateDiffMod = d; }
         uint32 GetUpdateDiffMod() const { return m_updateDiffMod; }
         void BindToInstanceOrRaid(Player* player, time_t objectResetTime, bool permBindToRaid);
@@ -655,11 +661,6 @@ class Map : public GridRefManager<NGridType>
         void RemoveCorpses(bool unload = false);
         void RemoveOldBones(uint32 const diff);
 
-        std::unique_ptr<ThreadPool> m_objectThreads;
-        std::unique_ptr<ThreadPool> m_motionThreads;
-        std::unique_ptr<ThreadPool> m_visibilityThreads;
-        std::unique_ptr<ThreadPool> m_cellThreads;
-
     protected:
         MapEntry const* i_mapEntry;
         uint32 i_id;
@@ -691,6 +692,7 @@ class Map : public GridRefManager<NGridType>
         bool m_unloading = false;
         bool m_crashed = false;
         bool m_updateFinished = false;
+        uint32 m_lastUpdateTime = 0;
         uint32 m_updateDiffMod;
         uint32 m_lastMvtSpellsUpdate = 0;
     private:
@@ -742,6 +744,9 @@ class Map : public GridRefManager<NGridType>
         // WeatherSystem
         WeatherSystem* m_weatherSystem;
 
+        // Loads the grids players are moving to, continents only
+        std::unique_ptr<GridPreloader> m_gridPreloader;
+
         // Creature summon limit
         std::unordered_map<uint64, uint32> m_mCreatureSummonLimit;
         std::unordered_map<uint64, uint32> m_mCreatureSummonCount;
@@ -31,7 +31,9 @@
 #include "Group.h"
 #include "ZoneScriptMgr.h"
 #include "Map.h"
-#include "ThreadPool.h"
+#include "WorkStealingPool.h"
+#include "TickProfiler.h"
+#include <mysql.h>
 
 typedef MaNGOS::ClassLevelLockable<MapManager, std::recursive_mutex> MapManagerLock;
 INSTANTIATE_SINGLETON_2(MapManager, MapManagerLock);
@@ -41,10 +43,17 @@ MapManager::MapManager()
     :
     i_gridCleanUpDelay(sWorld.getConfig(CONFIG_UINT32_INTERVAL_GRIDCLEAN)),
     i_MaxInstanceId(RESERVED_INSTANCES_LAST),
-    m_threads(new ThreadPool(sWorld.getConfig(CONFIG_UINT32_MAPUPDATE_INSTANCED_UPDATE_THREADS)))
+    m_updateScheduler(new WorkStealingPool(sWorld.getConfig(CONFIG_UINT32_MAPUPDATE_WORKER_THREADS)))
 {
     i_timer.SetInterval(sWorld.getConfig(CONFIG_UINT32_INTERVAL_MAPUPDATE));
-    m_threads->start<ThreadPool::MySQL<>>();
+    m_updateScheduler->start([]() { mysql_thread_init(); TickProfiler::SetThreadName("Map update"); }, []() { mysql_thread_end(); });
+
+    // file IO only, no mysql
+    if (uint32 threads = sWorld.getConfig(CONFIG_UINT32_GRID_PRELOAD_THREADS))
+    {
+        m_gridPreloadScheduler.reset(new WorkStealingPool(int(threads)));
+        m_gridPreloadScheduler->start();
+    }
 }
 
 MapManager::~MapManager()
@@ -238,6 +247,8 @@ void MapManager::Update(uint32 diff)
     if (!i_timer.Passed())
         return;
 
+    TICK_PROFILE_SCOPE("MapManager::Update");
+
     // Execute any teleports scheduled in the main thread prior to map update
     // eg. area triggers, world port acks
     ExecuteDelayedPlayerTeleports();
@@ -249,8 +260,8 @@ void MapManager::Update(uint32 diff)
     uint32 now = WorldTimer::getMSTime();
 
     uint32 inactiveTimeLimit = sWorld.getConfig(CONFIG_UINT32_EMPTY_MAPS_UPDATE_TIME);
-    std::vector<std::function<void()>> continentsUpdaters;
-    std::vector<std::function<void()>> instancesUpdaters;
+    std::vector<Map*> continents;
+    std::vector<Map*> instances;
 
     for (MapMapType::iterator iter = i_maps.begin(); iter != i_maps.end(); ++iter)
     {
@@ -261,21 +272,10 @@ void MapManager::Update(uint32 diff)
         iter->second->UpdateSync(mapsDiff);
         iter->second->MarkNotUpdated();
         if (iter->second->Instanceable())
+            instances.push_back(iter->second);
+        else // One task per continent part
         {
-            if (m_threads->status() == ThreadPool::Status::READY)
-                instancesUpdaters.emplace_back([iter,mapsDiff](){
-                    iter->second->DoUpdate(mapsDiff);
-                });
-            else
-                iter->second->DoUpdate(mapsDiff);
-        }
-        else // One threat per continent part
-        {
-            continentsUpdaters.emplace_back([iter,mapsDiff](){
-                Map *m = iter->second;
-                if (!m->IsUpdateFinished() || !sMapMgr.IsContinentUpdateFinished())
-                    m->DoUpdate(mapsDiff);
-            });
+            continents.push_back(iter->second);
             continentsIdx++;
         }
     }
@@ -283,31 +283,55 @@ void MapManager::Update(uint32 diff)
 
     i_continentUpdateFinished.store(0);
 
-    if (!m_continentThreads || m_continentThreads->size() < continentsUpdaters.size())
-    {
-        m_continentThreads.reset(new ThreadPool(continentsUpdaters.size()));
-        m_continentThreads->start<>();
-    }
-    std::future<void> continents = m_continentThreads->processWorkload(std::move(continentsUpdaters),
-                                                                       ThreadPool::Callable());
+    // Every map update is a top-level task. Maps split their own update into
+    // sub-tasks on the same scheduler, so idle threads steal from the busiest map.
+    WorkStealingPool::TaskGroup continentsUpdate(*m_updateScheduler);
+    for (Map* map : continents)
+        continentsUpdate.run([map, mapsDiff]() { map->DoUpdate(mapsDiff); }, false);
 
     SwitchPlayersInstances();
 
-    std::chrono::high_resolution_clock::time_point start;
+    // Instances keep being updated until every continent is done
+    WorkStealingPool::Clock::time_point deadline;
     do {
-        start = std::chrono::high_resolution_clock::now();
-        std::future<void> f = m_threads->processWorkload(instancesUpdaters,
-                                                         ThreadPool::Callable());
-
-        if (f.valid())
-            f.wait();
-        else
+        deadline = WorkStealingPool::Clock::now() + std::chrono::milliseconds(sWorld.getConfig(CONFIG_UINT32_INTERVAL_MAPUPDATE));
+        if (instances.empty())
             break;
-    }while(!sMapMgr.waitContinentUpdateFinishedUntil(start + std::chrono::milliseconds(sWorld.getConfig(CONFIG_UINT32_INTERVAL_MAPUPDATE))));
 
+        WorkStealingPool::TaskGroup instancesUpdate(*m_updateScheduler);
+        for (Map* map : instances)
+            instancesUpdate.run([map, mapsDiff]() { map->DoUpdate(mapsDiff); }, false);
+        instancesUpdate.waitAny();
+    } while (!m_updateScheduler->helpUntil(deadline, [this]() { return IsContinentUpdateFinished(); }));
+
+    {
+        TICK_PROFILE_SCOPE("MapManager::WaitContinents");
+        continentsUpdate.waitAny();
+    }
 
-    if (continents.valid())
-        continents.wait();
+    WorkStealingPool::Stats stats = m_updateScheduler->collectStats();
+    Map const* criticalMap = nullptr;
+    for (Map const* map : continents)
+        if (!criticalMap || map->GetLastUpdateTime() > criticalMap->GetLastUpdateTime())
+            criticalMap = map;
+    for (Map const* map : instances)
+        if (!criticalMap || map->GetLastUpdateTime() > criticalMap->GetLastUpdateTime())
+            criticalMap = map;
+    m_lastUpdateStats.tickTime = WorldTimer::getMSTimeDiffToNow(now);
+    m_lastUpdateStats.continents = uint32(continents.size());
+    m_lastUpdateStats.instances = uint32(instances.size());
+    m_lastUpdateStats.executed = uint32(stats.executed);
+    m_lastUpdateStats.stolen = uint32(stats.stolen);
+    m_lastUpdateStats.helped = uint32(stats.helped);
+    m_lastUpdateStats.criticalMapId = criticalMap ? criticalMap->GetId() : 0;
+    m_lastUpdateStats.criticalInstanceId = criticalMap ? criticalMap->GetInstanceId() : 0;
+    m_lastUpdateStats.criticalMapTime = criticalMap ? criticalMap->GetLastUpdateTime() : 0;
+
+    MapUpdateStats const& last = m_lastUpdateStats;
+    if (criticalMap && sWorld.getConfig(CONFIG_UINT32_PERFLOG_SLOW_MAPSYSTEM_UPDATE) && last.tickTime > sWorld.getConfig(CONFIG_UINT32_PERFLOG_SLOW_MAPSYSTEM_UPDATE))
+        sLog.out(LOG_PERFORMANCE, "Update maps: %ums [%u continents|%u instances] tasks %u stolen %u helped %u, critical path: map %u inst %u %ums",
+            last.tickTime, last.continents, last.instances, last.executed, last.stolen, last.helped,
+            last.criticalMapId, last.criticalInstanceId, last.criticalMapTime);
 
     asyncMapUpdating = false;
 
@@ -837,6 +861,7 @@ void MapManager::ScheduleFarTeleport(Player* player, ScheduledTeleportData* data
 // Execute all delayed teleports at the end of a map update
 void MapManager::ExecuteDelayedPlayerTeleports()
 {
+    TICK_PROFILE_SCOPE("MapManager::ExecuteDelayedPlayerTeleports");
     ScheduledTeleportMap::iterator iter;
     for (iter = m_scheduledFarTeleports.begin(); iter != m_scheduledFarTeleports.end(); ++iter)
     {
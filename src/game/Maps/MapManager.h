@@ -72,9 +72,23 @@ struct MapID
     uint32 nInstanceId;
 };
 
-class ThreadPool;
+class WorkStealingPool;
 struct ScheduledTeleportData;
 
+// Scheduler counters of the last map system update, shown by .instance stats
+struct MapUpdateStats
+{
+    uint32 tickTime = 0;
+    uint32 continents = 0;
+    uint32 instances = 0;
+    uint32 executed = 0;                // tasks run by the shared scheduler
+    uint32 stolen = 0;                  // tasks taken from another worker's deque
+    uint32 helped = 0;                  // tasks run by a thread waiting on a group
+    uint32 criticalMapId = 0;           // slowest map of the tick
+    uint32 criticalInstanceId = 0;
+    uint32 criticalMapTime = 0;
+};
+
 class MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::ClassLevelLockable<MapManager, std::recursive_mutex> >
 {
     friend class MaNGOS::OperatorNew<MapManager>;
@@ -170,6 +184,8 @@ class MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::ClassLevelLockab
         /* statistics */
         uint32 GetNumInstances();
         uint32 GetNumPlayersInInstances();
+        // Written by Update, read by commands: both run on the world thread
+        MapUpdateStats const& GetLastUpdateStats() const { return m_lastUpdateStats; }
 
 
         //get list of all maps
@@ -190,6 +206,11 @@ class MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::ClassLevelLockab
 
         bool waitContinentUpdateFinishedFor(std::chrono::milliseconds time) const;
         bool waitContinentUpdateFinishedUntil(std::chrono::high_resolution_clock::time_point time) const;
+
+        // Shared scheduler running every map update and their sub-tasks (cells, motion, visibility, object updates)
+        WorkStealingPool& GetUpdateScheduler() const { return *m_updateScheduler; }
+        // Threads of the continent grid preloaders, null if disabled
+        WorkStealingPool* GetGridPreloadScheduler() const { return m_gridPreloadScheduler.get(); }
     private:
 
         // debugging code, should be deleted some day
@@ -222,9 +243,10 @@ class MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::ClassLevelLockab
         mutable std::condition_variable      m_continentCV;
         std::atomic<int> i_continentUpdateFinished{0};
 
-        std::unique_ptr<ThreadPool> m_threads;
-        std::unique_ptr<ThreadPool> m_continentThreads;
+        std::unique_ptr<WorkStealingPool> m_updateScheduler;
+        std::unique_ptr<WorkStealingPool> m_gridPreloadScheduler;
         bool asyncMapUpdating = false;
+        MapUpdateStats m_lastUpdateStats;
 
         // Instanced continent zones
         const static int LAST_CONTINENT_ID = 2;
@@ -24,6 +24,74 @@
 
 namespace MMAP
 {
+namespace
+{
+    // every MMapData gets its own generation, so that a cached query is never taken for one of a reloaded map
+    std::atomic<uint32> s_lastGeneration(0);
+
+    struct CachedNavMeshQuery
+    {
+        uint32 generation;
+        dtNavMeshQuery* query;
+    };
+    // queries already handed to the current thread by GetNavMeshQuery, read without any lock
+    thread_local std::unordered_map<uint32, CachedNavMeshQuery> t_navMeshQueries;
+}
+
+MMapData::MMapData(dtNavMesh* mesh) : navMesh(mesh), generation(++s_lastGeneration)
+{
+}
+
+// ######################## PathCorridorCache ########################
+uint32 PathCorridorCache::Get(dtPolyRef startRef, dtPolyRef endRef, uint32 filterKey, dtPolyRef* path, uint32 maxLength)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    auto itr = m_index.find({ startRef, endRef, filterKey });
+    if (itr == m_index.end() || itr->second->second.size() > maxLength)
+    {
+        ++m_misses;
+        return 0;
+    }
+
+    ++m_hits;
+    m_entries.splice(m_entries.begin(), m_entries, itr->second);
+    std::vector<dtPolyRef> const& corridor = itr->second->second;
+    std::copy(corridor.begin(), corridor.end(), path);
+    return corridor.size();
+}
+
+void PathCorridorCache::Add(dtPolyRef startRef, dtPolyRef endRef, uint32 filterKey, dtPolyRef const* path, uint32 length, uint32 maxEntries)
+{
+    if (!maxEntries || !length)
+        return;
+
+    Key const key = { startRef, endRef, filterKey };
+    std::unique_lock<std::mutex> lock(m_lock);
+    auto itr = m_index.find(key);
+    if (itr != m_index.end())
+    {
+        itr->second->second.assign(path, path + length);
+        m_entries.splice(m_entries.begin(), m_entries, itr->second);
+        return;
+    }
+
+    if (m_index.size() >= maxEntries)
+    {
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+    }
+
+    m_entries.emplace_front(key, std::vector<dtPolyRef>(path, path + length));
+    m_index[key] = m_entries.begin();
+}
+
+void PathCorridorCache::Clear()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    m_entries.clear();
+    m_index.clear();
+}
+
 // ######################## MMapFactory ########################
 // our global singelton copy
 MMapManager *g_MMapManager = nullptr;
@@ -194,6 +262,7 @@ bool MMapManager::loadMap(uint32 mapId, int32 x, int32 y)
     if (dtStatusSucceed(dResult))
     {
         mmap->mmapLoadedTiles.insert(std::pair<uint32, dtTileRef>(packedGridPos, tileRef));
+        mmap->corridors.Clear();
         ++loadedTiles;
         return true;
     }
@@ -243,6 +312,7 @@ bool MMapManager::unloadMap(uint32 mapId, int32 x, int32 y)
     else
     {
         mmap->mmapLoadedTiles.erase(packedGridPos);
+        mmap->corridors.Clear();
         --loadedTiles;
         return true;
     }
@@ -296,10 +366,13 @@ bool MMapManager::unloadMapInstance(uint32 mapId, std::thread::id instanceId)
         return false;
     }
 
+    std::unique_lock<std::shared_timed_mutex> lock(mmap->navMeshQueries_lock);
     dtNavMeshQuery* query = mmap->navMeshQueries[instanceId];
 
     dtFreeNavMeshQuery(query);
     mmap->navMeshQueries.erase(instanceId);
+    // the owning thread may still have the query cached
+    mmap->generation = ++s_lastGeneration;
     DETAIL_LOG("MMAP:unloadMapInstance: Unloaded mapId %03u instanceId %u", mapId, instanceId);
 
     return true;
@@ -313,13 +386,27 @@ dtNavMesh const* MMapManager::GetNavMesh(uint32 mapId)
     return loadedMMaps[mapId]->navMesh;
 }
 
+PathCorridorCache* MMapManager::GetCorridorCache(uint32 mapId)
+{
+    MMapDataSet::const_iterator itr = loadedMMaps.find(mapId);
+    if (itr == loadedMMaps.end())
+        return nullptr;
+
+    return &itr->second->corridors;
+}
+
 dtNavMeshQuery const* MMapManager::GetNavMeshQuery(uint32 mapId)
 {
-    if (loadedMMaps.find(mapId) == loadedMMaps.end())
+    MMapDataSet::const_iterator mmapItr = loadedMMaps.find(mapId);
+    if (mmapItr == loadedMMaps.end())
         return nullptr;
 
+    MMapData* mmap = mmapItr->second;
+    auto cached = t_navMeshQueries.find(mapId);
+    if (cached != t_navMeshQueries.end() && cached->second.generation == mmap->generation)
+        return cached->second.query;
+
     std::thread::id tid= std::this_thread::get_id();
-    MMapData* mmap = loadedMMaps[mapId];
     std::shared_lock<std::shared_timed_mutex> lock(mmap->navMeshQueries_lock);
 
     NavMeshQuerySet::iterator it = mmap->navMeshQueries.find(tid);
@@ -347,6 +434,7 @@ dtNavMeshQuery const* MMapManager::GetNavMeshQuery(uint32 mapId)
     else
         navMeshQuery = it->second;
 
+    t_navMeshQueries[mapId] = { mmap->generation, navMeshQuery };
     return navMeshQuery;
 }
 
@@ -30,6 +30,10 @@
 
 #include <thread>
 #include <shared_mutex>
+#include <atomic>
+#include <mutex>
+#include <list>
+#include <vector>
 
 //  memory management
 inline void* dtCustomAlloc(size_t size, dtAllocHint /*hint*/)
@@ -48,10 +52,51 @@ namespace MMAP
     typedef std::unordered_map<uint32, dtTileRef> MMapTileSet;
     typedef std::unordered_map<std::thread::id, dtNavMeshQuery*> NavMeshQuerySet;
 
+    // LRU of poly corridors found by PathInfo, keyed by start poly, end poly and filter.
+    // Pets, followers and chasing mobs keep asking for the same corridors.
+    class PathCorridorCache
+    {
+        public:
+            PathCorridorCache() : m_hits(0), m_misses(0) {}
+
+            // copies a cached corridor into path, returns its length or 0 when not cached
+            uint32 Get(dtPolyRef startRef, dtPolyRef endRef, uint32 filterKey, dtPolyRef* path, uint32 maxLength);
+            void Add(dtPolyRef startRef, dtPolyRef endRef, uint32 filterKey, dtPolyRef const* path, uint32 length, uint32 maxEntries);
+            // corridors may go through a removed tile, or miss a shorter way through a new one
+            void Clear();
+
+            uint32 GetHits() const { return m_hits; }
+            uint32 GetMisses() const { return m_misses; }
+
+        private:
+            struct Key
+            {
+                dtPolyRef startRef;
+                dtPolyRef endRef;
+                uint32 filterKey;
+                bool operator==(Key const& other) const { return startRef == other.startRef && endRef == other.endRef && filterKey == other.filterKey; }
+            };
+            struct KeyHash
+            {
+                size_t operator()(Key const& key) const
+                {
+                    return std::hash<uint64>()(uint64(key.startRef) * 0x9E3779B97F4A7C15ULL ^ uint64(key.endRef)) ^ key.filterKey;
+                }
+            };
+            typedef std::pair<Key, std::vector<dtPolyRef>> Entry;
+            typedef std::list<Entry> EntryList;
+
+            EntryList m_entries;                // most recently used first
+            std::unordered_map<Key, EntryList::iterator, KeyHash> m_index;
+            std::mutex m_lock;
+            std::atomic<uint32> m_hits;
+            std::atomic<uint32> m_misses;
+    };
+
     // dummy struct to hold map's mmap data
     struct MMapData
     {
-        MMapData(dtNavMesh* mesh) : navMesh(mesh) {}
+        MMapData(dtNavMesh* mesh);
         ~MMapData()
         {
             for (const auto& itr : navMeshQueries)
@@ -66,8 +111,11 @@ namespace MMAP
         // we have to use single dtNavMeshQuery for every instance, since those are not thread safe
         NavMeshQuerySet navMeshQueries;     // threadId to query
         std::shared_timed_mutex navMeshQueries_lock;
+        // changes whenever queries of navMeshQueries may have been freed, invalidates the per-thread caches
+        std::atomic<uint32> generation;
         MMapTileSet mmapLoadedTiles;        // maps [map grid coords] to [dtTile]
         std::mutex tilesLoading_lock;
+        PathCorridorCache corridors;
     };
 
     typedef std::unordered_map<uint32, MMapData*> MMapDataSet;
@@ -91,6 +139,7 @@ namespace MMAP
             dtNavMeshQuery const* GetNavMeshQuery(uint32 mapId);
             dtNavMeshQuery const* GetModelNavMeshQuery(uint32 displayId);
             dtNavMesh const* GetNavMesh(uint32 mapId);
+            PathCorridorCache* GetCorridorCache(uint32 mapId);
 
             uint32 getLoadedTilesCount() const { return loadedTiles; }
             uint32 getLoadedMapsCount() const { return loadedMMaps.size(); }
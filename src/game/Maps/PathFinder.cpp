@@ -23,6 +23,7 @@
 #include "Log.h"
 #include "Map.h"
 #include "Transport.h"
+#include "World.h"
 
 #include "Detour/Include/DetourCommon.h"
 
@@ -351,23 +352,39 @@ void PathInfo::BuildPolyPath(Vector3 const& startPos, Vector3 const& endPos)
         //if (threadId != m_navMeshQuery->m_owningThread)
             //sLog.outError("CRASH: We are using a dtNavMeshQuery from thread %u which belongs to thread %u!", threadId, m_navMeshQuery->m_owningThread);
 
-        dtStatus dtResult = m_navMeshQuery->findPath(
-                                startPoly,          // start polygon
-                                endPoly,            // end polygon
-                                startPoint,         // start position
-                                endPoint,           // end position
-                                &m_filter,           // polygon search filter
-                                m_pathPolyRefs,     // [out] path
-                                (int*)&m_polyLength,
-                                MAX_PATH_LENGTH);   // max number of polygons in output path
+        // other units of the map may have asked for the same corridor recently
+        MMAP::PathCorridorCache* corridors = nullptr;
+        uint32 const filterKey = uint32(m_filter.getIncludeFlags()) << 16 | m_filter.getExcludeFlags();
+        if (!m_transport && sWorld.getConfig(CONFIG_UINT32_MMAP_CORRIDOR_CACHE_SIZE))
+            corridors = MMAP::MMapFactory::createOrGetMMapManager()->GetCorridorCache(m_sourceUnit->GetMapId());
 
-        if (!m_polyLength || dtStatusFailed(dtResult))
+        if (corridors)
+            m_polyLength = corridors->Get(startPoly, endPoly, filterKey, m_pathPolyRefs, MAX_PATH_LENGTH);
+
+        if (!m_polyLength)
         {
-            // only happens if we passed bad data to findPath(), or navmesh is messed up
-            sLog.outError("%u's Path Build failed: 0 length path. Result=0x%x", m_sourceUnit->GetGUIDLow(), dtResult);
-            BuildShortcut();
-            m_type = PATHFIND_NOPATH;
-            return;
+            dtStatus dtResult = m_navMeshQuery->findPath(
+                                    startPoly,          // start polygon
+                                    endPoly,            // end polygon
+                                    startPoint,         // start position
+                                    endPoint,           // end position
+                                    &m_filter,           // polygon search filter
+                                    m_pathPolyRefs,     // [out] path
+                                    (int*)&m_polyLength,
+                                    MAX_PATH_LENGTH);   // max number of polygons in output path
+
+            if (!m_polyLength || dtStatusFailed(dtResult))
+            {
+                // only happens if we passed bad data to findPath(), or navmesh is messed up
+                sLog.outError("%u's Path Build failed: 0 length path. Result=0x%x", m_sourceUnit->GetGUIDLow(), dtResult);
+                BuildShortcut();
+                m_type = PATHFIND_NOPATH;
+                return;
+            }
+
+            // partial corridors do not lead to endPoly, do not share them
+            if (corridors && !dtStatusDetail(dtResult, DT_PARTIAL_RESULT))
+                corridors->Add(startPoly, endPoly, filterKey, m_pathPolyRefs, m_polyLength, sWorld.getConfig(CONFIG_UINT32_MMAP_CORRIDOR_CACHE_SIZE));
         }
     }
 
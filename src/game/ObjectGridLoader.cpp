@@ -31,6 +31,7 @@
 #include "World.h"
 #include "CellImpl.h"
 #include "BattleGround.h"
+#include "GridPreloader.h"
 
 class ObjectGridRespawnMover
 {
@@ -39,7 +40,7 @@ public:
 
     void Move(GridType& grid);
 
-    template<class T> void Visit(GridRefManager<T>&) {}
+    template<class T> void Visit(GridObjectList<T>&) {}
     void Visit(CreatureMapType& m);
 };
 
@@ -56,12 +57,14 @@ ObjectGridRespawnMover::Visit(CreatureMapType& m)
     // creature in unloading grid can have respawn point in another grid
     // if it will be unloaded then it will not respawn in original grid until unload/load original grid
     // move to respawn point to prevent this case. For player view in respawn grid this will be normal respawn.
-    for (CreatureMapType::iterator iter = m.begin(), next; iter != m.end(); iter = next)
-    {
-        next = iter;
-        ++next;
+    // relocation takes creatures out of the list
+    std::vector<Creature*> creatures;
+    creatures.reserve(m.getSize());
+    for (auto const& iter : m)
+        creatures.push_back(iter.getSource());
 
-        Creature* c = iter->getSource();
+    for (Creature* c : creatures)
+    {
 
         MANGOS_ASSERT(!c->IsPet() && "ObjectGridRespawnMover don't must be called for pets");
 
@@ -90,7 +93,7 @@ public:
 
     void Visit(CorpseMapType& m);
 
-    template<class T> void Visit(GridRefManager<T>&) { }
+    template<class T> void Visit(GridObjectList<T>&) { }
 
 private:
     Cell i_cell;
@@ -137,8 +140,8 @@ bool IsEnabledOnMap<Creature>(Map* map, uint32 guid)
     return data->instanciatedContinentInstanceId == map->GetInstanceId();
 }
 
-template <class T>
-void LoadHelper(CellGuidSet const& guid_set, CellPair& cell, GridRefManager<T>& m, uint32& count, Map* map, GridType& grid)
+template <class T, class GuidList>
+void LoadHelper(GuidList const& guid_set, CellPair& cell, GridObjectList<T>& m, uint32& count, Map* map, GridType& grid)
 {
     BattleGround* bg = map->IsBattleGround() ? ((BattleGroundMap*)map)->GetBG() : nullptr;
 
@@ -208,10 +211,11 @@ ObjectGridLoader::Visit(GameObjectMapType& m)
     CellPair cell_pair(x, y);
     uint32 cell_id = (cell_pair.y_coord * TOTAL_NUMBER_OF_CELLS_PER_MAP) + cell_pair.x_coord;
 
-    CellObjectGuids const& cell_guids = sObjectMgr.GetCellObjectGuids(i_map->GetId(), cell_id);
-
     GridType& grid = (*i_map->getNGrid(i_cell.GridX(), i_cell.GridY()))(i_cell.CellX(), i_cell.CellY());
-    LoadHelper(cell_guids.gameobjects, cell_pair, m, i_gameObjects, i_map, grid);
+    if (i_spawns)
+        LoadHelper(i_spawns->gameobjects[i_cell.CellX()][i_cell.CellY()], cell_pair, m, i_gameObjects, i_map, grid);
+    else
+        LoadHelper(sObjectMgr.GetCellObjectGuids(i_map->GetId(), cell_id).gameobjects, cell_pair, m, i_gameObjects, i_map, grid);
     LoadHelper(i_map->GetPersistentState()->GetCellObjectGuids(cell_id).gameobjects, cell_pair, m, i_gameObjects, i_map, grid);
 }
 
@@ -223,10 +227,11 @@ ObjectGridLoader::Visit(CreatureMapType& m)
     CellPair cell_pair(x, y);
     uint32 cell_id = (cell_pair.y_coord * TOTAL_NUMBER_OF_CELLS_PER_MAP) + cell_pair.x_coord;
 
-    CellObjectGuids const& cell_guids = sObjectMgr.GetCellObjectGuids(i_map->GetId(), cell_id);
-
     GridType& grid = (*i_map->getNGrid(i_cell.GridX(), i_cell.GridY()))(i_cell.CellX(), i_cell.CellY());
-    LoadHelper(cell_guids.creatures, cell_pair, m, i_creatures, i_map, grid);
+    if (i_spawns)
+        LoadHelper(i_spawns->creatures[i_cell.CellX()][i_cell.CellY()], cell_pair, m, i_creatures, i_map, grid);
+    else
+        LoadHelper(sObjectMgr.GetCellObjectGuids(i_map->GetId(), cell_id).creatures, cell_pair, m, i_creatures, i_map, grid);
     LoadHelper(i_map->GetPersistentState()->GetCellObjectGuids(cell_id).creatures, cell_pair, m, i_creatures, i_map, grid);
 }
 
@@ -299,15 +304,15 @@ ObjectGridUnloader::Unload(GridType& grid)
 
 template<class T>
 void
-ObjectGridUnloader::Visit(GridRefManager<T>& m)
+ObjectGridUnloader::Visit(GridObjectList<T>& m)
 {
     // remove all cross-reference before deleting
-    for (typename GridRefManager<T>::iterator iter = m.begin(); iter != m.end(); ++iter)
+    for (typename GridObjectList<T>::iterator iter = m.begin(); iter != m.end(); ++iter)
         iter->getSource()->CleanupsBeforeDelete();
 
     while (!m.isEmpty())
     {
-        T* obj = m.getFirst()->getSource();
+        T* obj = m.begin()->getSource();
         // if option set then object already saved at this moment
         if (!sWorld.getConfig(CONFIG_BOOL_SAVE_RESPAWN_TIME_IMMEDIATELY))
             obj->SaveRespawnTime();
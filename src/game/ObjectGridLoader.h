@@ -30,14 +30,16 @@
 #include "Cell.h"
 
 class ObjectWorldLoader;
+struct GridSpawnLists;
 
 class ObjectGridLoader
 {
     friend class ObjectWorldLoader;
 
     public:
-        ObjectGridLoader(NGridType& grid, Map* map, Cell const& cell)
-            : i_cell(cell), i_grid(grid), i_map(map), i_gameObjects(0), i_creatures(0), i_corpses (0)
+        // spawns: static spawns copied by the GridPreloader, read from ObjectMgr if null
+        ObjectGridLoader(NGridType& grid, Map* map, Cell const& cell, GridSpawnLists const* spawns = nullptr)
+            : i_cell(cell), i_grid(grid), i_map(map), i_spawns(spawns), i_gameObjects(0), i_creatures(0), i_corpses (0)
             {}
 
         void Load(GridType& grid);
@@ -53,6 +55,7 @@ class ObjectGridLoader
         Cell i_cell;
         NGridType& i_grid;
         Map* i_map;
+        GridSpawnLists const* i_spawns;
         uint32 i_gameObjects;
         uint32 i_creatures;
         uint32 i_corpses;
@@ -77,7 +80,7 @@ class ObjectGridUnloader
         }
 
         void Unload(GridType& grid);
-        template<class T> void Visit(GridRefManager<T>& m);
+        template<class T> void Visit(GridObjectList<T>& m);
     private:
         NGridType& i_grid;
 };
@@ -104,7 +107,7 @@ class ObjectGridStoper
         void Visit(CreatureMapType& m);
         void Visit(GameObjectMapType& m);
 
-        template<class NONACTIVE> void Visit(GridRefManager<NONACTIVE>&) {}
+        template<class NONACTIVE> void Visit(GridObjectList<NONACTIVE>&) {}
     private:
         NGridType& i_grid;
 };
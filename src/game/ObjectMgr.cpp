@@ -2029,6 +2029,7 @@ void ObjectMgr::AddCreatureToGrid(uint32 guid, CreatureData const* data)
     std::unique_lock<std::mutex> lock(m_MapObjectGuids_lock);
     CellObjectGuids& cell_guids = m_MapObjectGuids[data->position.mapId][cell_id];
     cell_guids.creatures.insert(guid);
+    ++m_MapObjectGuidsVersion;
 }
 
 void ObjectMgr::RemoveCreatureFromGrid(uint32 guid, CreatureData const* data)
@@ -2039,6 +2040,7 @@ void ObjectMgr::RemoveCreatureFromGrid(uint32 guid, CreatureData const* data)
     std::unique_lock<std::mutex> lock(m_MapObjectGuids_lock);
     CellObjectGuids& cell_guids = m_MapObjectGuids[data->position.mapId][cell_id];
     cell_guids.creatures.erase(guid);
+    ++m_MapObjectGuidsVersion;
 }
 
 void ObjectMgr::LoadGameobjects(bool reload)
@@ -2203,6 +2205,7 @@ void ObjectMgr::AddGameobjectToGrid(uint32 guid, GameObjectData const* data)
     std::unique_lock<std::mutex> lock(m_MapObjectGuids_lock);
     CellObjectGuids& cell_guids = m_MapObjectGuids[data->position.mapId][cell_id];
     cell_guids.gameobjects.insert(guid);
+    ++m_MapObjectGuidsVersion;
 }
 
 void ObjectMgr::RemoveGameobjectFromGrid(uint32 guid, GameObjectData const* data)
@@ -2213,6 +2216,24 @@ void ObjectMgr::RemoveGameobjectFromGrid(uint32 guid, GameObjectData const* data
     std::unique_lock<std::mutex> lock(m_MapObjectGuids_lock);
     CellObjectGuids& cell_guids = m_MapObjectGuids[data->position.mapId][cell_id];
     cell_guids.gameobjects.erase(guid);
+    ++m_MapObjectGuidsVersion;
+}
+
+void ObjectMgr::CopyCellObjectGuids(uint16 mapid, uint32 cell_id, CellGuidSet& creatures, CellGuidSet& gameobjects)
+{
+    creatures.clear();
+    gameobjects.clear();
+
+    // unlike GetCellObjectGuids, never adds the cell
+    std::unique_lock<std::mutex> lock(m_MapObjectGuids_lock);
+    auto mapItr = m_MapObjectGuids.find(mapid);
+    if (mapItr == m_MapObjectGuids.end())
+        return;
+    auto cellItr = mapItr->second.find(cell_id);
+    if (cellItr == mapItr->second.end())
+        return;
+    creatures = cellItr->second.creatures;
+    gameobjects = cellItr->second.gameobjects;
 }
 
 // In order to keep database item template data correct for each patch, fix changed spell effects used by some items here.
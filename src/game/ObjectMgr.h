@@ -38,6 +38,7 @@
 #include <string>
 #include <map>
 #include <limits>
+#include <atomic>
 
 extern SQLStorage sCreatureDataLinkGroupStorage;
 
@@ -1096,6 +1097,10 @@ class ObjectMgr
         {
             return m_MapObjectGuids_lock;
         }
+        // copy of the static spawns of a cell, for the threads preloading grids
+        void CopyCellObjectGuids(uint16 mapid, uint32 cell_id, CellGuidSet& creatures, CellGuidSet& gameobjects);
+        // changes whenever a creature or gameobject is added to or removed from a cell
+        uint32 GetCellObjectGuidsVersion() const { return m_MapObjectGuidsVersion; }
 
         // modifiers for global grid objects state (static DB spawns, global spawn mods from gameevent system)
         // Don't must be used for modify instance specific spawn state modifications
@@ -1480,6 +1485,7 @@ class ObjectMgr
 
         MapObjectGuids m_MapObjectGuids;
         std::mutex m_MapObjectGuids_lock;
+        std::atomic<uint32> m_MapObjectGuidsVersion{0};
 
         CreatureDataMap m_CreatureDataMap;
         CreatureLocaleMap m_CreatureLocaleMap;
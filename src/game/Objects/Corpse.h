@@ -87,14 +87,11 @@ class Corpse : public WorldObject
         Player* lootRecipient;
         bool lootForBody;
 
-        GridReference<Corpse>& GetGridRef() { return m_gridRef; }
-
         bool IsExpired(time_t t) const;
         void SetFactionTemplate(FactionTemplateEntry const* entry) { m_faction = entry; }
         FactionTemplateEntry const* GetFactionTemplate() { return m_faction; }
         uint32 GetFactionTemplateId() const final;
     private:
-        GridReference<Corpse> m_gridRef;
         FactionTemplateEntry const* m_faction;
 
         CorpseType m_type;
@@ -53,6 +53,7 @@
 #include "CreatureLinkingMgr.h"
 #include "TemporarySummon.h"
 #include "GuardMgr.h"
+#include "TickProfiler.h"
 
 TrainerSpell const* TrainerSpellData::Find(uint32 spell_id) const
 {
@@ -836,7 +837,10 @@ void Creature::Update(uint32 update_diff, uint32 diff)
                     if (leash || (m_TargetNotReachableTimer > 24000))
                         AI()->EnterEvadeMode();
                     else if (!IsEvadeBecauseTargetNotReachable())
+                    {
+                        TICK_PROFILE_SCOPE_ARG("CreatureAI::UpdateAI", "entry", GetEntry());
                         AI()->UpdateAI(diff);   // AI not react good at real update delays (while freeze in non-active part of map)
+                    }
                 }
                 catch (std::runtime_error& e)
                 {
@@ -2713,7 +2717,7 @@ Unit* Creature::SelectAttackingTarget(AttackingTarget target, uint32 position, S
         {
             std::vector<Unit*> suitableUnits;
             suitableUnits.reserve(threatlist.size() - position);
-            advance(itr, position);
+            std::advance(itr, position);
             for (; itr != threatlist.end(); ++itr)
                 if (Unit* pTarget = GetMap()->GetUnit((*itr)->getUnitGuid()))
                     if (!selectFlags || MeetsSelectAttackingRequirement(pTarget, pSpellInfo, selectFlags))
@@ -2726,7 +2730,7 @@ Unit* Creature::SelectAttackingTarget(AttackingTarget target, uint32 position, S
         }
         case ATTACKING_TARGET_TOPAGGRO:
         {
-            advance(itr, position);
+            std::advance(itr, position);
             for (; itr != threatlist.end(); ++itr)
                 if (Unit* pTarget = GetMap()->GetUnit((*itr)->getUnitGuid()))
                     if (!selectFlags || MeetsSelectAttackingRequirement(pTarget, pSpellInfo, selectFlags))
@@ -2736,7 +2740,7 @@ Unit* Creature::SelectAttackingTarget(AttackingTarget target, uint32 position, S
         }
         case ATTACKING_TARGET_BOTTOMAGGRO:
         {
-            advance(ritr, position);
+            std::advance(ritr, position);
             for (; ritr != threatlist.rend(); ++ritr)
                 if (Unit* pTarget = GetMap()->GetUnit((*itr)->getUnitGuid()))
                     if (!selectFlags || MeetsSelectAttackingRequirement(pTarget, pSpellInfo, selectFlags))
@@ -2751,7 +2755,7 @@ Unit* Creature::SelectAttackingTarget(AttackingTarget target, uint32 position, S
             Unit* pTarget = nullptr;
             Unit* suitableTarget = nullptr;
 
-            advance(itr, position);
+            std::advance(itr, position);
             for (; itr != threatlist.end(); ++itr)
             {
                 pTarget = GetMap()->GetUnit((*itr)->getUnitGuid());
@@ -2775,7 +2779,7 @@ Unit* Creature::SelectAttackingTarget(AttackingTarget target, uint32 position, S
             Unit* pTarget = nullptr;
             Unit* suitableTarget = nullptr;
 
-            advance(itr, position);
+            std::advance(itr, position);
             for (; itr != threatlist.end(); ++itr)
             {
                 pTarget = GetMap()->GetUnit((*itr)->getUnitGuid());
@@ -453,7 +453,6 @@ class Creature : public Unit
         void SetDefaultGossipMenuId(uint32 menuId) { m_gossipMenuId = menuId; }
         uint32 GetDefaultGossipMenuId() const override { return m_gossipMenuId; }
 
-        GridReference<Creature>& GetGridRef() { return m_gridRef; }
         bool IsRegeneratingHealth() const { return HasCreatureState(CSTATE_REGEN_HEALTH); }
         bool IsRegeneratingMana() const { return HasCreatureState(CSTATE_REGEN_MANA); }
         virtual uint8 GetPetAutoSpellSize() const { return CREATURE_MAX_SPELLS; }
@@ -630,7 +629,6 @@ class Creature : public Unit
         float m_detectionDistance;
 
     private:
-        GridReference<Creature> m_gridRef;
         CreatureInfo const* m_creatureInfo;
 };
 
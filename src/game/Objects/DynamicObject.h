@@ -71,8 +71,6 @@ class DynamicObject : public WorldObject
 
         bool IsVisibleForInState(WorldObject const* pDetector, WorldObject const* viewPoint, bool inVisibleList) const override;
 
-        GridReference<DynamicObject>& GetGridRef() { return m_gridRef; }
-
     protected:
         uint32 m_spellId;
         SpellEffectIndex m_effIndex;
@@ -81,7 +79,5 @@ class DynamicObject : public WorldObject
         bool m_positive;
         bool m_channeled;
         AffectedMap m_affected;
-    private:
-        GridReference<DynamicObject> m_gridRef;
 };
 #endif
@@ -209,8 +209,6 @@ class GameObject : public SpellCaster
         
         GameObject* LookupFishingHoleAround(float range);
 
-        GridReference<GameObject>& GetGridRef() { return m_gridRef; }
-
         // Nostalrius
         bool IsUseRequirementMet() const;
         bool PlayerCanUse(Player* pl);
@@ -274,7 +272,6 @@ class GameObject : public SpellCaster
     private:
         void SwitchDoorOrButton(bool activate, bool alternative = false);
 
-        GridReference<GameObject> m_gridRef;
 };
 
 inline GameObject* Object::ToGameObject()
@@ -0,0 +1,31 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_INTERESTTIER_H
+#define MANGOS_INTERESTTIER_H
+
+#include "Platform/Define.h"
+
+// How closely an observer follows a visible object, see WorldObject::GetInterestTier.
+// Only observers seeing a crowd (Visibility.Tiers.CrowdThreshold) get tiers above near.
+enum InterestTier : uint8
+{
+    INTEREST_TIER_NEAR  = 0,                                // every values update and movement packet
+    INTEREST_TIER_MID   = 1,                                // values and position every Visibility.Tiers.MidInterval
+    INTEREST_TIER_FAR   = 2,                                // position and values every Visibility.Tiers.FarInterval
+};
+
+#endif
@@ -188,6 +188,7 @@ Object::Object() : m_updateFlag(0)
     m_objectUpdated     = false;
     _deleted            = false;
     _delayedActions     = 0;
+    m_hasDeferredUpdate = false;
 }
 
 Object::~Object()
@@ -559,8 +560,6 @@ void Object::BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* u
 {
     if (!target)
         return;
-    
-    bool const ShowHealthValues = sWorld.getConfig(CONFIG_BOOL_OBJECT_HEALTH_VALUE_SHOW);
 
     bool IsActivateToQuest = false;
 
@@ -616,198 +615,7 @@ void Object::BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* u
         for (uint16 index = 0; index < m_valuesCount; ++index)
         {
             if (updateMask->GetBit(index))
-            {
-                if (index == UNIT_NPC_FLAGS)
-                {
-                    uint32 appendValue = m_uint32Values[index];
-
-                    if (GetTypeId() == TYPEID_UNIT)
-                    {
-                        if (appendValue & UNIT_NPC_FLAG_TRAINER)
-                        {
-                            if (!((Creature*)this)->IsTrainerOf(target, false))
-                                appendValue &= ~UNIT_NPC_FLAG_TRAINER;
-                        }
-
-                        if (appendValue & UNIT_NPC_FLAG_STABLEMASTER)
-                        {
-                            if (target->GetClass() != CLASS_HUNTER)
-                                appendValue &= ~UNIT_NPC_FLAG_STABLEMASTER;
-                        }
-
-                        if (appendValue & UNIT_NPC_FLAG_FLIGHTMASTER)
-                        {
-                            QuestRelationsMapBounds bounds = sObjectMgr.GetCreatureQuestRelationsMapBounds(((Creature*)this)->GetEntry());
-                            for (QuestRelationsMap::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
-                            {
-                                Quest const* pQuest = sObjectMgr.GetQuestTemplate(itr->second);
-                                if (target->CanSeeStartQuest(pQuest))
-                                {
-                                    appendValue &= ~UNIT_NPC_FLAG_FLIGHTMASTER;
-                                    break;
-                                }
-                            }
-
-                            if (appendValue & UNIT_NPC_FLAG_FLIGHTMASTER)
-                            {
-                                bounds = sObjectMgr.GetCreatureQuestInvolvedRelationsMapBounds(((Creature*)this)->GetEntry());
-                                for (QuestRelationsMap::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
-                                {
-                                    Quest const* pQuest = sObjectMgr.GetQuestTemplate(itr->second);
-                                    if (target->CanRewardQuest(pQuest, false))
-                                    {
-                                        appendValue &= ~UNIT_NPC_FLAG_FLIGHTMASTER;
-                                        break;
-                                    }
-                                }
-                            }
-                        }
-                    }
-
-                    *data << uint32(appendValue);
-                }
-                // FIXME: Some values at server stored in float format but must be sent to client in uint32 format
-                else if (index >= UNIT_FIELD_BASEATTACKTIME && index <= UNIT_FIELD_RANGEDATTACKTIME)
-                {
-                    // convert from float to uint32 and send
-                    *data << uint32(m_floatValues[index] < 0 ? 0 : m_floatValues[index]);
-                }
-
-                // there are some float values which may be negative or can't get negative due to other checks
-                else if ((index >= PLAYER_FIELD_NEGSTAT0    && index <= PLAYER_FIELD_NEGSTAT4) ||
-                         (index >= PLAYER_FIELD_RESISTANCEBUFFMODSPOSITIVE  && index <= (PLAYER_FIELD_RESISTANCEBUFFMODSPOSITIVE + 6)) ||
-                         (index >= PLAYER_FIELD_RESISTANCEBUFFMODSNEGATIVE  && index <= (PLAYER_FIELD_RESISTANCEBUFFMODSNEGATIVE + 6)) ||
-                         (index >= PLAYER_FIELD_POSSTAT0    && index <= PLAYER_FIELD_POSSTAT4))
-                    *data << uint32(m_floatValues[index]);
-                // Gamemasters should be always able to select units and view auras
-                else if (index == UNIT_FIELD_FLAGS && target->IsGameMaster())
-                    *data << ((m_uint32Values[index] | UNIT_FLAG_AURAS_VISIBLE) & ~UNIT_FLAG_NOT_SELECTABLE);
-                // hide lootable animation for unallowed players
-                else if (index == UNIT_DYNAMIC_FLAGS)
-                {
-                    uint32 dynamicFlags = m_uint32Values[index];
-                    if (HasFlag(UNIT_DYNAMIC_FLAGS, UNIT_DYNFLAG_TRACK_UNIT))
-                        if (Unit const* unit = ToUnit())
-                        {
-                            Unit::AuraList auras = unit->GetAurasByType(SPELL_AURA_MOD_STALKED);
-                            if (std::find_if(auras.begin(), auras.end(),[target](Aura* a){
-                                return target->GetObjectGuid() == a->GetCasterGuid();
-                            }) == auras.end())
-                                dynamicFlags &= ~UNIT_DYNFLAG_TRACK_UNIT;
-                        }
-                    if (Creature const* creature = ToCreature())
-                    {
-                        if (creature->HasLootRecipient())
-                        {
-                            if (creature->IsTappedBy(target))
-                                dynamicFlags |= (UNIT_DYNFLAG_TAPPED | UNIT_DYNFLAG_TAPPED_BY_PLAYER);
-                            else
-                            {
-                                dynamicFlags |= UNIT_DYNFLAG_TAPPED;
-                                dynamicFlags &= ~UNIT_DYNFLAG_TAPPED_BY_PLAYER;
-                            }
-                        }
-                        else
-                        {
-                            dynamicFlags &= ~UNIT_DYNFLAG_TAPPED;
-                            dynamicFlags &= ~UNIT_DYNFLAG_TAPPED_BY_PLAYER;
-                        }
-
-                        if (!target->IsAllowedToLoot(creature))
-                            dynamicFlags &= ~UNIT_DYNFLAG_LOOTABLE;
-                    }
-                    *data << dynamicFlags;
-                }
-                // RAID ally-horde - Faction
-                else if (index == UNIT_FIELD_FACTIONTEMPLATE)
-                {
-                    Player* owner = ((Unit*)this)->GetCharmerOrOwnerPlayerOrPlayerItself();
-                    bool forceFriendly = false;
-                    if (owner)
-                    {
-                        FactionTemplateEntry const* ft1,* ft2;
-                        ft1 = owner->getFactionTemplateEntry();
-                        ft2 = target->getFactionTemplateEntry();
-                        if (ft1 && ft2 && !ft1->IsFriendlyTo(*ft2) && owner->IsInSameRaidWith(target))
-                            if (owner->IsInInterFactionMode() && target->IsInInterFactionMode())
-                                forceFriendly = true;
-                    }
-                    uint32 faction = m_uint32Values[index];
-                    if (forceFriendly)
-                        faction = target->GetFactionTemplateId();
-
-                    *data << uint32(faction);
-                }
-                // RAID ally-horde : pas de flag FFA
-                else if (index == PLAYER_FLAGS && (m_uint32Values[index] & PLAYER_FLAGS_FFA_PVP))
-                {
-                    Player* owner = ((Unit*)this)->GetCharmerOrOwnerPlayerOrPlayerItself();
-                    if (owner && owner != target && owner->IsInSameRaidWith(target))
-                        *data << uint32(m_uint32Values[index] & ~PLAYER_FLAGS_FFA_PVP);
-                    else
-                        *data << uint32(m_uint32Values[index]);
-                }
-                // Hide real health value. Send a percent instead. See ShowHealthValues option in mangosd.conf
-                else if (!ShowHealthValues && (index == UNIT_FIELD_HEALTH || index == UNIT_FIELD_MAXHEALTH))
-                {
-                    if (target->CanSeeHealthOf((Unit*)this))
-                        *data << m_uint32Values[index];
-                    else // Hide
-                    {
-                        if (index == UNIT_FIELD_MAXHEALTH)
-                            *data << uint32(100);
-                        else
-                        {
-                            uint32 pct = 0;
-                            if (m_uint32Values[UNIT_FIELD_HEALTH])
-                            {
-                                pct = uint32((m_uint32Values[UNIT_FIELD_HEALTH] * 100.0f) / m_uint32Values[UNIT_FIELD_MAXHEALTH]);
-                                if (pct > 100)
-                                    pct = 100;
-                                if (!pct)
-                                    pct = 1;
-                            }
-                            *data << pct;
-                        }
-                    }
-                }
-                else if (target == this && (index == PLAYER_TRACK_CREATURES || index == PLAYER_TRACK_RESOURCES))
-                {
-                    //if (Warden* base = target->GetSession()->GetWarden())
-                        //base->TrackingUpdateSent(index, m_uint32Values[index]);
-                    *data << m_uint32Values[index];
-                }
-                // This is done to make creatures face the target they are casting on.
-                else if (index == UNIT_FIELD_TARGET)
-                {
-                    if (Creature const* pCreature = ToCreature())
-                    {
-                        if (pCreature->m_castingTargetGuid)
-                        {
-                            *data << *((uint32*)&pCreature->m_castingTargetGuid);
-                            continue;
-                        }
-                    }
-                    *data << m_uint32Values[index];     
-                }
-                else if (index == UNIT_FIELD_TARGET+1)
-                {
-                    if (Creature const* pCreature = ToCreature())
-                    {
-                        if (pCreature->m_castingTargetGuid)
-                        {
-                            *data << *(((uint32*)&pCreature->m_castingTargetGuid) + 1);
-                            continue;
-                        }
-                    }
-                    *data << m_uint32Values[index];
-                }
-                else
-                {
-                    // send in current format (float as float, uint32 as uint32)
-                    *data << m_uint32Values[index];
-                }
-            }
+                *data << GetUnitUpdateFieldValue(index, target);
         }
     }
     else if (isType(TYPEMASK_GAMEOBJECT))                   // gameobject case
@@ -849,25 +657,7 @@ void Object::BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* u
         for (uint16 index = 0; index < m_valuesCount; ++index)
         {
             if (updateMask->GetBit(index))
-            {
-                if (index == CORPSE_FIELD_DYNAMIC_FLAGS)
-                {
-                    uint32 dynFlags = m_uint32Values[CORPSE_FIELD_DYNAMIC_FLAGS];
-                    if (Corpse const* corpse = ToCorpse())
-                    {
-                        Loot const* loot = &corpse->loot;
-                        if (loot->isLooted()) // nothing to loot or everything looted.
-                            dynFlags &= ~CORPSE_DYNFLAG_LOOTABLE;
-                        if (dynFlags & CORPSE_DYNFLAG_LOOTABLE)
-                            if (corpse->IsFriendlyTo(target))
-                                dynFlags &= ~CORPSE_DYNFLAG_LOOTABLE;
-                    }
-                    *data << dynFlags;
-                }
-                else
-                    // send in current format (float as float, uint32 as uint32)
-                    *data << m_uint32Values[index];
-            }
+                *data << GetCorpseUpdateFieldValue(index, target);
         }
     }
 #if SUPPORTED_CLIENT_BUILD <= CLIENT_BUILD_1_6_1
@@ -906,6 +696,268 @@ void Object::BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* u
     }
 }
 
+uint32 Object::GetUnitUpdateFieldValue(uint16 index, Player* target) const
+{
+    if (index == UNIT_NPC_FLAGS)
+    {
+        uint32 appendValue = m_uint32Values[index];
+
+        if (GetTypeId() == TYPEID_UNIT)
+        {
+            if (appendValue & UNIT_NPC_FLAG_TRAINER)
+            {
+                if (!((Creature*)this)->IsTrainerOf(target, false))
+                    appendValue &= ~UNIT_NPC_FLAG_TRAINER;
+            }
+
+            if (appendValue & UNIT_NPC_FLAG_STABLEMASTER)
+            {
+                if (target->GetClass() != CLASS_HUNTER)
+                    appendValue &= ~UNIT_NPC_FLAG_STABLEMASTER;
+            }
+
+            if (appendValue & UNIT_NPC_FLAG_FLIGHTMASTER)
+            {
+                QuestRelationsMapBounds bounds = sObjectMgr.GetCreatureQuestRelationsMapBounds(((Creature*)this)->GetEntry());
+                for (QuestRelationsMap::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
+                {
+                    Quest const* pQuest = sObjectMgr.GetQuestTemplate(itr->second);
+                    if (target->CanSeeStartQuest(pQuest))
+                    {
+                        appendValue &= ~UNIT_NPC_FLAG_FLIGHTMASTER;
+                        break;
+                    }
+                }
+
+                if (appendValue & UNIT_NPC_FLAG_FLIGHTMASTER)
+                {
+                    bounds = sObjectMgr.GetCreatureQuestInvolvedRelationsMapBounds(((Creature*)this)->GetEntry());
+                    for (QuestRelationsMap::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
+                    {
+                        Quest const* pQuest = sObjectMgr.GetQuestTemplate(itr->second);
+                        if (target->CanRewardQuest(pQuest, false))
+                        {
+                            appendValue &= ~UNIT_NPC_FLAG_FLIGHTMASTER;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        return appendValue;
+    }
+    // FIXME: Some values at server stored in float format but must be sent to client in uint32 format
+    else if (index >= UNIT_FIELD_BASEATTACKTIME && index <= UNIT_FIELD_RANGEDATTACKTIME)
+    {
+        // convert from float to uint32 and send
+        return uint32(m_floatValues[index] < 0 ? 0 : m_floatValues[index]);
+    }
+
+    // there are some float values which may be negative or can't get negative due to other checks
+    else if ((index >= PLAYER_FIELD_NEGSTAT0    && index <= PLAYER_FIELD_NEGSTAT4) ||
+             (index >= PLAYER_FIELD_RESISTANCEBUFFMODSPOSITIVE  && index <= (PLAYER_FIELD_RESISTANCEBUFFMODSPOSITIVE + 6)) ||
+             (index >= PLAYER_FIELD_RESISTANCEBUFFMODSNEGATIVE  && index <= (PLAYER_FIELD_RESISTANCEBUFFMODSNEGATIVE + 6)) ||
+             (index >= PLAYER_FIELD_POSSTAT0    && index <= PLAYER_FIELD_POSSTAT4))
+        return uint32(m_floatValues[index]);
+    // Gamemasters should be always able to select units and view auras
+    else if (index == UNIT_FIELD_FLAGS && target->IsGameMaster())
+        return (m_uint32Values[index] | UNIT_FLAG_AURAS_VISIBLE) & ~UNIT_FLAG_NOT_SELECTABLE;
+    // hide lootable animation for unallowed players
+    else if (index == UNIT_DYNAMIC_FLAGS)
+    {
+        uint32 dynamicFlags = m_uint32Values[index];
+        if (HasFlag(UNIT_DYNAMIC_FLAGS, UNIT_DYNFLAG_TRACK_UNIT))
+            if (Unit const* unit = ToUnit())
+            {
+                Unit::AuraList auras = unit->GetAurasByType(SPELL_AURA_MOD_STALKED);
+                if (std::find_if(auras.begin(), auras.end(),[target](Aura* a){
+                    return target->GetObjectGuid() == a->GetCasterGuid();
+                }) == auras.end())
+                    dynamicFlags &= ~UNIT_DYNFLAG_TRACK_UNIT;
+            }
+        if (Creature const* creature = ToCreature())
+        {
+            if (creature->HasLootRecipient())
+            {
+                if (creature->IsTappedBy(target))
+                    dynamicFlags |= (UNIT_DYNFLAG_TAPPED | UNIT_DYNFLAG_TAPPED_BY_PLAYER);
+                else
+                {
+                    dynamicFlags |= UNIT_DYNFLAG_TAPPED;
+                    dynamicFlags &= ~UNIT_DYNFLAG_TAPPED_BY_PLAYER;
+                }
+            }
+            else
+            {
+                dynamicFlags &= ~UNIT_DYNFLAG_TAPPED;
+                dynamicFlags &= ~UNIT_DYNFLAG_TAPPED_BY_PLAYER;
+            }
+
+            if (!target->IsAllowedToLoot(creature))
+                dynamicFlags &= ~UNIT_DYNFLAG_LOOTABLE;
+        }
+        return dynamicFlags;
+    }
+    // RAID ally-horde - Faction
+    else if (index == UNIT_FIELD_FACTIONTEMPLATE)
+    {
+        Player* owner = ((Unit*)this)->GetCharmerOrOwnerPlayerOrPlayerItself();
+        bool forceFriendly = false;
+        if (owner)
+        {
+            FactionTemplateEntry const* ft1,* ft2;
+            ft1 = owner->getFactionTemplateEntry();
+            ft2 = target->getFactionTemplateEntry();
+            if (ft1 && ft2 && !ft1->IsFriendlyTo(*ft2) && owner->IsInSameRaidWith(target))
+                if (owner->IsInInterFactionMode() && target->IsInInterFactionMode())
+                    forceFriendly = true;
+        }
+        uint32 faction = m_uint32Values[index];
+        if (forceFriendly)
+            faction = target->GetFactionTemplateId();
+
+        return faction;
+    }
+    // RAID ally-horde : pas de flag FFA
+    else if (index == PLAYER_FLAGS && (m_uint32Values[index] & PLAYER_FLAGS_FFA_PVP))
+    {
+        Player* owner = ((Unit*)this)->GetCharmerOrOwnerPlayerOrPlayerItself();
+        if (owner && owner != target && owner->IsInSameRaidWith(target))
+            return m_uint32Values[index] & ~PLAYER_FLAGS_FFA_PVP;
+        else
+            return m_uint32Values[index];
+    }
+    // Hide real health value. Send a percent instead. See ShowHealthValues option in mangosd.conf
+    else if (!sWorld.getConfig(CONFIG_BOOL_OBJECT_HEALTH_VALUE_SHOW) && (index == UNIT_FIELD_HEALTH || index == UNIT_FIELD_MAXHEALTH))
+    {
+        if (target->CanSeeHealthOf((Unit*)this))
+            return m_uint32Values[index];
+        else // Hide
+        {
+            if (index == UNIT_FIELD_MAXHEALTH)
+                return 100;
+
+            uint32 pct = 0;
+            if (m_uint32Values[UNIT_FIELD_HEALTH])
+            {
+                pct = uint32((m_uint32Values[UNIT_FIELD_HEALTH] * 100.0f) / m_uint32Values[UNIT_FIELD_MAXHEALTH]);
+                if (pct > 100)
+                    pct = 100;
+                if (!pct)
+                    pct = 1;
+            }
+            return pct;
+        }
+    }
+    // This is done to make creatures face the target they are casting on.
+    else if (index == UNIT_FIELD_TARGET || index == UNIT_FIELD_TARGET + 1)
+    {
+        if (Creature const* pCreature = ToCreature())
+        {
+            if (pCreature->m_castingTargetGuid)
+                return *(((uint32*)&pCreature->m_castingTargetGuid) + (index - UNIT_FIELD_TARGET));
+        }
+        return m_uint32Values[index];
+    }
+
+    // send in current format (float as float, uint32 as uint32)
+    return m_uint32Values[index];
+}
+
+uint32 Object::GetCorpseUpdateFieldValue(uint16 index, Player* target) const
+{
+    if (index == CORPSE_FIELD_DYNAMIC_FLAGS)
+    {
+        uint32 dynFlags = m_uint32Values[CORPSE_FIELD_DYNAMIC_FLAGS];
+        if (Corpse const* corpse = ToCorpse())
+        {
+            Loot const* loot = &corpse->loot;
+            if (loot->isLooted()) // nothing to loot or everything looted.
+                dynFlags &= ~CORPSE_DYNFLAG_LOOTABLE;
+            if (dynFlags & CORPSE_DYNFLAG_LOOTABLE)
+                if (corpse->IsFriendlyTo(target))
+                    dynFlags &= ~CORPSE_DYNFLAG_LOOTABLE;
+        }
+        return dynFlags;
+    }
+
+    // send in current format (float as float, uint32 as uint32)
+    return m_uint32Values[index];
+}
+
+bool Object::IsTargetDependentUpdateField(uint16 index) const
+{
+    if (isType(TYPEMASK_UNIT))
+    {
+        switch (index)
+        {
+            case UNIT_FIELD_FLAGS:
+            case UNIT_DYNAMIC_FLAGS:
+            case UNIT_FIELD_FACTIONTEMPLATE:
+                return true;
+            case UNIT_NPC_FLAGS:
+                return GetTypeId() == TYPEID_UNIT;
+            case UNIT_FIELD_HEALTH:
+            case UNIT_FIELD_MAXHEALTH:
+                return !sWorld.getConfig(CONFIG_BOOL_OBJECT_HEALTH_VALUE_SHOW);
+            default:
+                return index == PLAYER_FLAGS && GetTypeId() == TYPEID_PLAYER;
+        }
+    }
+    if (isType(TYPEMASK_CORPSE))
+        return index == CORPSE_FIELD_DYNAMIC_FLAGS;
+    if (isType(TYPEMASK_GAMEOBJECT))
+        return index == GAMEOBJECT_DYN_FLAGS;
+    return false;
+}
+
+void Object::BuildSharedValuesUpdateBlock(SharedUpdateBlock& shared) const
+{
+    MANGOS_ASSERT(!isType(TYPEMASK_GAMEOBJECT));            // per player quest state, see BuildValuesUpdate
+
+    ByteBuffer& buf = shared.block;
+    buf.reserve(500);
+
+    buf << uint8(UPDATETYPE_VALUES);
+#if SUPPORTED_CLIENT_BUILD > CLIENT_BUILD_1_8_4
+    buf << GetPackGUID();
+#else
+    buf << GetGUID();
+#endif
+
+    // No target: the fields visible to any other player
+    UpdateMask updateMask;
+    updateMask.SetCount(m_valuesCount);
+    _SetUpdateBits(&updateMask, nullptr);
+
+    buf << (uint8)updateMask.GetBlockCount();
+    buf.append(updateMask.GetMask(), updateMask.GetLength());
+
+    bool const isUnit = isType(TYPEMASK_UNIT);
+    for (uint16 index = 0; index < m_valuesCount; ++index)
+    {
+        if (!updateMask.GetBit(index))
+            continue;
+
+        if (IsTargetDependentUpdateField(index))
+        {
+            shared.patches.emplace_back(buf.wpos(), index);
+            buf << uint32(0);
+        }
+        else
+            buf << (isUnit ? GetUnitUpdateFieldValue(index, nullptr) : m_uint32Values[index]);
+    }
+}
+
+void Object::BuildSharedValuesUpdateBlockForPlayer(UpdateData* data, SharedUpdateBlock const& shared, Player* target) const
+{
+    size_t offset;
+    ByteBuffer& buf = data->AppendUpdateBlock(shared.block, offset);
+    for (const auto& patch : shared.patches)
+        buf.put<uint32>(offset + patch.first, isType(TYPEMASK_UNIT) ? GetUnitUpdateFieldValue(patch.second, target) : GetCorpseUpdateFieldValue(patch.second, target));
+}
+
 void Object::ClearUpdateMask(bool remove)
 {
     if (m_uint32Values)
@@ -917,6 +969,9 @@ void Object::ClearUpdateMask(bool remove)
             RemoveFromClientUpdateList();
         m_objectUpdated = false;
     }
+    // out of the world, observers get a create block when it comes back
+    if (remove)
+        m_hasDeferredUpdate = false;
     _delayedActions &= ~OBJECT_DELAYED_MARK_CLIENT_UPDATE;
 }
 
@@ -961,6 +1016,33 @@ void Object::_SetUpdateBits(UpdateMask* updateMask, Player* /*target*/) const
         if (m_uint32Values_mirror[index] != m_uint32Values[index])
             updateMask->SetBit(index);
     }
+
+    // resent to everyone, the observers that already have them cannot be told apart
+    if (m_hasDeferredUpdate)
+        *updateMask |= m_deferredUpdateMask;
+}
+
+bool Object::HasChangedValues() const
+{
+    return memcmp(m_uint32Values_mirror, m_uint32Values, sizeof(uint32) * m_valuesCount) != 0;
+}
+
+void Object::DeferChangedValues()
+{
+    if (!m_hasDeferredUpdate)
+    {
+        if (m_deferredUpdateMask.GetCount() != m_valuesCount)
+            m_deferredUpdateMask.SetCount(m_valuesCount);
+        else
+            m_deferredUpdateMask.Clear();
+        m_hasDeferredUpdate = true;
+    }
+
+    for (uint16 index = 0; index < m_valuesCount; ++index)
+    {
+        if (m_uint32Values_mirror[index] != m_uint32Values[index])
+            m_deferredUpdateMask.SetBit(index);
+    }
 }
 
 void Object::_SetCreateBits(UpdateMask* updateMask, Player* /*target*/) const
@@ -1028,6 +1110,9 @@ void Object::SetFloatValue(uint16 index, float value)
     {
         m_floatValues[ index ] = value;
         MarkForClientUpdate();
+
+        if (index == UNIT_FIELD_BOUNDINGRADIUS && isType(TYPEMASK_UNIT))
+            static_cast<WorldObject*>(this)->UpdateGridPosition();
     }
 }
 
@@ -1310,7 +1395,7 @@ void WorldObject::SetVisibilityModifier(float f)
 
 WorldObject::WorldObject()
     :   m_isActiveObject(false), m_visibilityModifier(DEFAULT_VISIBILITY_MODIFIER), m_currMap(nullptr),
-        m_mapId(0), m_InstanceId(0), m_summonLimitAlert(0)
+        m_mapId(0), m_InstanceId(0), m_summonLimitAlert(0), m_lastMidTierUpdate(0), m_lastFarTierUpdate(0)
 {
     // Phasing
     worldMask = WORLD_DEFAULT_OBJECT;
@@ -1343,6 +1428,7 @@ void WorldObject::Relocate(float x, float y, float z, float orientation)
 
     m_movementInfo.ChangePosition(x, y, z, orientation);
     m_movementInfo.UpdateTime(WorldTimer::getMSTime());
+    UpdateGridPosition();
     /*if (Transport* t = GetTransport())
     {
         t->CalculatePassengerOffset(x, y, z);
@@ -1537,16 +1623,64 @@ bool WorldObject::_IsWithinDist(WorldObject const* obj, float dist2compare, bool
 }
 
 bool WorldObject::IsWithinLOSInMap(WorldObject const* obj, bool checkDynLos) const
+{
+    VMAP::LineOfSightQuery ray;
+    bool result;
+    if (!GetLineOfSightQuery(obj, ray, result))
+        return result;
+    return GetMap()->isInLineOfSight(ray.x1, ray.y1, ray.z1, ray.x2, ray.y2, ray.z2, checkDynLos);
+}
+
+void WorldObject::IsWithinLOSInMap(WorldObject const* const* sources, WorldObject const* const* targets, uint32 count, bool* results, bool checkDynLos)
+{
+    Map const* map = nullptr;
+    std::vector<VMAP::LineOfSightQuery> rays;
+    std::vector<uint32> indexes;
+    rays.reserve(count);
+    indexes.reserve(count);
+    for (uint32 i = 0; i < count; ++i)
+    {
+        VMAP::LineOfSightQuery ray;
+        if (!sources[i]->GetLineOfSightQuery(targets[i], ray, results[i]))
+            continue;
+
+        if (!map)
+            map = sources[i]->GetMap();
+        else if (map != sources[i]->GetMap())
+        {
+            results[i] = sources[i]->IsWithinLOSInMap(targets[i], checkDynLos);
+            continue;
+        }
+        rays.push_back(ray);
+        indexes.push_back(i);
+    }
+
+    if (rays.empty())
+        return;
+
+    std::unique_ptr<bool[]> rayResults(new bool[rays.size()]);
+    map->isInLineOfSight(rays.data(), rays.size(), rayResults.get(), checkDynLos);
+    for (uint32 i = 0; i < indexes.size(); ++i)
+        results[indexes[i]] = rayResults[i];
+}
+
+bool WorldObject::GetLineOfSightQuery(WorldObject const* obj, VMAP::LineOfSightQuery& ray, bool& result) const
 {
     ASSERT(obj);
-    if (!IsInMap(obj))
+    result = IsInMap(obj);
+    if (!result || IsWithinDist(obj, 0.0f))
         return false;
-    if (IsWithinDist(obj, 0.0f))
-        return true;
-    float ox, oy, oz;
-    obj->GetPosition(ox, oy, oz);
-    float targetHeight = obj->IsUnit() ? obj->ToUnit()->GetCollisionHeight() : 2.f;
-    return (IsWithinLOS(ox, oy, oz, checkDynLos, targetHeight));
+
+    // same ray as IsWithinLOSAtPosition
+    float const height = IsUnit() ? ToUnit()->GetCollisionHeight() : 2.f;
+    float const targetHeight = obj->IsUnit() ? obj->ToUnit()->GetCollisionHeight() : 2.f;
+    ray.x1 = GetPositionX();
+    ray.y1 = GetPositionY();
+    ray.z1 = GetPositionZ() + height;
+    ray.x2 = obj->GetPositionX();
+    ray.y2 = obj->GetPositionY();
+    ray.z2 = obj->GetPositionZ() + targetHeight;
+    return true;
 }
 
 bool WorldObject::IsWithinLOSAtPosition(float ownX, float ownY, float ownZ, float targetX, float targetY, float targetZ, bool checkDynLos, float targetHeight) const
@@ -1948,7 +2082,7 @@ struct ObjectViewersDeliverer
                     if (player->IsInVisibleList_Unsafe(i_sender))
                         player->GetSession()->SendPacket(i_message);
     }
-    template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
+    template<class SKIP> void Visit(GridObjectList<SKIP>&) {}
 };
 
 void WorldObject::SendObjectMessageToSet(WorldPacket* data, bool self, WorldObject const* except) const
@@ -2585,7 +2719,15 @@ struct WorldObjectChangeAccumulator
 {
     UpdateDataMapType &i_updateDatas;
     WorldObject &i_object;
-    WorldObjectChangeAccumulator(WorldObject &obj, UpdateDataMapType &d) : i_updateDatas(d), i_object(obj)
+    // Values block shared by every receiver, built on first use
+    bool i_useSharedBlock;
+    std::unique_ptr<SharedUpdateBlock> i_sharedBlock;
+    // Farthest observers receiving this update, the others wait for their next turn
+    InterestTier i_maxTier;
+    bool i_deferred;
+    WorldObjectChangeAccumulator(WorldObject &obj, UpdateDataMapType &d, InterestTier maxTier) : i_updateDatas(d), i_object(obj),
+        i_useSharedBlock(sWorld.getConfig(CONFIG_BOOL_MAP_OBJECTSUPDATE_SHARED_BLOCKS) && !obj.isType(TYPEMASK_GAMEOBJECT)),
+        i_maxTier(maxTier), i_deferred(false)
     {
         // send self fields changes in another way, otherwise
         // with new camera system when player's camera too far from player, camera wouldn't receive packets and changes from player
@@ -2599,20 +2741,98 @@ struct WorldObjectChangeAccumulator
         {
             Player* owner = iter.getSource()->GetOwner();
             if (owner != &i_object && owner->IsInVisibleList_Unsafe(&i_object))
-                i_object.BuildUpdateDataForPlayer(owner, i_updateDatas);
+            {
+                if (i_maxTier != INTEREST_TIER_FAR && i_object.GetInterestTier(owner, iter.getSource()->GetBody()) > i_maxTier)
+                {
+                    i_deferred = true;
+                    continue;
+                }
+
+                if (!i_useSharedBlock)
+                {
+                    i_object.BuildUpdateDataForPlayer(owner, i_updateDatas);
+                    continue;
+                }
+
+                if (!i_sharedBlock)
+                {
+                    i_sharedBlock.reset(new SharedUpdateBlock);
+                    i_object.BuildSharedValuesUpdateBlock(*i_sharedBlock);
+                }
+                i_object.BuildSharedValuesUpdateBlockForPlayer(&i_updateDatas[owner], *i_sharedBlock, owner);
+            }
         }
     }
 
-    template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
+    template<class SKIP> void Visit(GridObjectList<SKIP>&) {}
 };
 
 void WorldObject::BuildUpdateData(UpdateDataMapType & update_players)
 {
-    WorldObjectChangeAccumulator notifier(*this, update_players);
+    // Observers in the mid and far tiers only get the changes on their turn. Until the next far turn,
+    // every update also carries the fields they were not sent, so that whatever the tier of an observer
+    // was, it never misses a change.
+    InterestTier maxTier = INTEREST_TIER_FAR;
+    uint32 const now = WorldTimer::getMSTime();
+    if (sWorld.getConfig(CONFIG_UINT32_VISIBILITY_TIERS_CROWD))
+    {
+        if (WorldTimer::getMSTimeDiff(m_lastFarTierUpdate, now) < sWorld.getConfig(CONFIG_UINT32_VISIBILITY_TIERS_FAR_INTERVAL))
+        {
+            if (WorldTimer::getMSTimeDiff(m_lastMidTierUpdate, now) < sWorld.getConfig(CONFIG_UINT32_VISIBILITY_TIERS_MID_INTERVAL))
+                maxTier = INTEREST_TIER_NEAR;
+            else
+                maxTier = INTEREST_TIER_MID;
+        }
+
+        // only kept in the update list for the next turn of the deferred observers
+        if (maxTier == INTEREST_TIER_NEAR && m_hasDeferredUpdate && !HasChangedValues())
+            return;
+    }
+
+    WorldObjectChangeAccumulator notifier(*this, update_players, maxTier);
     // Update with modifier for long range players
     Cell::VisitWorldObjects(this, notifier, std::max(GetMap()->GetVisibilityDistance(), GetVisibilityModifier()));
 
+    if (maxTier >= INTEREST_TIER_MID)
+        m_lastMidTierUpdate = now;
+    if (maxTier == INTEREST_TIER_FAR)
+    {
+        m_lastFarTierUpdate = now;
+        m_hasDeferredUpdate = false;
+    }
+    else if (notifier.i_deferred)
+        DeferChangedValues();
+
     ClearUpdateMask(false);
+
+    // stays in the update list of the map until every observer got the changes
+    if (m_hasDeferredUpdate)
+        m_objectUpdated = true;
+}
+
+// Called from the Map::SendObjectUpdates workers. The map thread waits for them, and the viewer's
+// visible list and selection only change on the map thread (visibility updates, spell packets), so
+// reading them without lock is safe here, as IsInVisibleList_Unsafe is.
+InterestTier WorldObject::GetInterestTier(Player const* viewer, WorldObject const* viewpoint) const
+{
+    uint32 const crowd = sWorld.getConfig(CONFIG_UINT32_VISIBILITY_TIERS_CROWD);
+    if (!crowd || viewer->GetVisibleObjectsCount() < crowd)
+        return INTEREST_TIER_NEAR;
+
+    // target frame, pets and charms are always shown accurately
+    if (viewer->GetSelectionGuid() == GetObjectGuid())
+        return INTEREST_TIER_NEAR;
+    if (isType(TYPEMASK_UNIT) && static_cast<Unit const*>(this)->GetCharmerOrOwnerGuid() == viewer->GetObjectGuid())
+        return INTEREST_TIER_NEAR;
+
+    float const distSq = viewpoint->GetDistanceSqr(GetPositionX(), GetPositionY(), GetPositionZ());
+    float const nearDist = sWorld.getConfig(CONFIG_FLOAT_VISIBILITY_TIERS_NEAR_DISTANCE);
+    if (distSq <= nearDist * nearDist)
+        return INTEREST_TIER_NEAR;
+    float const midDist = sWorld.getConfig(CONFIG_FLOAT_VISIBILITY_TIERS_MID_DISTANCE);
+    if (distSq <= midDist * midDist)
+        return INTEREST_TIER_MID;
+    return INTEREST_TIER_FAR;
 }
 
 bool WorldObject::IsControlledByPlayer() const
@@ -3187,7 +3407,7 @@ void WorldObject::Update(uint32 update_diff, uint32 /*time_diff*/)
 class NULLNotifier
 {
 public:
-    template<class T> void Visit(GridRefManager<T>& m) {}
+    template<class T> void Visit(GridObjectList<T>& m) {}
     void Visit(CameraMapType&) {}
 };
 
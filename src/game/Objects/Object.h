@@ -33,6 +33,8 @@
 #include "Util.h"
 #include "Timer.h"
 #include "Camera.h"
+#include "UpdateMask.h"
+#include "InterestTier.h"
 
 #include <string>
 
@@ -51,6 +53,11 @@ class InstanceData;
 class TerrainInfo;
 class ZoneScript;
 class Transport;
+
+namespace VMAP
+{
+    struct LineOfSightQuery;
+}
 struct FactionTemplateEntry;
 
 typedef std::unordered_map<Player*, UpdateData> UpdateDataMapType;
@@ -300,6 +307,10 @@ class Object
         void BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* updateMask, Player* target) const;
         void BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players);
 
+        // Values update serialized once for every player but the object itself, then patched per receiver
+        void BuildSharedValuesUpdateBlock(SharedUpdateBlock& shared) const;
+        void BuildSharedValuesUpdateBlockForPlayer(UpdateData* data, SharedUpdateBlock const& shared, Player* target) const;
+
         void SendOutOfRangeUpdateToPlayer(Player* player);
 
         virtual void DestroyForPlayer(Player* target) const;
@@ -481,6 +492,8 @@ class Object
         }
 
         void ClearUpdateMask(bool remove);
+        // some observers still have to receive changes already sent to the others
+        bool HasDeferredUpdate() const { return m_hasDeferredUpdate; }
 
         bool LoadValues(char const* data);
 
@@ -538,6 +551,16 @@ class Object
 
         virtual void _SetCreateBits(UpdateMask* updateMask, Player* target) const;
 
+        bool HasChangedValues() const;
+        // keeps the changed fields for the observers skipped by this update
+        void DeferChangedValues();
+
+        // Value of an update field as seen by `target`. `target` may be null
+        // for the fields that IsTargetDependentUpdateField() does not report.
+        uint32 GetUnitUpdateFieldValue(uint16 index, Player* target) const;
+        uint32 GetCorpseUpdateFieldValue(uint16 index, Player* target) const;
+        bool IsTargetDependentUpdateField(uint16 index) const;
+
         uint16 m_objectType;
 
         uint8 m_objectTypeId;
@@ -558,6 +581,10 @@ class Object
         bool _deleted;          // Object in remove list
         uint32 _delayedActions;
 
+        // fields changed since the last update sent to every observer, see WorldObject::BuildUpdateData
+        UpdateMask m_deferredUpdateMask;
+        bool m_hasDeferredUpdate;
+
     private:
         bool m_inWorld;
         bool m_isNewObject;
@@ -616,13 +643,28 @@ class WorldObject : public Object
 
         void SetOrientation(float orientation);
 
-        void SetRawPosition(Position&& pos) { m_position = std::move(pos); }
+        void SetRawPosition(Position&& pos) { m_position = std::move(pos); UpdateGridPosition(); }
         Position const& GetPosition() const { return m_position; }
         float GetPositionX() const { return m_position.x; }
         float GetPositionY() const { return m_position.y; }
         float GetPositionZ() const { return m_position.z; }
         virtual void GetSafePosition(float &x, float &y, float &z, Transport* onTransport = nullptr) const { GetPosition(x, y, z, onTransport); }
         void GetPosition(float &x, float &y, float &z, Transport* onTransport = nullptr) const;
+
+        GridObjectHandle& GetGridRef() { return m_gridRef; }
+        bool GetGridPosition(float& x, float& y, float& radius) const
+        {
+            x = GetPositionX();
+            y = GetPositionY();
+            radius = GetObjectBoundingRadius();
+            return true;
+        }
+        // the list of the grid cell keeps a copy of the position and bounding radius
+        void UpdateGridPosition()
+        {
+            if (m_gridRef.isValid())
+                m_gridRef.SetPosition(GetPositionX(), GetPositionY(), GetObjectBoundingRadius());
+        }
         void GetPosition(WorldLocation &loc) const { loc.mapId = m_mapId; GetPosition(loc.x, loc.y, loc.z); loc.o = GetOrientation(); }
         float GetOrientation() const { return m_position.o; }
         void GetNearPoint2D(float &x, float &y, float distance, float absAngle) const
@@ -725,6 +767,10 @@ class WorldObject : public Object
         }
         bool IsWithinLOSAtPosition(float ownX, float ownY, float ownZ, float targetX, float targetY, float targetZ, bool checkDynLos = true, float targetHeight = 2.f) const;
         bool IsWithinLOSInMap(WorldObject const* obj, bool checkDynLos = true) const;
+        // sources[i]->IsWithinLOSInMap(targets[i]) for every i, the rays of a same map are cast together
+        static void IsWithinLOSInMap(WorldObject const* const* sources, WorldObject const* const* targets, uint32 count, bool* results, bool checkDynLos = true);
+        // Ray checked by IsWithinLOSInMap(obj), returns false if there is nothing to cast and `result` is the answer
+        bool GetLineOfSightQuery(WorldObject const* obj, VMAP::LineOfSightQuery& ray, bool& result) const;
         bool GetDistanceOrder(WorldObject const* obj1, WorldObject const* obj2, bool is3D = true) const;
         bool IsInRange(WorldObject const* obj, float minRange, float maxRange, bool is3D = true) const;
         bool IsInRange2d(float x, float y, float minRange, float maxRange) const;
@@ -834,6 +880,8 @@ class WorldObject : public Object
 
         // main visibility check function in normal case (ignore grey zone distance check)
         bool isWithinVisibilityDistanceOf(Unit const* viewer, WorldObject const* viewpoint, bool inVisibleList = false) const;
+        // how often `viewer`, looking from `viewpoint`, needs the changes of this object
+        InterestTier GetInterestTier(Player const* viewer, WorldObject const* viewpoint) const;
         bool isVisibleFor(Player const* u, WorldObject const* viewPoint) const;
 
         // low level function for visibility change code, must be define in all main world object subclasses
@@ -919,12 +967,16 @@ class WorldObject : public Object
         uint32 m_InstanceId;                                // in map copy with instance id
 
         Position m_position;
+        GridObjectHandle m_gridRef;
 
         ViewPoint m_viewPoint;
 
         WorldUpdateCounter m_updateTracker;
 
         uint32 m_summonLimitAlert;                          // Timer to alert GMs if a creature is at the summon limit
+
+        uint32 m_lastMidTierUpdate;                         // last values update sent to the mid range observers
+        uint32 m_lastFarTierUpdate;                         // last values update sent to every observer
 };
 
 inline WorldObject* Object::ToWorldObject()
@@ -76,9 +76,12 @@
 #include "MovementBroadcaster.h"
 #include "PlayerBroadcaster.h"
 #include "GameEventMgr.h"
+#include "TickProfiler.h"
 #include "world/world_event_naxxramas.h"
 #include "world/world_event_wareffort.h"
 
+#include <iomanip>
+
 #define ZONE_UPDATE_INTERVAL (1*IN_MILLISECONDS)
 
 #define PLAYER_SKILL_INDEX(x)       (PLAYER_SKILL_INFO_1_1 + ((x)*3))
@@ -89,6 +92,80 @@
 #define SKILL_MAX(x)           PAIR32_HIPART(x)
 #define MAKE_SKILL_VALUE(v, m) MAKE_PAIR32(v,m)
 
+namespace
+{
+    // Columns bound by Player::SaveToDB, in order
+    char const* const CharacterSaveColumns[] =
+    {
+        "guid", "account", "name", "race", "class", "gender", "level", "xp", "money", "playerBytes", "playerBytes2", "playerFlags",
+        "map", "position_x", "position_y", "position_z", "orientation",
+        "taximask", "online", "cinematic",
+        "totaltime", "leveltime", "rest_bonus", "logout_time", "is_logout_resting", "resettalents_multiplier", "resettalents_time",
+        "trans_x", "trans_y", "trans_z", "trans_o", "transguid", "extra_flags", "stable_slots", "at_login", "zone",
+        "death_expire_time", "taxi_path",
+        "honorRankPoints", "honorHighestRank", "honorStanding", "honorLastWeekHK", "honorLastWeekCP", "honorStoredHK", "honorStoredDK",
+        "watchedFaction", "drunk", "health", "power1", "power2", "power3",
+        "power4", "power5", "exploredZones", "equipmentCache", "ammoId", "actionBars",
+        "area", "world_phase_mask"
+    };
+
+    std::string MakeCharacterReplaceSql()
+    {
+        std::ostringstream columns;
+        std::ostringstream values;
+        for (uint32 i = 0; i < countof(CharacterSaveColumns); ++i)
+        {
+            columns << (i ? ", `" : "`") << CharacterSaveColumns[i] << '`';
+            values << (i ? ", ?" : "?");
+        }
+        return "REPLACE INTO `characters` (" + columns.str() + ") VALUES (" + values.str() + ")";
+    }
+
+    uint32 GetCharacterSaveColumn(char const* name)
+    {
+        for (uint32 i = 0; i < countof(CharacterSaveColumns); ++i)
+            if (!strcmp(CharacterSaveColumns[i], name))
+                return i;
+
+        MANGOS_ASSERT(false);
+        return 0;
+    }
+
+    // Bound value as a SQL literal
+    void AppendSqlValue(std::ostringstream& ss, SqlStmtFieldData const& data)
+    {
+        switch (data.type())
+        {
+            case FIELD_BOOL:   ss << uint32(data.toBool()); break;
+            case FIELD_UI8:    ss << uint32(data.toUint8()); break;
+            case FIELD_I8:     ss << int32(data.toInt8()); break;
+            case FIELD_UI16:   ss << data.toUint16(); break;
+            case FIELD_I16:    ss << data.toInt16(); break;
+            case FIELD_UI32:   ss << data.toUint32(); break;
+            case FIELD_I32:    ss << data.toInt32(); break;
+            case FIELD_UI64:   ss << data.toUint64(); break;
+            case FIELD_I64:    ss << data.toInt64(); break;
+            case FIELD_FLOAT:  ss << std::setprecision(9) << data.toFloat(); break;
+            case FIELD_DOUBLE: ss << std::setprecision(17) << data.toDouble(); break;
+            case FIELD_STRING:
+            {
+                std::string str = data.toStr();
+                CharacterDatabase.escape_string(str);
+                ss << '\'' << str << '\'';
+                break;
+            }
+            default:
+                ss << "NULL";
+                break;
+        }
+    }
+
+    bool SameRow(SqlStatement const& stmt, std::vector<SqlStmtFieldData> const& saved)
+    {
+        return stmt.params() && stmt.params()->params() == saved;
+    }
+}
+
 #define SKILL_TEMP_BONUS(x)    int16(PAIR32_LOPART(x))
 #define SKILL_PERM_BONUS(x)    int16(PAIR32_HIPART(x))
 #define MAKE_SKILL_BONUS(t, p) MAKE_PAIR32(t,p)
@@ -460,6 +537,7 @@ Player::Player(WorldSession* session) : Unit(),
     // randomize first save time in range [CONFIG_UINT32_INTERVAL_SAVE] around [CONFIG_UINT32_INTERVAL_SAVE]
     // this must help in case next save after mass player load after server startup
     m_nextSave = urand(m_nextSave / 2, m_nextSave * 3 / 2);
+    m_savesSinceFullSave = 0;
 
     ClearResurrectRequestData();
 
@@ -1253,7 +1331,10 @@ void Player::Update(uint32 update_diff, uint32 p_time)
     SetCanDelayTeleport(true);
     Unit::Update(update_diff, p_time);
     if (i_AI)
+    {
+        TICK_PROFILE_SCOPE("PlayerAI::UpdateAI");
         i_AI->UpdateAI(p_time);
+    }
     SetCanDelayTeleport(false);
 
     time_t now = time(nullptr);
@@ -1527,6 +1608,7 @@ void Player::RelocateToLastClientPosition()
         m_position.y = y;
         m_position.z = z;
         m_position.o = o;
+        UpdateGridPosition();
     }
 }
 
@@ -2845,6 +2927,7 @@ void Player::SetGMVisible(bool on, bool notify)
     }
     // Sauvegarde directement pour que le site n'affiche plus le MJ parmis les joueurs co.
     CharacterDatabase.PExecute("UPDATE characters SET extra_flags = %u WHERE guid = %u", m_ExtraFlags, GetGUIDLow());
+    _SetSavedCharacterColumn("extra_flags", m_ExtraFlags);
 }
 
 void Player::SetCheatGod(bool on, bool notify)
@@ -4011,16 +4094,23 @@ void Player::_LoadSpellCooldowns(QueryResult* result)
     }
 }
 
-void Player::_SaveSpellCooldowns()
+void Player::_SaveSpellCooldowns(bool fullSave)
 {
+    static SqlStatementID deleteSpellCooldowns;
     static SqlStatementID deleteSpellCooldown;
 
     // delete all old cooldown
-    SqlStatement stmt = CharacterDatabase.CreateStatement(deleteSpellCooldown, "DELETE FROM character_spell_cooldown WHERE guid = ?");
-    stmt.PExecute(GetGUIDLow());
+    SqlStatement stmt = CharacterDatabase.CreateStatement(deleteSpellCooldowns, "DELETE FROM character_spell_cooldown WHERE guid = ?");
+    if (fullSave)
+    {
+        stmt.PExecute(GetGUIDLow());
+        m_savedCooldowns.clear();
+    }
 
     static SqlStatementID insertSpellCooldown;
 
+    // expire times are absolute, a cooldown already saved normally needs no write
+    std::map<uint32, SavedRow> savedCooldowns;
     for (auto& cdItr : m_cooldownMap)
     {
         auto& cdData = cdItr.second;
@@ -4033,16 +4123,37 @@ void Player::_SaveSpellCooldowns()
             uint64 spellExpireTime = uint64(Clock::to_time_t(sTime));
             uint64 catExpireTime = uint64(Clock::to_time_t(cTime));
 
-            stmt = CharacterDatabase.CreateStatement(insertSpellCooldown, "INSERT INTO `character_spell_cooldown` (`guid`, `SpellId`, `SpellExpireTime`, `Category`, `CategoryExpireTime`, `ItemId`) VALUES( ?, ?, ?, ?, ?, ?)");
+            stmt = CharacterDatabase.CreateStatement(insertSpellCooldown, "INSERT INTO `character_spell_cooldown` (`guid`, `SpellId`, `SpellExpireTime`, `Category`, `CategoryExpireTime`, `ItemId`) VALUES( ?, ?, ?, ?, ?, ?) "
+                "ON DUPLICATE KEY UPDATE `SpellExpireTime` = VALUES(`SpellExpireTime`), `Category` = VALUES(`Category`), `CategoryExpireTime` = VALUES(`CategoryExpireTime`), `ItemId` = VALUES(`ItemId`)");
             stmt.addUInt32(GetGUIDLow());
             stmt.addUInt32(cdData->GetSpellId());
             stmt.addUInt64(spellExpireTime);
             stmt.addUInt32(cdData->GetCategory());
             stmt.addUInt64(catExpireTime);
             stmt.addUInt32(cdData->GetItemId());
+
+            auto saved = m_savedCooldowns.find(cdData->GetSpellId());
+            if (saved != m_savedCooldowns.end() && SameRow(stmt, saved->second))
+            {
+                savedCooldowns[cdData->GetSpellId()].swap(saved->second);
+                continue;
+            }
+
+            savedCooldowns[cdData->GetSpellId()] = stmt.params()->params();
             stmt.Execute();
         }
     }
+
+    for (auto const& saved : m_savedCooldowns)
+    {
+        if (savedCooldowns.find(saved.first) != savedCooldowns.end())
+            continue;
+
+        stmt = CharacterDatabase.CreateStatement(deleteSpellCooldown, "DELETE FROM character_spell_cooldown WHERE guid = ? AND SpellId = ?");
+        stmt.PExecute(GetGUIDLow(), saved.first);
+    }
+
+    m_savedCooldowns.swap(savedCooldowns);
 }
 
 void Player::UpdateResetTalentsMultiplier() const
@@ -4493,6 +4604,7 @@ void Player::DeleteFromDB(ObjectGuid playerguid, uint32 accountId, bool updateRe
     // remove signs from petitions (also remove petitions if owner);
     RemovePetitionsAndSigns(playerguid);
     sObjectMgr.DeletePlayerFromCache(lowguid);
+    WorldSession::ForgetPrefetchedLogin(playerguid);
 
     switch (charDelete_method)
     {
@@ -16240,32 +16352,21 @@ void Player::SaveToDB(bool online, bool force)
     //DEBUG_FILTER_LOG(LOG_FILTER_PLAYER_STATS, "The value of player %s at save: ", m_name.c_str());
     //outDebugStatsValues();
 
+    // The first save after login, the logout save and every Nth save rewrite everything,
+    // so that a lost transaction never leaves the character partially saved for long
+    bool const fullSave = m_savedCharacter.empty() || m_session->isLogingOut() ||
+                          ++m_savesSinceFullSave >= sWorld.getConfig(CONFIG_UINT32_PLAYER_FULL_SAVE_EVERY);
+    if (fullSave)
+        m_savesSinceFullSave = 0;
+
     CharacterDatabase.BeginTransaction(GetGUIDLow());
 
     m_honorMgr.Update();
 
     static SqlStatementID insChar;
+    static std::string const insCharSql = MakeCharacterReplaceSql();
 
-    SqlStatement uberInsert = CharacterDatabase.CreateStatement(insChar, "REPLACE INTO `characters` (`guid`, `account`, `name`, `race`, `class`, `gender`, `level`, `xp`, `money`, `playerBytes`, `playerBytes2`, `playerFlags`,"
-                              "`map`, `position_x`, `position_y`, `position_z`, `orientation`, "
-                              "`taximask`, `online`, `cinematic`, "
-                              "`totaltime`, `leveltime`, `rest_bonus`, `logout_time`, `is_logout_resting`, `resettalents_multiplier`, `resettalents_time`, "
-                              "`trans_x`, `trans_y`, `trans_z`, `trans_o`, `transguid`, `extra_flags`, `stable_slots`, `at_login`, `zone`, "
-                              "`death_expire_time`, `taxi_path`, "
-                              "`honorRankPoints`, `honorHighestRank`, `honorStanding`, `honorLastWeekHK`, `honorLastWeekCP`, `honorStoredHK`, `honorStoredDK`, "
-                              "`watchedFaction`, `drunk`, `health`, `power1`, `power2`, `power3`, "
-                              "`power4`, `power5`, `exploredZones`, `equipmentCache`, `ammoId`, `actionBars`, "
-                              "`area`, `world_phase_mask`) "
-                              "VALUES ( ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?,"
-                              "?, ?, ?, ?, ?, "
-                              "?, ?, ?, "
-                              "?, ?, ?, ?, ?, ?, ?, "
-                              "?, ?, ?, ?, ?, ?, ?, ?, ?, "
-                              "?, ?, "
-                              "?, ?, ?, ?, ?, ?, ?, "
-                              "?, ?, ?, ?, ?, ?, "
-                              "?, ?, ?, ?, ?, ?, "
-                              "?, ?) ");
+    SqlStatement uberInsert = CharacterDatabase.CreateStatement(insChar, insCharSql.c_str());
 
     uberInsert.addUInt32(GetGUIDLow());
     uberInsert.addUInt32(GetSession()->GetAccountId());
@@ -16394,14 +16495,14 @@ void Player::SaveToDB(bool online, bool force)
     // Nostalrius
     uberInsert.addUInt32(GetAreaId());
     uberInsert.addUInt32(GetWorldMask());
-    uberInsert.Execute();
+    _SaveCharacter(uberInsert, fullSave);
 
     _SaveBGData();
     _SaveInventory();
     _SaveQuestStatus();
     _SaveSpells();
-    _SaveSpellCooldowns();
-    _SaveAuras();
+    _SaveSpellCooldowns(fullSave);
+    _SaveAuras(fullSave);
     _SaveSkills();
     m_reputationMgr.SaveToDB();
     m_honorMgr.Save();
@@ -16410,12 +16511,16 @@ void Player::SaveToDB(bool online, bool force)
     sObjectMgr.SetPlayerWorldMask(GetGUIDLow(), GetWorldMask());
     GetSession()->SaveTutorialsData();                      // changed only while character in game
 
+    uint32 statements, bytes;
+    if (CharacterDatabase.GetTransactionSize(statements, bytes))
+        sWorld.AddCharacterSave(GetGUIDLow(), fullSave, statements, bytes);
+
     CharacterDatabase.CommitTransaction();
 
     // check if stats should only be saved on logout
     // save stats can be out of transaction
     if (m_session->isLogingOut() || !sWorld.getConfig(CONFIG_BOOL_STATS_SAVE_ONLY_ON_LOGOUT))
-        _SaveStats();
+        _SaveStats(fullSave);
 
     // save pet (hunter pet level and experience and all type pets health/mana).
     if (Pet* pet = GetPet())
@@ -16453,33 +16558,84 @@ void Player::SaveGoldToDB()
 
     SqlStatement stmt = CharacterDatabase.CreateStatement(updateGold, "UPDATE `characters` SET `money` = ? WHERE `guid` = ?");
     stmt.PExecute(GetMoney(), GetGUIDLow());
+    _SetSavedCharacterColumn("money", GetMoney());
 }
 
-void Player::_SaveAuras()
+void Player::_SaveCharacter(SqlStatement& row, bool fullSave)
 {
-    static SqlStatementID deleteAuras ;
-    static SqlStatementID insertAuras ;
+    SavedRow const& values = row.params()->params();
+    MANGOS_ASSERT(values.size() == countof(CharacterSaveColumns));
 
-    SqlStatement stmt = CharacterDatabase.CreateStatement(deleteAuras, "DELETE FROM `character_aura` WHERE `guid` = ?");
-    stmt.PExecute(GetGUIDLow());
+    if (fullSave || m_savedCharacter.size() != values.size())
+    {
+        m_savedCharacter = values;
+        row.Execute();
+        return;
+    }
 
-    SpellAuraHolderMap const& auraHolders = GetSpellAuraHolderMap();
+    // Only the columns that changed since the previous save
+    std::ostringstream ss;
+    bool changed = false;
+    for (uint32 i = 0; i < values.size(); ++i)
+    {
+        if (values[i] == m_savedCharacter[i])
+            continue;
 
-    if (auraHolders.empty())
+        ss << (changed ? ", `" : "UPDATE `characters` SET `") << CharacterSaveColumns[i] << "` = ";
+        AppendSqlValue(ss, values[i]);
+        changed = true;
+    }
+
+    if (!changed)
         return;
 
-    stmt = CharacterDatabase.CreateStatement(insertAuras, "INSERT INTO `character_aura` (`guid`, `caster_guid`, `item_guid`, `spell`, `stackcount`, `remaincharges`, "
-            "`basepoints0`, `basepoints1`, `basepoints2`, `periodictime0`, `periodictime1`, `periodictime2`, `maxduration`, `remaintime`, `effIndexMask`) "
-            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    ss << " WHERE `guid` = " << GetGUIDLow();
+    CharacterDatabase.Execute(ss.str().c_str());
+    m_savedCharacter = values;
+}
+
+// For the columns also written outside of SaveToDB: the next save compares against what is now in the database
+void Player::_SetSavedCharacterColumn(char const* column, SqlStmtFieldData const& value)
+{
+    if (!m_savedCharacter.empty())
+        m_savedCharacter[GetCharacterSaveColumn(column)] = value;
+}
+
+void Player::_SaveAuras(bool fullSave)
+{
+    static SqlStatementID deleteAuras ;
+    static SqlStatementID deleteAura ;
+    static SqlStatementID insertAuras ;
+
+    SqlStatement stmt = CharacterDatabase.CreateStatement(deleteAuras, "DELETE FROM `character_aura` WHERE `guid` = ?");
+    if (fullSave)
+    {
+        stmt.PExecute(GetGUIDLow());
+        m_savedAuras.clear();
+    }
 
+    // Rows are inserted when new, updated when changed and left alone otherwise
+    std::map<SavedAuraKey, SavedRow> savedAuras;
     AuraSaveStruct s;
-    for (const auto& auraHolder : auraHolders)
+    for (const auto& auraHolder : GetSpellAuraHolderMap())
     {
         SpellAuraHolder* holder = auraHolder.second;
 
         if (!SaveAura(holder, s))
             continue;
 
+        SavedAuraKey const key(s.caster_guid.GetRawValue(), s.item_lowguid, s.spellid);
+        if (savedAuras.find(key) != savedAuras.end())
+            continue;                                       // primary key, only one row per caster, item and spell
+
+        stmt = CharacterDatabase.CreateStatement(insertAuras, "INSERT INTO `character_aura` (`guid`, `caster_guid`, `item_guid`, `spell`, `stackcount`, `remaincharges`, "
+                "`basepoints0`, `basepoints1`, `basepoints2`, `periodictime0`, `periodictime1`, `periodictime2`, `maxduration`, `remaintime`, `effIndexMask`) "
+                "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?) "
+                "ON DUPLICATE KEY UPDATE `stackcount` = VALUES(`stackcount`), `remaincharges` = VALUES(`remaincharges`), "
+                "`basepoints0` = VALUES(`basepoints0`), `basepoints1` = VALUES(`basepoints1`), `basepoints2` = VALUES(`basepoints2`), "
+                "`periodictime0` = VALUES(`periodictime0`), `periodictime1` = VALUES(`periodictime1`), `periodictime2` = VALUES(`periodictime2`), "
+                "`maxduration` = VALUES(`maxduration`), `remaintime` = VALUES(`remaintime`), `effIndexMask` = VALUES(`effIndexMask`)");
+
         stmt.addUInt32(GetGUIDLow());
         stmt.addUInt64(s.caster_guid.GetRawValue());
         stmt.addUInt32(s.item_lowguid);
@@ -16496,8 +16652,33 @@ void Player::_SaveAuras()
         stmt.addInt32(s.maxduration);
         stmt.addInt32(s.remaintime);
         stmt.addUInt32(s.effIndexMask);
+
+        auto saved = m_savedAuras.find(key);
+        if (saved != m_savedAuras.end() && SameRow(stmt, saved->second))
+        {
+            savedAuras[key].swap(saved->second);
+            continue;
+        }
+
+        savedAuras[key] = stmt.params()->params();
+        stmt.Execute();
+    }
+
+    // What is left was saved before and is gone now
+    for (auto const& saved : m_savedAuras)
+    {
+        if (savedAuras.find(saved.first) != savedAuras.end())
+            continue;
+
+        stmt = CharacterDatabase.CreateStatement(deleteAura, "DELETE FROM `character_aura` WHERE `guid` = ? AND `caster_guid` = ? AND `item_guid` = ? AND `spell` = ?");
+        stmt.addUInt32(GetGUIDLow());
+        stmt.addUInt64(std::get<0>(saved.first));
+        stmt.addUInt32(std::get<1>(saved.first));
+        stmt.addUInt32(std::get<2>(saved.first));
         stmt.Execute();
     }
+
+    m_savedAuras.swap(savedAuras);
 }
 
 bool Player::SaveAura(SpellAuraHolder* holder, AuraSaveStruct& saveStruct)
@@ -16822,7 +17003,7 @@ void Player::_SaveSpells()
 
 // save player stats -- only for external usage
 // real stats will be recalculated on player login
-void Player::_SaveStats()
+void Player::_SaveStats(bool fullSave)
 {
     // check if stat saving is enabled and if char level is high enough
     if (!sWorld.getConfig(CONFIG_UINT32_MIN_LEVEL_STAT_SAVE) || GetLevel() < sWorld.getConfig(CONFIG_UINT32_MIN_LEVEL_STAT_SAVE))
@@ -16831,10 +17012,7 @@ void Player::_SaveStats()
     static SqlStatementID delStats ;
     static SqlStatementID insertStats ;
 
-    SqlStatement stmt = CharacterDatabase.CreateStatement(delStats, "DELETE FROM `character_stats` WHERE `guid` = ?");
-    stmt.PExecute(GetGUIDLow());
-
-    stmt = CharacterDatabase.CreateStatement(insertStats, "INSERT INTO `character_stats` (`guid`, `maxhealth`, `maxpower1`, `maxpower2`, `maxpower3`, `maxpower4`, `maxpower5`, "
+    SqlStatement stmt = CharacterDatabase.CreateStatement(insertStats, "INSERT INTO `character_stats` (`guid`, `maxhealth`, `maxpower1`, `maxpower2`, `maxpower3`, `maxpower4`, `maxpower5`, "
             "`strength`, `agility`, `stamina`, `intellect`, `spirit`, `armor`, `resHoly`, `resFire`, `resNature`, `resFrost`, `resShadow`, `resArcane`, "
             "`blockPct`, `dodgePct`, `parryPct`, `critPct`, `rangedCritPct`, `attackPower`, `rangedAttackPower`) "
             "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
@@ -16856,6 +17034,14 @@ void Player::_SaveStats()
     stmt.addUInt32(GetUInt32Value(UNIT_FIELD_ATTACK_POWER));
     stmt.addUInt32(GetUInt32Value(UNIT_FIELD_RANGED_ATTACK_POWER));
 
+    if (!fullSave && SameRow(stmt, m_savedStats))
+        return;
+
+    m_savedStats = stmt.params()->params();
+
+    SqlStatement delStmt = CharacterDatabase.CreateStatement(delStats, "DELETE FROM `character_stats` WHERE `guid` = ?");
+    delStmt.PExecute(GetGUIDLow());
+
     stmt.Execute();
 }
 
@@ -18525,6 +18711,11 @@ void Player::UpdateVisibilityOf(WorldObject const* viewPoint, WorldObject* targe
 
             DEBUG_FILTER_LOG(LOG_FILTER_VISIBILITY_CHANGES, "%s out of range for player %u. Distance = %f", t_guid.GetString().c_str(), GetGUIDLow(), GetDistance(target));
         }
+        else if (Player* plTarget = target->ToPlayer())
+        {
+            if (plTarget->m_broadcaster && sWorld.getConfig(CONFIG_UINT32_VISIBILITY_TIERS_CROWD))
+                plTarget->m_broadcaster->SetListenerTier(this, plTarget->GetInterestTier(this, viewPoint));
+        }
     }
     else
     {
@@ -18588,6 +18779,17 @@ void RemoveBroadcastListener(Player* target, Player* me)
         target->m_broadcaster->RemoveListener(me);
 }
 
+template<class T>
+void UpdateBroadcastListenerTier(T* target, Player* me, WorldObject const* viewPoint)
+{
+}
+template<>
+void UpdateBroadcastListenerTier(Player* target, Player* me, WorldObject const* viewPoint)
+{
+    if (target->m_broadcaster && sWorld.getConfig(CONFIG_UINT32_VISIBILITY_TIERS_CROWD))
+        target->m_broadcaster->SetListenerTier(me, target->GetInterestTier(me, viewPoint));
+}
+
 template<class T>
 void Player::UpdateVisibilityOf(WorldObject const* viewPoint, T* target, UpdateData& data, std::set<WorldObject*>& visibleNow)
 {
@@ -18610,6 +18812,8 @@ void Player::UpdateVisibilityOf(WorldObject const* viewPoint, T* target, UpdateD
             RemoveBroadcastListener(target, this);
             DEBUG_FILTER_LOG(LOG_FILTER_VISIBILITY_CHANGES, "%s is out of range for %s. Distance = %f", t_guid.GetString().c_str(), GetGuidStr().c_str(), GetDistance(target));
         }
+        else
+            UpdateBroadcastListenerTier(target, this, viewPoint);
     }
     else
     {
@@ -20541,7 +20745,11 @@ void Player::RemoveAtLoginFlag(AtLoginFlags f, bool in_db_also /*= false*/)
     m_atLoginFlags &= ~f;
 
     if (in_db_also)
+    {
         CharacterDatabase.PExecute("UPDATE `characters` SET `at_login` = `at_login` & ~ %u WHERE `guid` ='%u'", uint32(f), GetGUIDLow());
+        if (!m_savedCharacter.empty())
+            _SetSavedCharacterColumn("at_login", m_savedCharacter[GetCharacterSaveColumn("at_login")].toUint32() & ~uint32(f));
+    }
 }
 
 void Player::SendClearCooldown(uint32 spell_id, Unit* target) const
@@ -21285,15 +21493,16 @@ void Player::InterruptSpellsWithCastItem(Item* item)
             }
 
     // Interrupt eventually delayed spells
-    auto i_Events = m_Events.GetEvents().begin();
-    for (; i_Events != m_Events.GetEvents().end(); ++i_Events)
-        if (SpellEvent* event = dynamic_cast<SpellEvent*>(i_Events->second))
-            if (event && event->GetSpell()->m_CastItem == item)
+    m_Events.ForEachEvent([item](BasicEvent* basicEvent)
+    {
+        if (SpellEvent* event = dynamic_cast<SpellEvent*>(basicEvent))
+            if (event->GetSpell()->m_CastItem == item)
             {
                 event->GetSpell()->ClearCastItem();
                 if (event->GetSpell()->getState() != SPELL_STATE_FINISHED)
                     event->GetSpell()->cancel();
             }
+    });
 }
 
 std::string Player::GetShortDescription() const
@@ -39,6 +39,7 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <tuple>
 
 struct Mail;
 struct ItemPrototype;
@@ -1331,17 +1332,29 @@ class Player final: public Unit
         /*********************************************************/
         
     private:
-        void _SaveAuras();
+        void _SaveCharacter(SqlStatement& row, bool fullSave);
+        void _SetSavedCharacterColumn(char const* column, SqlStmtFieldData const& value);
+        void _SaveAuras(bool fullSave);
         void _SaveInventory();
         void _SaveQuestStatus();
         void _SaveSkills();
         void _SaveSpells();
         void _SaveBGData();
-        void _SaveStats();
+        void _SaveStats(bool fullSave);
 
         void _SetCreateBits(UpdateMask* updateMask, Player* target) const override;
         void _SetUpdateBits(UpdateMask* updateMask, Player* target) const override;
         uint32 m_nextSave;
+
+        // Values bound by the previous save, the next one only writes what differs.
+        // Inventory, quests, spells, skills and reputation keep their own per-row states.
+        typedef std::vector<SqlStmtFieldData> SavedRow;
+        typedef std::tuple<uint64 /*caster*/, uint32 /*item*/, uint32 /*spell*/> SavedAuraKey;
+        SavedRow m_savedCharacter;
+        std::map<SavedAuraKey, SavedRow> m_savedAuras;
+        std::map<uint32 /*spell*/, SavedRow> m_savedCooldowns;
+        SavedRow m_savedStats;
+        uint32 m_savesSinceFullSave;
     public:
         void SaveToDB(bool online = true, bool force = false);
         void SaveInventoryAndGoldToDB();                    // fast save function for item/money cheating preventing
@@ -1451,7 +1464,7 @@ class Player final: public Unit
         void SendClearAllCooldowns(Unit* target) const;
         void SendSpellCooldown(uint32 spellId, uint32 cooldown, ObjectGuid target) const;
         void _LoadSpellCooldowns(QueryResult* result);
-        void _SaveSpellCooldowns();
+        void _SaveSpellCooldowns(bool fullSave);
 
         template <typename F>
         void RemoveSomeCooldown(F check)
@@ -1711,7 +1724,6 @@ class Player final: public Unit
         bool IsAllowedToMove(Unit* unit) const;
 
         Unit* m_mover;
-        GridReference<Player> m_gridRef;
         MapReference m_mapRef;
 
         uint32 m_lastFallTime;
@@ -1783,7 +1795,6 @@ class Player final: public Unit
         uint32 GetCachedZoneId() const { return m_zoneUpdateId; }
         uint32 GetCachedAreaId() const { return m_areaUpdateId; }
 
-        GridReference<Player>& GetGridRef() { return m_gridRef; }
         MapReference &GetMapRef() { return m_mapRef; }
 
         bool SetPosition(float x, float y, float z, float orientation, bool teleport = false);
@@ -1842,6 +1853,8 @@ class Player final: public Unit
 
         bool IsInVisibleList(WorldObject const* u) const;
         bool IsInVisibleList_Unsafe(WorldObject const* u) const { return this == u || m_visibleGUIDs.find(u->GetObjectGuid()) != m_visibleGUIDs.end(); }
+        // no lock, for the map update threads
+        size_t GetVisibleObjectsCount() const { return m_visibleGUIDs.size(); }
         bool IsVisibleInGridForPlayer(Player const* pl) const override;
         bool IsVisibleGloballyFor(Player* pl) const;
         void UpdateVisibilityOf(WorldObject const* viewPoint, WorldObject* target);
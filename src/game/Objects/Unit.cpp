@@ -58,6 +58,7 @@
 
 #include <math.h>
 #include <stdarg.h>
+#include <atomic>
 
 //#define DEBUG_DEBUFF_LIMIT
 
@@ -106,6 +107,8 @@ Unit::Unit()
     //m_AurasCheck = 2000;
     //m_removeAuraTimer = 4;
     m_spellAuraHoldersUpdateIterator = m_spellAuraHolders.end();
+    m_procCandidatesFlags = 0;
+    m_procCandidatesGeneration = sSpellMgr.GetSpellProcEventGeneration();
 
     m_Visibility = VISIBILITY_ON;
     m_AINotifyScheduled = false;
@@ -3303,6 +3306,7 @@ bool Unit::AddSpellAuraHolder(SpellAuraHolder* holder)
     }
     // add aura, register in lists and arrays
     m_spellAuraHolders.insert(SpellAuraHolderMap::value_type(holder->GetId(), holder));
+    AddProcCandidate(holder);
 
     for (int32 i = 0; i < MAX_EFFECT_INDEX; ++i)
         if (Aura* aur = holder->GetAuraByEffectIndex(SpellEffectIndex(i)))
@@ -3872,6 +3876,7 @@ void Unit::RemoveSpellAuraHolder(SpellAuraHolder* holder, AuraRemoveMode mode)
         if (itr->second == holder)
         {
             m_spellAuraHolders.erase(itr);
+            RemoveProcCandidate(holder);
             foundInMap = true;
             break;
         }
@@ -8303,28 +8308,118 @@ void Unit::ProcSkillsAndReactives(bool isVictim, Unit* pTarget, uint32 procFlag,
     }
 }
 
+namespace
+{
+    std::atomic<uint64> s_procCalls(0);
+    std::atomic<uint64> s_procHolders(0);
+    std::atomic<uint64> s_procScanned(0);
+    std::atomic<uint64> s_procFired(0);
+}
+
+void Unit::AddProcCandidate(SpellAuraHolder* holder)
+{
+    if (m_procCandidatesGeneration != sSpellMgr.GetSpellProcEventGeneration())
+    {
+        RebuildProcCandidates();
+        return;
+    }
+
+    uint32 const procFlags = GetAuraProcFlagMask(holder->GetSpellProto());
+    if (!procFlags)
+        return;
+
+    // The holders map inserts equal keys last, do the same to keep the proc order unchanged
+    uint32 const spellId = holder->GetId();
+    auto itr = std::upper_bound(m_procCandidates.begin(), m_procCandidates.end(), spellId,
+        [](uint32 id, ProcCandidate const& candidate) { return id < candidate.holder->GetId(); });
+    m_procCandidates.insert(itr, { procFlags, holder });
+    m_procCandidatesFlags |= procFlags;
+}
+
+void Unit::RemoveProcCandidate(SpellAuraHolder* holder)
+{
+    auto itr = std::find_if(m_procCandidates.begin(), m_procCandidates.end(),
+        [holder](ProcCandidate const& candidate) { return candidate.holder == holder; });
+    if (itr == m_procCandidates.end())
+        return;
+
+    m_procCandidates.erase(itr);
+    m_procCandidatesFlags = 0;
+    for (auto const& candidate : m_procCandidates)
+        m_procCandidatesFlags |= candidate.procFlags;
+}
+
+void Unit::RebuildProcCandidates()
+{
+    m_procCandidates.clear();
+    m_procCandidatesFlags = 0;
+    m_procCandidatesGeneration = sSpellMgr.GetSpellProcEventGeneration();
+
+    for (auto const& itr : m_spellAuraHolders)
+    {
+        if (uint32 procFlags = GetAuraProcFlagMask(itr.second->GetSpellProto()))
+        {
+            m_procCandidates.push_back({ procFlags, itr.second });
+            m_procCandidatesFlags |= procFlags;
+        }
+    }
+}
+
+Unit::ProcScanStats Unit::GetProcScanStats(bool reset)
+{
+    ProcScanStats stats;
+    if (reset)
+    {
+        stats.calls = s_procCalls.exchange(0);
+        stats.holders = s_procHolders.exchange(0);
+        stats.scanned = s_procScanned.exchange(0);
+        stats.fired = s_procFired.exchange(0);
+    }
+    else
+    {
+        stats.calls = s_procCalls.load();
+        stats.holders = s_procHolders.load();
+        stats.scanned = s_procScanned.load();
+        stats.fired = s_procFired.load();
+    }
+    return stats;
+}
+
 void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* pTarget, uint32 procFlag, uint32 procExtra, WeaponAttackType attType, SpellEntry const* procSpell, uint32 damage, ProcTriggeredList& triggeredList, std::list<SpellModifier*> const& appliedSpellModifiers, bool isSpellTriggeredByAura)
 {
     DEBUG_UNIT(this, DEBUG_PROCS, "PROC: Flags 0x%.5x Ex 0x%.3x Spell %5u %s", procFlag, procExtra, procSpell ? procSpell->Id : 0, isVictim ? "[victim]" : "");
 
+    if (m_procCandidatesGeneration != sSpellMgr.GetSpellProcEventGeneration())
+        RebuildProcCandidates();
+
+    uint32 scanned = 0;
+    uint32 fired = 0;
+
     // Fill triggeredList list
-    for (const auto& itr : GetSpellAuraHolderMap())
+    // Indexed loop: a proc check with side effects may still add or remove holders
+    for (size_t index = 0; (m_procCandidatesFlags & procFlag) && index < m_procCandidates.size(); ++index)
     {
+        if (!(m_procCandidates[index].procFlags & procFlag))
+            continue;
+
+        SpellAuraHolder* holder = m_procCandidates[index].holder;
+        ++scanned;
+
         // Can not proc on self.
-        if (procSpell && procSpell->Id == itr.first)
+        if (procSpell && procSpell->Id == holder->GetId())
             continue;
 
         // skip deleted auras (possible at recursive triggered call
-        if (itr.second->IsDeleted())
+        if (holder->IsDeleted())
             continue;
 
         // Aura that applies a modifier with charges. Gere? otherwise.
         bool hasmodifier = false;
         for (int i = 0; i < 3; ++i)
         {
-            if (itr.second->GetAuraByEffectIndex(SpellEffectIndex(i)))
+            if (holder->GetAuraByEffectIndex(SpellEffectIndex(i)))
             {
-                if (SpellModifier* auraMod = itr.second->GetAuraByEffectIndex(SpellEffectIndex(i))->GetSpellModifier())
+                if (SpellModifier* auraMod = holder->GetAuraByEffectIndex(SpellEffectIndex(i))->GetSpellModifier())
                 {
                     if (auraMod->charges > 0 || (std::find(appliedSpellModifiers.begin(), appliedSpellModifiers.end(), auraMod) != appliedSpellModifiers.end()))
                     {
@@ -8338,12 +8433,18 @@ void Unit::ProcDamageAndSpellFor(bool isVictim, Unit* pTarget, uint32 procFlag,
             continue;
 
         SpellProcEventEntry const* spellProcEvent = nullptr;
-        if (!IsTriggeredAtSpellProcEvent(pTarget, itr.second, procSpell, procFlag, procExtra, attType, isVictim, spellProcEvent, isSpellTriggeredByAura))
+        if (!IsTriggeredAtSpellProcEvent(pTarget, holder, procSpell, procFlag, procExtra, attType, isVictim, spellProcEvent, isSpellTriggeredByAura))
             continue;
 
-        itr.second->SetInUse(true);                        // prevent holder deletion
-        triggeredList.push_back(ProcTriggeredData(spellProcEvent, itr.second, pTarget, procFlag));
+        holder->SetInUse(true);                            // prevent holder deletion
+        triggeredList.push_back(ProcTriggeredData(spellProcEvent, holder, pTarget, procFlag));
+        ++fired;
     }
+
+    s_procCalls.fetch_add(1, std::memory_order_relaxed);
+    s_procHolders.fetch_add(m_spellAuraHolders.size(), std::memory_order_relaxed);
+    s_procScanned.fetch_add(scanned, std::memory_order_relaxed);
+    s_procFired.fetch_add(fired, std::memory_order_relaxed);
 }
 
 Player* Unit::GetSpellModOwner() const
@@ -9498,12 +9599,13 @@ void Unit::InterruptSpellsCastedOnMe(bool killDelayed, bool interruptPositiveSpe
         if (!killDelayed)
             continue;
         // 2/ Interruption des sorts qui ne sont plus reference, mais dont il reste un event (ceux en parcours par exemple)
-        auto i_Events = iter->m_Events.GetEvents().begin();
-        for (; i_Events != iter->m_Events.GetEvents().end(); ++i_Events)
-            if (SpellEvent* event = dynamic_cast<SpellEvent*>(i_Events->second))
-                if (event && event->GetSpell()->m_targets.getUnitTargetGuid() == GetObjectGuid())
+        iter->m_Events.ForEachEvent([this](BasicEvent* basicEvent)
+        {
+            if (SpellEvent* event = dynamic_cast<SpellEvent*>(basicEvent))
+                if (event->GetSpell()->m_targets.getUnitTargetGuid() == GetObjectGuid())
                     if (event->GetSpell()->getState() != SPELL_STATE_FINISHED)
                         event->GetSpell()->cancel();
+        });
     }
 }
 
@@ -637,6 +637,18 @@ class Unit : public SpellCaster
     protected:
         SpellAuraHolderMap m_spellAuraHolders;
         SpellAuraHolderMap::iterator m_spellAuraHoldersUpdateIterator; // != end() in Unit::m_spellAuraHolders update and point to next element
+        // Holders that can react to a proc, kept in the same order as m_spellAuraHolders
+        struct ProcCandidate
+        {
+            uint32 procFlags;                                          // see Unit::GetAuraProcFlagMask
+            SpellAuraHolder* holder;
+        };
+        std::vector<ProcCandidate> m_procCandidates;
+        uint32 m_procCandidatesFlags;                                  // union of the candidates' proc flags
+        uint32 m_procCandidatesGeneration;                             // SpellMgr proc event generation the index was built with
+        void AddProcCandidate(SpellAuraHolder* holder);
+        void RemoveProcCandidate(SpellAuraHolder* holder);
+        void RebuildProcCandidates();
         AuraList m_deletedAuras;                                       // auras removed while in ApplyModifier and waiting deleted
         SpellAuraHolderList m_deletedHolders;
         SingleCastSpellTargetMap m_singleCastSpellTargets;  // casted by unit single per-caster auras
@@ -853,6 +865,17 @@ class Unit : public SpellCaster
         void HandleTriggers(Unit* pVictim, uint32 procExtra, uint32 amount, SpellEntry const* procSpell, ProcTriggeredList const& procTriggered);
 
         bool IsTriggeredAtSpellProcEvent(Unit* pVictim, SpellAuraHolder* holder, SpellEntry const* procSpell, uint32 procFlag, uint32 procExtra, WeaponAttackType attType, bool isVictim, SpellProcEventEntry const*& spellProcEvent, bool dontTriggerSpecial) const;
+        // Proc flags on which IsTriggeredAtSpellProcEvent may accept an aura of this spell, 0 if it never can
+        static uint32 GetAuraProcFlagMask(SpellEntry const* spellProto);
+
+        struct ProcScanStats
+        {
+            uint64 calls = 0;                                          // ProcDamageAndSpellFor calls
+            uint64 holders = 0;                                        // holders present on the unit
+            uint64 scanned = 0;                                        // candidates actually checked
+            uint64 fired = 0;                                          // holders added to the triggered list
+        };
+        static ProcScanStats GetProcScanStats(bool reset);
         // only to be used in proc handlers - basepoints is expected to be a MAX_EFFECT_INDEX sized array
         SpellAuraProcResult TriggerProccedSpell(Unit* target, int32* basepoints, uint32 triggeredSpellId, Item* castItem, Aura* triggeredByAura, uint32 cooldown, ObjectGuid originalCaster = ObjectGuid(), SpellEntry const* triggeredByParent = nullptr);
         SpellAuraProcResult TriggerProccedSpell(Unit* target, int32* basepoints, SpellEntry const* spellInfo, Item* castItem, Aura* triggeredByAura, uint32 cooldown, ObjectGuid originalCaster = ObjectGuid(), SpellEntry const* triggeredByParent = nullptr);
@@ -31,7 +31,7 @@
 
 #define MAX_UNCOMPRESSED_PACKET_SIZE 0x8000 // 32ko
 
-UpdateData::UpdateData()
+UpdateData::UpdateData() : m_data(0)
 {
 }
 
@@ -52,88 +52,154 @@ void UpdateData::AddOutOfRangeGUID(ObjectGuid const& guid)
 
 void UpdateData::AddUpdateBlock(ByteBuffer const& block)
 {
-    if (m_datas.empty())
-        m_datas.push_back(UpdatePacket());
-    std::list<UpdatePacket>::iterator it = m_datas.end();
-    --it;
-    if (it->data.wpos() > MAX_UNCOMPRESSED_PACKET_SIZE)
+    size_t offset;
+    AppendUpdateBlock(block, offset);
+}
+
+ByteBuffer& UpdateData::AppendUpdateBlock(ByteBuffer const& block, size_t& offset)
+{
+    if (m_packets.empty())
+        m_data.reserve(1024);
+    if (m_packets.empty() || m_packets.back().size > MAX_UNCOMPRESSED_PACKET_SIZE)
+        m_packets.emplace_back(m_data.wpos());
+
+    UpdatePacket& packet = m_packets.back();
+    offset = m_data.wpos();
+    m_data.append(block);
+    packet.size += block.wpos();
+    ++packet.blockCount;
+    return m_data;
+}
+
+namespace
+{
+    // deflateInit allocates about 256KB of state: keep one stream per thread
+    // and only reset it between two packets.
+    class ThreadCompressor
     {
-        m_datas.push_back(UpdatePacket());
-        it = m_datas.end();
-        --it;
-    }
-    it->data.append(block);
-    ++it->blockCount;
+        public:
+            ThreadCompressor() : m_initialized(false), m_level(0) {}
+            ~ThreadCompressor()
+            {
+                if (m_initialized)
+                    deflateEnd(&m_stream);
+            }
+
+            z_stream* Acquire(int level)
+            {
+                if (m_initialized && level == m_level)
+                {
+                    int z_res = deflateReset(&m_stream);
+                    if (z_res == Z_OK)
+                        return &m_stream;
+                    sLog.outError("Can't compress update packet (zlib: deflateReset) Error code: %i (%s)", z_res, zError(z_res));
+                    Release();
+                }
+                else if (m_initialized)
+                    Release();
+
+                m_stream.zalloc = (alloc_func)0;
+                m_stream.zfree = (free_func)0;
+                m_stream.opaque = (voidpf)0;
+
+                int z_res = deflateInit(&m_stream, level);
+                if (z_res != Z_OK)
+                {
+                    sLog.outError("Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
+                    return nullptr;
+                }
+                m_initialized = true;
+                m_level = level;
+                return &m_stream;
+            }
+
+            // After an error the stream state is unknown, start over on next use
+            void Release()
+            {
+                deflateEnd(&m_stream);
+                m_initialized = false;
+            }
+
+        private:
+            z_stream m_stream;
+            bool m_initialized;
+            int m_level;
+    };
+
+    thread_local ThreadCompressor t_compressor;
 }
 
 void PacketCompressor::Compress(void* dst, uint32* dst_size, void* src, int src_size)
 {
-    z_stream c_stream;
-
-    c_stream.zalloc = (alloc_func)0;
-    c_stream.zfree = (free_func)0;
-    c_stream.opaque = (voidpf)0;
+    Compress(dst, dst_size, (uint8 const*)src, src_size, nullptr, 0);
+}
 
+void PacketCompressor::Compress(void* dst, uint32* dst_size, uint8 const* src1, size_t src1_size, uint8 const* src2, size_t src2_size)
+{
     // default Z_BEST_SPEED (1)
-    int z_res = deflateInit(&c_stream, sWorld.getConfig(CONFIG_UINT32_COMPRESSION));
-    if (z_res != Z_OK)
+    z_stream* c_stream = t_compressor.Acquire(sWorld.getConfig(CONFIG_UINT32_COMPRESSION));
+    if (!c_stream)
     {
-        sLog.outError("Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
         *dst_size = 0;
         return;
     }
 
-    c_stream.next_out = (Bytef*)dst;
-    c_stream.avail_out = *dst_size;
-    c_stream.next_in = (Bytef*)src;
-    c_stream.avail_in = (uInt)src_size;
+    c_stream->next_out = (Bytef*)dst;
+    c_stream->avail_out = *dst_size;
 
-    z_res = deflate(&c_stream, Z_NO_FLUSH);
-    if (z_res != Z_OK)
+    uint8 const* sources[2] = { src1, src2 };
+    size_t const sizes[2] = { src1_size, src2_size };
+    for (int i = 0; i < 2; ++i)
     {
-        sLog.outError("Can't compress update packet (zlib: deflate) Error code: %i (%s)", z_res, zError(z_res));
-        *dst_size = 0;
-        return;
+        if (!sizes[i])
+            continue;
+
+        c_stream->next_in = (Bytef*)sources[i];
+        c_stream->avail_in = (uInt)sizes[i];
+
+        int z_res = deflate(c_stream, Z_NO_FLUSH);
+        if (z_res != Z_OK)
+        {
+            sLog.outError("Can't compress update packet (zlib: deflate) Error code: %i (%s)", z_res, zError(z_res));
+            t_compressor.Release();
+            *dst_size = 0;
+            return;
+        }
+
+        if (c_stream->avail_in != 0)
+        {
+            sLog.outError("Can't compress update packet (zlib: deflate not greedy)");
+            t_compressor.Release();
+            *dst_size = 0;
+            return;
+        }
     }
 
-    if (c_stream.avail_in != 0)
-    {
-        sLog.outError("Can't compress update packet (zlib: deflate not greedy)");
-        *dst_size = 0;
-        return;
-    }
-
-    z_res = deflate(&c_stream, Z_FINISH);
+    int z_res = deflate(c_stream, Z_FINISH);
     if (z_res != Z_STREAM_END)
     {
         sLog.outError("Can't compress update packet (zlib: deflate should report Z_STREAM_END instead %i (%s)", z_res, zError(z_res));
+        t_compressor.Release();
         *dst_size = 0;
         return;
     }
 
-    z_res = deflateEnd(&c_stream);
-    if (z_res != Z_OK)
-    {
-        sLog.outError("Can't compress update packet (zlib: deflateEnd) Error code: %i (%s)", z_res, zError(z_res));
-        *dst_size = 0;
-        return;
-    }
-
-    *dst_size = c_stream.total_out;
+    *dst_size = c_stream->total_out;
 }
 
 bool UpdateData::BuildPacket(WorldPacket* packet, bool hasTransport)
 {
-    if (m_datas.empty())
+    if (m_packets.empty())
         return BuildPacket(packet, nullptr, hasTransport);
-    return BuildPacket(packet, &(m_datas.front()), hasTransport);
+    return BuildPacket(packet, &(m_packets.front()), hasTransport);
 }
 
 bool UpdateData::BuildPacket(WorldPacket* packet, UpdatePacket const* updPacket, bool hasTransport)
 {
     MANGOS_ASSERT(packet->empty());                         // shouldn't happen
 
-    ByteBuffer buf(4 + 1 + (m_outOfRangeGUIDs.empty() ? 0 : 1 + 4 + 9 * m_outOfRangeGUIDs.size()) + (updPacket ? updPacket->data.wpos() : 0));
+    // Only the header is built here, the blocks are read in place from m_data
+    ByteBuffer buf(4 + 1 + (m_outOfRangeGUIDs.empty() ? 0 : 1 + 4 + 9 * m_outOfRangeGUIDs.size()));
 
     uint32 blockCount = updPacket ? updPacket->blockCount : 0;
     buf << (uint32)(!m_outOfRangeGUIDs.empty() ? blockCount + 1 : blockCount);
@@ -153,10 +219,9 @@ bool UpdateData::BuildPacket(WorldPacket* packet, UpdatePacket const* updPacket,
 #endif
     }
 
-    if (updPacket)
-        buf.append(updPacket->data);
-
-    size_t pSize = buf.wpos();                              // use real used data size
+    uint8 const* blocks = updPacket ? m_data.contents() + updPacket->offset : nullptr;
+    size_t blocksSize = updPacket ? updPacket->size : 0;
+    size_t pSize = buf.wpos() + blocksSize;                 // use real used data size
 
     if (pSize > 100)                                       // compress large packets
     {
@@ -167,7 +232,7 @@ bool UpdateData::BuildPacket(WorldPacket* packet, UpdatePacket const* updPacket,
         packet->resize(destsize + sizeof(uint32));
 
         packet->put<uint32>(0, pSize);
-        PacketCompressor::Compress(const_cast<uint8*>(packet->contents()) + sizeof(uint32), &destsize, (void*)buf.contents(), pSize);
+        PacketCompressor::Compress(const_cast<uint8*>(packet->contents()) + sizeof(uint32), &destsize, buf.contents(), buf.wpos(), blocks, blocksSize);
         if (destsize == 0)
             return false;
 
@@ -177,6 +242,8 @@ bool UpdateData::BuildPacket(WorldPacket* packet, UpdatePacket const* updPacket,
     else                                                    // send small packets without compression
     {
         packet->append(buf);
+        if (blocksSize)
+            packet->append(blocks, blocksSize);
         packet->SetOpcode(SMSG_UPDATE_OBJECT);
     }
 
@@ -186,14 +253,14 @@ bool UpdateData::BuildPacket(WorldPacket* packet, UpdatePacket const* updPacket,
 void UpdateData::Send(WorldSession* session, bool hasTransport)
 {
     WorldPacket data;
-    if (m_datas.empty() && !m_outOfRangeGUIDs.empty())
+    if (m_packets.empty() && !m_outOfRangeGUIDs.empty())
     {
         BuildPacket(&data, nullptr, hasTransport);
         session->SendPacket(&data);
         m_outOfRangeGUIDs.clear();
         return;
     }
-    for (const auto& itr : m_datas)
+    for (const auto& itr : m_packets)
     {
         BuildPacket(&data, &itr, hasTransport);
         session->SendPacket(&data);
@@ -204,7 +271,8 @@ void UpdateData::Send(WorldSession* session, bool hasTransport)
 
 void UpdateData::Clear()
 {
-    m_datas.clear();
+    m_data.clear();
+    m_packets.clear();
     m_outOfRangeGUIDs.clear();
 }
 
@@ -56,18 +56,33 @@ enum ObjectUpdateFlags
 #endif
 };
 
+// Slice of UpdateData's block buffer that is sent as one packet
 class UpdatePacket
 {
     public:
-        UpdatePacket() : blockCount(0) {}
-        ByteBuffer data;
+        explicit UpdatePacket(size_t offset) : offset(offset), size(0), blockCount(0) {}
+        size_t offset;
+        size_t size;
         uint32 blockCount;
 };
 
+// Update block that is the same for many receivers. `patches` lists the
+// uint32 fields (offset in block, update field index) that differ per receiver.
+class SharedUpdateBlock
+{
+    public:
+        ByteBuffer block;
+        std::vector<std::pair<size_t, uint16>> patches;
+};
+
+// Every thread keeps its own zlib stream, reset between packets instead of
+// being allocated and freed for each of them.
 class PacketCompressor
 {
     public:
         static void Compress(void* dst, uint32* dst_size, void* src, int src_size);
+        // Compresses the concatenation of two buffers without copying them together first
+        static void Compress(void* dst, uint32* dst_size, uint8 const* src1, size_t src1_size, uint8 const* src2, size_t src2_size);
 };
 
 class UpdateData
@@ -79,17 +94,20 @@ class UpdateData
         void AddOutOfRangeGUID(ObjectGuidSet& guids);
         void AddOutOfRangeGUID(ObjectGuid const& guid);
         void AddUpdateBlock(ByteBuffer const& block);
+        // Same as AddUpdateBlock, returns the buffer and the offset of the block to patch it in place
+        ByteBuffer& AppendUpdateBlock(ByteBuffer const& block, size_t& offset);
         void Send(WorldSession* session, bool hasTransport = false);
         bool BuildPacket(WorldPacket* packet, bool hasTransport = false);
         bool BuildPacket(WorldPacket* packet, UpdatePacket const* updPacket, bool hasTransport = false);
-        bool HasData() { return !m_datas.empty() || !m_outOfRangeGUIDs.empty(); }
+        bool HasData() { return !m_packets.empty() || !m_outOfRangeGUIDs.empty(); }
         void Clear();
 
         ObjectGuidSet const& GetOutOfRangeGUIDs() const { return m_outOfRangeGUIDs; }
 
     protected:
         ObjectGuidSet m_outOfRangeGUIDs;
-        std::list<UpdatePacket> m_datas;
+        ByteBuffer m_data;                                  // all the blocks, back to back
+        std::vector<UpdatePacket> m_packets;
 };
 
 class MovementData
@@ -78,16 +78,15 @@ void MovementBroadcaster::Work(std::size_t thread_id)
     while (!m_stop)
     {
         ThreadUpdateStats& stats = m_thread_update_stats[thread_id];
-        uint32 num_packets = 0;
         uint32 begin_time = WorldTimer::getMSTime();
-        BroadcastPackets(thread_id, num_packets);
-        stats.num_packets = num_packets;
+        BroadcastPackets(thread_id, stats);
         stats.update_time = WorldTimer::getMSTimeDiffToNow(begin_time);
 
         if (sWorld.getConfig(CONFIG_UINT32_PERFLOG_SLOW_PACKET_BCAST) &&
             stats.update_time > sWorld.getConfig(CONFIG_UINT32_PERFLOG_SLOW_PACKET_BCAST))
-            sLog.out(LOG_PERFORMANCE, "MovementBroadcaster thread %02u: %04ums to process queue [%u packets]",
-                thread_id, stats.update_time, num_packets);
+            sLog.out(LOG_PERFORMANCE, "MovementBroadcaster thread %02u: %04ums to process queue [%u packets, %u queued, max depth %u, %u dropped, %u overflow, %u coalesced]",
+                thread_id, stats.update_time, stats.num_packets, stats.queued_packets, stats.max_queue_depth,
+                stats.dropped_packets, stats.overflow_packets, stats.coalesced_packets);
 
         if (sWorld.getConfig(CONFIG_UINT32_PBCAST_DIFF_LOWER_VISIBILITY_DISTANCE) &&
             stats.update_time > sWorld.getConfig(CONFIG_UINT32_PBCAST_DIFF_LOWER_VISIBILITY_DISTANCE))
@@ -121,7 +120,7 @@ uint32 MovementBroadcaster::IdentifySlowMap(std::size_t thread_id)
     return max_instance_id;
 }
 
-void MovementBroadcaster::BroadcastPackets(std::size_t index, uint32& num_packets)
+void MovementBroadcaster::BroadcastPackets(std::size_t index, ThreadUpdateStats& stats)
 {
     PlayersBCastSet my_players;
     {
@@ -129,8 +128,31 @@ void MovementBroadcaster::BroadcastPackets(std::size_t index, uint32& num_packet
         my_players = m_thread_players[index];
     }
 
+    uint32 num_packets = 0;
+    uint32 queued_packets = 0;
+    uint32 max_queue_depth = 0;
+    uint32 dropped_packets = 0;
+    uint32 overflow_packets = 0;
+    uint32 coalesced_packets = 0;
     for (auto& player : my_players)
+    {
+        uint32 const depth = player->m_queue.size();
+        queued_packets += depth;
+        max_queue_depth = std::max(max_queue_depth, depth);
+        dropped_packets += player->m_dropped_packets.exchange(0, std::memory_order_relaxed);
+        overflow_packets += player->m_overflow_packets.exchange(0, std::memory_order_relaxed);
+
         player->ProcessQueue(num_packets);
+        coalesced_packets += player->m_coalesced_packets;
+        player->m_coalesced_packets = 0;
+    }
+
+    stats.num_packets = num_packets;
+    stats.queued_packets = queued_packets;
+    stats.max_queue_depth = max_queue_depth;
+    stats.dropped_packets = dropped_packets;
+    stats.overflow_packets = overflow_packets;
+    stats.coalesced_packets = coalesced_packets;
 }
 
 void MovementBroadcaster::Stop()
@@ -38,7 +38,6 @@ class MovementBroadcaster final
     std::vector<std::mutex> m_thread_locks;
 
     void Work(std::size_t thread_id);
-    void BroadcastPackets(std::size_t index, uint32& num_packets);
     uint32 IdentifySlowMap(std::size_t thread_id);
 
 public:
@@ -57,6 +56,11 @@ public:
         uint32 update_time;
         uint32 num_packets;
         int32 slow_instance;
+        uint32 queued_packets;      // packets waiting in the players' queues when the run started
+        uint32 max_queue_depth;     // longest queue of a single player
+        uint32 dropped_packets;     // skippable movement packets dropped because a queue was full
+        uint32 overflow_packets;    // packets kept outside of a full queue because they can't be dropped
+        uint32 coalesced_packets;   // movement replaced by a newer one before the turn of a mid or far listener
     };
     std::vector<ThreadUpdateStats> const& GetStats() const { return m_thread_update_stats; }
     std::chrono::milliseconds GetSleepTimer() const { return m_sleep_timer; }
@@ -65,6 +69,8 @@ public:
     bool IsEnabled();
 
 protected:
+    void BroadcastPackets(std::size_t index, ThreadUpdateStats& stats);
+
     std::vector<ThreadUpdateStats> m_thread_update_stats;
 };
 
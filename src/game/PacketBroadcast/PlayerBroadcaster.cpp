@@ -3,17 +3,19 @@
 #include "WorldSocket.h"
 #include "WorldPacket.h"
 #include "Player.h"
+#include "World.h"
+#include "Timer.h"
 
 uint32 PlayerBroadcaster::num_bcaster_created = 0;
 uint32 PlayerBroadcaster::num_bcaster_deleted = 0;
 
 PlayerBroadcaster::PlayerBroadcaster(WorldSocket* w_socket, ObjectGuid const& self, std::size_t max_queue)
-    : MAX_QUEUE_SIZE(max_queue), m_socket(w_socket), m_self(self), instanceId(0), lastUpdatePackets(0)
+    : MAX_QUEUE_SIZE(max_queue), m_socket(w_socket), m_self(self), m_listeners_version(0), m_snapshot_version(0), m_has_pending(false),
+      m_queue(max_queue), m_has_overflow(false), m_dropped_packets(0), m_overflow_packets(0), m_coalesced_packets(0), instanceId(0), lastUpdatePackets(0)
 {
     if (m_socket)
         m_socket->AddReference();
 
-    m_queue.reserve(max_queue);
     ++num_bcaster_created;
 }
 
@@ -26,86 +28,220 @@ void PlayerBroadcaster::ChangeSocket(WorldSocket* new_socket)
     m_socket = new_socket;
 }
 
-void PlayerBroadcaster::AddListener(Player const* player)
+void PlayerBroadcaster::AddListener(Player const* player, InterestTier tier)
 {
     ASSERT(player);
     if (player->GetObjectGuid() == m_self)
         return;
 
     const std::lock_guard<std::mutex> guard(m_listeners_lock);
-    m_listeners[player->GetObjectGuid()] = player->m_broadcaster;
+    Listener& listener = m_listeners[player->GetObjectGuid()];
+    listener.broadcaster = player->m_broadcaster;
+    listener.tier = tier;
+    m_listeners_version.fetch_add(1, std::memory_order_release);
+}
+
+void PlayerBroadcaster::SetListenerTier(Player const* player, InterestTier tier)
+{
+    ASSERT(player);
+    const std::lock_guard<std::mutex> guard(m_listeners_lock);
+    auto itr = m_listeners.find(player->GetObjectGuid());
+    if (itr == m_listeners.end() || itr->second.tier == tier)
+        return;
+
+    itr->second.tier = tier;
+    m_listeners_version.fetch_add(1, std::memory_order_release);
 }
 
 void PlayerBroadcaster::RemoveListener(Player const* player)
 {
     ASSERT(player);
     const std::lock_guard<std::mutex> guard(m_listeners_lock);
-    m_listeners.erase(player->GetObjectGuid());
+    if (m_listeners.erase(player->GetObjectGuid()))
+        m_listeners_version.fetch_add(1, std::memory_order_release);
 }
 
 void PlayerBroadcaster::ClearListeners()
 {
     const std::lock_guard<std::mutex> guard(m_listeners_lock);
     m_listeners.clear();
+    m_listeners_version.fetch_add(1, std::memory_order_release);
 }
 
-void PlayerBroadcaster::SendPacket(WorldPacket const& packet)
+// The socket copies the payload into its output buffer, or keeps a reference if it has to queue it
+void PlayerBroadcaster::SendPacket(std::shared_ptr<WorldPacket const> const& packet)
 {
     if (m_socket)
         m_socket->SendPacket(packet);
 }
 
-void PlayerBroadcaster::ProcessQueue(uint32& num_packets)
+void PlayerBroadcaster::UpdateListenersSnapshot()
 {
-    if (m_queue.empty())
+    if (m_listeners_version.load(std::memory_order_acquire) == m_snapshot_version)
         return;
 
-    std::unique_lock<std::mutex> q_g(m_queue_lock), v_g(m_listeners_lock);
-    auto queue = std::move(m_queue);
-    q_g.unlock();
+    ListenersSnapshot snapshot;
+    {
+        const std::lock_guard<std::mutex> guard(m_listeners_lock);
+        snapshot.resize(m_listeners.size());
+        auto state = snapshot.begin();
+        for (auto const& itr : m_listeners)
+        {
+            state->guid = itr.first;
+            state->broadcaster = itr.second.broadcaster;
+            state->tier = itr.second.tier;
+            ++state;
+        }
+        m_snapshot_version = m_listeners_version.load(std::memory_order_relaxed);
+    }
 
-    lastUpdatePackets = queue.size() * m_listeners.size();
-    num_packets += lastUpdatePackets;
+    // Listeners still there keep their pending movement, both lists are sorted by guid
+    auto old = m_listeners_snapshot.begin();
+    for (auto& state : snapshot)
+    {
+        while (old != m_listeners_snapshot.end() && old->guid < state.guid)
+            ++old;
+        if (old == m_listeners_snapshot.end())
+            break;
+        if (old->guid == state.guid)
+        {
+            state.pending = std::move(old->pending);
+            state.lastSent = old->lastSent;
+        }
+    }
+    m_listeners_snapshot.swap(snapshot);
+}
+
+void PlayerBroadcaster::SendPendingMovement(uint32 now)
+{
+    uint32 const midInterval = sWorld.getConfig(CONFIG_UINT32_VISIBILITY_TIERS_MID_INTERVAL);
+    uint32 const farInterval = sWorld.getConfig(CONFIG_UINT32_VISIBILITY_TIERS_FAR_INTERVAL);
+
+    bool pending = false;
+    for (auto& listener : m_listeners_snapshot)
+    {
+        if (!listener.pending)
+            continue;
+
+        uint32 const interval = listener.tier == INTEREST_TIER_FAR ? farInterval : (listener.tier == INTEREST_TIER_MID ? midInterval : 0);
+        if (WorldTimer::getMSTimeDiff(listener.lastSent, now) < interval)
+        {
+            pending = true;
+            continue;
+        }
+
+        listener.broadcaster->SendPacket(listener.pending);
+        listener.pending.reset();
+        listener.lastSent = now;
+    }
+    m_has_pending = pending;
+}
 
-    for (auto& data : queue)
+void PlayerBroadcaster::ProcessQueue(uint32& num_packets)
+{
+    if (!m_queue.size() && !m_has_overflow.load(std::memory_order_acquire) && !m_has_pending.load(std::memory_order_relaxed))
+        return;
+
+    const std::lock_guard<std::mutex> guard(m_consumer_lock);
+    UpdateListenersSnapshot();
+    uint32 const now = WorldTimer::getMSTime();
+
+    uint32 processed = 0;
+    auto broadcast = [this, &processed, now](BroadcastData const& data)
     {
         // Send to self?
         if (data.sendToSelf && data.except != GetGUID())
             SendPacket(data.packet);
 
-        for (const auto& itr : m_listeners)
+        // Mid and far listeners only get the latest movement on their turn, see SendPendingMovement
+        bool const movement = CanSkipPacket(data.packet->GetOpcode());
+        for (auto& listener : m_listeners_snapshot)
         {
-            if (itr.first == data.except)
+            if (listener.guid == data.except)
                 continue;
 
-            itr.second->SendPacket(data.packet);
+            if (listener.tier != INTEREST_TIER_NEAR)
+            {
+                if (movement)
+                {
+                    if (listener.pending)
+                        ++m_coalesced_packets;
+                    listener.pending = data.packet;
+                    m_has_pending = true;
+                    continue;
+                }
+
+                // Keep the order with the other packets
+                if (listener.pending)
+                {
+                    listener.broadcaster->SendPacket(listener.pending);
+                    listener.pending.reset();
+                    listener.lastSent = now;
+                }
+            }
+
+            listener.broadcaster->SendPacket(data.packet);
+        }
+        ++processed;
+    };
+
+    // Do not chase the producers: what is queued after this point waits for the next run
+    BroadcastData data;
+    for (std::size_t budget = m_queue.size(); budget && m_queue.pop(data); --budget)
+        broadcast(data);
+
+    if (m_has_overflow.load(std::memory_order_acquire))
+    {
+        // Overflowed packets are newer than everything left in the ring
+        while (m_queue.pop(data))
+            broadcast(data);
+
+        std::vector<BroadcastData> overflow;
+        {
+            const std::lock_guard<std::mutex> o_g(m_overflow_lock);
+            overflow.swap(m_overflow);
+            m_has_overflow = false;
         }
+        for (auto const& overflowData : overflow)
+            broadcast(overflowData);
     }
+
+    if (m_has_pending.load(std::memory_order_relaxed))
+        SendPendingMovement(now);
+
+    lastUpdatePackets = processed * m_listeners_snapshot.size();
+    num_packets += lastUpdatePackets;
 }
 
 void PlayerBroadcaster::QueuePacket(WorldPacket packet, bool self, ObjectGuid except)
 {
+    bool const canSkip = CanSkipPacket(packet.GetOpcode());
+
     BroadcastData data;
-    data.packet = std::move(packet);
+    data.packet = std::make_shared<WorldPacket const>(std::move(packet));
     data.sendToSelf = self;
     data.except = except;
 
-    std::unique_lock<std::mutex> guard(m_queue_lock);
+    // Once packets overflow, keep queuing behind them to preserve the order
+    if (!m_has_overflow.load(std::memory_order_acquire) && m_queue.push(std::move(data)))
+        return;
+
+    // The flag is only a hint, decide again under the lock: the consumer
+    // may have emptied the overflow list since, or the ring may have room now.
+    const std::lock_guard<std::mutex> guard(m_overflow_lock);
+    if (m_overflow.empty() && m_queue.push(std::move(data)))
+        return;
 
     // We need to drop a packet here - if possible
-    if (m_queue.size() >= MAX_QUEUE_SIZE)
+    if (canSkip)
     {
-        BroadcastData& last_in_queue = m_queue[m_queue.size() - 1];
-        if (CanSkipPacket(last_in_queue.packet.GetOpcode()) && CanSkipPacket(data.packet.GetOpcode()))
-        {
-            m_queue[m_queue.size() - 1] = std::move(data);
-            guard.unlock();
-            return;
-        }
+        ++m_dropped_packets;
+        return;
     }
-    m_queue.emplace_back(std::move(data));
 
-    guard.release();
+    m_overflow.emplace_back(std::move(data));
+    m_has_overflow = true;
+    ++m_overflow_packets;
 }
 
 ObjectGuid PlayerBroadcaster::GetGUID() const
@@ -120,9 +256,20 @@ void PlayerBroadcaster::FreeAtLogout()
         m_socket->RemoveReference();
         m_socket = nullptr;
     }
-    const std::lock_guard<std::mutex> q_g(m_queue_lock), v_g(m_listeners_lock);
-    m_queue.clear();
+    const std::lock_guard<std::mutex> c_g(m_consumer_lock);
+    BroadcastData data;
+    while (m_queue.pop(data)) {}
+    {
+        const std::lock_guard<std::mutex> o_g(m_overflow_lock);
+        m_overflow.clear();
+        m_has_overflow = false;
+    }
+
+    const std::lock_guard<std::mutex> v_g(m_listeners_lock);
     m_listeners.clear();
+    m_listeners_snapshot.clear();
+    m_has_pending = false;
+    m_snapshot_version = m_listeners_version.fetch_add(1, std::memory_order_release) + 1;
 }
 
 PlayerBroadcaster::~PlayerBroadcaster()
@@ -4,9 +4,14 @@
 #include "ObjectGuid.h"
 #include "WorldPacket.h"
 #include "Opcodes.h"
+#include "MPSCRingBuffer.h"
+#include "InterestTier.h"
 #include <list>
 #include <vector>
 #include <cstddef>
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 class WorldSocket;
 class MovementBroadcaster;
@@ -16,23 +21,63 @@ class PlayerBroadcaster final
 {
     struct BroadcastData
     {
-        WorldPacket packet;
-        bool sendToSelf;
+        // Shared by every listener, never modified once queued
+        std::shared_ptr<WorldPacket const> packet;
+        bool sendToSelf = false;
         ObjectGuid except;
     };
+    struct Listener
+    {
+        std::shared_ptr<PlayerBroadcaster> broadcaster;
+        InterestTier tier = INTEREST_TIER_NEAR;
+    };
+    // Consumer side state of a listener
+    struct ListenerState
+    {
+        ObjectGuid guid;
+        std::shared_ptr<PlayerBroadcaster> broadcaster;
+        InterestTier tier = INTEREST_TIER_NEAR;
+        // Latest movement not sent yet to a mid or far listener, older ones are useless
+        std::shared_ptr<WorldPacket const> pending;
+        uint32 lastSent = 0;
+    };
+    typedef std::vector<ListenerState> ListenersSnapshot;
 
     std::size_t const MAX_QUEUE_SIZE;
 
     WorldSocket* m_socket;
     ObjectGuid m_self;
 
-    std::map<ObjectGuid, std::shared_ptr<PlayerBroadcaster> > m_listeners;
-    std::vector<BroadcastData> m_queue;
+    std::map<ObjectGuid, Listener> m_listeners;
     std::mutex m_listeners_lock;
-    std::mutex m_queue_lock;
+    // Bumped on every listener change, the consumer only copies m_listeners when it moved
+    std::atomic<uint32> m_listeners_version;
+    ListenersSnapshot m_listeners_snapshot;
+    uint32 m_snapshot_version;
+    // Some listener of the snapshot has a pending movement packet
+    std::atomic<bool> m_has_pending;
+
+    // Filled by the map threads, emptied by a single broadcaster thread.
+    // Drop policy: skippable (movement) packets are dropped when the ring is
+    // full, and also while m_overflow is not empty, since queuing them in the
+    // ring would let them overtake the overflowed packets. Other packets are
+    // never dropped.
+    MPSCRingBuffer<BroadcastData> m_queue;
+    // Packets that cannot be dropped and did not fit in the ring, newer than anything in the ring
+    std::vector<BroadcastData> m_overflow;
+    std::mutex m_overflow_lock;
+    std::atomic<bool> m_has_overflow;
+    // Held by the consumer, so that FreeAtLogout can empty the queue
+    std::mutex m_consumer_lock;
+
+    std::atomic<uint32> m_dropped_packets;
+    std::atomic<uint32> m_overflow_packets;
+    uint32 m_coalesced_packets;                 // consumer only
 
     void ProcessQueue(uint32& num_packets);
-    void SendPacket(WorldPacket const& packet);
+    void SendPacket(std::shared_ptr<WorldPacket const> const& packet);
+    void UpdateListenersSnapshot();
+    void SendPendingMovement(uint32 now);
 
     static inline bool CanSkipPacket(uint32 opcode)
     {
@@ -58,8 +103,9 @@ public:
 
     void QueuePacket(WorldPacket packet, bool self, ObjectGuid except);
 
-    void AddListener(Player const* player);
+    void AddListener(Player const* player, InterestTier tier = INTEREST_TIER_NEAR);
     void RemoveListener(Player const* player);
+    void SetListenerTier(Player const* player, InterestTier tier);
 
     void ClearListeners();
     void SetInstanceId(uint32 id) { instanceId = id; }
@@ -0,0 +1,221 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "OpcodeProfiler.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+    // Marks the counters of a thread as inactive when it exits, they are kept for the reports
+    struct ThreadCountersOwner
+    {
+        std::atomic<bool>* active = nullptr;
+        void* counters = nullptr;
+
+        ~ThreadCountersOwner()
+        {
+            if (active)
+                *active = false;
+        }
+    };
+
+    thread_local ThreadCountersOwner t_counters;
+
+    // Only the owning thread writes its counters, no read-modify-write needed
+    inline void Add(std::atomic<uint64>& counter, uint64 value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    inline void Max(std::atomic<uint64>& counter, uint64 value)
+    {
+        if (value > counter.load(std::memory_order_relaxed))
+            counter.store(value, std::memory_order_relaxed);
+    }
+}
+
+OpcodeProfiler& OpcodeProfiler::Instance()
+{
+    static OpcodeProfiler profiler;
+    return profiler;
+}
+
+uint64 OpcodeProfiler::Now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+OpcodeProfiler::ThreadCounters* OpcodeProfiler::GetThreadCounters()
+{
+    if (t_counters.counters)
+        return static_cast<ThreadCounters*>(t_counters.counters);
+
+    std::lock_guard<std::mutex> guard(m_threadsLock);
+    m_threads.emplace_back(new ThreadCounters());
+    ThreadCounters* thread = m_threads.back().get();
+    thread->index = uint32(m_threads.size() - 1);
+    t_counters.active = &thread->active;
+    t_counters.counters = thread;
+    return thread;
+}
+
+void OpcodeProfiler::Record(uint16 opcode, PacketProcessing processing, uint64 start, size_t size)
+{
+    if (opcode >= NUM_MSG_TYPES)
+        return;
+
+    uint64 const time = Now() - start;
+    ThreadCounters* thread = GetThreadCounters();
+
+    // counters of a previous generation are cleared by their own thread, readers skip them meanwhile
+    uint32 const generation = m_generation.load(std::memory_order_relaxed);
+    if (thread->generation.load(std::memory_order_relaxed) != generation)
+    {
+        for (Counters& counters : thread->opcodes)
+        {
+            counters.calls.store(0, std::memory_order_relaxed);
+            counters.totalTime.store(0, std::memory_order_relaxed);
+            counters.maxTime.store(0, std::memory_order_relaxed);
+            counters.bytes.store(0, std::memory_order_relaxed);
+            counters.maxSize.store(0, std::memory_order_relaxed);
+        }
+        thread->processingMask.store(0, std::memory_order_relaxed);
+        thread->generation.store(generation, std::memory_order_release);
+    }
+
+    uint32 const processingBit = 1 << processing;
+    uint32 const mask = thread->processingMask.load(std::memory_order_relaxed);
+    if (!(mask & processingBit))
+        thread->processingMask.store(mask | processingBit, std::memory_order_relaxed);
+
+    Counters& counters = thread->opcodes[opcode];
+    Add(counters.calls, 1);
+    Add(counters.totalTime, time);
+    Max(counters.maxTime, time);
+    Add(counters.bytes, size);
+    Max(counters.maxSize, size);
+}
+
+std::vector<OpcodeProfiler::OpcodeStats> OpcodeProfiler::GetOpcodeStats(SortOrder order) const
+{
+    std::vector<OpcodeStats> stats(NUM_MSG_TYPES);
+    for (uint16 opcode = 0; opcode < NUM_MSG_TYPES; ++opcode)
+        stats[opcode] = { opcode, 0, 0, 0, 0, 0 };
+
+    {
+        uint32 const generation = m_generation.load();
+        std::lock_guard<std::mutex> guard(m_threadsLock);
+        for (auto const& thread : m_threads)
+        {
+            if (thread->generation.load(std::memory_order_acquire) != generation)
+                continue;
+
+            for (uint16 opcode = 0; opcode < NUM_MSG_TYPES; ++opcode)
+            {
+                Counters const& counters = thread->opcodes[opcode];
+                OpcodeStats& total = stats[opcode];
+                total.calls += counters.calls.load(std::memory_order_relaxed);
+                total.totalTime += counters.totalTime.load(std::memory_order_relaxed);
+                total.maxTime = std::max(total.maxTime, counters.maxTime.load(std::memory_order_relaxed));
+                total.bytes += counters.bytes.load(std::memory_order_relaxed);
+                total.maxSize = std::max(total.maxSize, counters.maxSize.load(std::memory_order_relaxed));
+            }
+        }
+    }
+
+    stats.erase(std::remove_if(stats.begin(), stats.end(), [](OpcodeStats const& s) { return !s.calls; }), stats.end());
+
+    auto key = [order](OpcodeStats const& s)
+    {
+        switch (order)
+        {
+            case SORT_BY_MAX_TIME: return s.maxTime;
+            case SORT_BY_CALLS:    return s.calls;
+            case SORT_BY_BYTES:    return s.bytes;
+            default:               return s.totalTime;
+        }
+    };
+    std::sort(stats.begin(), stats.end(), [&key](OpcodeStats const& a, OpcodeStats const& b) { return key(a) > key(b); });
+    return stats;
+}
+
+std::vector<OpcodeProfiler::ThreadStats> OpcodeProfiler::GetThreadStats() const
+{
+    std::vector<ThreadStats> stats;
+
+    uint32 const generation = m_generation.load();
+    std::lock_guard<std::mutex> guard(m_threadsLock);
+    for (auto const& thread : m_threads)
+    {
+        if (thread->generation.load(std::memory_order_acquire) != generation)
+            continue;
+
+        ThreadStats total = { thread->index, thread->processingMask.load(std::memory_order_relaxed), thread->active, 0, 0, 0, 0 };
+        for (uint16 opcode = 0; opcode < NUM_MSG_TYPES; ++opcode)
+        {
+            Counters const& counters = thread->opcodes[opcode];
+            uint64 const time = counters.totalTime.load(std::memory_order_relaxed);
+            total.calls += counters.calls.load(std::memory_order_relaxed);
+            total.totalTime += time;
+            if (time > total.topOpcodeTime)
+            {
+                total.topOpcode = opcode;
+                total.topOpcodeTime = time;
+            }
+        }
+
+        if (total.calls)
+            stats.push_back(total);
+    }
+    return stats;
+}
+
+bool OpcodeProfiler::Dump(std::string const& fileName) const
+{
+    std::string const tmpName = fileName + ".tmp";
+    FILE* file = fopen(tmpName.c_str(), "w");
+    if (!file)
+    {
+        sLog.outError("OpcodeProfiler: can not open '%s' for writing", tmpName.c_str());
+        return false;
+    }
+
+    fprintf(file, "# Opcode handler profile, %s\n", Log::GetTimestampStr().c_str());
+    fprintf(file, "opcode,name,calls,total_us,avg_us,max_us,bytes,max_bytes\n");
+    for (OpcodeStats const& s : GetOpcodeStats(SORT_BY_TOTAL_TIME))
+        fprintf(file, "0x%.4X,%s," UI64FMTD "," UI64FMTD "," UI64FMTD "," UI64FMTD "," UI64FMTD "," UI64FMTD "\n",
+                s.opcode, LookupOpcodeName(s.opcode), s.calls, s.totalTime, s.totalTime / s.calls, s.maxTime, s.bytes, s.maxSize);
+
+    fprintf(file, "\nthread,processing_mask,active,calls,total_us,top_opcode,top_opcode_us\n");
+    for (ThreadStats const& s : GetThreadStats())
+        fprintf(file, "%u,0x%X,%u," UI64FMTD "," UI64FMTD ",%s," UI64FMTD "\n", s.index, s.processingMask, uint32(s.active),
+                s.calls, s.totalTime, LookupOpcodeName(s.topOpcode), s.topOpcodeTime);
+
+    bool const written = !ferror(file);
+    fclose(file);
+    // rename does not replace an existing file everywhere
+    std::remove(fileName.c_str());
+    if (!written || std::rename(tmpName.c_str(), fileName.c_str()) != 0)
+    {
+        sLog.outError("OpcodeProfiler: can not write '%s'", fileName.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,115 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_OPCODEPROFILER_H
+#define MANGOS_OPCODEPROFILER_H
+
+#include "Common.h"
+#include "Opcodes.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Counts the calls, handler time and payload size of every client opcode.
+ *  Each thread processing packets writes its own counters without locking,
+ *  the readers (GM command, periodic dump) sum them up.
+ *  Times are in microseconds.
+ */
+class OpcodeProfiler
+{
+    public:
+        enum SortOrder
+        {
+            SORT_BY_TOTAL_TIME,
+            SORT_BY_MAX_TIME,
+            SORT_BY_CALLS,
+            SORT_BY_BYTES,
+        };
+
+        struct OpcodeStats
+        {
+            uint16 opcode;
+            uint64 calls;
+            uint64 totalTime;
+            uint64 maxTime;
+            uint64 bytes;
+            uint64 maxSize;
+        };
+
+        struct ThreadStats
+        {
+            uint32 index;
+            uint32 processingMask;                          // bit per PacketProcessing handled by the thread
+            bool active;                                    // false once the thread exited
+            uint64 calls;
+            uint64 totalTime;
+            uint16 topOpcode;                               // opcode with the most handler time
+            uint64 topOpcodeTime;
+        };
+
+        static OpcodeProfiler& Instance();
+
+        void SetEnabled(bool enabled) { m_enabled = enabled; }
+        bool IsEnabled() const { return m_enabled; }
+
+        static uint64 Now();
+
+        /// Called by WorldSession::ProcessPackets once the packet was handled, start is from Now().
+        void Record(uint16 opcode, PacketProcessing processing, uint64 start, size_t size);
+
+        std::vector<OpcodeStats> GetOpcodeStats(SortOrder order) const;
+        std::vector<ThreadStats> GetThreadStats() const;
+        void Reset() { ++m_generation; }
+
+        /// Writes the opcode and thread counters as CSV, replacing the file.
+        bool Dump(std::string const& fileName) const;
+
+    private:
+        struct Counters
+        {
+            std::atomic<uint64> calls{0};
+            std::atomic<uint64> totalTime{0};
+            std::atomic<uint64> maxTime{0};
+            std::atomic<uint64> bytes{0};
+            std::atomic<uint64> maxSize{0};
+        };
+
+        struct ThreadCounters
+        {
+            uint32 index = 0;
+            std::atomic<uint32> generation{0};              // counters are ignored until it matches the profiler one
+            std::atomic<uint32> processingMask{0};
+            std::atomic<bool> active{true};
+            Counters opcodes[NUM_MSG_TYPES];
+        };
+
+        OpcodeProfiler() : m_enabled(true), m_generation(1) {}
+
+        ThreadCounters* GetThreadCounters();
+
+        std::atomic<bool> m_enabled;
+        std::atomic<uint32> m_generation;
+
+        mutable std::mutex m_threadsLock;
+        std::vector<std::unique_ptr<ThreadCounters>> m_threads;
+};
+
+#define sOpcodeProfiler OpcodeProfiler::Instance()
+
+#endif
@@ -44,6 +44,8 @@
 #include "PathFinder.h"
 #include "CharacterDatabaseCache.h"
 #include "ZoneScript.h"
+#include "PooledAllocator.h"
+#include "TickProfiler.h"
 
 using namespace Spells;
 
@@ -353,6 +355,22 @@ Spell::Spell(GameObject* caster, SpellEntry const* info, bool triggered, ObjectG
     CleanupTargetList();
 }
 
+static PooledAllocator& GetSpellAllocator()
+{
+    static PooledAllocator* allocator = new PooledAllocator("Spell", sizeof(Spell));
+    return *allocator;
+}
+
+void* Spell::operator new(size_t size)
+{
+    return GetSpellAllocator().allocate(size);
+}
+
+void Spell::operator delete(void* pointer)
+{
+    GetSpellAllocator().deallocate(pointer);
+}
+
 Spell::~Spell()
 {
     m_destroyed = true;
@@ -659,15 +677,41 @@ void Spell::FillTargetMap()
                 break;
         }
 
+        // the line of sight of all the targets is checked at once
+        std::vector<WorldObject const*> losTargets;
+        std::vector<WorldObject const*> losCasters;
         for (UnitList::iterator itr = tmpUnitMap.begin(); itr != tmpUnitMap.end();)
         {
-            if (!CheckTarget(*itr, SpellEffectIndex(i)))
+            SpellCaster* losCaster = nullptr;
+            if (!CheckTarget(*itr, SpellEffectIndex(i), &losCaster))
             {
                 itr = tmpUnitMap.erase(itr);
                 continue;
             }
-            else
+            if (losCaster)
+            {
+                losTargets.push_back(*itr);
+                losCasters.push_back(losCaster);
+            }
+            ++itr;
+        }
+
+        if (!losTargets.empty())
+        {
+            std::unique_ptr<bool[]> inLos(new bool[losTargets.size()]);
+            WorldObject::IsWithinLOSInMap(losTargets.data(), losCasters.data(), losTargets.size(), inLos.get());
+
+            // losTargets is in list order
+            uint32 los = 0;
+            for (UnitList::iterator itr = tmpUnitMap.begin(); itr != tmpUnitMap.end() && los < losTargets.size();)
+            {
+                if (*itr == losTargets[los] && !inLos[los++])
+                {
+                    itr = tmpUnitMap.erase(itr);
+                    continue;
+                }
                 ++itr;
+            }
         }
 
         for (const auto iunit : tmpUnitMap)
@@ -4111,6 +4155,7 @@ void Spell::SendSpellCooldown()
 
 void Spell::update(uint32 difftime)
 {
+    TICK_PROFILE_SCOPE_ARG("Spell::update", "spell", m_spellInfo->Id);
     // update pointers based at it's GUIDs
     UpdatePointers();
 
@@ -8024,7 +8069,7 @@ CurrentSpellTypes Spell::GetCurrentContainer() const
         return (CURRENT_GENERIC_SPELL);
 }
 
-bool Spell::CheckTarget(Unit* target, SpellEffectIndex eff)
+bool Spell::CheckTarget(Unit* target, SpellEffectIndex eff, SpellCaster** losCaster)
 {
     if (m_casterUnit && target != m_casterUnit && m_spellInfo->IsPositiveSpell())
     {
@@ -8115,8 +8160,13 @@ bool Spell::CheckTarget(Unit* target, SpellEffectIndex eff)
             // Get GO cast coordinates if original caster -> GO
             if (target != m_caster && !IsIgnoreLosTarget(m_spellInfo->EffectImplicitTargetA[eff]))
                 if (SpellCaster* caster = GetCastingObject())
-                    if (!(m_spellInfo->AttributesEx2 & SPELL_ATTR_EX2_IGNORE_LOS) && !target->IsWithinLOSInMap(caster))
-                        return false;
+                    if (!(m_spellInfo->AttributesEx2 & SPELL_ATTR_EX2_IGNORE_LOS))
+                    {
+                        if (losCaster)
+                            *losCaster = caster;
+                        else if (!target->IsWithinLOSInMap(caster))
+                            return false;
+                    }
             break;
     }
 
@@ -8405,16 +8455,43 @@ public:
         }
     }
 
+    // the distance checked at the end of Visit for every push type
+    MaNGOS::RangeFilter GetRangeFilter() const
+    {
+        switch (i_push_type)
+        {
+            case PUSH_IN_FRONT:
+            case PUSH_IN_FRONT_90:
+            case PUSH_IN_FRONT_15:
+            case PUSH_IN_BACK:
+            case PUSH_SELF_CENTER:
+                return MaNGOS::RangeFilter(i_castingObject, i_radius);
+            case PUSH_DEST_CENTER:
+                return MaNGOS::RangeFilter(i_spell.m_targets.m_destX, i_spell.m_targets.m_destY, i_radius);
+            case PUSH_TARGET_CENTER:
+                if (Unit* target = i_spell.m_targets.getUnitTarget())
+                    return MaNGOS::RangeFilter(target, i_radius);
+                break;
+            default:
+                break;
+        }
+        return MaNGOS::RangeFilter();
+    }
+
     template<class T>
-    void Visit(GridRefManager<T>& m)
+    void Visit(GridObjectList<T>& m)
     {
         MANGOS_ASSERT(i_data);
 
         if (!i_originalCaster || !i_castingObject)
             return;
 
-        for (typename GridRefManager<T>::iterator itr = m.begin(); itr != m.end(); ++itr)
+        MaNGOS::RangeFilter const filter = GetRangeFilter();
+        for (typename GridObjectList<T>::iterator itr = m.begin(); itr != m.end(); ++itr)
         {
+            if (!filter.MayPass(m, itr))
+                continue;
+
             // The template is only defined for Player and Creature maps. If it is extended
             // in the future, we should swap to WorldObject. Furthermore, we will have to
             // ensure all the checks are not using invalid casts.
@@ -327,6 +327,10 @@ class Spell
         Spell(GameObject* caster, SpellEntry const* info, bool triggered, ObjectGuid originalCasterGUID = ObjectGuid(), SpellEntry const* triggeredBy = nullptr, Unit* victim = nullptr, SpellEntry const* triggeredByParent = nullptr);
         ~Spell();
 
+        // pooled per thread, see PooledAllocator
+        static void* operator new(size_t size);
+        static void operator delete(void* pointer);
+
         SpellCastResult prepare(SpellCastTargets targets, Aura* triggeredByAura = nullptr, uint32 chance = 0);
         SpellCastResult prepare(Aura* triggeredByAura = nullptr, uint32 chance = 0);
 
@@ -382,7 +386,8 @@ class Spell
 
         template<typename T> WorldObject* FindCorpseUsing();
 
-        bool CheckTarget(Unit* target, SpellEffectIndex eff);
+        // With `losCaster`, the usual line of sight check is left to the caller: *losCaster is set to the object the target has to see
+        bool CheckTarget(Unit* target, SpellEffectIndex eff, SpellCaster** losCaster = nullptr);
         bool CanAutoCast(Unit* target);
 
         static void SendCastResult(Player* caster, SpellEntry const* spellInfo, SpellCastResult result);
@@ -761,7 +766,7 @@ namespace MaNGOS
                     i_data.push_back(pPlayer);
             }
         }
-        template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
+        template<class SKIP> void Visit(GridObjectList<SKIP>&) {}
     };
 }
 
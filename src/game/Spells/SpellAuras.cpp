@@ -47,6 +47,7 @@
 #include "MoveSpline.h"
 #include "MovementPacketSender.h"
 #include "ZoneScript.h"
+#include "PooledAllocator.h"
 
 using namespace Spells;
 
@@ -379,6 +380,22 @@ bool SpellAuraHolder::IsMoreImportantDebuffThan(SpellAuraHolder* other) const
     return m_debuffLimitScore > other->m_debuffLimitScore;
 }
 
+static PooledAllocator& GetAuraAllocator()
+{
+    static PooledAllocator* allocator = new PooledAllocator("Aura", std::max({ sizeof(Aura), sizeof(AreaAura), sizeof(PersistentAreaAura), sizeof(SingleEnemyTargetAura) }));
+    return *allocator;
+}
+
+void* Aura::operator new(size_t size)
+{
+    return GetAuraAllocator().allocate(size);
+}
+
+void Aura::operator delete(void* pointer)
+{
+    GetAuraAllocator().deallocate(pointer);
+}
+
 Aura::~Aura()
 {
 }
@@ -6968,6 +6985,22 @@ void Aura::HandleAuraSafeFall(bool Apply, bool Real)
     // implemented in WorldSession::HandleMovementOpcodes
 }
 
+static PooledAllocator& GetSpellAuraHolderAllocator()
+{
+    static PooledAllocator* allocator = new PooledAllocator("SpellAuraHolder", sizeof(SpellAuraHolder));
+    return *allocator;
+}
+
+void* SpellAuraHolder::operator new(size_t size)
+{
+    return GetSpellAuraHolderAllocator().allocate(size);
+}
+
+void SpellAuraHolder::operator delete(void* pointer)
+{
+    GetSpellAuraHolderAllocator().deallocate(pointer);
+}
+
 SpellAuraHolder::~SpellAuraHolder()
 {
     // note: auras in delete list won't be affected since they clear themselves from holder when adding to deletedAuraslist
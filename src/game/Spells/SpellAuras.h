@@ -236,6 +236,10 @@ class SpellAuraHolder
         bool IsTriggered() const { return m_spellTriggered; }
 
         ~SpellAuraHolder();
+
+        // pooled per thread, see PooledAllocator
+        static void* operator new(size_t size);
+        static void operator delete(void* pointer);
     private:
         void UpdateAuraApplication();                       // called at charges or stack changes
 
@@ -431,6 +435,10 @@ class Aura
 
         virtual ~Aura();
 
+        // pooled per thread for every aura class, see PooledAllocator
+        static void* operator new(size_t size);
+        static void operator delete(void* pointer);
+
         void SetModifier(AuraType t, float a, uint32 pt, int32 miscValue);
         Modifier*       GetModifier()       { return &m_modifier; }
         Modifier const* GetModifier() const { return &m_modifier; }
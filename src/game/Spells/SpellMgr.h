@@ -552,6 +552,9 @@ class SpellMgr
             return nullptr;
         }
 
+        // Bumped on every (re)load of spell_proc_event, units rebuild their proc index when it changes
+        uint32 GetSpellProcEventGeneration() const { return mSpellProcEventGeneration; }
+
         // Spell procs from item enchants
         float GetItemEnchantProcChance(uint32 spellid) const
         {
@@ -824,6 +827,7 @@ class SpellMgr
         SpellElixirMap     mSpellElixirs;
         SpellThreatMap     mSpellThreatMap;
         SpellProcEventMap  mSpellProcEventMap;
+        uint32             mSpellProcEventGeneration = 0;
         SpellProcItemEnchantMap mSpellProcItemEnchantMap;
         SpellEnchantChargesMap mSpellEnchantChargesMap;
         SkillLineAbilityMap mSkillLineAbilityMapBySpellId;
@@ -67,6 +67,8 @@ HostileReference::HostileReference(Unit* pUnit, ThreatManager *pThreatManager, f
     iUnitGuid = pUnit->GetObjectGuid();
     iOnline = true;
     iAccessible = true;
+    iListIndex = 0;
+    iRepositionPending = false;
 }
 
 //============================================================
@@ -203,12 +205,70 @@ Unit* HostileReference::getSourceUnit()
 
 void ThreatContainer::clearReferences()
 {
-    for (ThreatList::const_iterator i = iThreatList.begin(); i != iThreatList.end(); ++i)
+    for (HostileReference* ref : iThreatList.iRefs)
     {
-        (*i)->unlink();
-        delete(*i);
+        if (!ref)
+            continue;
+        ref->unlink();
+        delete ref;
     }
-    iThreatList.clear();
+    iThreatList.iRefs.clear();
+    iThreatList.iSize = 0;
+    iRepositionPending.clear();
+    iHoles = 0;
+}
+
+//============================================================
+
+bool ThreatContainer::contains(HostileReference const* pRef) const
+{
+    return pRef->iListIndex < iThreatList.iRefs.size() && iThreatList.iRefs[pRef->iListIndex] == pRef;
+}
+
+//============================================================
+
+void ThreatContainer::addReference(HostileReference* pHostileReference)
+{
+    pHostileReference->iListIndex = iThreatList.iRefs.size();
+    iThreatList.iRefs.push_back(pHostileReference);
+    ++iThreatList.iSize;
+    threatChanged(pHostileReference);
+}
+
+//============================================================
+// Leave a hole, filled at the next update, so that iterations over the list are not disturbed
+
+void ThreatContainer::remove(HostileReference* pRef)
+{
+    if (!contains(pRef))
+        return;
+
+    ThreatList::Storage& refs = iThreatList.iRefs;
+    refs[pRef->iListIndex] = nullptr;
+    --iThreatList.iSize;
+    ++iHoles;
+    while (!refs.empty() && !refs.back())
+    {
+        refs.pop_back();
+        --iHoles;
+    }
+
+    if (pRef->iRepositionPending)
+    {
+        pRef->iRepositionPending = false;
+        iRepositionPending.erase(std::find(iRepositionPending.begin(), iRepositionPending.end(), pRef));
+    }
+}
+
+//============================================================
+
+void ThreatContainer::threatChanged(HostileReference* pRef)
+{
+    if (pRef->iRepositionPending || !contains(pRef))
+        return;
+
+    pRef->iRepositionPending = true;
+    iRepositionPending.push_back(pRef);
 }
 
 //============================================================
@@ -264,20 +324,77 @@ void ThreatContainer::modifyThreatPercent(Unit* pVictim, int32 pPercent)
 
 //============================================================
 
-bool HostileReferenceSortPredicate(HostileReference const* lhs, HostileReference const* rhs)
+void ThreatContainer::reindex(size_t first, size_t last)
 {
-    // std::list::sort ordering predicate must be: (Pred(x,y)&&Pred(y,x))==false
-    return lhs->getThreat() > rhs->getThreat();             // reverse sorting
+    for (size_t i = first; i < last; ++i)
+        iThreatList.iRefs[i]->iListIndex = i;
 }
 
 //============================================================
-// Check if the list is dirty and sort if necessary
+// Put the references whose threat changed at their place. The result is the
+// same as a stable sort by decreasing threat of the whole list.
 
 void ThreatContainer::update()
 {
-    if (iDirty && iThreatList.size() > 1)
-        iThreatList.sort(HostileReferenceSortPredicate);
-    iDirty = false;
+    if (!isDirty())
+        return;
+
+    ThreatList::Storage& refs = iThreatList.iRefs;
+
+    // Usual case, a single reference changed: binary search of its new place
+    // and move the references it overtook or fell behind by one slot
+    if (iRepositionPending.size() == 1 && !iHoles)
+    {
+        HostileReference* ref = iRepositionPending.front();
+        ref->iRepositionPending = false;
+        iRepositionPending.clear();
+
+        size_t const index = ref->iListIndex;
+        float const threat = ref->getThreat();
+        auto const position = refs.begin() + index;
+        if (index && threat > refs[index - 1]->getThreat())
+        {
+            // behind the ones with the same threat
+            auto const target = std::upper_bound(refs.begin(), position, threat,
+                [](float value, HostileReference const* other) { return value > other->getThreat(); });
+            std::rotate(target, position, position + 1);
+            reindex(target - refs.begin(), index + 1);
+        }
+        else if (index + 1 < refs.size() && threat < refs[index + 1]->getThreat())
+        {
+            // in front of the ones with the same threat
+            auto const target = std::lower_bound(position + 1, refs.end(), threat,
+                [](HostileReference const* other, float value) { return other->getThreat() > value; });
+            std::rotate(position, position + 1, target);
+            reindex(index, target - refs.begin());
+        }
+        return;
+    }
+
+    // Several changes or holes: the unchanged references are still in order,
+    // merge them with the sorted changed ones
+    auto const before = [](HostileReference const* lhs, HostileReference const* rhs)
+    {
+        if (lhs->getThreat() != rhs->getThreat())
+            return lhs->getThreat() > rhs->getThreat();
+        return lhs->iListIndex < rhs->iListIndex;
+    };
+
+    ThreatList::Storage unchanged;
+    unchanged.reserve(iThreatList.iSize);
+    for (HostileReference* ref : refs)
+        if (ref && !ref->iRepositionPending)
+            unchanged.push_back(ref);
+
+    std::sort(iRepositionPending.begin(), iRepositionPending.end(), before);
+    for (HostileReference* ref : iRepositionPending)
+        ref->iRepositionPending = false;
+
+    refs.clear();
+    std::merge(unchanged.begin(), unchanged.end(), iRepositionPending.begin(), iRepositionPending.end(), std::back_inserter(refs), before);
+    iRepositionPending.clear();
+    iHoles = 0;
+    reindex(0, refs.size());
 }
 
 //============================================================
@@ -454,6 +571,7 @@ void ThreatManager::modifyThreatPercent(Unit* pVictim, int32 pPercent)
 Unit* ThreatManager::getHostileTarget()
 {
     iThreatContainer.update();
+    iThreatOfflineContainer.update();
     HostileReference* nextVictim = iThreatContainer.selectNextVictim((Creature*) getOwner(), getCurrentVictim());
     setCurrentVictim(nextVictim);
     return getCurrentVictim() != nullptr ? getCurrentVictim()->getTarget() : nullptr;
@@ -515,35 +633,29 @@ void ThreatManager::processThreatEvent(ThreatRefStatusChangeEvent* threatRefStat
     switch (threatRefStatusChangeEvent->getType())
     {
         case UEV_THREAT_REF_THREAT_CHANGE:
-            if ((getCurrentVictim() == hostileReference && threatRefStatusChangeEvent->getFValue() < 0.0f) ||
-                    (getCurrentVictim() != hostileReference && threatRefStatusChangeEvent->getFValue() > 0.0f))
-                setDirty(true);                             // the order in the threat list might have changed
+            // the order in the threat list might have changed
+            if (hostileReference->isOnline())
+                iThreatContainer.threatChanged(hostileReference);
+            else
+                iThreatOfflineContainer.threatChanged(hostileReference);
             break;
         case UEV_THREAT_REF_ONLINE_STATUS:
             if (!hostileReference->isOnline())
             {
                 if (hostileReference == getCurrentVictim())
-                {
                     setCurrentVictim(nullptr);
-                    setDirty(true);
-                }
                 iThreatContainer.remove(hostileReference);
                 iThreatOfflineContainer.addReference(hostileReference);
             }
             else
             {
-                if (getCurrentVictim() && hostileReference->getThreat() > (1.1f * getCurrentVictim()->getThreat()))
-                    setDirty(true);
-                iThreatContainer.addReference(hostileReference);
                 iThreatOfflineContainer.remove(hostileReference);
+                iThreatContainer.addReference(hostileReference);
             }
             break;
         case UEV_THREAT_REF_REMOVE_FROM_LIST:
             if (hostileReference == getCurrentVictim())
-            {
                 setCurrentVictim(nullptr);
-                setDirty(true);
-            }
             if (hostileReference->isOnline())
                 iThreatContainer.remove(hostileReference);
             else
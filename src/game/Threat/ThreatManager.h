@@ -28,7 +28,8 @@
 #include "UnitEvents.h"
 #include "ObjectGuid.h"
 #include "SpellDefines.h"
-#include <list>
+#include <vector>
+#include <iterator>
 
 //==============================================================
 
@@ -49,6 +50,8 @@ class ThreatCalcHelper
 //==============================================================
 class HostileReference : public Reference<Unit, ThreatManager>
 {
+    friend class ThreatContainer;
+
     public:
         HostileReference(Unit* pUnit, ThreatManager *pThreatManager, float pThreat);
 
@@ -131,27 +134,100 @@ class HostileReference : public Reference<Unit, ThreatManager>
         ObjectGuid iUnitGuid;
         bool iOnline;
         bool iAccessible;
+
+        // position in the ThreatContainer holding the reference
+        uint32 iListIndex;
+        bool iRepositionPending;
 };
 
 //==============================================================
 class ThreatManager;
 
-typedef std::list<HostileReference*> ThreatList;
+// Hostile references ordered by decreasing threat, stored contiguously.
+// Removed references leave a hole skipped by the iterators until the owning
+// container is updated, so removing or adding references while iterating is safe.
+class ThreatList
+{
+    friend class ThreatContainer;
+
+    typedef std::vector<HostileReference*> Storage;
+
+public:
+    class const_iterator
+    {
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef HostileReference* value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef HostileReference* const* pointer;
+        typedef HostileReference* const& reference;
+
+        const_iterator() : iRefs(nullptr), iIndex(0) {}
+        const_iterator(Storage const* refs, size_t index) : iRefs(refs), iIndex(index) { skipForward(); }
+
+        reference operator*() const { return (*iRefs)[iIndex]; }
+        pointer operator->() const { return &(*iRefs)[iIndex]; }
+
+        const_iterator& operator++() { ++iIndex; skipForward(); return *this; }
+        const_iterator operator++(int) { const_iterator tmp = *this; ++*this; return tmp; }
+        const_iterator& operator--()
+        {
+            iIndex = std::min(iIndex, iRefs->size());
+            do --iIndex; while (iIndex && !(*iRefs)[iIndex]);
+            return *this;
+        }
+        const_iterator operator--(int) { const_iterator tmp = *this; --*this; return tmp; }
+
+        // an iterator past the last element equals end() even if the list shrank meanwhile
+        bool operator==(const_iterator const& other) const { return std::min(iIndex, iRefs->size()) == std::min(other.iIndex, other.iRefs->size()); }
+        bool operator!=(const_iterator const& other) const { return !(*this == other); }
+
+    private:
+        void skipForward() { while (iIndex < iRefs->size() && !(*iRefs)[iIndex]) ++iIndex; }
+
+        Storage const* iRefs;
+        size_t iIndex;
+    };
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+    typedef const_iterator iterator;
+    typedef const_reverse_iterator reverse_iterator;
+    typedef HostileReference* value_type;
+    typedef size_t size_type;
+
+    ThreatList() : iSize(0) {}
+
+    const_iterator begin() const { return const_iterator(&iRefs, 0); }
+    const_iterator end() const { return const_iterator(&iRefs, iRefs.size()); }
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+    size_t size() const { return iSize; }
+    bool empty() const { return !iSize; }
+    HostileReference* front() const { return *begin(); }
+    HostileReference* back() const { return *rbegin(); }
+
+private:
+    Storage iRefs;
+    size_t iSize;                                           // references, holes excluded
+};
 
 class ThreatContainer
 {
     ThreatList iThreatList;
-    bool iDirty;
+    std::vector<HostileReference*> iRepositionPending;      // threat changed or newly added, not at their place yet
+    size_t iHoles;
 protected:
     friend class ThreatManager;
 
-    void remove(HostileReference* pRef) { iThreatList.remove(pRef); }
-    void addReference(HostileReference* pHostileReference) { iThreatList.push_back(pHostileReference); }
+    void remove(HostileReference* pRef);
+    void addReference(HostileReference* pHostileReference);
     void clearReferences();
-    // Sort the list if necessary
+    // A reference's threat changed, it is moved at the next update
+    void threatChanged(HostileReference* pRef);
+    // Move the changed references at their place and fill the holes
     void update();
 public:
-    ThreatContainer() { iDirty = false; }
+    ThreatContainer() : iHoles(0) {}
     ~ThreatContainer() { clearReferences(); }
 
     HostileReference* addThreat(Unit* pVictim, float pThreat);
@@ -160,9 +236,7 @@ public:
 
     HostileReference* selectNextVictim(Creature* pAttacker, HostileReference* pCurrentVictim);
 
-    void setDirty(bool pDirty) { iDirty = pDirty; }
-
-    bool isDirty() const { return iDirty; }
+    bool isDirty() const { return iHoles || !iRepositionPending.empty(); }
 
     bool empty() const { return iThreatList.empty(); }
 
@@ -171,6 +245,10 @@ public:
     HostileReference* getReferenceByTarget(Unit* pVictim);
 
     ThreatList const& getThreatList() const { return iThreatList; }
+
+private:
+    bool contains(HostileReference const* pRef) const;
+    void reindex(size_t first, size_t last);
 };
 
 //=================================================
@@ -212,8 +290,6 @@ public:
 
     void setCurrentVictim(HostileReference* pHostileReference);
 
-    void setDirty(bool pDirty) { iThreatContainer.setDirty(pDirty); }
-
     // Don't must be used for explicit modify threat values in iterator return pointers
     ThreatList const& getThreatList() const { return iThreatContainer.getThreatList(); }
 private:
@@ -230,6 +230,48 @@ inline bool SpellCanTrigger(SpellEntry const* spellProto, SpellEntry const* proc
     return (procSpell && procSpell->SpellFamilyName == spellProto->SpellFamilyName && procSpell->SpellFamilyFlags & spellProto->EffectItemType[eff_idx]);
 }
 
+// Must stay in sync with the hard-coded cases of IsTriggeredAtSpellProcEvent: those
+// may accept an aura whatever its proc flags are, so they are candidates for every proc.
+uint32 Unit::GetAuraProcFlagMask(SpellEntry const* spellProto)
+{
+    // Improved Lay on Hands, Inspiration
+    if (spellProto->SpellIconID == 79 && (spellProto->SpellFamilyName == SPELLFAMILY_PALADIN || spellProto->SpellFamilyName == SPELLFAMILY_PRIEST))
+        return ~uint32(0);
+
+    switch (spellProto->Id)
+    {
+        case 25906:                                         // Wrath of Cenarius
+        case 24658:                                         // Unstable Power
+        case 16864:                                         // Omen of Clarity
+        case 6346:                                          // Fear Ward
+#if SUPPORTED_CLIENT_BUILD <= CLIENT_BUILD_1_9_4
+        case 12292:                                         // Sweeping Strikes
+        case 18765:
+#endif
+            return ~uint32(0);
+    }
+
+    if (spellProto->EffectApplyAuraName[0] == SPELL_AURA_ADD_TARGET_TRIGGER)
+        return ~uint32(0);
+
+    uint32 procFlags = spellProto->procFlags;
+    SpellProcEventEntry const* spellProcEvent = sSpellMgr.GetSpellProcEvent(spellProto->Id);
+    if (spellProcEvent && spellProcEvent->procFlags)
+        procFlags = spellProcEvent->procFlags;
+
+#if SUPPORTED_CLIENT_BUILD > CLIENT_BUILD_1_8_4
+    // Eye for an Eye
+#if SUPPORTED_CLIENT_BUILD > CLIENT_BUILD_1_9_4
+    if (spellProto->SpellIconID == 1820)
+#else
+    if (spellProto->SpellIconID == 1799)
+#endif
+        procFlags |= PROC_FLAG_TAKEN_NEGATIVE_SPELL_HIT;
+#endif
+
+    return procFlags;
+}
+
 bool Unit::IsTriggeredAtSpellProcEvent(Unit* pVictim, SpellAuraHolder* holder, SpellEntry const* procSpell, uint32 procFlag, uint32 procExtra, WeaponAttackType attType, bool isVictim, SpellProcEventEntry const*& spellProcEvent, bool dontTriggerSpecial) const
 {
     SpellEntry const* spellProto = holder->GetSpellProto();
@@ -55,6 +55,7 @@
 #include "GameEventMgr.h"
 #include "PoolManager.h"
 #include "Database/DatabaseImpl.h"
+#include "Database/SQLStorage.h"
 #include "GridNotifiersImpl.h"
 #include "CellImpl.h"
 #include "MapPersistentStateMgr.h"
@@ -79,7 +80,10 @@
 #include "ThreadPool.h"
 #include "AuraRemovalMgr.h"
 #include "InstanceStatistics.h"
+#include "OpcodeProfiler.h"
+#include "TickProfiler.h"
 #include "GuardMgr.h"
+#include "TaskGraph.h"
 
 #include <chrono>
 
@@ -526,6 +530,8 @@ void World::LoadConfigSettings(bool reload)
     setConfigPos(CONFIG_UINT32_INTERVAL_SAVE, "PlayerSave.Interval", 15 * MINUTE * IN_MILLISECONDS);
     setConfigMinMax(CONFIG_UINT32_MIN_LEVEL_STAT_SAVE, "PlayerSave.Stats.MinLevel", 0, 0, MAX_LEVEL);
     setConfig(CONFIG_BOOL_STATS_SAVE_ONLY_ON_LOGOUT, "PlayerSave.Stats.SaveOnlyOnLogout", true);
+    setConfigMin(CONFIG_UINT32_PLAYER_FULL_SAVE_EVERY, "PlayerSave.FullSaveEvery", 10, 1);
+    setConfig(CONFIG_UINT32_LOGIN_CACHE_TIME, "PlayerSave.LoginCacheTime", 300);
 
     setConfigMin(CONFIG_UINT32_INTERVAL_GRIDCLEAN, "GridCleanUpDelay", 5 * MINUTE * IN_MILLISECONDS, MIN_GRID_DELAY);
     if (reload)
@@ -752,6 +758,12 @@ void World::LoadConfigSettings(bool reload)
     m_relocation_ai_notify_delay = sConfig.GetIntDefault("Visibility.AIRelocationNotifyDelay", 1000u);
     m_relocation_lower_limit_sq  = pow(sConfig.GetFloatDefault("Visibility.RelocationLowerLimit", 10), 2);
 
+    setConfig(CONFIG_UINT32_VISIBILITY_TIERS_CROWD, "Visibility.Tiers.CrowdThreshold", 100);
+    setConfigMin(CONFIG_FLOAT_VISIBILITY_TIERS_NEAR_DISTANCE, "Visibility.Tiers.NearDistance", 30.0f, 0.0f);
+    setConfigMin(CONFIG_FLOAT_VISIBILITY_TIERS_MID_DISTANCE, "Visibility.Tiers.MidDistance", 60.0f, getConfig(CONFIG_FLOAT_VISIBILITY_TIERS_NEAR_DISTANCE));
+    setConfigMinMax(CONFIG_UINT32_VISIBILITY_TIERS_MID_INTERVAL, "Visibility.Tiers.MidInterval", 500, 0, 10000);
+    setConfigMinMax(CONFIG_UINT32_VISIBILITY_TIERS_FAR_INTERVAL, "Visibility.Tiers.FarInterval", 2000, getConfig(CONFIG_UINT32_VISIBILITY_TIERS_MID_INTERVAL), 30000);
+
     m_VisibleUnitGreyDistance = sConfig.GetFloatDefault("Visibility.Distance.Grey.Unit", 1);
     if (m_VisibleUnitGreyDistance >  MAX_VISIBILITY_DISTANCE)
     {
@@ -881,13 +893,19 @@ void World::LoadConfigSettings(bool reload)
     sLog.outString("WORLD: VMap data directory is: %svmaps", m_dataPath.c_str());
     setConfig(CONFIG_BOOL_MMAP_ENABLED, "mmap.enabled", true);
     sLog.outString("WORLD: mmap pathfinding %sabled", getConfig(CONFIG_BOOL_MMAP_ENABLED) ? "en" : "dis");
+    setConfig(CONFIG_UINT32_MMAP_CORRIDOR_CACHE_SIZE, "mmap.corridorCacheSize", 1024);
 
     setConfig(CONFIG_UINT32_EMPTY_MAPS_UPDATE_TIME, "MapUpdate.Empty.UpdateTime", 0);
     setConfigMinMax(CONFIG_UINT32_MAP_OBJECTSUPDATE_THREADS, "MapUpdate.ObjectsUpdate.MaxThreads", 4, 1, 20);
     setConfigMinMax(CONFIG_UINT32_MAP_OBJECTSUPDATE_TIMEOUT, "MapUpdate.ObjectsUpdate.Timeout", 100, 10, 2000);
+    setConfig(CONFIG_BOOL_MAP_OBJECTSUPDATE_SHARED_BLOCKS, "MapUpdate.ObjectsUpdate.SharedBlocks", true);
     setConfigMinMax(CONFIG_UINT32_MAP_VISIBILITYUPDATE_THREADS, "MapUpdate.VisibilityUpdate.MaxThreads", 4, 1, 20);
     setConfigMinMax(CONFIG_UINT32_MAP_VISIBILITYUPDATE_TIMEOUT, "MapUpdate.VisibilityUpdate.Timeout", 100, 10, 2000);
-    setConfigMinMax(CONFIG_UINT32_MAPUPDATE_INSTANCED_UPDATE_THREADS, "MapUpdate.Instanced.UpdateThreads", 2, 0, 20);
+    setConfigMinMax(CONFIG_UINT32_MAPUPDATE_WORKER_THREADS, "MapUpdate.WorkerThreads", 4, 0, 64);
+    setConfigMinMax(CONFIG_UINT32_GRID_PRELOAD_THREADS, "GridPreload.Threads", 1, 0, 16);
+    setConfigMinMax(CONFIG_UINT32_GRID_PRELOAD_INTERVAL, "GridPreload.Interval", 1000, 100, 60000);
+    setConfigMinMax(CONFIG_UINT32_GRID_PRELOAD_LOOKAHEAD, "GridPreload.LookAhead", 10000, 1000, 60000);
+    setConfigMinMax(CONFIG_UINT32_STARTUP_LOADER_THREADS, "StartupLoaderThreads", 1, 1, 32);
     setConfigMinMax(CONFIG_UINT32_MTCELLS_THREADS, "MapUpdate.Continents.MTCells.Threads", 0, 0, 20);
     setConfigMinMax(CONFIG_UINT32_MTCELLS_SAFEDISTANCE, "MapUpdate.Continents.MTCells.SafeDistance", 1066, 0, 34112);
     setConfigMinMax(CONFIG_UINT32_MAPUPDATE_UPDATE_PACKETS_DIFF, "MapUpdate.UpdatePacketsDiff", 100, 1, 10000);
@@ -904,6 +922,7 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_UINT32_CONTINENTS_MOTIONUPDATE_THREADS, "Continents.MotionUpdate.Threads", 0);
     setConfig(CONFIG_BOOL_TERRAIN_PRELOAD_CONTINENTS, "Terrain.Preload.Continents", 1);
     setConfig(CONFIG_BOOL_TERRAIN_PRELOAD_INSTANCES, "Terrain.Preload.Instances", 1);
+    setConfig(CONFIG_BOOL_TERRAIN_MEMORY_MAPPED, "Terrain.MemoryMapped", true);
 
     setConfig(CONFIG_BOOL_ENABLE_MOVEMENT_EXTRAPOLATION_CHARGE, "Movement.ExtrapolateChargePosition", true);
     setConfig(CONFIG_BOOL_ENABLE_MOVEMENT_EXTRAPOLATION_PET, "Movement.ExtrapolatePetPosition", true);
@@ -940,6 +959,20 @@ void World::LoadConfigSettings(bool reload)
     setConfig(CONFIG_UINT32_PERFLOG_SLOW_MAP_PACKETS, "PerformanceLog.SlowMapPackets", 60);
     setConfig(CONFIG_UINT32_PERFLOG_SLOW_SESSIONS_UPDATE, "PerformanceLog.SlowSessionsUpdate", 0);
     setConfig(CONFIG_UINT32_PERFLOG_SLOW_PACKET_BCAST, "PerformanceLog.SlowPacketBroadcast", 0);
+
+    setConfig(CONFIG_BOOL_OPCODE_PROFILER, "OpcodeProfiler.Enable", true);
+    setConfig(CONFIG_UINT32_OPCODE_PROFILER_DUMP_INTERVAL, "OpcodeProfiler.DumpInterval", 0);
+    sOpcodeProfiler.SetEnabled(getConfig(CONFIG_BOOL_OPCODE_PROFILER));
+    m_opcodeProfilerFile = sConfig.GetStringDefault("OpcodeProfiler.DumpFile", "opcodes.csv");
+    if (!m_opcodeProfilerFile.empty())
+        m_opcodeProfilerFile = sLog.GetLogsDir() + m_opcodeProfilerFile;
+    m_timers[WUPDATE_OPCODES].SetInterval(getConfig(CONFIG_UINT32_OPCODE_PROFILER_DUMP_INTERVAL) * IN_MILLISECONDS);
+    m_timers[WUPDATE_OPCODES].Reset();
+
+    setConfig(CONFIG_BOOL_TICK_PROFILER, "TickProfiler.Enable", false);
+    setConfigMinMax(CONFIG_UINT32_TICK_PROFILER_BUFFER_SIZE, "TickProfiler.BufferSize", 262144, 1024, 16777216);
+    TickProfiler::SetBufferSize(getConfig(CONFIG_UINT32_TICK_PROFILER_BUFFER_SIZE));
+    TickProfiler::SetRecording(getConfig(CONFIG_BOOL_TICK_PROFILER));
     setConfig(CONFIG_UINT32_LOG_MONEY_TRADES_TRESHOLD, "LogMoneyTreshold", 10000);
 
     setConfig(CONFIG_FLOAT_DYN_RESPAWN_CHECK_RANGE, "DynamicRespawn.Range", -1.0f);
@@ -1257,6 +1290,9 @@ void World::SetInitialWorldSettings()
     ///- Remove the bones (they should not exist in DB though) and old corpses after a restart
     CharacterDatabase.PExecute("DELETE FROM `corpse` WHERE `corpse_type` = '0' OR `time` < (UNIX_TIMESTAMP()-'%u')", 3 * DAY);
 
+    ///- Template tables may be read back from the snapshots written by the previous start
+    SQLStorageBase::EnableSnapshots(sConfig.GetStringDefault("WorldDatabase.SnapshotDir", ""));
+
     sLog.outString("Loading spells ...");
     sSpellMgr.LoadSpells();
 
@@ -1299,6 +1335,10 @@ void World::SetInitialWorldSettings()
     sLog.outString("Loading Script Names...");
     sScriptMgr.LoadScriptNames();
 
+    ///- The template tables store script ids, an index into the script names: their snapshots are only valid for the same names
+    for (uint32 i = 0; i < sScriptMgr.GetScriptIdsCount(); ++i)
+        SQLStorageBase::AddSnapshotDependency(sScriptMgr.GetScriptName(i));
+
     sLog.outString("Loading MapTemplate...");
     sObjectMgr.LoadMapTemplate();
 
@@ -1332,294 +1372,11 @@ void World::SetInitialWorldSettings()
     sObjectMgr.SetHighestGuids();                           // must be after packing instances
     sLog.outString();
 
-    sLog.outString("Loading Broadcast Texts...");
-    sObjectMgr.LoadBroadcastTexts();
-
-    sLog.outString("Loading Page Texts...");
-    sObjectMgr.LoadPageTexts();
-
-    sLog.outString("Loading Game Object Templates...");     // must be after LoadPageTexts
-    sObjectMgr.LoadGameobjectInfo();
-
-    sLog.outString("Loading Transport templates...");
-    sTransportMgr->LoadTransportTemplates();
-
-    sLog.outString("Loading Spell Chain Data...");
-    sSpellMgr.LoadSpellChains();
-
-    sLog.outString("Loading Spell Elixir types...");
-    sSpellMgr.LoadSpellElixirs();
-
-    sLog.outString("Loading Spell Learn Skills...");
-    sSpellMgr.LoadSpellLearnSkills();                       // must be after LoadSpellChains
-
-    sLog.outString("Loading Spell Learn Spells...");
-    sSpellMgr.LoadSpellLearnSpells();
-
-    sLog.outString("Loading Spell Proc Event conditions...");
-    sSpellMgr.LoadSpellProcEvents();
-
-    sLog.outString("Loading Spell Proc Item Enchant...");
-    sSpellMgr.LoadSpellProcItemEnchant();                   // must be after LoadSpellChains
-
-    sLog.outString("Loading Aggro Spells Definitions...");
-    sSpellMgr.LoadSpellThreats();
-
-    sLog.outString("Loading Spell Enchant Charges...");
-    sSpellMgr.LoadSpellEnchantCharges();
-
-    sLog.outString("Loading NPC Texts...");
-    sObjectMgr.LoadNPCText();
-
-    sLog.outString("Loading Item Random Enchantments Table...");
-    LoadRandomEnchantmentsTable();
-
-    sLog.outString("Loading Items...");                     // must be after LoadRandomEnchantmentsTable and LoadPageTexts
-    sObjectMgr.LoadItemPrototypes();
-
-    sLog.outString("Loading Item Texts...");
-    sObjectMgr.LoadItemTexts();
-
-    sLog.outString("Loading Creature Display Info Addon...");
-    sObjectMgr.LoadCreatureDisplayInfoAddon();
-
-    sLog.outString("Loading Equipment templates...");
-    sObjectMgr.LoadEquipmentTemplates();
-
-    sLog.outString("Loading Creature spells...");
-    sObjectMgr.LoadCreatureSpells();
-
-    sLog.outString("Loading Creature templates...");
-    sObjectMgr.LoadCreatureTemplates();
-
-    sLog.outString("Loading SpellsScriptTarget...");
-    sSpellMgr.LoadSpellScriptTarget();                      // must be after LoadCreatureTemplates and LoadGameobjectInfo
-
-    sLog.outString("Loading ItemRequiredTarget...");
-    sObjectMgr.LoadItemRequiredTarget();
-
-    sLog.outString("Loading Reputation Reward Rates...");
-    sObjectMgr.LoadReputationRewardRate();
-
-    sLog.outString("Loading Creature Reputation OnKill Data...");
-    sObjectMgr.LoadReputationOnKill();
-
-    sLog.outString("Loading Reputation Spillover Data...");
-    sObjectMgr.LoadReputationSpilloverTemplate();
-
-    sLog.outString("Loading Points Of Interest Data...");
-    sObjectMgr.LoadPointsOfInterest();
-
-    sLog.outString("Loading Pet Create Spells...");
-    sObjectMgr.LoadPetCreateSpells();
-
-    sLog.outString("Loading Creature Data...");
-    sObjectMgr.LoadCreatures();
-
-    sLog.outString("Loading Creature Addon Data...");
-    sLog.outString();
-    sObjectMgr.LoadCreatureAddons();                        // must be after LoadCreatureTemplates() and LoadCreatures()
-    sLog.outString(">>> Creature Addon Data loaded");
-    sLog.outString();
-
-    sLog.outString("Loading Creature Groups ...");
-    sCreatureGroupsManager->Load();
-
-    sLog.outString("Loading Gameobject Data...");
-    sObjectMgr.LoadGameobjects();
-
-    sLog.outString("Loading Gameobject Requirements...");
-    sObjectMgr.LoadGameobjectsRequirements();
-
-    sLog.outString("Loading Gameobject Display Info Addon...");
-    sObjectMgr.LoadGameObjectDisplayInfoAddon();
-
-    sLog.outString("Loading CreatureLinking Data...");      // must be after Creatures
-    sLog.outString();
-    sCreatureLinkingMgr.LoadFromDB();
-
-    sLog.outString("Loading Objects Pooling Data...");
-    sPoolMgr.LoadFromDB();
-
-    sLog.outString("Loading Weather Data...");
-    sWeatherMgr.LoadWeatherZoneChances();
-
-    sLog.outString("Loading Quests...");
-    sObjectMgr.LoadQuests();                                // must be loaded after DBCs, creature_template, item_template, gameobject tables
-
-    sLog.outString("Loading Quests Relations...");
-    sLog.outString();
-    sObjectMgr.LoadQuestRelations();                        // must be after quest load
-    sLog.outString(">>> Quests Relations loaded");
-    sLog.outString();
-
-    sLog.outString("Loading Quests Greetings...");          // must be loaded after creature_template
-    sObjectMgr.LoadQuestGreetings();
-
-    sLog.outString("Loading Trainer Greetings...");
-    sObjectMgr.LoadTrainerGreetings();
-
-    sLog.outString("Loading Game Event Data...");           // must be after sPoolMgr.LoadFromDB and quests to properly load pool events and quests for events, but before area trigger teleports
-    sLog.outString();
-    sGameEventMgr.LoadFromDB();
-    sLog.outString(">>> Game Event Data loaded");
-    sLog.outString();
-
-    // Load Conditions
-    sLog.outString("Loading Conditions ...");
-    sObjectMgr.LoadConditions();
-
-    sLog.outString("Loading Creature Respawn Data...");     // must be after LoadCreatures()
-    sMapPersistentStateMgr.LoadCreatureRespawnTimes();
-
-    sLog.outString("Loading Gameobject Respawn Data...");   // must be after LoadGameobjects()
-    sMapPersistentStateMgr.LoadGameobjectRespawnTimes();
-
-    sLog.outString("Loading SpellArea Data...");            // must be after quest load
-    sSpellMgr.LoadSpellAreas();
-
-    sLog.outString("Loading AreaTrigger teleports...");
-    sObjectMgr.LoadAreaTriggerTeleports();                  // must be after item template load
-
-    sLog.outString("Loading Quest Area Triggers...");
-    sObjectMgr.LoadQuestAreaTriggers();                     // must be after LoadQuests
-
-    sLog.outString("Loading Tavern Area Triggers...");
-    sObjectMgr.LoadTavernAreaTriggers();
-
-    sLog.outString("Loading Battleground Entrance Area Triggers...");
-    sObjectMgr.LoadBattlegroundEntranceTriggers();
-
-    sLog.outString("Loading AreaTrigger script names...");
-    sScriptMgr.LoadAreaTriggerScripts();
-
-    sLog.outString("Loading event id script names...");
-    sScriptMgr.LoadEventIdScripts();
-
-    sLog.outString("Loading Graveyard-zone links...");
-    sObjectMgr.LoadGraveyardZones();
-
-    sLog.outString("Loading spell target destination coordinates...");
-    sSpellMgr.LoadSpellTargetPositions();
-
-    sLog.outString("Loading SpellAffect definitions...");
-    sSpellMgr.LoadSpellAffects();
-
-    sLog.outString("Loading spell pet auras...");
-    sSpellMgr.LoadSpellPetAuras();
-
-    sLog.outString("Loading Player Create Info & Level Stats...");
-    sLog.outString();
-    sObjectMgr.LoadPlayerInfo();
-    sLog.outString(">>> Player Create Info & Level Stats loaded");
-    sLog.outString();
-
-    sLog.outString("Loading Exploration BaseXP Data...");
-    sObjectMgr.LoadExplorationBaseXP();
-
-    sLog.outString("Loading Pet Name Parts...");
-    sObjectMgr.LoadPetNames();
-
-    CharacterDatabaseCleaner::CleanDatabase();
-
-    sLog.outString("Loading character cache data...");
-    sObjectMgr.LoadPlayerCacheData();
-
-    sLog.outString("Loading the max pet number...");
-    sObjectMgr.LoadPetNumber();
-
-    sLog.outString("Loading pet level stats...");
-    sObjectMgr.LoadPetLevelInfo();
-
-    sLog.outString("Loading Player Corpses...");
-    sObjectMgr.LoadCorpses();
-
-    sLog.outString("Loading Loot Tables...");
-    sLog.outString();
-    LoadLootTables();
-    sLog.outString(">>> Loot Tables loaded");
-    sLog.outString();
-
-    sLog.outString("Loading Skill Fishing base level requirements...");
-    sObjectMgr.LoadFishingBaseSkillLevel();
-
-    sLog.outString("Loading Npc Text Id...");
-    sObjectMgr.LoadNpcGossips();                            // must be after load Creature and LoadNPCText
-
-    sLog.outString("Loading Gossip scripts...");
-    sScriptMgr.LoadGossipScripts();                         // must be before gossip menu options
-
-    sObjectMgr.LoadGossipMenus();
-
-    sLog.outString("Loading Vendors...");
-    sObjectMgr.LoadVendorTemplates();                       // must be after load ItemTemplate
-    sObjectMgr.LoadVendors();                               // must be after load CreatureTemplate, VendorTemplate, and ItemTemplate
-
-    sLog.outString("Loading Trainers...");
-    sObjectMgr.LoadTrainerTemplates();                      // must be after load CreatureTemplate
-    sObjectMgr.LoadTrainers();                              // must be after load CreatureTemplate, TrainerTemplate
-
-    sLog.outString("Loading Waypoint scripts...");          // before loading from creature_movement
-    sScriptMgr.LoadCreatureMovementScripts();
-
-    sLog.outString("Loading Waypoints...");
-    sLog.outString();
-    sWaypointMgr.Load();
-
-    ///- Loading localization data
-    sLog.outString("Loading Localization strings...");
-    sObjectMgr.LoadBroadcastTextLocales();
-    sObjectMgr.LoadCreatureLocales();                       // must be after CreatureInfo loading
-    sObjectMgr.LoadGameObjectLocales();                     // must be after GameobjectInfo loading
-    sObjectMgr.LoadItemLocales();                           // must be after ItemPrototypes loading
-    sObjectMgr.LoadQuestLocales();                          // must be after QuestTemplates loading
-    sObjectMgr.LoadPageTextLocales();                       // must be after PageText loading
-    sObjectMgr.LoadGossipMenuItemsLocales();                // must be after gossip menu items loading
-    sObjectMgr.LoadPointOfInterestLocales();                // must be after POI loading
-    sObjectMgr.LoadAreaLocales();
-    sLog.outString(">>> Localization strings loaded");
-    sLog.outString();
-
-    ///- Load dynamic data tables from the database
-    sLog.outString("Loading Auctions...");
-    sLog.outString();
-    sAuctionMgr.LoadAuctionHouses();
-    sAuctionMgr.LoadAuctionItems();
-    sAuctionMgr.LoadAuctions();
-    sLog.outString(">>> Auctions loaded");
-    sLog.outString();
-
-    sLog.outString("Loading Guilds...");
-    sGuildMgr.LoadGuilds();
+    ///- Load the world and characters tables, independent loaders may run concurrently
+    LoadStartupTables();
 
-    sLog.outString("Loading Petitions...");
-    sGuildMgr.LoadPetitions();
-
-    sLog.outString("Loading Groups...");
-    sObjectMgr.LoadGroups();
-
-    sLog.outString("Loading ReservedNames...");
-    sObjectMgr.LoadReservedPlayersNames();
-
-    sLog.outString("Loading GameObjects for quests...");
-    sObjectMgr.LoadGameObjectForQuests();
-
-    sLog.outString("Loading BattleMasters...");
-    sBattleGroundMgr.LoadBattleMastersEntry();
-
-    sLog.outString("Loading BattleGround event indexes...");
-    sBattleGroundMgr.LoadBattleEventIndexes();
-
-    sLog.outString("Loading GameTeleports...");
-    sObjectMgr.LoadGameTele();
-
-    sLog.outString("Loading Taxi path transitions...");
-    sObjectMgr.LoadTaxiPathTransitions();
-
-    sLog.outString("Loading GM tickets and surveys...");
-    sTicketMgr->Initialize();
-    sTicketMgr->LoadTickets();
-    sTicketMgr->LoadSurveys();
+    // Reloads must always see the database contents
+    SQLStorageBase::DisableSnapshots();
 
     ///- Handle outdated emails (delete/return)
     sLog.outString("Returning old mails...");
@@ -1781,6 +1538,591 @@ void World::SetInitialWorldSettings()
     sLog.outString("SERVER STARTUP TIME: %i minutes %i seconds", uStartInterval / 60000, (uStartInterval % 60000) / 1000);
 }
 
+void World::LoadStartupTables()
+{
+    // A loader may only run once the loaders it reads data from are done. Any order
+    // compatible with the dependencies is valid: with StartupLoaderThreads = 1 they
+    // run in declaration order on the world thread.
+    TaskGraph loaders;
+
+    loaders.add("BroadcastTexts", {}, []()
+    {
+        sLog.outString("Loading Broadcast Texts...");
+        sObjectMgr.LoadBroadcastTexts();
+    });
+
+    loaders.add("PageTexts", {}, []()
+    {
+        sLog.outString("Loading Page Texts...");
+        sObjectMgr.LoadPageTexts();
+    });
+
+    loaders.add("GameobjectInfo", { "PageTexts" }, []()
+    {
+        sLog.outString("Loading Game Object Templates...");
+        sObjectMgr.LoadGameobjectInfo();
+    });
+
+    loaders.add("TransportTemplates", { "GameobjectInfo" }, []()
+    {
+        sLog.outString("Loading Transport templates...");
+        sTransportMgr->LoadTransportTemplates();
+    });
+
+    loaders.add("SpellChains", {}, []()
+    {
+        sLog.outString("Loading Spell Chain Data...");
+        sSpellMgr.LoadSpellChains();
+    });
+
+    loaders.add("SpellElixirs", {}, []()
+    {
+        sLog.outString("Loading Spell Elixir types...");
+        sSpellMgr.LoadSpellElixirs();
+    });
+
+    loaders.add("SpellLearnSkills", { "SpellChains" }, []()
+    {
+        sLog.outString("Loading Spell Learn Skills...");
+        sSpellMgr.LoadSpellLearnSkills();
+    });
+
+    loaders.add("SpellLearnSpells", { "SpellChains" }, []()
+    {
+        sLog.outString("Loading Spell Learn Spells...");
+        sSpellMgr.LoadSpellLearnSpells();
+    });
+
+    loaders.add("SpellProcEvents", {}, []()
+    {
+        sLog.outString("Loading Spell Proc Event conditions...");
+        sSpellMgr.LoadSpellProcEvents();
+    });
+
+    loaders.add("SpellProcItemEnchant", { "SpellChains" }, []()
+    {
+        sLog.outString("Loading Spell Proc Item Enchant...");
+        sSpellMgr.LoadSpellProcItemEnchant();
+    });
+
+    loaders.add("SpellThreats", {}, []()
+    {
+        sLog.outString("Loading Aggro Spells Definitions...");
+        sSpellMgr.LoadSpellThreats();
+    });
+
+    loaders.add("SpellEnchantCharges", {}, []()
+    {
+        sLog.outString("Loading Spell Enchant Charges...");
+        sSpellMgr.LoadSpellEnchantCharges();
+    });
+
+    loaders.add("NPCText", { "BroadcastTexts" }, []()
+    {
+        sLog.outString("Loading NPC Texts...");
+        sObjectMgr.LoadNPCText();
+    });
+
+    loaders.add("RandomEnchantments", {}, []()
+    {
+        sLog.outString("Loading Item Random Enchantments Table...");
+        LoadRandomEnchantmentsTable();
+    });
+
+    loaders.add("ItemPrototypes", { "RandomEnchantments", "PageTexts" }, []()
+    {
+        sLog.outString("Loading Items...");
+        sObjectMgr.LoadItemPrototypes();
+    });
+
+    loaders.add("ItemTexts", {}, []()
+    {
+        sLog.outString("Loading Item Texts...");
+        sObjectMgr.LoadItemTexts();
+    });
+
+    loaders.add("CreatureDisplayInfoAddon", {}, []()
+    {
+        sLog.outString("Loading Creature Display Info Addon...");
+        sObjectMgr.LoadCreatureDisplayInfoAddon();
+    });
+
+    loaders.add("EquipmentTemplates", { "ItemPrototypes" }, []()
+    {
+        sLog.outString("Loading Equipment templates...");
+        sObjectMgr.LoadEquipmentTemplates();
+    });
+
+    // Script target checks look at the creature and gameobject templates
+    loaders.add("CreatureSpells", { "GameobjectInfo" }, []()
+    {
+        sLog.outString("Loading Creature spells...");
+        sObjectMgr.LoadCreatureSpells();
+    });
+
+    loaders.add("CreatureTemplates", { "CreatureDisplayInfoAddon", "EquipmentTemplates", "CreatureSpells" }, []()
+    {
+        sLog.outString("Loading Creature templates...");
+        sObjectMgr.LoadCreatureTemplates();
+    });
+
+    loaders.add("SpellScriptTarget", { "CreatureTemplates", "GameobjectInfo" }, []()
+    {
+        sLog.outString("Loading SpellsScriptTarget...");
+        sSpellMgr.LoadSpellScriptTarget();
+    });
+
+    loaders.add("ItemRequiredTarget", { "ItemPrototypes", "SpellScriptTarget" }, []()
+    {
+        sLog.outString("Loading ItemRequiredTarget...");
+        sObjectMgr.LoadItemRequiredTarget();
+    });
+
+    loaders.add("ReputationRewardRate", {}, []()
+    {
+        sLog.outString("Loading Reputation Reward Rates...");
+        sObjectMgr.LoadReputationRewardRate();
+    });
+
+    loaders.add("ReputationOnKill", { "CreatureTemplates" }, []()
+    {
+        sLog.outString("Loading Creature Reputation OnKill Data...");
+        sObjectMgr.LoadReputationOnKill();
+    });
+
+    loaders.add("ReputationSpillover", {}, []()
+    {
+        sLog.outString("Loading Reputation Spillover Data...");
+        sObjectMgr.LoadReputationSpilloverTemplate();
+    });
+
+    loaders.add("PointsOfInterest", {}, []()
+    {
+        sLog.outString("Loading Points Of Interest Data...");
+        sObjectMgr.LoadPointsOfInterest();
+    });
+
+    loaders.add("PetCreateSpells", { "CreatureTemplates" }, []()
+    {
+        sLog.outString("Loading Pet Create Spells...");
+        sObjectMgr.LoadPetCreateSpells();
+    });
+
+    loaders.add("Creatures", { "CreatureTemplates" }, []()
+    {
+        sLog.outString("Loading Creature Data...");
+        sObjectMgr.LoadCreatures();
+    });
+
+    loaders.add("CreatureAddons", { "Creatures" }, []()
+    {
+        sLog.outString("Loading Creature Addon Data...");
+        sLog.outString();
+        sObjectMgr.LoadCreatureAddons();
+        sLog.outString(">>> Creature Addon Data loaded");
+        sLog.outString();
+    });
+
+    loaders.add("CreatureGroups", { "Creatures" }, []()
+    {
+        sLog.outString("Loading Creature Groups ...");
+        sCreatureGroupsManager->Load();
+    });
+
+    loaders.add("Gameobjects", { "GameobjectInfo" }, []()
+    {
+        sLog.outString("Loading Gameobject Data...");
+        sObjectMgr.LoadGameobjects();
+    });
+
+    loaders.add("GameobjectsRequirements", { "Creatures", "Gameobjects" }, []()
+    {
+        sLog.outString("Loading Gameobject Requirements...");
+        sObjectMgr.LoadGameobjectsRequirements();
+    });
+
+    loaders.add("GameObjectDisplayInfoAddon", {}, []()
+    {
+        sLog.outString("Loading Gameobject Display Info Addon...");
+        sObjectMgr.LoadGameObjectDisplayInfoAddon();
+    });
+
+    loaders.add("CreatureLinking", { "Creatures" }, []()
+    {
+        sLog.outString("Loading CreatureLinking Data...");
+        sLog.outString();
+        sCreatureLinkingMgr.LoadFromDB();
+    });
+
+    loaders.add("Pools", { "Creatures", "Gameobjects" }, []()
+    {
+        sLog.outString("Loading Objects Pooling Data...");
+        sPoolMgr.LoadFromDB();
+    });
+
+    loaders.add("Weather", {}, []()
+    {
+        sLog.outString("Loading Weather Data...");
+        sWeatherMgr.LoadWeatherZoneChances();
+    });
+
+    // Quests, vendors and loot flag item prototypes as discovered, keep them on a single chain
+    loaders.add("Quests", { "ItemPrototypes", "CreatureTemplates", "GameobjectInfo" }, []()
+    {
+        sLog.outString("Loading Quests...");
+        sObjectMgr.LoadQuests();
+    });
+
+    loaders.add("QuestRelations", { "Quests" }, []()
+    {
+        sLog.outString("Loading Quests Relations...");
+        sLog.outString();
+        sObjectMgr.LoadQuestRelations();
+        sLog.outString(">>> Quests Relations loaded");
+        sLog.outString();
+    });
+
+    // Every loader of locale data may register a new locale index, they run one after another
+    loaders.add("QuestGreetings", { "CreatureTemplates" }, []()
+    {
+        sLog.outString("Loading Quests Greetings...");
+        sObjectMgr.LoadQuestGreetings();
+    });
+
+    loaders.add("TrainerGreetings", { "QuestGreetings" }, []()
+    {
+        sLog.outString("Loading Trainer Greetings...");
+        sObjectMgr.LoadTrainerGreetings();
+    });
+
+    loaders.add("GameEvents", { "Pools", "QuestRelations", "EquipmentTemplates" }, []()
+    {
+        sLog.outString("Loading Game Event Data...");
+        sLog.outString();
+        sGameEventMgr.LoadFromDB();
+        sLog.outString(">>> Game Event Data loaded");
+        sLog.outString();
+    });
+
+    // Conditions may refer to almost anything loaded above
+    loaders.add("Conditions", { "GameEvents" }, []()
+    {
+        sLog.outString("Loading Conditions ...");
+        sObjectMgr.LoadConditions();
+    });
+
+    // Both fill the persistent states of the maps
+    loaders.add("CreatureRespawnTimes", { "Creatures" }, []()
+    {
+        sLog.outString("Loading Creature Respawn Data...");
+        sMapPersistentStateMgr.LoadCreatureRespawnTimes();
+    });
+
+    loaders.add("GameobjectRespawnTimes", { "Gameobjects", "CreatureRespawnTimes" }, []()
+    {
+        sLog.outString("Loading Gameobject Respawn Data...");
+        sMapPersistentStateMgr.LoadGameobjectRespawnTimes();
+    });
+
+    loaders.add("SpellAreas", { "Conditions" }, []()
+    {
+        sLog.outString("Loading SpellArea Data...");
+        sSpellMgr.LoadSpellAreas();
+    });
+
+    loaders.add("AreaTriggerTeleports", { "Conditions" }, []()
+    {
+        sLog.outString("Loading AreaTrigger teleports...");
+        sObjectMgr.LoadAreaTriggerTeleports();
+    });
+
+    loaders.add("QuestAreaTriggers", { "Quests" }, []()
+    {
+        sLog.outString("Loading Quest Area Triggers...");
+        sObjectMgr.LoadQuestAreaTriggers();
+    });
+
+    loaders.add("TavernAreaTriggers", {}, []()
+    {
+        sLog.outString("Loading Tavern Area Triggers...");
+        sObjectMgr.LoadTavernAreaTriggers();
+    });
+
+    loaders.add("BattlegroundEntranceTriggers", {}, []()
+    {
+        sLog.outString("Loading Battleground Entrance Area Triggers...");
+        sObjectMgr.LoadBattlegroundEntranceTriggers();
+    });
+
+    loaders.add("AreaTriggerScripts", {}, []()
+    {
+        sLog.outString("Loading AreaTrigger script names...");
+        sScriptMgr.LoadAreaTriggerScripts();
+    });
+
+    loaders.add("EventIdScripts", { "GameobjectInfo" }, []()
+    {
+        sLog.outString("Loading event id script names...");
+        sScriptMgr.LoadEventIdScripts();
+    });
+
+    loaders.add("GraveyardZones", {}, []()
+    {
+        sLog.outString("Loading Graveyard-zone links...");
+        sObjectMgr.LoadGraveyardZones();
+    });
+
+    loaders.add("SpellTargetPositions", {}, []()
+    {
+        sLog.outString("Loading spell target destination coordinates...");
+        sSpellMgr.LoadSpellTargetPositions();
+    });
+
+    loaders.add("SpellAffects", {}, []()
+    {
+        sLog.outString("Loading SpellAffect definitions...");
+        sSpellMgr.LoadSpellAffects();
+    });
+
+    loaders.add("SpellPetAuras", {}, []()
+    {
+        sLog.outString("Loading spell pet auras...");
+        sSpellMgr.LoadSpellPetAuras();
+    });
+
+    loaders.add("PlayerInfo", { "ItemPrototypes" }, []()
+    {
+        sLog.outString("Loading Player Create Info & Level Stats...");
+        sLog.outString();
+        sObjectMgr.LoadPlayerInfo();
+        sLog.outString(">>> Player Create Info & Level Stats loaded");
+        sLog.outString();
+    });
+
+    loaders.add("ExplorationBaseXP", {}, []()
+    {
+        sLog.outString("Loading Exploration BaseXP Data...");
+        sObjectMgr.LoadExplorationBaseXP();
+    });
+
+    loaders.add("PetNames", {}, []()
+    {
+        sLog.outString("Loading Pet Name Parts...");
+        sObjectMgr.LoadPetNames();
+    });
+
+    loaders.add("CleanCharacterDB", {}, []()
+    {
+        CharacterDatabaseCleaner::CleanDatabase();
+    });
+
+    loaders.add("PlayerCacheData", { "CleanCharacterDB" }, []()
+    {
+        sLog.outString("Loading character cache data...");
+        sObjectMgr.LoadPlayerCacheData();
+    });
+
+    loaders.add("PetNumber", {}, []()
+    {
+        sLog.outString("Loading the max pet number...");
+        sObjectMgr.LoadPetNumber();
+    });
+
+    loaders.add("PetLevelInfo", { "CreatureTemplates" }, []()
+    {
+        sLog.outString("Loading pet level stats...");
+        sObjectMgr.LoadPetLevelInfo();
+    });
+
+    loaders.add("Corpses", { "PlayerCacheData" }, []()
+    {
+        sLog.outString("Loading Player Corpses...");
+        sObjectMgr.LoadCorpses();
+    });
+
+    loaders.add("LootTables", { "Conditions" }, []()
+    {
+        sLog.outString("Loading Loot Tables...");
+        sLog.outString();
+        LoadLootTables();
+        sLog.outString(">>> Loot Tables loaded");
+        sLog.outString();
+    });
+
+    loaders.add("FishingBaseSkillLevel", {}, []()
+    {
+        sLog.outString("Loading Skill Fishing base level requirements...");
+        sObjectMgr.LoadFishingBaseSkillLevel();
+    });
+
+    loaders.add("NpcGossips", { "Creatures", "NPCText" }, []()
+    {
+        sLog.outString("Loading Npc Text Id...");
+        sObjectMgr.LoadNpcGossips();
+    });
+
+    loaders.add("GossipScripts", { "Conditions", "BroadcastTexts" }, []()
+    {
+        sLog.outString("Loading Gossip scripts...");
+        sScriptMgr.LoadGossipScripts();
+    });
+
+    loaders.add("GossipMenus", { "GossipScripts", "NPCText", "PointsOfInterest" }, []()
+    {
+        sObjectMgr.LoadGossipMenus();
+    });
+
+    loaders.add("Vendors", { "Conditions" }, []()
+    {
+        sLog.outString("Loading Vendors...");
+        sObjectMgr.LoadVendorTemplates();
+        sObjectMgr.LoadVendors();
+    });
+
+    loaders.add("Trainers", { "CreatureTemplates", "SpellChains" }, []()
+    {
+        sLog.outString("Loading Trainers...");
+        sObjectMgr.LoadTrainerTemplates();
+        sObjectMgr.LoadTrainers();
+    });
+
+    // Same script loader as the gossip scripts
+    loaders.add("CreatureMovementScripts", { "GossipScripts" }, []()
+    {
+        sLog.outString("Loading Waypoint scripts...");
+        sScriptMgr.LoadCreatureMovementScripts();
+    });
+
+    loaders.add("Waypoints", { "CreatureMovementScripts" }, []()
+    {
+        sLog.outString("Loading Waypoints...");
+        sLog.outString();
+        sWaypointMgr.Load();
+    });
+
+    loaders.add("Locales", { "TrainerGreetings", "ItemPrototypes", "QuestRelations", "GossipMenus" }, []()
+    {
+        sLog.outString("Loading Localization strings...");
+        sObjectMgr.LoadBroadcastTextLocales();
+        sObjectMgr.LoadCreatureLocales();
+        sObjectMgr.LoadGameObjectLocales();
+        sObjectMgr.LoadItemLocales();
+        sObjectMgr.LoadQuestLocales();
+        sObjectMgr.LoadPageTextLocales();
+        sObjectMgr.LoadGossipMenuItemsLocales();
+        sObjectMgr.LoadPointOfInterestLocales();
+        sObjectMgr.LoadAreaLocales();
+        sLog.outString(">>> Localization strings loaded");
+        sLog.outString();
+    });
+
+    loaders.add("Auctions", { "ItemPrototypes", "PlayerCacheData" }, []()
+    {
+        sLog.outString("Loading Auctions...");
+        sLog.outString();
+        sAuctionMgr.LoadAuctionHouses();
+        sAuctionMgr.LoadAuctionItems();
+        sAuctionMgr.LoadAuctions();
+        sLog.outString(">>> Auctions loaded");
+        sLog.outString();
+    });
+
+    loaders.add("Guilds", { "PlayerCacheData" }, []()
+    {
+        sLog.outString("Loading Guilds...");
+        sGuildMgr.LoadGuilds();
+    });
+
+    loaders.add("Petitions", { "Guilds" }, []()
+    {
+        sLog.outString("Loading Petitions...");
+        sGuildMgr.LoadPetitions();
+    });
+
+    loaders.add("Groups", { "PlayerCacheData", "GameobjectRespawnTimes" }, []()
+    {
+        sLog.outString("Loading Groups...");
+        sObjectMgr.LoadGroups();
+    });
+
+    loaders.add("ReservedNames", {}, []()
+    {
+        sLog.outString("Loading ReservedNames...");
+        sObjectMgr.LoadReservedPlayersNames();
+    });
+
+    loaders.add("GameObjectForQuests", { "QuestRelations", "LootTables" }, []()
+    {
+        sLog.outString("Loading GameObjects for quests...");
+        sObjectMgr.LoadGameObjectForQuests();
+    });
+
+    loaders.add("BattleMasters", {}, []()
+    {
+        sLog.outString("Loading BattleMasters...");
+        sBattleGroundMgr.LoadBattleMastersEntry();
+    });
+
+    loaders.add("BattleEventIndexes", { "BattleMasters", "Creatures", "Gameobjects" }, []()
+    {
+        sLog.outString("Loading BattleGround event indexes...");
+        sBattleGroundMgr.LoadBattleEventIndexes();
+    });
+
+    loaders.add("GameTeleports", {}, []()
+    {
+        sLog.outString("Loading GameTeleports...");
+        sObjectMgr.LoadGameTele();
+    });
+
+    loaders.add("TaxiPathTransitions", {}, []()
+    {
+        sLog.outString("Loading Taxi path transitions...");
+        sObjectMgr.LoadTaxiPathTransitions();
+    });
+
+    loaders.add("Tickets", { "PlayerCacheData" }, []()
+    {
+        sLog.outString("Loading GM tickets and surveys...");
+        sTicketMgr->Initialize();
+        sTicketMgr->LoadTickets();
+        sTicketMgr->LoadSurveys();
+    });
+
+    int const numThreads = getConfig(CONFIG_UINT32_STARTUP_LOADER_THREADS);
+    if (numThreads > 1)
+    {
+        // Singletons are not created in a thread safe way, create the ones several loaders share first
+        MapManager::Instance();
+        TerrainManager::Instance();
+        ObjectAccessor::Instance();
+
+        sLog.outString("Running startup loaders on %i threads", numThreads);
+    }
+
+    // Progress bars of concurrent loaders would overwrite each other
+    bool const showProgressBars = BarGoLink::GetOutputState();
+    if (numThreads > 1)
+        BarGoLink::SetOutputState(false);
+
+    loaders.run(numThreads,
+        []()
+        {
+            WorldDatabase.ThreadStart();
+            CharacterDatabase.ThreadStart();
+            LoginDatabase.ThreadStart();
+        },
+        []()
+        {
+            WorldDatabase.ThreadEnd();
+            CharacterDatabase.ThreadEnd();
+            LoginDatabase.ThreadEnd();
+        });
+
+    BarGoLink::SetOutputState(showProgressBars);
+    loaders.logTimings("Startup loaders");
+}
+
 void World::DetectDBCLang()
 {
     uint32 m_lang_confid = sConfig.GetIntDefault("DBC.Locale", 255);
@@ -1828,6 +2170,7 @@ void World::DetectDBCLang()
 /// Update the World !
 void World::Update(uint32 diff)
 {
+    TICK_PROFILE_SCOPE("World::Update");
     m_currentMSTime = WorldTimer::getMSTime();
     m_currentTime = std::chrono::time_point_cast<std::chrono::milliseconds>(Clock::now());
     m_currentDiff = diff;
@@ -1926,6 +2269,14 @@ void World::Update(uint32 diff)
         sObjectMgr.SaveVariables();
     }
 
+    ///- Write the opcode handler counters
+    if (getConfig(CONFIG_UINT32_OPCODE_PROFILER_DUMP_INTERVAL) && m_timers[WUPDATE_OPCODES].Passed())
+    {
+        m_timers[WUPDATE_OPCODES].Reset();
+        if (!m_opcodeProfilerFile.empty())
+            sOpcodeProfiler.Dump(m_opcodeProfilerFile);
+    }
+
     // execute callbacks from sql queries that were queued recently
     uint32 asyncQueriesTime = WorldTimer::getMSTime();
     UpdateResultQueue();
@@ -2527,6 +2878,7 @@ void World::SendServerMessage(ServerMessageType type, char const* text, Player*
 
 void World::UpdateSessions(uint32 diff)
 {
+    TICK_PROFILE_SCOPE("World::UpdateSessions");
     ///- Update player limit if needed
     int32 hardPlayerLimit = getConfig(CONFIG_UINT32_PLAYER_HARD_LIMIT);
     if (hardPlayerLimit)
@@ -2671,6 +3023,27 @@ void World::UpdateMaxSessionCounters()
     m_maxQueuedSessionCount = std::max(m_maxQueuedSessionCount, uint32(m_QueuedSessions.size()));
 }
 
+void World::AddCharacterSave(uint32 guidLow, bool fullSave, uint32 statements, uint32 bytes)
+{
+    std::lock_guard<std::mutex> guard(m_characterSaveStatsMutex);
+    ++m_characterSaveStats.saves;
+    if (fullSave)
+        ++m_characterSaveStats.fullSaves;
+    m_characterSaveStats.statements += statements;
+    m_characterSaveStats.bytes += bytes;
+    if (bytes > m_characterSaveStats.largestBytes)
+    {
+        m_characterSaveStats.largestBytes = bytes;
+        m_characterSaveStats.largestGuid = guidLow;
+    }
+}
+
+World::CharacterSaveStats World::GetCharacterSaveStats() const
+{
+    std::lock_guard<std::mutex> guard(m_characterSaveStatsMutex);
+    return m_characterSaveStats;
+}
+
 void World::setConfig(eConfigUInt32Values index, char const* fieldname, uint32 defvalue)
 {
     setConfig(index, sConfig.GetIntDefault(fieldname, defvalue));
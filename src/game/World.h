@@ -84,7 +84,8 @@ enum WorldTimers
     WUPDATE_EVENTS      = 3,
     WUPDATE_SAVE_VAR    = 4,
     WUPDATE_GROUPS      = 5,
-    WUPDATE_COUNT       = 6
+    WUPDATE_OPCODES     = 6,
+    WUPDATE_COUNT       = 7
 };
 
 /// Configuration elements
@@ -136,7 +137,17 @@ enum eConfigUInt32Values
     CONFIG_UINT32_DYN_RESPAWN_AFFECT_LEVEL_BELOW,
     CONFIG_UINT32_MTCELLS_THREADS,
     CONFIG_UINT32_MTCELLS_SAFEDISTANCE,
-    CONFIG_UINT32_MAPUPDATE_INSTANCED_UPDATE_THREADS,
+    CONFIG_UINT32_MAPUPDATE_WORKER_THREADS,
+    CONFIG_UINT32_GRID_PRELOAD_THREADS,
+    CONFIG_UINT32_GRID_PRELOAD_INTERVAL,
+    CONFIG_UINT32_GRID_PRELOAD_LOOKAHEAD,
+    CONFIG_UINT32_VISIBILITY_TIERS_CROWD,
+    CONFIG_UINT32_VISIBILITY_TIERS_MID_INTERVAL,
+    CONFIG_UINT32_VISIBILITY_TIERS_FAR_INTERVAL,
+    CONFIG_UINT32_MMAP_CORRIDOR_CACHE_SIZE,
+    CONFIG_UINT32_STARTUP_LOADER_THREADS,
+    CONFIG_UINT32_PLAYER_FULL_SAVE_EVERY,
+    CONFIG_UINT32_LOGIN_CACHE_TIME,
     CONFIG_UINT32_MAPUPDATE_UPDATE_PACKETS_DIFF,
     CONFIG_UINT32_MAPUPDATE_UPDATE_PLAYERS_DIFF,
     CONFIG_UINT32_MAPUPDATE_UPDATE_CELLS_DIFF,
@@ -159,6 +170,8 @@ enum eConfigUInt32Values
     CONFIG_UINT32_PERFLOG_SLOW_PACKET,
     CONFIG_UINT32_PERFLOG_SLOW_MAP_PACKETS,
     CONFIG_UINT32_PERFLOG_SLOW_PACKET_BCAST,
+    CONFIG_UINT32_OPCODE_PROFILER_DUMP_INTERVAL,
+    CONFIG_UINT32_TICK_PROFILER_BUFFER_SIZE,
     CONFIG_UINT32_ASYNC_QUERIES_TICK_TIMEOUT,
     CONFIG_UINT32_LOGIN_PER_TICK,
     CONFIG_UINT32_ANTICRASH_REARM_TIMER,
@@ -365,6 +378,8 @@ enum eConfigFloatValues
     CONFIG_FLOAT_RATE_HEALTH = 0,
     CONFIG_FLOAT_MAX_CREATURE_ATTACK_RADIUS,
     CONFIG_FLOAT_MAX_PLAYERS_STEALTH_DETECT_RANGE,
+    CONFIG_FLOAT_VISIBILITY_TIERS_NEAR_DISTANCE,
+    CONFIG_FLOAT_VISIBILITY_TIERS_MID_DISTANCE,
     CONFIG_FLOAT_DYN_RESPAWN_CHECK_RANGE,
     CONFIG_FLOAT_DYN_RESPAWN_PERCENT_PER_PLAYER,
     CONFIG_FLOAT_DYN_RESPAWN_MAX_REDUCTION_RATE,
@@ -464,6 +479,7 @@ enum eConfigBoolValues
     CONFIG_BOOL_SMARTLOG_SCRIPTINFO,
     CONFIG_BOOL_TERRAIN_PRELOAD_CONTINENTS,
     CONFIG_BOOL_TERRAIN_PRELOAD_INSTANCES,
+    CONFIG_BOOL_TERRAIN_MEMORY_MAPPED,
     CONFIG_BOOL_CLEANUP_TERRAIN,
     CONFIG_BOOL_OUTDOORPVP_EP_ENABLE,
     CONFIG_BOOL_OUTDOORPVP_SI_ENABLE,
@@ -590,6 +606,9 @@ enum eConfigBoolValues
     CONFIG_BOOL_PLAYER_BOT_SHOW_IN_WHO_LIST,
     CONFIG_BOOL_PARTY_BOT_SKIP_CHECKS,
     CONFIG_BOOL_WORLD_AVAILABLE,
+    CONFIG_BOOL_MAP_OBJECTSUPDATE_SHARED_BLOCKS,
+    CONFIG_BOOL_OPCODE_PROFILER,
+    CONFIG_BOOL_TICK_PROFILER,
     CONFIG_BOOL_VALUE_COUNT
 };
 
@@ -722,6 +741,19 @@ class World
         uint32 GetMaxQueuedSessionCount() const { return m_maxQueuedSessionCount; }
         uint32 GetMaxActiveSessionCount() const { return m_maxActiveSessionCount; }
 
+        /// Size of the character save transactions since last reboot
+        struct CharacterSaveStats
+        {
+            uint64 saves = 0;
+            uint64 fullSaves = 0;
+            uint64 statements = 0;
+            uint64 bytes = 0;
+            uint32 largestBytes = 0;
+            uint32 largestGuid = 0;
+        };
+        void AddCharacterSave(uint32 guidLow, bool fullSave, uint32 statements, uint32 bytes);
+        CharacterSaveStats GetCharacterSaveStats() const;
+
         /// Get the active session server limit (or security level limitations)
         uint32 GetPlayerAmountLimit() const { return m_playerLimit >= 0 ? m_playerLimit : 0; }
         AccountTypes GetPlayerSecurityLimit() const { return m_playerLimit <= 0 ? AccountTypes(-m_playerLimit) : SEC_PLAYER; }
@@ -963,6 +995,10 @@ class World
         uint32 m_maxActiveSessionCount = 0;
         uint32 m_maxQueuedSessionCount = 0;
 
+        // players are saved from the map threads
+        mutable std::mutex m_characterSaveStatsMutex;
+        CharacterSaveStats m_characterSaveStats;
+
         uint32 m_configUint32Values[CONFIG_UINT32_VALUE_COUNT];
         int32 m_configInt32Values[CONFIG_INT32_VALUE_COUNT];
         float m_configFloatValues[CONFIG_FLOAT_VALUE_COUNT];
@@ -974,11 +1010,13 @@ class World
         LocaleConstant m_defaultDbcLocale;                     // from config for one from loaded DBC locales
         uint32 m_availableDbcLocaleMask = 0;                       // by loaded DBC
         void DetectDBCLang();
+        void LoadStartupTables();
         bool m_allowMovement;
         std::string m_motd;
         std::string m_dataPath;
         std::string m_honorPath;
         std::string m_wardenModuleDirectory;
+        std::string m_opcodeProfilerFile;
 
         // for max speed access
         static float m_MaxVisibleDistanceOnContinents;
@@ -28,6 +28,7 @@
 #include "Database/DatabaseEnv.h"
 #include "Log.h"
 #include "Opcodes.h"
+#include "OpcodeProfiler.h"
 #include "WorldPacket.h"
 #include "WorldSession.h"
 #include "Player.h"
@@ -459,6 +460,8 @@ void WorldSession::ProcessPackets(PacketFilter& updater)
         }
         ALL_SESSION_SCRIPTS(this, OnPacket(packet->GetOpcode()));
         OpcodeHandler const& opHandle = opcodeTable[packet->GetOpcode()];
+        bool const profile = sOpcodeProfiler.IsEnabled();
+        uint64 const profileStart = profile ? OpcodeProfiler::Now() : 0;
         try
         {
             uint32 packetTime = WorldTimer::getMSTime();
@@ -555,6 +558,9 @@ void WorldSession::ProcessPackets(PacketFilter& updater)
             ProcessAnticheatAction("Anticrash", "Exception raised", CHEAT_ACTION_KICK);
         }
 
+        if (profile)
+            sOpcodeProfiler.Record(packet->GetOpcode(), updater.PacketProcessType(), profileStart, packet->size());
+
         delete packet;
     }
 }
@@ -596,6 +602,7 @@ void WorldSession::LogoutPlayer(bool Save)
     m_playerLogout = true;
     m_playerSave = Save;
     bool doBanPlayer = false;
+    ObjectGuid savedGuid;
 
     if (_player)
     {
@@ -702,7 +709,10 @@ void WorldSession::LogoutPlayer(bool Save)
         ///- empty buyback items and save the player in the database
         // some save parts only correctly work in case player present in map/player_lists (pets, etc)
         if (Save)
+        {
             _player->SaveToDB(false, removedFromMap);
+            savedGuid = _player->GetObjectGuid();
+        }
 
         ///- Leave all channels before player delete...
         _player->CleanupChannels();
@@ -762,6 +772,10 @@ void WorldSession::LogoutPlayer(bool Save)
         m_masterPlayer = nullptr;
     }
 
+    // after every write of the logout, they share the serial queue of the character
+    if (!savedGuid.IsEmpty())
+        PrefetchLoginQueries(savedGuid);
+
     m_playerLogout = false;
     m_playerSave = false;
     m_playerRecentlyLogout = true;
@@ -326,6 +326,9 @@ class WorldSession
         }
 
         void LogoutPlayer(bool Save);
+        // loads the login data the character alone writes to ahead of its next login
+        static void PrefetchLoginQueries(ObjectGuid guid);
+        static void ForgetPrefetchedLogin(ObjectGuid guid);
         void KickPlayer();
         // Session can be safely deleted if returns false
         bool ForcePlayerLogoutDelay();
@@ -31,6 +31,7 @@ This is the minimum interface to the VMapMamager.
 namespace VMAP
 {
     class ModelInstance;
+    struct StaticMapTile;
 
     enum VMAPLoadResult
     {
@@ -42,6 +43,13 @@ namespace VMAP
 #define VMAP_INVALID_HEIGHT       -100000.0f            // for check
 #define VMAP_INVALID_HEIGHT_VALUE -200000.0f            // real assigned value in unknown height case
 
+    // one ray of a batched line of sight query
+    struct LineOfSightQuery
+    {
+        float x1, y1, z1;
+        float x2, y2, z2;
+    };
+
     //===========================================================
     class IVMapManager
     {
@@ -56,6 +64,12 @@ namespace VMAP
             virtual ~IVMapManager(void) {}
 
             virtual VMAPLoadResult loadMap(char const* pBasePath, unsigned int pMapId, int x, int y) = 0;
+            /**
+            Load in two steps: readMapTile does the file reads and changes nothing, it may run along the queries and the other loads.
+            loadMap then adds the tile, as the other loadMap.
+            */
+            virtual void readMapTile(char const* pBasePath, unsigned int pMapId, int x, int y, StaticMapTile& tile) = 0;
+            virtual VMAPLoadResult loadMap(char const* pBasePath, unsigned int pMapId, int x, int y, StaticMapTile const& tile) = 0;
 
             virtual bool existsMap(char const* pBasePath, unsigned int pMapId, int x, int y) = 0;
 
@@ -65,6 +79,14 @@ namespace VMAP
             virtual bool isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2) = 0;
             virtual float getHeight(unsigned int pMapId, float x, float y, float z, float maxSearchDist) = 0;
             /**
+            batched version of isInLineOfSight, results[i] is the answer for queries[i]
+            */
+            virtual void isInLineOfSight(unsigned int pMapId, LineOfSightQuery const* queries, uint32 count, bool* results)
+            {
+                for (uint32 i = 0; i < count; ++i)
+                    results[i] = isInLineOfSight(pMapId, queries[i].x1, queries[i].y1, queries[i].z1, queries[i].x2, queries[i].y2, queries[i].z2);
+            }
+            /**
             test if we hit an object. return true if we hit one. rx,ry,rz will hold the hit position or the dest position, if no intersection was found
             return a position, that is pReduceDist closer to the origin
             */
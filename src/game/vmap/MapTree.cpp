@@ -389,6 +389,57 @@ void StaticMapTree::UnloadMap(VMapManager2* vm)
 //=========================================================
 
 bool StaticMapTree::LoadMapTile(uint32 tileX, uint32 tileY, VMapManager2* vm)
+{
+    StaticMapTile tile;
+    if (iIsTiled && iTreeValues)
+        ReadMapTile(iBasePath, iMapID, tileX, tileY, vm, tile);
+    return LoadMapTile(tileX, tileY, tile);
+}
+
+//=========================================================
+
+void StaticMapTree::ReadMapTile(std::string const& basePath, uint32 mapID, uint32 tileX, uint32 tileY, VMapManager2* vm, StaticMapTile& tile)
+{
+    std::string path = basePath;
+    if (path.length() > 0 && (path[path.length() - 1] != '/' && path[path.length() - 1] != '\\'))
+        path.append("/");
+
+    std::string tilefile = path + getTileFileName(mapID, tileX, tileY);
+    FILE* tf = fopen(tilefile.c_str(), "rb");
+    if (!tf)
+        return;
+
+    tile.exists = true;
+    char chunk[8];
+    if (!readChunk(tf, chunk, VMAP_MAGIC, 8))
+        tile.valid = false;
+    uint32 numSpawns = 0;
+    if (tile.valid && fread(&numSpawns, sizeof(uint32), 1, tf) != 1)
+        tile.valid = false;
+    for (uint32 i = 0; i < numSpawns && tile.valid; ++i)
+    {
+        // read model spawns
+        ModelSpawn spawn;
+        tile.valid = ModelSpawn::readFromFile(tf, spawn);
+        if (tile.valid)
+        {
+            // acquire model instance
+            std::shared_ptr<WorldModel> model = vm->acquireModelInstance(path, spawn.name);
+            if (model == nullptr)
+                ERROR_LOG("StaticMapTree::LoadMapTile() could not acquire WorldModel pointer for '%s'!", spawn.name.c_str());
+
+            uint32 referencedVal;
+
+            fread(&referencedVal, sizeof(uint32), 1, tf);
+            tile.spawns.emplace_back(referencedVal, ModelInstance(spawn, model));
+        }
+    }
+    fclose(tf);
+}
+
+//=========================================================
+
+bool StaticMapTree::LoadMapTile(uint32 tileX, uint32 tileY, StaticMapTile const& tile)
 {
     if (!iIsTiled)
     {
@@ -402,62 +453,34 @@ bool StaticMapTree::LoadMapTile(uint32 tileX, uint32 tileY, VMapManager2* vm)
         ERROR_LOG("StaticMapTree::LoadMapTile(): Tree has not been initialized! [%u,%u]", tileX, tileY);
         return false;
     }
-    bool result = true;
 
-    std::string tilefile = iBasePath + getTileFileName(iMapID, tileX, tileY);
-    FILE* tf = fopen(tilefile.c_str(), "rb");
-    if (tf)
+    // update tree
+    for (auto const& spawn : tile.spawns)
     {
-        char chunk[8];
-        if (!readChunk(tf, chunk, VMAP_MAGIC, 8))
-            result = false;
-        uint32 numSpawns = 0;
-        if (result && fread(&numSpawns, sizeof(uint32), 1, tf) != 1)
-            result = false;
-        for (uint32 i = 0; i < numSpawns && result; ++i)
+        uint32 const referencedVal = spawn.first;
+        if (!iLoadedSpawns.count(referencedVal))
         {
-            // read model spawns
-            ModelSpawn spawn;
-            result = ModelSpawn::readFromFile(tf, spawn);
-            if (result)
+            if (referencedVal > iNTreeValues)
             {
-                // acquire model instance
-                std::shared_ptr<WorldModel> model = vm->acquireModelInstance(iBasePath, spawn.name);
-                if (model == nullptr)
-                    ERROR_LOG("StaticMapTree::LoadMapTile() could not acquire WorldModel pointer for '%s'!", spawn.name.c_str());
-
-                // update tree
-                uint32 referencedVal;
-
-                fread(&referencedVal, sizeof(uint32), 1, tf);
-                if (!iLoadedSpawns.count(referencedVal))
-                {
-                    if (referencedVal > iNTreeValues)
-                    {
-                        ERROR_LOG("invalid tree element! (%u/%u)", referencedVal, iNTreeValues);
-                        continue;
-                    }
-                    iTreeValues[referencedVal] = ModelInstance(spawn, model);
-                    iLoadedSpawns[referencedVal] = 1;
-                }
-                else
-                {
-                    ++iLoadedSpawns[referencedVal];
+                ERROR_LOG("invalid tree element! (%u/%u)", referencedVal, iNTreeValues);
+                continue;
+            }
+            iTreeValues[referencedVal] = spawn.second;
+            iLoadedSpawns[referencedVal] = 1;
+        }
+        else
+        {
+            ++iLoadedSpawns[referencedVal];
 #ifdef VMAP_DEBUG
-                    if (iTreeValues[referencedVal].ID != spawn.ID)
-                        DEBUG_LOG("Error: trying to load wrong spawn in node!");
-                    else if (iTreeValues[referencedVal].name != spawn.name)
-                        DEBUG_LOG("Error: name mismatch on GUID=%u", spawn.ID);
+            if (iTreeValues[referencedVal].ID != spawn.second.ID)
+                DEBUG_LOG("Error: trying to load wrong spawn in node!");
+            else if (iTreeValues[referencedVal].name != spawn.second.name)
+                DEBUG_LOG("Error: name mismatch on GUID=%u", spawn.second.ID);
 #endif
-                }
-            }
         }
-        iLoadedTiles[packTileID(tileX, tileY)] = true;
-        fclose(tf);
     }
-    else
-        iLoadedTiles[packTileID(tileX, tileY)] = false;
-    return result;
+    iLoadedTiles[packTileID(tileX, tileY)] = tile.exists;
+    return tile.valid;
 }
 
 //=========================================================
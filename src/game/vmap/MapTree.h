@@ -21,7 +21,9 @@
 
 #include "Platform/Define.h"
 #include <unordered_map>
+#include <vector>
 #include "BIH.h"
+#include "ModelInstance.h"
 
 namespace VMAP
 {
@@ -29,6 +31,15 @@ namespace VMAP
     class GroupModel;
     class VMapManager2;
 
+    // Spawns of a tile file with their models, read before being added to a tree
+    struct StaticMapTile
+    {
+        StaticMapTile() : exists(false), valid(true) {}
+        bool exists;                                        // the tile has a file
+        bool valid;                                         // the file was read without error
+        std::vector<std::pair<uint32, ModelInstance>> spawns;   // <tree_index, spawn>
+    };
+
     struct LocationInfo
     {
         LocationInfo() : hitInstance(nullptr), hitModel(nullptr), ground_Z(-G3D::inf()) {};
@@ -64,6 +75,8 @@ namespace VMAP
             static uint32 packTileID(uint32 tileX, uint32 tileY) { return tileX << 16 | tileY; }
             static void unpackTileID(uint32 ID, uint32& tileX, uint32& tileY) { tileX = ID >> 16; tileY = ID & 0xFF; }
             static bool CanLoadMap(std::string const& vmapPath, uint32 mapID, uint32 tileX, uint32 tileY);
+            // reads the tile file and acquires its models, changes no tree
+            static void ReadMapTile(std::string const& basePath, uint32 mapID, uint32 tileX, uint32 tileY, VMapManager2* vm, StaticMapTile& tile);
 
             StaticMapTree(uint32 mapID, std::string const& basePath);
             ~StaticMapTree();
@@ -79,6 +92,7 @@ namespace VMAP
             bool InitMap(std::string const& fname, VMapManager2* vm);
             void UnloadMap(VMapManager2* vm);
             bool LoadMapTile(uint32 tileX, uint32 tileY, VMapManager2* vm);
+            bool LoadMapTile(uint32 tileX, uint32 tileY, StaticMapTile const& tile);
             void UnloadMapTile(uint32 tileX, uint32 tileY, VMapManager2* vm);
             bool isTiled() const { return iIsTiled; }
             uint32 numLoadedTiles() const { return iLoadedTiles.size(); }
@@ -17,6 +17,7 @@
  */
 
 #include <iomanip>
+#include <algorithm>
 #include <string>
 #include <sstream>
 #include "VMapManager2.h"
@@ -82,10 +83,29 @@ VMAPLoadResult VMapManager2::loadMap(char const* pBasePath, unsigned int pMapId,
     return result;
 }
 
+void VMapManager2::readMapTile(char const* pBasePath, unsigned int pMapId, int x, int y, StaticMapTile& tile)
+{
+    if (isMapLoadingEnabled())
+        StaticMapTree::ReadMapTile(pBasePath, pMapId, x, y, this, tile);
+}
+
+VMAPLoadResult VMapManager2::loadMap(char const* pBasePath, unsigned int pMapId, int x, int y, StaticMapTile const& tile)
+{
+    VMAPLoadResult result = VMAP_LOAD_RESULT_IGNORED;
+    if (isMapLoadingEnabled())
+    {
+        if (_loadMap(pMapId, pBasePath, x, y, &tile))
+            result = VMAP_LOAD_RESULT_OK;
+        else
+            result = VMAP_LOAD_RESULT_ERROR;
+    }
+    return result;
+}
+
 //=========================================================
 // load one tile (internal use only)
 
-bool VMapManager2::_loadMap(unsigned int pMapId, std::string const& basePath, uint32 tileX, uint32 tileY)
+bool VMapManager2::_loadMap(unsigned int pMapId, std::string const& basePath, uint32 tileX, uint32 tileY, StaticMapTile const* tile)
 {
     InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
     if (instanceTree == iInstanceMapTrees.end())
@@ -99,6 +119,8 @@ bool VMapManager2::_loadMap(unsigned int pMapId, std::string const& basePath, ui
         }
         instanceTree = iInstanceMapTrees.insert(InstanceTreeMap::value_type(pMapId, newTree)).first;
     }
+    if (tile)
+        return instanceTree->second->LoadMapTile(tileX, tileY, *tile);
     return instanceTree->second->LoadMapTile(tileX, tileY, this);
 }
 
@@ -150,6 +172,25 @@ bool VMapManager2::isInLineOfSight(unsigned int pMapId, float x1, float y1, floa
     }
     return result;
 }
+
+void VMapManager2::isInLineOfSight(unsigned int pMapId, LineOfSightQuery const* queries, uint32 count, bool* results)
+{
+    InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(pMapId);
+    if (!isLineOfSightCalcEnabled() || instanceTree == iInstanceMapTrees.end())
+    {
+        std::fill(results, results + count, true);
+        return;
+    }
+
+    StaticMapTree const* tree = instanceTree->second;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        Vector3 const pos1 = convertPositionToInternalRep(queries[i].x1, queries[i].y1, queries[i].z1);
+        Vector3 const pos2 = convertPositionToInternalRep(queries[i].x2, queries[i].y2, queries[i].z2);
+        results[i] = pos1 == pos2 || tree->isInLineOfSight(pos1, pos2);
+    }
+}
+
 ModelInstance* VMapManager2::FindCollisionModel(unsigned int mapId, float x0, float y0, float z0, float x1, float y1, float z1)
 {
     if (!isLineOfSightCalcEnabled()) return nullptr;
@@ -469,6 +469,7 @@ bool StartDB(std::string name, DatabaseType& database, const char **migrations)
     std::string dbstring = sConfig.GetStringDefault((name + "Database.Info").c_str(), "");
     int nConnections = sConfig.GetIntDefault((name + "Database.Connections").c_str(), 1);
     int nAsyncConnections = sConfig.GetIntDefault((name + "Database.WorkerThreads").c_str(), 1);
+    int nHolderConnections = sConfig.GetIntDefault((name + "Database.HolderConnections").c_str(), 0);
     if (dbstring.empty())
     {
         sLog.outError("%s database not specified in configuration file", name.c_str());
@@ -508,10 +509,10 @@ bool StartDB(std::string name, DatabaseType& database, const char **migrations)
         return false;
     }
 
-    sLog.outString("%s Database: %s, sync threads: %i, workers: %i", name.c_str(), dbStringLog.c_str(), nConnections, nAsyncConnections);
+    sLog.outString("%s Database: %s, sync threads: %i, workers: %i, holder connections: %i", name.c_str(), dbStringLog.c_str(), nConnections, nAsyncConnections, nHolderConnections);
 
     ///- Initialise the world database
-    if (!database.Initialize(dbstring.c_str(), nConnections, nAsyncConnections))
+    if (!database.Initialize(dbstring.c_str(), nConnections, nAsyncConnections, nHolderConnections))
     {
         sLog.outError("Cannot connect to world database %s", name.c_str());
         return false;
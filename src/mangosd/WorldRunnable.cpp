@@ -28,6 +28,7 @@
 #include "World.h"
 #include "WorldRunnable.h"
 #include "Timer.h"
+#include "TickProfiler.h"
 #include "ObjectAccessor.h"
 #include "MapManager.h"
 #include "BattleGroundMgr.h"
@@ -48,6 +49,7 @@ void WorldRunnable::operator()()
     ///- Init new SQL thread for the world database
     WorldDatabase.ThreadStart();                                // let thread do safe mySQL requests (one connection call enough)
     sWorld.InitResultQueue();
+    TickProfiler::SetThreadName("World");
 
     Master::ArmAnticrash();
     uint32 anticrashRearmTimer = 0;
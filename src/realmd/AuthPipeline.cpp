@@ -0,0 +1,165 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** \file
+    \ingroup realmd
+*/
+
+#include "AuthPipeline.h"
+#include "AuthSocket.h"
+#include "Database/DatabaseEnv.h"
+#include "Log.h"
+
+#include <ace/Reactor.h>
+
+AuthPipeline& AuthPipeline::Instance()
+{
+    static AuthPipeline pipeline;
+    return pipeline;
+}
+
+AuthPipeline::AuthPipeline() : m_reactor(nullptr), m_pending(0), m_nextSocketId(0), m_notified(false)
+{
+}
+
+AuthPipeline::~AuthPipeline()
+{
+    Shutdown();
+}
+
+void AuthPipeline::Initialize(ACE_Reactor* reactor, uint32 databaseThreads, uint32 cryptoThreads)
+{
+    m_reactor = reactor;
+
+    uint32 const threads[MAX_STEP_TYPES] = { databaseThreads, cryptoThreads };
+    for (int type = 0; type < MAX_STEP_TYPES; ++type)
+    {
+        if (!threads[type])
+            continue;
+
+        m_pools[type].reset(new WorkStealingPool(int(threads[type])));
+        m_groups[type].reset(new WorkStealingPool::TaskGroup(*m_pools[type]));
+        if (type == STEP_DATABASE)
+            m_pools[type]->start([]() { LoginDatabase.ThreadStart(); }, []() { LoginDatabase.ThreadEnd(); });
+        else
+            m_pools[type]->start();
+    }
+
+    sLog.outString("Logon handshakes: %u database thread(s), %u crypto thread(s)", databaseThreads, cryptoThreads);
+}
+
+void AuthPipeline::Shutdown()
+{
+    for (int type = 0; type < MAX_STEP_TYPES; ++type)
+    {
+        if (m_groups[type])
+            m_groups[type]->waitAny();
+        m_groups[type].reset();
+        m_pools[type].reset();
+    }
+
+    std::lock_guard<std::mutex> guard(m_resultsLock);
+    m_results.clear();
+}
+
+uint32 AuthPipeline::RegisterSocket(AuthSocket* socket)
+{
+    // 0 is never used, so a socket id can be tested for validity
+    if (!++m_nextSocketId)
+        ++m_nextSocketId;
+    m_sockets[m_nextSocketId] = socket;
+    return m_nextSocketId;
+}
+
+void AuthPipeline::UnregisterSocket(uint32 socketId)
+{
+    m_sockets.erase(socketId);
+}
+
+bool AuthPipeline::Queue(uint32 socketId, StepType type, Step step)
+{
+    AuthSocket* socket = GetSocket(socketId);
+    if (!socket)
+        return false;
+
+    if (!m_groups[type])
+    {
+        Continuation continuation = step();
+        return !continuation || continuation(*socket);
+    }
+
+    ++m_pending;
+    m_groups[type]->run([this, socketId, step]()
+    {
+        Continuation continuation = step();
+
+        bool notify;
+        {
+            std::lock_guard<std::mutex> guard(m_resultsLock);
+            m_results.push_back({ socketId, std::move(continuation) });
+            notify = !m_notified;
+            m_notified = true;
+        }
+        --m_pending;
+
+        // one notification for every batch, the reactor pipe has a limited size
+        if (notify && m_reactor->notify(this, ACE_Event_Handler::EXCEPT_MASK) == -1)
+        {
+            sLog.outError("AuthPipeline: can not notify the reactor, logon results wait for the next step");
+            std::lock_guard<std::mutex> guard(m_resultsLock);
+            m_notified = false;
+        }
+    }, false);
+    return true;
+}
+
+int AuthPipeline::handle_exception(ACE_HANDLE)
+{
+    std::vector<Result> results;
+    {
+        std::lock_guard<std::mutex> guard(m_resultsLock);
+        results.swap(m_results);
+        m_notified = false;
+    }
+
+    for (Result const& result : results)
+        Resume(result.socketId, result.continuation);
+
+    return 0;
+}
+
+AuthSocket* AuthPipeline::GetSocket(uint32 socketId) const
+{
+    auto itr = m_sockets.find(socketId);
+    return itr != m_sockets.end() ? itr->second : nullptr;
+}
+
+void AuthPipeline::Resume(uint32 socketId, Continuation const& continuation)
+{
+    AuthSocket* socket = GetSocket(socketId);
+    if (!socket)
+        return;
+
+    if (continuation && !continuation(*socket))
+    {
+        DEBUG_LOG("[Auth] Logon step failed for '%s'", socket->get_remote_address().c_str());
+        socket->close_connection();
+        return;
+    }
+
+    // the client may have sent its next packet while the step was running
+    socket->OnRead();
+}
@@ -0,0 +1,109 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/// \addtogroup realmd
+/// @{
+/// \file
+
+#ifndef _AUTHPIPELINE_H
+#define _AUTHPIPELINE_H
+
+#include "Common.h"
+#include "WorkStealingPool.h"
+
+#include <ace/Event_Handler.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class AuthSocket;
+
+/**
+ * @brief Runs the slow steps of the logon handshakes (login database queries,
+ *  SRP6 big number math) off the network thread.
+ *  A step is a job run by a worker that returns the continuation of the
+ *  handshake. The continuation is run on the network thread through the
+ *  reactor notification queue, only if the socket still exists: a socket
+ *  closed in the meantime just drops the result.
+ *  With no thread configured for a kind of step, the step and its continuation
+ *  run on the network thread before Queue returns.
+ */
+class AuthPipeline : public ACE_Event_Handler
+{
+    public:
+        // returns false to close the connection
+        typedef std::function<bool(AuthSocket&)> Continuation;
+        typedef std::function<Continuation()> Step;
+
+        enum StepType
+        {
+            STEP_DATABASE,                                  // blocking login database queries
+            STEP_CRYPTO,                                    // SRP6 math
+            MAX_STEP_TYPES
+        };
+
+        static AuthPipeline& Instance();
+
+        AuthPipeline();
+        ~AuthPipeline();
+
+        void Initialize(ACE_Reactor* reactor, uint32 databaseThreads, uint32 cryptoThreads);
+
+        // waits for the steps in progress, their results are dropped
+        void Shutdown();
+
+        uint32 RegisterSocket(AuthSocket* socket);
+        void UnregisterSocket(uint32 socketId);
+
+        // returns false if the connection has to be closed, only known when the step runs on the network thread
+        bool Queue(uint32 socketId, StepType type, Step step);
+
+        // number of steps queued or running on the workers
+        uint32 GetPendingSteps() const { return m_pending; }
+
+        int handle_exception(ACE_HANDLE) override;
+
+    private:
+        struct Result
+        {
+            uint32 socketId;
+            Continuation continuation;
+        };
+
+        AuthSocket* GetSocket(uint32 socketId) const;
+        void Resume(uint32 socketId, Continuation const& continuation);
+
+        ACE_Reactor* m_reactor;
+        std::unique_ptr<WorkStealingPool> m_pools[MAX_STEP_TYPES];
+        std::unique_ptr<WorkStealingPool::TaskGroup> m_groups[MAX_STEP_TYPES];
+        std::atomic<uint32> m_pending;
+
+        std::unordered_map<uint32, AuthSocket*> m_sockets;  // network thread only
+        uint32 m_nextSocketId;
+
+        std::mutex m_resultsLock;
+        std::vector<Result> m_results;                      // filled by the workers
+        bool m_notified;                                    // a notification is queued in the reactor
+};
+
+#define sAuthPipeline AuthPipeline::Instance()
+
+#endif
+/// @}
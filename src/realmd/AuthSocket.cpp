@@ -33,6 +33,7 @@
 #include "AuthSocket.h"
 #include "AuthCodes.h"
 #include "PatchHandler.h"
+#include "AuthPipeline.h"
 #include "Util.h"
 
 #ifdef USE_SENDGRID
@@ -42,6 +43,7 @@
 
 #include <openssl/md5.h>
 #include <ctime>
+#include <memory>
 //#include "Util.h" -- for commented utf8ToUpperOnlyLatin
 
 #include <ace/OS_NS_unistd.h>
@@ -194,11 +196,15 @@ AuthSocket::AuthSocket() : promptPin(false), gridSeed(0), _geoUnlockPIN(0), _acc
 
     _build = 0;
     patch_ = ACE_INVALID_HANDLE;
+
+    _pipelineId = sAuthPipeline.RegisterSocket(this);
 }
 
 /// Close patch file descriptor before leaving
 AuthSocket::~AuthSocket()
 {
+    sAuthPipeline.UnregisterSocket(_pipelineId);
+
     if(patch_ != ACE_INVALID_HANDLE)
         ACE_OS::close(patch_);
 }
@@ -277,38 +283,243 @@ void AuthSocket::OnRead()
     }
 }
 
-/// Make the SRP6 calculation from hash in dB
-void AuthSocket::_SetVSFields(const std::string& rI)
+/// Login database rows of a logon challenge, read by a database step
+struct LogonChallengeLookup
 {
-    s.SetRand(s_BYTE_SIZE * 8);
+    bool ipBanned = false;
+    bool accountFound = false;
+    std::string shaPassHash;
+    uint32 accountId = 0;
+    uint32 lockFlags = 0;
+    std::string lastIP;
+    std::string databaseV;
+    std::string databaseS;
+    std::string securityInfo;
+    bool emailVerified = false;
+    uint32 geolockPin = 0;
+    std::string email;
+    uint32 joinDate = 0;
+    bool banned = false;
+    bool permanentBan = false;
+    std::vector<std::pair<int32, AccountTypes>> securityLevels; // realm id (negative for every realm), level
+};
 
-    BigNumber I;
-    I.SetHexStr(rI.c_str());
+/// Server values of a logon challenge, computed by a crypto step
+struct LogonChallengeSrp6
+{
+    BigNumber s, v;
+    BigNumber b, B;
+    bool newVerifier = false;                               // (v, s) made from the password hash, to be saved
+};
 
-    // In case of leading zeros in the rI hash, restore them
-    uint8 mDigest[SHA_DIGEST_LENGTH];
-    memset(mDigest, 0, SHA_DIGEST_LENGTH);
-    if (I.GetNumBytes() <= SHA_DIGEST_LENGTH)
-        memcpy(mDigest, I.AsByteArray().data(), I.GetNumBytes());
+/// Client proof and the values computed from it by a crypto step
+struct LogonProofSrp6
+{
+    uint8 A[32];
+    uint8 M1[20];
+    uint8 crcHash[20];
+    uint8 securityFlags = 0;
+    PINData pinData;
 
-    std::reverse(mDigest, mDigest + SHA_DIGEST_LENGTH);
+    bool valid = false;                                     // false if A is not acceptable
+    BigNumber K, M;
+    Sha1Hash M2;                                            // server proof, sent on success
+};
 
-    Sha1Hash sha;
-    sha.UpdateData(s.AsByteArray());
-    sha.UpdateData(mDigest, SHA_DIGEST_LENGTH);
-    sha.Finalize();
-    BigNumber x;
-    x.SetBinary(sha.GetDigest(), sha.GetLength());
-    v = g.ModExp(x, N);
-    // No SQL injection (username escaped)
-    const char *v_hex, *s_hex;
-    v_hex = v.AsHexStr();
-    s_hex = s.AsHexStr();
-    LoginDatabase.PExecute("UPDATE `account` SET `v` = '%s', `s` = '%s' WHERE `username` = '%s'", v_hex, s_hex, _safelogin.c_str() );
-    OPENSSL_free((void*)v_hex);
-    OPENSSL_free((void*)s_hex);
+namespace
+{
+    // No SQL injection: address and login are escaped by the caller
+    std::shared_ptr<LogonChallengeLookup> LookupLogonChallenge(std::string const& address, std::string const& safeLogin)
+    {
+        std::shared_ptr<LogonChallengeLookup> lookup = std::make_shared<LogonChallengeLookup>();
+
+        ///- Verify that this IP is not in the ip_banned table
+        if (QueryResult* result = LoginDatabase.PQuery("SELECT `unbandate` FROM `ip_banned` WHERE "
+        //    permanent                    still banned
+            "(`unbandate` = `bandate` OR `unbandate` > UNIX_TIMESTAMP()) AND `ip` = '%s'", address.c_str()))
+        {
+            lookup->ipBanned = true;
+            delete result;
+            return lookup;
+        }
+
+        ///- Get the account details from the account table
+        QueryResult* result = LoginDatabase.PQuery("SELECT `sha_pass_hash`, `id`, `locked`, `last_ip`, `v`, `s`, `security`, `email_verif`, `geolock_pin`, `email`, UNIX_TIMESTAMP(`joindate`) FROM `account` WHERE `username` = '%s'", safeLogin.c_str());
+        if (!result)
+            return lookup;
+
+        Field* fields = result->Fetch();
+        lookup->accountFound = true;
+        lookup->shaPassHash = fields[0].GetCppString();
+        lookup->accountId = fields[1].GetUInt32();
+        lookup->lockFlags = fields[2].GetUInt32();
+        lookup->lastIP = fields[3].GetCppString();
+        lookup->databaseV = fields[4].GetCppString();
+        lookup->databaseS = fields[5].GetCppString();
+        lookup->securityInfo = fields[6].GetCppString();
+        lookup->emailVerified = fields[7].GetBool();
+        lookup->geolockPin = fields[8].GetUInt32();
+        lookup->email = fields[9].GetCppString();
+        lookup->joinDate = fields[10].GetUInt32();
+        delete result;
+
+        ///- If the account is banned, the logon attempt is rejected
+        if (QueryResult* banResult = LoginDatabase.PQuery("SELECT `bandate`, `unbandate` FROM `account_banned` WHERE "
+            "`id` = %u AND `active` = 1 AND (`unbandate` > UNIX_TIMESTAMP() OR `unbandate` = `bandate`) LIMIT 1", lookup->accountId))
+        {
+            lookup->banned = true;
+            lookup->permanentBan = (*banResult)[0].GetUInt64() == (*banResult)[1].GetUInt64();
+            delete banResult;
+            return lookup;
+        }
+
+        if (QueryResult* accessResult = LoginDatabase.PQuery("SELECT `gmlevel`, `RealmID` FROM `account_access` WHERE `id` = %u", lookup->accountId))
+        {
+            do
+            {
+                Field* accessFields = accessResult->Fetch();
+                lookup->securityLevels.emplace_back(accessFields[1].GetInt32(), AccountTypes(accessFields[0].GetUInt32()));
+            }
+            while (accessResult->NextRow());
+
+            delete accessResult;
+        }
+
+        return lookup;
+    }
+
+    std::shared_ptr<LogonChallengeSrp6> ComputeLogonChallenge(BigNumber N, BigNumber g, std::string const& rI, std::string const& databaseV, std::string const& databaseS)
+    {
+        std::shared_ptr<LogonChallengeSrp6> srp = std::make_shared<LogonChallengeSrp6>();
+
+        ///- Don't calculate (v, s) if there are already some in the database
+        // multiply with 2, bytes are stored as hexstring
+        if (databaseV.size() == AuthSocket::s_BYTE_SIZE * 2 && databaseS.size() == AuthSocket::s_BYTE_SIZE * 2)
+        {
+            srp->s.SetHexStr(databaseS.c_str());
+            srp->v.SetHexStr(databaseV.c_str());
+        }
+        else
+        {
+            ///- Make the SRP6 calculation from hash in dB
+            srp->s.SetRand(AuthSocket::s_BYTE_SIZE * 8);
+
+            BigNumber I;
+            I.SetHexStr(rI.c_str());
+
+            // In case of leading zeros in the rI hash, restore them
+            uint8 mDigest[SHA_DIGEST_LENGTH];
+            memset(mDigest, 0, SHA_DIGEST_LENGTH);
+            if (I.GetNumBytes() <= SHA_DIGEST_LENGTH)
+                memcpy(mDigest, I.AsByteArray().data(), I.GetNumBytes());
+
+            std::reverse(mDigest, mDigest + SHA_DIGEST_LENGTH);
+
+            Sha1Hash sha;
+            sha.UpdateData(srp->s.AsByteArray());
+            sha.UpdateData(mDigest, SHA_DIGEST_LENGTH);
+            sha.Finalize();
+            BigNumber x;
+            x.SetBinary(sha.GetDigest(), sha.GetLength());
+            srp->v = g.ModExp(x, N);
+            srp->newVerifier = true;
+        }
+
+        srp->b.SetRand(19 * 8);
+        BigNumber gmod = g.ModExp(srp->b, N);
+        srp->B = ((srp->v * 3) + gmod) % N;
+
+        MANGOS_ASSERT(gmod.GetNumBytes() <= 32);
+        return srp;
+    }
+
+    void ComputeLogonProof(LogonProofSrp6& proof, BigNumber N, BigNumber g, BigNumber s, BigNumber v, BigNumber b, BigNumber B, std::string const& login)
+    {
+        BigNumber A;
+
+        A.SetBinary(proof.A, 32);
+
+        // SRP safeguard: abort if A==0
+        if (A.isZero())
+            return;
+
+        if ((A % N).isZero())
+            return;
+
+        Sha1Hash sha;
+        sha.UpdateBigNumbers(&A, &B, nullptr);
+        sha.Finalize();
+        BigNumber u;
+        u.SetBinary(sha.GetDigest(), 20);
+        BigNumber S = (A * (v.ModExp(u, N))).ModExp(b, N);
+
+        uint8 t[32];
+        uint8 t1[16];
+        uint8 vK[40];
+        memcpy(t, S.AsByteArray(32).data(), 32);
+        for (int i = 0; i < 16; ++i)
+        {
+            t1[i] = t[i * 2];
+        }
+        sha.Initialize();
+        sha.UpdateData(t1, 16);
+        sha.Finalize();
+        for (int i = 0; i < 20; ++i)
+        {
+            vK[i * 2] = sha.GetDigest()[i];
+        }
+        for (int i = 0; i < 16; ++i)
+        {
+            t1[i] = t[i * 2 + 1];
+        }
+        sha.Initialize();
+        sha.UpdateData(t1, 16);
+        sha.Finalize();
+        for (int i = 0; i < 20; ++i)
+        {
+            vK[i * 2 + 1] = sha.GetDigest()[i];
+        }
+        proof.K.SetBinary(vK, 40);
+
+        uint8 hash[20];
+
+        sha.Initialize();
+        sha.UpdateBigNumbers(&N, nullptr);
+        sha.Finalize();
+        memcpy(hash, sha.GetDigest(), 20);
+        sha.Initialize();
+        sha.UpdateBigNumbers(&g, nullptr);
+        sha.Finalize();
+        for (int i = 0; i < 20; ++i)
+        {
+            hash[i] ^= sha.GetDigest()[i];
+        }
+        BigNumber t3;
+        t3.SetBinary(hash, 20);
+
+        sha.Initialize();
+        sha.UpdateData(login);
+        sha.Finalize();
+        uint8 t4[SHA_DIGEST_LENGTH];
+        memcpy(t4, sha.GetDigest(), SHA_DIGEST_LENGTH);
+
+        sha.Initialize();
+        sha.UpdateBigNumbers(&t3, nullptr);
+        sha.UpdateData(t4, SHA_DIGEST_LENGTH);
+        sha.UpdateBigNumbers(&s, &A, &B, &proof.K, nullptr);
+        sha.Finalize();
+        proof.M.SetBinary(sha.GetDigest(), 20);
+
+        ///- Finish SRP6, the result is only sent if the client proof matches
+        proof.M2.Initialize();
+        proof.M2.UpdateBigNumbers(&A, &proof.M, &proof.K, nullptr);
+        proof.M2.Finalize();
+
+        proof.valid = true;
+    }
 }
 
+
 void AuthSocket::SendProof(Sha1Hash sha)
 {
     if (_build < 6299)  // before version 2.0.3 (exclusive)
@@ -388,14 +599,16 @@ bool AuthSocket::_HandleLogonChallenge()
     EndianConvert(ch->timezone_bias);
     EndianConvert(ch->ip);
 
-    ByteBuffer pkt;
-
     _login = (const char*)ch->I;
     _build = ch->build;
 
     memcpy(&_os, ch->os, sizeof(_os));
     memcpy(&_platform, ch->platform, sizeof(_platform));
 
+    _localizationName.resize(4);
+    for(int i = 0; i < 4; ++i)
+        _localizationName[i] = ch->country[4-i-1];
+
     ///- Normalize account name
     //utf8ToUpperOnlyLatin(_login); -- client already send account in expected form
 
@@ -404,189 +617,207 @@ bool AuthSocket::_HandleLogonChallenge()
     _safelogin = _login;
     LoginDatabase.escape_string(_safelogin);
 
-    pkt << (uint8) CMD_AUTH_LOGON_CHALLENGE;
-    pkt << (uint8) 0x00;
-
-    ///- Verify that this IP is not in the ip_banned table
     // No SQL injection possible (paste the IP address as passed by the socket)
     std::string address = get_remote_address();
     LoginDatabase.escape_string(address);
-    QueryResult *result = LoginDatabase.PQuery("SELECT `unbandate` FROM `ip_banned` WHERE "
-    //    permanent                    still banned
-        "(`unbandate` = `bandate` OR `unbandate` > UNIX_TIMESTAMP()) AND `ip` = '%s'", address.c_str());
-    if (result)
+
+    ///- Read the bans and the account from the database, the reply is sent once they arrive
+    std::string const safeLogin = _safelogin;
+    _status = STATUS_PENDING;
+    return sAuthPipeline.Queue(_pipelineId, AuthPipeline::STEP_DATABASE, [address, safeLogin]()
+    {
+        std::shared_ptr<LogonChallengeLookup> lookup = LookupLogonChallenge(address, safeLogin);
+        return AuthPipeline::Continuation([lookup](AuthSocket& socket) { return socket.OnLogonChallengeLookup(*lookup); });
+    });
+}
+
+/// Logon Challenge, once the account has been read from the database
+bool AuthSocket::OnLogonChallengeLookup(LogonChallengeLookup const& lookup)
+{
+    ///- Session is closed unless overriden
+    _status = STATUS_CLOSED;
+
+    ByteBuffer pkt;
+    pkt << (uint8) CMD_AUTH_LOGON_CHALLENGE;
+    pkt << (uint8) 0x00;
+
+    if (lookup.ipBanned)
     {
         pkt << (uint8)WOW_FAIL_DB_BUSY;
         BASIC_LOG("[AuthChallenge] Banned ip '%s' tries to login with account '%s'!", get_remote_address().c_str(), _login.c_str());
-        delete result;
+        send((char const*)pkt.contents(), pkt.size());
+        return true;
     }
-    else
+
+    if (!lookup.accountFound)                               // no account
     {
-        ///- Get the account details from the account table
-        // No SQL injection (escaped user name)
-        result = LoginDatabase.PQuery("SELECT `sha_pass_hash`, `id`, `locked`, `last_ip`, `v`, `s`, `security`, `email_verif`, `geolock_pin`, `email`, UNIX_TIMESTAMP(`joindate`) FROM `account` WHERE `username` = '%s'",_safelogin.c_str ());
-        if (result)
-        {
-            Field* fields = result->Fetch();
-
-            // Prevent login if the user's email address has not been verified
-            bool requireVerification = sConfig.GetBoolDefault("ReqEmailVerification", false);
-            int32 requireEmailSince = sConfig.GetIntDefault("ReqEmailSince", 0);
-            bool verified = (*result)[7].GetBool();
-            
-            // Prevent login if the user's join date is bigger than the timestamp in configuration
-            if (requireEmailSince > 0)
-            {
-                uint32 t = (*result)[10].GetUInt32();
-                requireVerification = requireVerification && (t >= uint32(requireEmailSince));
-            }
+        pkt<< (uint8) WOW_FAIL_UNKNOWN_ACCOUNT;
+        send((char const*)pkt.contents(), pkt.size());
+        return true;
+    }
 
-            if (requireVerification && !verified)
-            {
-                BASIC_LOG("[AuthChallenge] Account '%s' using IP '%s 'email address requires email verification - rejecting login", _login.c_str(), get_remote_address().c_str());
-                pkt << (uint8)WOW_FAIL_UNKNOWN_ACCOUNT;
-                send((char const*)pkt.contents(), pkt.size());
-                return true;
-            }
+    // Prevent login if the user's email address has not been verified
+    bool requireVerification = sConfig.GetBoolDefault("ReqEmailVerification", false);
+    int32 requireEmailSince = sConfig.GetIntDefault("ReqEmailSince", 0);
 
-            ///- If the IP is 'locked', check that the player comes indeed from the correct IP address
-            bool locked = false;
-            lockFlags = (LockFlag)(*result)[2].GetUInt32();
-            securityInfo = (*result)[6].GetCppString();
-            _lastIP = fields[3].GetString();
-            _geoUnlockPIN = fields[8].GetUInt32();
-            _email = fields[9].GetCppString();
+    // Prevent login if the user's join date is bigger than the timestamp in configuration
+    if (requireEmailSince > 0)
+        requireVerification = requireVerification && (lookup.joinDate >= uint32(requireEmailSince));
 
-            if (lockFlags & IP_LOCK)
-            {
-                DEBUG_LOG("[AuthChallenge] Account '%s' is locked to IP - '%s'", _login.c_str(), _lastIP.c_str());
-                DEBUG_LOG("[AuthChallenge] Player address is '%s'", get_remote_address().c_str());
+    if (requireVerification && !lookup.emailVerified)
+    {
+        BASIC_LOG("[AuthChallenge] Account '%s' using IP '%s 'email address requires email verification - rejecting login", _login.c_str(), get_remote_address().c_str());
+        pkt << (uint8)WOW_FAIL_UNKNOWN_ACCOUNT;
+        send((char const*)pkt.contents(), pkt.size());
+        return true;
+    }
 
-                if (_lastIP != get_remote_address())
-                {
-                    DEBUG_LOG("[AuthChallenge] Account IP differs");
+    ///- If the IP is 'locked', check that the player comes indeed from the correct IP address
+    bool locked = false;
+    lockFlags = (LockFlag)lookup.lockFlags;
+    securityInfo = lookup.securityInfo;
+    _lastIP = lookup.lastIP;
+    _geoUnlockPIN = lookup.geolockPin;
+    _email = lookup.email;
 
-                    // account is IP locked and the player does not have 2FA enabled
-                    if (((lockFlags & TOTP) != TOTP && (lockFlags & FIXED_PIN) != FIXED_PIN))
-                        pkt << (uint8) WOW_FAIL_SUSPENDED;
+    if (lockFlags & IP_LOCK)
+    {
+        DEBUG_LOG("[AuthChallenge] Account '%s' is locked to IP - '%s'", _login.c_str(), _lastIP.c_str());
+        DEBUG_LOG("[AuthChallenge] Player address is '%s'", get_remote_address().c_str());
 
-                    locked = true;
-                }
-                else
-                {
-                    DEBUG_LOG("[AuthChallenge] Account IP matches");
-                }
-            }
-            else
+        if (_lastIP != get_remote_address())
+        {
+            DEBUG_LOG("[AuthChallenge] Account IP differs");
+
+            // account is IP locked and the player does not have 2FA enabled
+            if (((lockFlags & TOTP) != TOTP && (lockFlags & FIXED_PIN) != FIXED_PIN))
             {
-                DEBUG_LOG("[AuthChallenge] Account '%s' is not locked to ip", _login.c_str());
+                pkt << (uint8) WOW_FAIL_SUSPENDED;
+                send((char const*)pkt.contents(), pkt.size());
+                return true;
             }
 
-            if (!locked || (locked && (lockFlags & FIXED_PIN || lockFlags & TOTP)))
-            {
-                uint32 account_id = fields[1].GetUInt32();
-                ///- If the account is banned, reject the logon attempt
-                QueryResult *banresult = LoginDatabase.PQuery("SELECT `bandate`, `unbandate` FROM `account_banned` WHERE "
-                    "`id` = %u AND `active` = 1 AND (`unbandate` > UNIX_TIMESTAMP() OR `unbandate` = `bandate`) LIMIT 1", account_id);
-                if (banresult)
-                {
-                    if((*banresult)[0].GetUInt64() == (*banresult)[1].GetUInt64())
-                    {
-                        pkt << (uint8) WOW_FAIL_BANNED;
-                        BASIC_LOG("[AuthChallenge] Banned account '%s' using IP '%s' tries to login!",_login.c_str (), get_remote_address().c_str());
-                    }
-                    else
-                    {
-                        pkt << (uint8) WOW_FAIL_SUSPENDED;
-                        BASIC_LOG("[AuthChallenge] Temporarily banned account '%s' using IP '%s' tries to login!",_login.c_str (), get_remote_address().c_str());
-                    }
+            locked = true;
+        }
+        else
+        {
+            DEBUG_LOG("[AuthChallenge] Account IP matches");
+        }
+    }
+    else
+    {
+        DEBUG_LOG("[AuthChallenge] Account '%s' is not locked to ip", _login.c_str());
+    }
 
-                    delete banresult;
-                }
-                else
-                {
-                    ///- Get the password from the account table, upper it, and make the SRP6 calculation
-                    std::string rI = fields[0].GetCppString();
+    ///- If the account is banned, reject the logon attempt
+    if (lookup.banned)
+    {
+        if (lookup.permanentBan)
+        {
+            pkt << (uint8) WOW_FAIL_BANNED;
+            BASIC_LOG("[AuthChallenge] Banned account '%s' using IP '%s' tries to login!",_login.c_str (), get_remote_address().c_str());
+        }
+        else
+        {
+            pkt << (uint8) WOW_FAIL_SUSPENDED;
+            BASIC_LOG("[AuthChallenge] Temporarily banned account '%s' using IP '%s' tries to login!",_login.c_str (), get_remote_address().c_str());
+        }
 
-                    ///- Don't calculate (v, s) if there are already some in the database
-                    std::string databaseV = fields[4].GetCppString();
-                    std::string databaseS = fields[5].GetCppString();
+        send((char const*)pkt.contents(), pkt.size());
+        return true;
+    }
 
-                    DEBUG_LOG("database authentication values: v='%s' s='%s'", databaseV.c_str(), databaseS.c_str());
+    // figure out whether we need to display the PIN grid
+    promptPin = locked; // always prompt if the account is IP locked & 2FA is enabled
 
-                    // multiply with 2, bytes are stored as hexstring
-                    if(databaseV.size() != s_BYTE_SIZE*2 || databaseS.size() != s_BYTE_SIZE*2)
-                        _SetVSFields(rI);
-                    else
-                    {
-                        s.SetHexStr(databaseS.c_str());
-                        v.SetHexStr(databaseV.c_str());
-                    }
+    if ((!locked && ((lockFlags & ALWAYS_ENFORCE) == ALWAYS_ENFORCE)) || _geoUnlockPIN)
+    {
+        promptPin = true; // prompt if the lock hasn't been triggered but ALWAYS_ENFORCE is set
+    }
 
-                    b.SetRand(19 * 8);
-                    BigNumber gmod = g.ModExp(b, N);
-                    B = ((v * 3) + gmod) % N;
+    for (auto const& level : lookup.securityLevels)
+    {
+        if (level.first < 0)
+            _accountDefaultSecurityLevel = level.second;
+        else
+            _accountSecurityOnRealm[level.first] = level.second;
+    }
 
-                    MANGOS_ASSERT(gmod.GetNumBytes() <= 32);
+    DEBUG_LOG("database authentication values: v='%s' s='%s'", lookup.databaseV.c_str(), lookup.databaseS.c_str());
 
-                    ///- Fill the response packet with the result
-                    pkt << uint8(WOW_SUCCESS);
+    ///- Get the password from the account table, upper it, and make the SRP6 calculation
+    std::shared_ptr<LogonChallengeLookup const> account = std::make_shared<LogonChallengeLookup>(lookup);
+    BigNumber const N_ = N, g_ = g;
+    _status = STATUS_PENDING;
+    return sAuthPipeline.Queue(_pipelineId, AuthPipeline::STEP_CRYPTO, [account, N_, g_]()
+    {
+        std::shared_ptr<LogonChallengeSrp6> srp = ComputeLogonChallenge(N_, g_, account->shaPassHash, account->databaseV, account->databaseS);
+        return AuthPipeline::Continuation([account, srp](AuthSocket& socket) { return socket.OnLogonChallengeSrp6(*account, *srp); });
+    });
+}
 
-                    // B may be calculated < 32B so we force minimal length to 32B
-                    pkt.append(B.AsByteArray(32));      // 32 bytes
-                    pkt << uint8(1);
-                    pkt.append(g.AsByteArray());
-                    pkt << uint8(32);
-                    pkt.append(N.AsByteArray(32));
-                    pkt.append(s.AsByteArray());        // 32 bytes
-                    pkt.append(VersionChallenge.data(), VersionChallenge.size());
+/// Logon Challenge, once the SRP6 values are computed
+bool AuthSocket::OnLogonChallengeSrp6(LogonChallengeLookup const& account, LogonChallengeSrp6& srp)
+{
+    ///- Session is closed unless overriden
+    _status = STATUS_CLOSED;
 
-                    // figure out whether we need to display the PIN grid
-                    promptPin = locked; // always prompt if the account is IP locked & 2FA is enabled
+    s = srp.s;
+    v = srp.v;
+    b = srp.b;
+    B = srp.B;
 
-                    if ((!locked && ((lockFlags & ALWAYS_ENFORCE) == ALWAYS_ENFORCE)) || _geoUnlockPIN)
-                    {
-                        promptPin = true; // prompt if the lock hasn't been triggered but ALWAYS_ENFORCE is set
-                    }
+    if (srp.newVerifier)
+    {
+        // No SQL injection (username escaped)
+        const char *v_hex, *s_hex;
+        v_hex = v.AsHexStr();
+        s_hex = s.AsHexStr();
+        LoginDatabase.PExecute("UPDATE `account` SET `v` = '%s', `s` = '%s' WHERE `username` = '%s'", v_hex, s_hex, _safelogin.c_str() );
+        OPENSSL_free((void*)v_hex);
+        OPENSSL_free((void*)s_hex);
+    }
 
-                    if (promptPin)
-                    {
-                        BASIC_LOG("[AuthChallenge] Account '%s' using IP '%s' requires PIN authentication", _login.c_str(), get_remote_address().c_str());
+    ///- Fill the response packet with the result
+    ByteBuffer pkt;
+    pkt << (uint8) CMD_AUTH_LOGON_CHALLENGE;
+    pkt << (uint8) 0x00;
+    pkt << uint8(WOW_SUCCESS);
+
+    // B may be calculated < 32B so we force minimal length to 32B
+    pkt.append(B.AsByteArray(32));      // 32 bytes
+    pkt << uint8(1);
+    pkt.append(g.AsByteArray());
+    pkt << uint8(32);
+    pkt.append(N.AsByteArray(32));
+    pkt.append(s.AsByteArray());        // 32 bytes
+    pkt.append(VersionChallenge.data(), VersionChallenge.size());
 
-                        uint32 gridSeedPkt = gridSeed = static_cast<uint32>(rand32());
-                        EndianConvert(gridSeedPkt);
-                        serverSecuritySalt.SetRand(16 * 8); // 16 bytes random
+    if (promptPin)
+    {
+        BASIC_LOG("[AuthChallenge] Account '%s' using IP '%s' requires PIN authentication", _login.c_str(), get_remote_address().c_str());
 
-                        pkt << uint8(1); // securityFlags, only '1' is available in classic (PIN input)
-                        pkt << gridSeedPkt;
-                        pkt.append(serverSecuritySalt.AsByteArray(16).data(), 16);
-                    }
-                    else
-                    {
-                        if (_build >= 5428)        // version 1.11.0 or later
-                            pkt << uint8(0);
-                    }
+        uint32 gridSeedPkt = gridSeed = static_cast<uint32>(rand32());
+        EndianConvert(gridSeedPkt);
+        serverSecuritySalt.SetRand(16 * 8); // 16 bytes random
 
-                    _localizationName.resize(4);
-                    for(int i = 0; i < 4; ++i)
-                        _localizationName[i] = ch->country[4-i-1];
+        pkt << uint8(1); // securityFlags, only '1' is available in classic (PIN input)
+        pkt << gridSeedPkt;
+        pkt.append(serverSecuritySalt.AsByteArray(16).data(), 16);
+    }
+    else
+    {
+        if (_build >= 5428)        // version 1.11.0 or later
+            pkt << uint8(0);
+    }
 
-                    LoadAccountSecurityLevels(account_id);
-                    BASIC_LOG("[AuthChallenge] Account '%s' using IP '%s' is using '%c%c%c%c' locale (%u)", _login.c_str (), get_remote_address().c_str(), ch->country[3], ch->country[2], ch->country[1], ch->country[0], GetLocaleByName(_localizationName));
+    BASIC_LOG("[AuthChallenge] Account '%s' using IP '%s' is using '%s' locale (%u)", _login.c_str (), get_remote_address().c_str(), _localizationName.c_str(), GetLocaleByName(_localizationName));
 
-                    _accountId = account_id;
+    _accountId = account.accountId;
+
+    ///- All good, await client's proof
+    _status = STATUS_LOGON_PROOF;
 
-                    ///- All good, await client's proof
-                    _status = STATUS_LOGON_PROOF;
-                }
-            }
-            delete result;
-        }
-        else                                                // no account
-        {
-            pkt<< (uint8) WOW_FAIL_UNKNOWN_ACCOUNT;
-        }
-    }
     send((char const*)pkt.contents(), pkt.size());
     return true;
 }
@@ -690,93 +921,45 @@ bool AuthSocket::_HandleLogonProof()
     /// </ul>
 
     ///- Continue the SRP6 calculation based on data received from the client
-    BigNumber A;
-
-    A.SetBinary(lp.A, 32);
-
-    // SRP safeguard: abort if A==0
-    if (A.isZero())
-        return false;
-
-    if ((A % N).isZero())
-        return false;
-
-    Sha1Hash sha;
-    sha.UpdateBigNumbers(&A, &B, nullptr);
-    sha.Finalize();
-    BigNumber u;
-    u.SetBinary(sha.GetDigest(), 20);
-    BigNumber S = (A * (v.ModExp(u, N))).ModExp(b, N);
-
-    uint8 t[32];
-    uint8 t1[16];
-    uint8 vK[40];
-    memcpy(t, S.AsByteArray(32).data(), 32);
-    for (int i = 0; i < 16; ++i)
-    {
-        t1[i] = t[i * 2];
-    }
-    sha.Initialize();
-    sha.UpdateData(t1, 16);
-    sha.Finalize();
-    for (int i = 0; i < 20; ++i)
-    {
-        vK[i * 2] = sha.GetDigest()[i];
-    }
-    for (int i = 0; i < 16; ++i)
-    {
-        t1[i] = t[i * 2 + 1];
-    }
-    sha.Initialize();
-    sha.UpdateData(t1, 16);
-    sha.Finalize();
-    for (int i = 0; i < 20; ++i)
-    {
-        vK[i * 2 + 1] = sha.GetDigest()[i];
-    }
-    K.SetBinary(vK, 40);
-
-    uint8 hash[20];
+    std::shared_ptr<LogonProofSrp6> proof = std::make_shared<LogonProofSrp6>();
+    memcpy(proof->A, lp.A, sizeof(proof->A));
+    memcpy(proof->M1, lp.M1, sizeof(proof->M1));
+    memcpy(proof->crcHash, lp.crc_hash, sizeof(proof->crcHash));
+    proof->securityFlags = lp.securityFlags;
+    if (lp.securityFlags)
+        proof->pinData = pinData;
 
-    sha.Initialize();
-    sha.UpdateBigNumbers(&N, nullptr);
-    sha.Finalize();
-    memcpy(hash, sha.GetDigest(), 20);
-    sha.Initialize();
-    sha.UpdateBigNumbers(&g, nullptr);
-    sha.Finalize();
-    for (int i = 0; i < 20; ++i)
+    BigNumber const N_ = N, g_ = g, s_ = s, v_ = v, b_ = b, B_ = B;
+    std::string const login = _login;
+    _status = STATUS_PENDING;
+    return sAuthPipeline.Queue(_pipelineId, AuthPipeline::STEP_CRYPTO, [proof, N_, g_, s_, v_, b_, B_, login]()
     {
-        hash[i] ^= sha.GetDigest()[i];
-    }
-    BigNumber t3;
-    t3.SetBinary(hash, 20);
+        ComputeLogonProof(*proof, N_, g_, s_, v_, b_, B_, login);
+        return AuthPipeline::Continuation([proof](AuthSocket& socket) { return socket.OnLogonProofSrp6(proof); });
+    });
+}
 
-    sha.Initialize();
-    sha.UpdateData(_login);
-    sha.Finalize();
-    uint8 t4[SHA_DIGEST_LENGTH];
-    memcpy(t4, sha.GetDigest(), SHA_DIGEST_LENGTH);
+/// Logon Proof, once the SRP6 values are computed
+bool AuthSocket::OnLogonProofSrp6(std::shared_ptr<LogonProofSrp6> const& proof)
+{
+    ///- Session is closed unless overriden
+    _status = STATUS_CLOSED;
 
-    sha.Initialize();
-    sha.UpdateBigNumbers(&t3, nullptr);
-    sha.UpdateData(t4, SHA_DIGEST_LENGTH);
-    sha.UpdateBigNumbers(&s, &A, &B, &K, nullptr);
-    sha.Finalize();
-    BigNumber M;
-    M.SetBinary(sha.GetDigest(), 20);
+    // SRP safeguard: A is 0 or a multiple of N
+    if (!proof->valid)
+        return false;
 
     ///- Check PIN data is correct
     bool pinResult = true;
 
-    if (promptPin && !lp.securityFlags)
+    if (promptPin && !proof->securityFlags)
         pinResult = false; // expected PIN data but did not receive it
 
-    if (promptPin && lp.securityFlags)
+    if (promptPin && proof->securityFlags)
     {
         if ((lockFlags & FIXED_PIN) == FIXED_PIN)
         {
-            pinResult = VerifyPinData(std::stoi(securityInfo), pinData);
+            pinResult = VerifyPinData(std::stoi(securityInfo), proof->pinData);
             BASIC_LOG("[AuthChallenge] Account '%s' using IP '%s' PIN result: %u", _login.c_str(), get_remote_address().c_str(), pinResult);
         }
         else if ((lockFlags & TOTP) == TOTP)
@@ -788,13 +971,13 @@ bool AuthSocket::_HandleLogonProof()
                 if (pin == uint32(-1))
                     break;
 
-                if ((pinResult = VerifyPinData(pin, pinData)))
+                if ((pinResult = VerifyPinData(pin, proof->pinData)))
                     break;
             }
         }
         else if (_geoUnlockPIN)
         {
-            pinResult = VerifyPinData(_geoUnlockPIN, pinData);
+            pinResult = VerifyPinData(_geoUnlockPIN, proof->pinData);
         }
         else
         {
@@ -804,9 +987,9 @@ bool AuthSocket::_HandleLogonProof()
     }
 
     ///- Check if SRP6 results match (password is correct), else send an error
-    if (!memcmp(M.AsByteArray().data(), lp.M1, 20) && pinResult)
+    if (!memcmp(proof->M.AsByteArray().data(), proof->M1, 20) && pinResult)
     {
-        if (!VerifyVersion(lp.A, sizeof(lp.A), lp.crc_hash, false))
+        if (!VerifyVersion(proof->A, sizeof(proof->A), proof->crcHash, false))
         {
             BASIC_LOG("[AuthChallenge] Account %s tried to login with modified client!", _login.c_str());
             char data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_VERSION_INVALID };
@@ -814,83 +997,35 @@ bool AuthSocket::_HandleLogonProof()
             return true;
         }
 
-        // Geolocking checks must be done after an otherwise successful login to prevent lockout attacks
-        if (_geoUnlockPIN) // remove the PIN to unlock the account since login succeeded
-        {
-            auto result = LoginDatabase.PExecute("UPDATE `account` SET `geolock_pin` = 0 WHERE `username` = '%s'",
-                _safelogin.c_str());
-
-            if (!result)
-            {
-                sLog.outError("Unable to remove geolock PIN for %s - account has not been unlocked", _safelogin.c_str());
-            }
-        }
-        else if (GeographicalLockCheck())
-        {
-            BASIC_LOG("Account '%s' (%u) using IP '%s' has been geolocked", _login.c_str(), _accountId, get_remote_address().c_str()); // todo, add additional logging info
-
-            auto pin = urand(100000, 999999); // check rand32_max
-            auto result = LoginDatabase.PExecute("UPDATE `account` SET `geolock_pin` = %u WHERE `username` = '%s'",
-                pin, _safelogin.c_str());
-
-            if (!result)
-            {
-                sLog.outError("Unable to write geolock PIN for %s - account has not been locked", _safelogin.c_str());
-
-                char data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_DB_BUSY };
-                send(data, sizeof(data));
-                return true;
-            }
-
-#ifdef USE_SENDGRID
-            if (sConfig.GetBoolDefault("SendMail", false))
-            {
-                auto mail = std::make_unique<SendgridMail>
-                (
-                    sConfig.GetStringDefault("SendGridKey", ""),
-                    sConfig.GetStringDefault("GeolockGUID", "")
-                );
-
-                mail->recipient(_email);
-                mail->from(sConfig.GetStringDefault("MailFrom", ""));
-                mail->substitution("%username%", _login);
-                mail->substitution("%unlock_pin%", std::to_string(pin));
-                mail->substitution("%originating_ip%", get_remote_address());
-
-                MailerService::get_global_mailer()->send(std::move(mail),
-                    [](SendgridMail::Result res)
-                    {
-                        DEBUG_LOG("Mail result: %d", res);
-                    }
-                );
-            }
-#endif
-
-            char data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_PARENTCONTROL };
-            send(data, sizeof(data));
-            return true;
-        }
-
-        BASIC_LOG("[AuthChallenge] Account '%s' using IP '%s' successfully authenticated", _login.c_str(), get_remote_address().c_str());
+        K = proof->K;
 
+        ///- Geolocking checks must be done after an otherwise successful login to prevent lockout attacks
         ///- Update the sessionkey, last_ip, last login time and reset number of failed logins in the account table for this account
         // No SQL injection (escaped user name) and IP address as received by socket
+        std::string address = get_remote_address();
+        LoginDatabase.escape_string(address);
+        std::string const safeLogin = _safelogin;
+        std::string const lastIP = _lastIP;
+        std::string const os(reinterpret_cast<char const*>(&_os), strnlen(reinterpret_cast<char const*>(&_os), sizeof(_os)));    // no injection as there are only two possible values
+        bool const checkGeoLock = !_geoUnlockPIN;
+        LockFlag const flags = lockFlags;
+        uint32 const locale = GetLocaleByName(_localizationName);
         const char* K_hex = K.AsHexStr();
-        const char *os = reinterpret_cast<char *>(&_os);    // no injection as there are only two possible values
-        auto result = LoginDatabase.PQuery("UPDATE `account` SET `sessionkey` = '%s', `last_ip` = '%s', `last_login` = NOW(), `locale` = '%u', `failed_logins` = 0, `os` = '%s' WHERE `username` = '%s'",
-            K_hex, get_remote_address().c_str(), GetLocaleByName(_localizationName), os, _safelogin.c_str() );
-        delete result;
+        std::string const sessionKey = K_hex;
         OPENSSL_free((void*)K_hex);
 
-        ///- Finish SRP6 and send the final result to the client
-        sha.Initialize();
-        sha.UpdateBigNumbers(&A, &M, &K, nullptr);
-        sha.Finalize();
-
-        SendProof(sha);
-
-        ///- Set _status to authed!
-        _status = STATUS_AUTHED;
+        _status = STATUS_PENDING;
+        return sAuthPipeline.Queue(_pipelineId, AuthPipeline::STEP_DATABASE, [proof, address, safeLogin, lastIP, os, checkGeoLock, flags, locale, sessionKey]()
+        {
+            bool const geolocked = checkGeoLock && GeographicalLockCheck(flags, lastIP, address);
+            if (!geolocked)
+            {
+                auto result = LoginDatabase.PQuery("UPDATE `account` SET `sessionkey` = '%s', `last_ip` = '%s', `last_login` = NOW(), `locale` = '%u', `failed_logins` = 0, `os` = '%s' WHERE `username` = '%s'",
+                    sessionKey.c_str(), address.c_str(), locale, os.c_str(), safeLogin.c_str() );
+                delete result;
+            }
+            return AuthPipeline::Continuation([proof, geolocked](AuthSocket& socket) { return socket.OnLogonProofSaved(*proof, geolocked); });
+        });
     }
     else
     {
@@ -910,45 +1045,124 @@ bool AuthSocket::_HandleLogonProof()
         uint32 MaxWrongPassCount = sConfig.GetIntDefault("WrongPass.MaxCount", 0);
         if(MaxWrongPassCount > 0)
         {
-            //Increment number of failed logins by one and if it reaches the limit temporarily ban that account or IP
-            LoginDatabase.PExecute("UPDATE `account` SET `failed_logins` = `failed_logins` + 1 WHERE `username` = '%s'",_safelogin.c_str());
-
-            if(QueryResult *loginfail = LoginDatabase.PQuery("SELECT `id`, `failed_logins` FROM `account` WHERE `username` = '%s'", _safelogin.c_str()))
+            uint32 WrongPassBanTime = sConfig.GetIntDefault("WrongPass.BanTime", 600);
+            bool WrongPassBanType = sConfig.GetBoolDefault("WrongPass.BanType", false);
+            std::string const login = _login;
+            std::string const safeLogin = _safelogin;
+            std::string current_ip = get_remote_address();
+            LoginDatabase.escape_string(current_ip);
+
+            // nothing left to send, the socket does not wait for the queries
+            sAuthPipeline.Queue(_pipelineId, AuthPipeline::STEP_DATABASE, [MaxWrongPassCount, WrongPassBanTime, WrongPassBanType, login, safeLogin, current_ip]()
             {
-                Field* fields = loginfail->Fetch();
-                uint32 failed_logins = fields[1].GetUInt32();
+                //Increment number of failed logins by one and if it reaches the limit temporarily ban that account or IP
+                LoginDatabase.DirectPExecute("UPDATE `account` SET `failed_logins` = `failed_logins` + 1 WHERE `username` = '%s'",safeLogin.c_str());
 
-                if( failed_logins >= MaxWrongPassCount )
+                if(QueryResult *loginfail = LoginDatabase.PQuery("SELECT `id`, `failed_logins` FROM `account` WHERE `username` = '%s'", safeLogin.c_str()))
                 {
-                    uint32 WrongPassBanTime = sConfig.GetIntDefault("WrongPass.BanTime", 600);
-                    bool WrongPassBanType = sConfig.GetBoolDefault("WrongPass.BanType", false);
+                    Field* fields = loginfail->Fetch();
+                    uint32 failed_logins = fields[1].GetUInt32();
 
-                    if(WrongPassBanType)
-                    {
-                        uint32 acc_id = fields[0].GetUInt32();
-                        LoginDatabase.PExecute("INSERT INTO `account_banned` (`id`, `bandate`, `unbandate`, `bannedby`, `banreason`, `active`, `realm`) "
-                            "VALUES ('%u',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban',1,1)",
-                            acc_id, WrongPassBanTime);
-                        BASIC_LOG("[AuthChallenge] Account '%s' using  IP '%s' got banned for '%u' seconds because it failed to authenticate '%u' times",
-                            _login.c_str(), get_remote_address().c_str(), WrongPassBanTime, failed_logins);
-                    }
-                    else
+                    if( failed_logins >= MaxWrongPassCount )
                     {
-                        std::string current_ip = get_remote_address();
-                        LoginDatabase.escape_string(current_ip);
-                        LoginDatabase.PExecute("INSERT INTO `ip_banned` VALUES ('%s',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban')",
-                            current_ip.c_str(), WrongPassBanTime);
-                        BASIC_LOG("[AuthChallenge] IP '%s' got banned for '%u' seconds because account '%s' failed to authenticate '%u' times",
-                            current_ip.c_str(), WrongPassBanTime, _login.c_str(), failed_logins);
+                        if(WrongPassBanType)
+                        {
+                            uint32 acc_id = fields[0].GetUInt32();
+                            LoginDatabase.PExecute("INSERT INTO `account_banned` (`id`, `bandate`, `unbandate`, `bannedby`, `banreason`, `active`, `realm`) "
+                                "VALUES ('%u',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban',1,1)",
+                                acc_id, WrongPassBanTime);
+                            BASIC_LOG("[AuthChallenge] Account '%s' using  IP '%s' got banned for '%u' seconds because it failed to authenticate '%u' times",
+                                login.c_str(), current_ip.c_str(), WrongPassBanTime, failed_logins);
+                        }
+                        else
+                        {
+                            LoginDatabase.PExecute("INSERT INTO `ip_banned` VALUES ('%s',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban')",
+                                current_ip.c_str(), WrongPassBanTime);
+                            BASIC_LOG("[AuthChallenge] IP '%s' got banned for '%u' seconds because account '%s' failed to authenticate '%u' times",
+                                current_ip.c_str(), WrongPassBanTime, login.c_str(), failed_logins);
+                        }
                     }
+                    delete loginfail;
                 }
-                delete loginfail;
-            }
+                return AuthPipeline::Continuation();
+            });
         }
     }
     return true;
 }
 
+/// Logon Proof, once the geolocking check is done and the session key saved
+bool AuthSocket::OnLogonProofSaved(LogonProofSrp6 const& proof, bool geolocked)
+{
+    ///- Session is closed unless overriden
+    _status = STATUS_CLOSED;
+
+    if (_geoUnlockPIN) // remove the PIN to unlock the account since login succeeded
+    {
+        auto result = LoginDatabase.PExecute("UPDATE `account` SET `geolock_pin` = 0 WHERE `username` = '%s'",
+            _safelogin.c_str());
+
+        if (!result)
+        {
+            sLog.outError("Unable to remove geolock PIN for %s - account has not been unlocked", _safelogin.c_str());
+        }
+    }
+    else if (geolocked)
+    {
+        BASIC_LOG("Account '%s' (%u) using IP '%s' has been geolocked", _login.c_str(), _accountId, get_remote_address().c_str()); // todo, add additional logging info
+
+        auto pin = urand(100000, 999999); // check rand32_max
+        auto result = LoginDatabase.PExecute("UPDATE `account` SET `geolock_pin` = %u WHERE `username` = '%s'",
+            pin, _safelogin.c_str());
+
+        if (!result)
+        {
+            sLog.outError("Unable to write geolock PIN for %s - account has not been locked", _safelogin.c_str());
+
+            char data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_DB_BUSY };
+            send(data, sizeof(data));
+            return true;
+        }
+
+#ifdef USE_SENDGRID
+        if (sConfig.GetBoolDefault("SendMail", false))
+        {
+            auto mail = std::make_unique<SendgridMail>
+            (
+                sConfig.GetStringDefault("SendGridKey", ""),
+                sConfig.GetStringDefault("GeolockGUID", "")
+            );
+
+            mail->recipient(_email);
+            mail->from(sConfig.GetStringDefault("MailFrom", ""));
+            mail->substitution("%username%", _login);
+            mail->substitution("%unlock_pin%", std::to_string(pin));
+            mail->substitution("%originating_ip%", get_remote_address());
+
+            MailerService::get_global_mailer()->send(std::move(mail),
+                [](SendgridMail::Result res)
+                {
+                    DEBUG_LOG("Mail result: %d", res);
+                }
+            );
+        }
+#endif
+
+        char data[2] = { CMD_AUTH_LOGON_PROOF, WOW_FAIL_PARENTCONTROL };
+        send(data, sizeof(data));
+        return true;
+    }
+
+    BASIC_LOG("[AuthChallenge] Account '%s' using IP '%s' successfully authenticated", _login.c_str(), get_remote_address().c_str());
+
+    ///- Send the final result to the client
+    SendProof(proof.M2);
+
+    ///- Set _status to authed!
+    _status = STATUS_AUTHED;
+    return true;
+}
+
 /// Reconnect Challenge command handler
 bool AuthSocket::_HandleReconnectChallenge()
 {
@@ -990,20 +1204,40 @@ bool AuthSocket::_HandleReconnectChallenge()
     EndianConvert(ch->build);
     _build = ch->build;
 
-    QueryResult *result = LoginDatabase.PQuery ("SELECT `sessionkey`, `id` FROM `account` WHERE `username` = '%s'", _safelogin.c_str ());
+    std::string const safeLogin = _safelogin;
+    _status = STATUS_PENDING;
+    return sAuthPipeline.Queue(_pipelineId, AuthPipeline::STEP_DATABASE, [safeLogin]()
+    {
+        bool found = false;
+        std::string sessionKey;
+        uint32 accountId = 0;
+        if (QueryResult *result = LoginDatabase.PQuery ("SELECT `sessionkey`, `id` FROM `account` WHERE `username` = '%s'", safeLogin.c_str ()))
+        {
+            Field* fields = result->Fetch ();
+            found = true;
+            sessionKey = fields[0].GetCppString();
+            accountId = fields[1].GetUInt32();
+            delete result;
+        }
+        return AuthPipeline::Continuation([found, sessionKey, accountId](AuthSocket& socket) { return socket.OnReconnectChallengeLookup(found, sessionKey, accountId); });
+    });
+}
+
+/// Reconnect Challenge, once the session key has been read from the database
+bool AuthSocket::OnReconnectChallengeLookup(bool found, std::string const& sessionKey, uint32 accountId)
+{
+    ///- Session is closed unless overriden
+    _status = STATUS_CLOSED;
 
     // Stop if the account is not found
-    if (!result)
+    if (!found)
     {
         sLog.outError("[ERROR] user %s tried to login and we cannot find his session key in the database.", _login.c_str());
-        close_connection();
         return false;
     }
 
-    Field* fields = result->Fetch ();
-    K.SetHexStr (fields[0].GetString ());
-    _accountId = fields[1].GetUInt32();
-    delete result;
+    K.SetHexStr (sessionKey.c_str ());
+    _accountId = accountId;
 
     ///- All good, await client's proof
     _status = STATUS_RECON_PROOF;
@@ -1409,35 +1643,15 @@ void AuthSocket::InitPatch()
     }
 }
 
-void AuthSocket::LoadAccountSecurityLevels(uint32 accountId)
-{
-    QueryResult* result = LoginDatabase.PQuery("SELECT `gmlevel`, `RealmID` FROM `account_access` WHERE `id` = %u",
-        accountId);
-    if (!result)
-        return;
-
-    do
-    {
-        Field *fields = result->Fetch();
-        AccountTypes security = AccountTypes(fields[0].GetUInt32());
-        int realmId = fields[1].GetInt32();
-        if (realmId < 0)
-            _accountDefaultSecurityLevel = security;
-        else
-            _accountSecurityOnRealm[realmId] = security;
-    } while (result->NextRow());
-
-    delete result;
-}
-
-bool AuthSocket::GeographicalLockCheck()
+/// Runs on a database step, only touches its arguments
+bool AuthSocket::GeographicalLockCheck(LockFlag lockFlags, std::string const& lastIP, std::string const& address)
 {
     if (!sConfig.GetBoolDefault("GeoLocking"), false)
     {
         return false;
     }
 
-    if (_lastIP.empty() || _lastIP == get_remote_address())
+    if (lastIP.empty() || lastIP == address)
     {
         return false;
     }
@@ -1452,7 +1666,7 @@ bool AuthSocket::GeographicalLockCheck()
         "FROM geoip "
         "WHERE network_last_integer >= INET_ATON('%s') "
         "ORDER BY network_last_integer ASC LIMIT 1",
-        get_remote_address().c_str(), get_remote_address().c_str())
+        address.c_str(), address.c_str())
         );
 
     auto result_prev = std::unique_ptr<QueryResult>(LoginDatabase.PQuery(
@@ -1460,7 +1674,7 @@ bool AuthSocket::GeographicalLockCheck()
         "FROM geoip "
         "WHERE network_last_integer >= INET_ATON('%s') "
         "ORDER BY network_last_integer ASC LIMIT 1",
-        _lastIP.c_str(), _lastIP.c_str())
+        lastIP.c_str(), lastIP.c_str())
         );
 
     if (!result && !result_prev)
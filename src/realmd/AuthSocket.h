@@ -33,6 +33,8 @@
 
 #include "BufferedSocket.h"
 
+#include <memory>
+
 struct PINData
 {
     uint8 salt[16];
@@ -50,6 +52,10 @@ enum LockFlag
     GEO_CITY        = 0x20
 };
 
+struct LogonChallengeLookup;
+struct LogonChallengeSrp6;
+struct LogonProofSrp6;
+
 /// Handle login commands
 class AuthSocket: public BufferedSocket
 {
@@ -77,7 +83,12 @@ class AuthSocket: public BufferedSocket
         bool _HandleXferCancel();
         bool _HandleXferAccept();
 
-        void _SetVSFields(const std::string& rI);
+        // continuations of the handlers, run once the pipeline steps are done
+        bool OnLogonChallengeLookup(LogonChallengeLookup const& lookup);
+        bool OnLogonChallengeSrp6(LogonChallengeLookup const& account, LogonChallengeSrp6& srp);
+        bool OnLogonProofSrp6(std::shared_ptr<LogonProofSrp6> const& proof);
+        bool OnLogonProofSaved(LogonProofSrp6 const& proof, bool geolocked);
+        bool OnReconnectChallengeLookup(bool found, std::string const& sessionKey, uint32 accountId);
 
     private:
         enum eStatus
@@ -87,7 +98,8 @@ class AuthSocket: public BufferedSocket
             STATUS_RECON_PROOF,
             STATUS_PATCH,      // unused in CMaNGOS
             STATUS_AUTHED,
-            STATUS_CLOSED
+            STATUS_CLOSED,
+            STATUS_PENDING     // waiting for an AuthPipeline step, packets stay buffered
         };
 
         bool VerifyVersion(uint8 const* a, int32 aLength, uint8 const* versionProof, bool isReconnect);
@@ -129,14 +141,14 @@ class AuthSocket: public BufferedSocket
         uint16 _build;
 
         AccountTypes GetSecurityOn(uint32 realmId) const;
-        void LoadAccountSecurityLevels(uint32 accountId);
-        bool GeographicalLockCheck();
+        static bool GeographicalLockCheck(LockFlag lockFlags, std::string const& lastIP, std::string const& address);
 
         AccountTypes _accountDefaultSecurityLevel;
         typedef std::map<uint32, AccountTypes> AccountSecurityMap;
         AccountSecurityMap _accountSecurityOnRealm;
 
         ACE_HANDLE patch_;
+        uint32 _pipelineId;
 
         void InitPatch();
 };
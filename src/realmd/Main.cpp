@@ -30,6 +30,7 @@
 #include "Config/Config.h"
 #include "Log.h"
 #include "AuthSocket.h"
+#include "AuthPipeline.h"
 #include "SystemConfig.h"
 #include "revision.h"
 #include "Util.h"
@@ -298,6 +299,9 @@ extern int main(int argc, char **argv)
         return 1;
     }
 
+    ///- Move the database queries and the SRP6 math of the logon handshakes off the network thread
+    sAuthPipeline.Initialize(ACE_Reactor::instance(), sConfig.GetIntDefault("Auth.DatabaseThreads", 1), sConfig.GetIntDefault("Auth.CryptoThreads", 2));
+
     ///- Catch termination signals
     HookSignals();
 
@@ -375,6 +379,9 @@ extern int main(int argc, char **argv)
 #endif
     }
 
+    ///- Wait for the logon steps in progress
+    sAuthPipeline.Shutdown();
+
     ///- Wait for the delay thread to exit
     LoginDatabase.HaltDelayThread();
 
@@ -449,7 +456,17 @@ bool StartDB()
     }
 
     sLog.outString("Database: %s", dbStringLog.c_str() );
-    if(!LoginDatabase.Initialize(dbstring.c_str()))
+
+    ///- One connection per auth database thread, plus the one of the network thread
+    int connections = sConfig.GetIntDefault("LoginDatabase.Connections", 2);
+    int const databaseThreads = sConfig.GetIntDefault("Auth.DatabaseThreads", 1);
+    if (databaseThreads > 0 && connections < databaseThreads + 1)
+    {
+        sLog.outString("LoginDatabase.Connections raised from %d to %d (Auth.DatabaseThreads + 1)", connections, databaseThreads + 1);
+        connections = databaseThreads + 1;
+    }
+
+    if(!LoginDatabase.Initialize(dbstring.c_str(), connections))
     {
         sLog.outError("Cannot connect to database");
         return false;
@@ -23,6 +23,7 @@
 #include "DatabaseEnv.h"
 #include "Config/Config.h"
 #include "Database/SqlOperations.h"
+#include "Timer.h"
 
 #include <ctime>
 #include <iostream>
@@ -140,7 +141,7 @@ Database::~Database()
     StopServer();
 }
 
-bool Database::Initialize(char const* infoString, int nConns /*= 1*/, int nWorkers)
+bool Database::Initialize(char const* infoString, int nConns /*= 1*/, int nWorkers, int nHolderConns)
 {
     // Enable logging of SQL commands (usually only GM commands)
     // (See method: PExecuteLog)
@@ -153,6 +154,8 @@ bool Database::Initialize(char const* infoString, int nConns /*= 1*/, int nWorke
     }
 
     m_pingIntervallms = sConfig.GetIntDefault ("MaxPingTime", 30) * (MINUTE * 1000);
+    m_asyncBatchSize = std::max(1, sConfig.GetIntDefault("Database.AsyncBatchSize", 64));
+    m_asyncStatsIntervalms = std::max(0, sConfig.GetIntDefault("Database.AsyncStatsInterval", 0)) * IN_MILLISECONDS;
 
     //create DB connections
 
@@ -177,6 +180,18 @@ bool Database::Initialize(char const* infoString, int nConns /*= 1*/, int nWorke
         m_pQueryConnections.push_back(pConn);
     }
 
+    // A failed batch is rolled back and replayed, which would apply twice
+    // the statements of the batch a rollback can't undo.
+    if (m_asyncBatchSize > 1)
+    {
+        if (uint32 tables = m_pQueryConnections[0]->GetNonTransactionalTableCount())
+        {
+            sLog.outString("Database %s: %u tables are not transactional (MyISAM), async writes are not batched (Database.AsyncBatchSize).",
+                           m_pQueryConnections[0]->GetDatabaseName().c_str(), tables);
+            m_asyncBatchSize = 1;
+        }
+    }
+
     //create and initialize connection for async requests
     m_pResultQueue = new SqlResultQueue;
     m_pAsyncConn = CreateConnection();
@@ -189,12 +204,26 @@ bool Database::Initialize(char const* infoString, int nConns /*= 1*/, int nWorke
         if (!InitDelayThread(infoString))
             return false;
 
+    //connections running the queries of a holder side by side with the async worker
+    for (int i = 0; i < std::min(nHolderConns, MAX_CONNECTION_POOL_SIZE); ++i)
+    {
+        SqlConnection* pConn = CreateConnection();
+        if (!pConn->Initialize(infoString))
+        {
+            delete pConn;
+            return false;
+        }
+
+        m_holderThreads.emplace_back([this, pConn]() { HolderThreadLoop(pConn); });
+    }
+
     return true;
 }
 
 void Database::StopServer()
 {
     HaltDelayThread();
+    HaltHolderThreads();
 
     /*Delete objects*/
     if (m_pResultQueue)
@@ -226,7 +255,7 @@ bool Database::InitDelayThread(std::string const& infoString)
     if(!threadConnection->Initialize(infoString.c_str()))
         return false;
 
-    std::shared_ptr<SqlDelayThread> tbody = std::make_shared<SqlDelayThread>(this, threadConnection);
+    std::shared_ptr<SqlDelayThread> tbody = std::make_shared<SqlDelayThread>(this, threadConnection, uint32(m_threadsBodies.size()));
     m_threadsBodies.emplace_back(tbody);
     m_delayThreads.emplace_back([tbody](){
         tbody->run();
@@ -252,6 +281,71 @@ void Database::HaltDelayThread()
     m_numAsyncWorkers = 0;
 }
 
+void Database::HaltHolderThreads()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_holderLock);
+        m_holderStopping = true;
+    }
+    m_holderWakeUp.notify_all();
+
+    for (auto& thread : m_holderThreads)
+        thread.join();
+
+    m_holderThreads.clear();
+    m_holderJobs.clear();
+}
+
+void Database::RunOnHolderConnections(uint32 count, std::function<void(SqlConnection*)> const& job)
+{
+    count = std::min(count, GetHolderConnectionCount());
+    if (!count)
+        return;
+
+    {
+        std::unique_lock<std::mutex> lock(m_holderLock);
+        for (uint32 i = 0; i < count; ++i)
+            m_holderJobs.push_back(job);
+    }
+
+    if (count == 1)
+        m_holderWakeUp.notify_one();
+    else
+        m_holderWakeUp.notify_all();
+}
+
+void Database::HolderThreadLoop(SqlConnection* conn)
+{
+    ThreadStart();
+
+    for (;;)
+    {
+        std::function<void(SqlConnection*)> job;
+        {
+            std::unique_lock<std::mutex> lock(m_holderLock);
+            // an idle connection still has to be pinged to not time out
+            uint32 const pingms = std::max(m_pingIntervallms, uint32(MINUTE * IN_MILLISECONDS));
+            if (!m_holderWakeUp.wait_for(lock, std::chrono::milliseconds(pingms), [this]() { return m_holderStopping || !m_holderJobs.empty(); }))
+            {
+                lock.unlock();
+                SqlConnection::Lock guard(conn);
+                if (QueryResult* res = guard->Query("SELECT 1"))
+                    delete res;
+                continue;
+            }
+            if (m_holderStopping)
+                break;
+
+            job = std::move(m_holderJobs.front());
+            m_holderJobs.pop_front();
+        }
+        job(conn);
+    }
+
+    delete conn;
+    ThreadEnd();
+}
+
 void Database::ThreadStart()
 {
 }
@@ -480,6 +574,17 @@ uint32 Database::GetTransactionSerialId()
     return 0;
 }
 
+bool Database::GetTransactionSize(uint32& statements, uint32& bytes)
+{
+    SqlTransaction* trans = m_TransStorage->get();
+    if (!trans)
+        return false;
+
+    statements = trans->GetOperationCount();
+    bytes = trans->GetPayloadSize();
+    return true;
+}
+
 bool Database::CommitTransaction()
 {
     if (!m_pAsyncConn)
@@ -546,7 +651,33 @@ void Database::AddToSerialDelayQueue(SqlOperation* op)
     // TODO: Load balance, must maintain mapping of serial ID so queries are
     // executed sequentially, however
     int worker = op->GetSerialId() % m_numAsyncWorkers;
-    m_threadsBodies[worker]->addSerialOperation(op);
+    AddToSerialDelayQueue(worker, op);
+}
+
+void Database::OnAsyncOperationQueued(SqlOperation* op)
+{
+    op->SetQueueTime(WorldTimer::getMSTime());
+    ++m_asyncQueueDepth;
+}
+
+void Database::CollectAsyncStats(SqlAsyncStats& stats)
+{
+    for (uint32 i = 0; i < m_numAsyncWorkers; ++i)
+        m_threadsBodies[i]->CollectStats(stats);
+}
+
+void Database::LogAsyncStats()
+{
+    SqlAsyncStats stats;
+    CollectAsyncStats(stats);
+    if (!stats.executed)
+        return;
+
+    std::string name = m_pAsyncConn ? m_pAsyncConn->GetDatabaseName() : "";
+    sLog.out(LOG_PERFORMANCE, "Database %s async: %u ops, %u batches (%u ops, %u replayed), latency p50 %ums p99 %ums max %ums, queue depth p50 %u p99 %u, pending %u",
+        name.c_str(), stats.executed, stats.batches, stats.batchedOperations, stats.replayed,
+        SqlAsyncStats::GetPercentile(stats.latency, 50), SqlAsyncStats::GetPercentile(stats.latency, 99), stats.maxLatency,
+        SqlAsyncStats::GetPercentile(stats.queueDepth, 50), SqlAsyncStats::GetPercentile(stats.queueDepth, 99), GetAsyncQueueDepth());
 }
 
 bool Database::HasAsyncQuery()
@@ -626,7 +757,7 @@ bool Database::ExecuteStmt(SqlStatementID const& id, SqlStmtParameters* params)
     if(pTrans)
     {
         //add SQL request to trans queue
-        pTrans->DelayExecute(new SqlPreparedRequest(id.ID(), params));
+        pTrans->DelayExecute(new SqlPreparedRequest(id.ID(), params, id.batchable()));
     }
     else
     {
@@ -635,7 +766,7 @@ bool Database::ExecuteStmt(SqlStatementID const& id, SqlStmtParameters* params)
             return DirectExecuteStmt(id, params);
 
         // Simple sql statement
-        AddToDelayQueue(new SqlPreparedRequest(id.ID(), params));
+        AddToDelayQueue(new SqlPreparedRequest(id.ID(), params, id.batchable()));
     }
 
     return true;
@@ -672,7 +803,7 @@ SqlStatement Database::CreateStatement(SqlStatementID& index, char const* fmt)
             nId = iter->second;
 
         //save initialized statement index info
-        index.init(nId, nParams);
+        index.init(nId, nParams, !SqlOperation::CommitsImplicitly(fmt));
     }
 
     return SqlStatement(index, *this);
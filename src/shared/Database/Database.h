@@ -30,6 +30,9 @@
 #include <memory>
 #include <thread>
 #include <atomic>
+#include <deque>
+#include <functional>
+#include <condition_variable>
 
 class SqlTransaction;
 class SqlResultQueue;
@@ -67,6 +70,8 @@ class SqlConnection
         virtual bool CommitTransaction() { return true; }
         // can't rollback without transaction support
         virtual bool RollbackTransaction() { return true; }
+        // number of tables of the database a rollback can't undo the writes to (MyISAM...)
+        virtual uint32 GetNonTransactionalTableCount() { return 0; }
 
         //methods to work with prepared statements
         bool ExecuteStmt(int nIndex, SqlStmtParameters const& id);
@@ -86,6 +91,7 @@ class SqlConnection
 
         //get DB object
         Database& DB() { return m_db; }
+        std::string const& GetDatabaseName() const { return m_database; }
 
     protected:
         SqlConnection(Database& db) : m_db(db) {}
@@ -120,11 +126,13 @@ class Database
     public:
         virtual ~Database();
 
-        virtual bool Initialize(char const* infoString, int nConns = 1, int nWorkers = 1);
+        virtual bool Initialize(char const* infoString, int nConns = 1, int nWorkers = 1, int nHolderConns = 0);
         //start worker thread for async DB request execution
         virtual bool InitDelayThread(std::string const& infoString);
         //stop worker thread
         virtual void HaltDelayThread();
+        //stop the threads owning the holder connections
+        void HaltHolderThreads();
 
         /// Synchronous DB queries
         inline QueryResult* Query(char const* sql)
@@ -226,6 +234,8 @@ class Database
         bool BeginTransaction(uint32 serialId = 0);
         bool InTransaction();
         uint32 GetTransactionSerialId();
+        // statements and bytes queued so far in the transaction of the current thread
+        bool GetTransactionSize(uint32& statements, uint32& bytes);
         bool CommitTransaction();
         bool RollbackTransaction();
         //for sync transaction execution
@@ -261,21 +271,38 @@ class Database
         //you should call it explicitly after your server successfully started up
         //NO ASYNC TRANSACTIONS DURING SERVER STARTUP - ONLY DURING RUNTIME!!!
         void AllowAsyncTransactions() { m_bAllowAsyncTransactions = true; }
-        inline void AddToDelayQueue(SqlOperation* op) { m_delayQueue->add(op); }
+        inline void AddToDelayQueue(SqlOperation* op) { OnAsyncOperationQueued(op); m_delayQueue->add(op); }
         inline bool NextDelayedOperation(SqlOperation*& op) { return m_delayQueue->next(op); }
 
-        inline void AddToSerialDelayQueue(int workerId, SqlOperation* op) { m_threadsBodies[workerId]->addSerialOperation(op); }
+        inline void AddToSerialDelayQueue(int workerId, SqlOperation* op) { OnAsyncOperationQueued(op); m_threadsBodies[workerId]->addSerialOperation(op); }
         bool NextSerialDelayedOperation(int workerId, SqlOperation*& op);
 
         bool HasAsyncQuery();
 
         void AddToSerialDelayQueue(SqlOperation* op);
 
+        // async operations queued but not executed yet, over every worker
+        uint32 GetAsyncQueueDepth() const { return m_asyncQueueDepth; }
+        void OnAsyncOperationDone() { --m_asyncQueueDepth; }
+        // max number of writes a worker commits in a single transaction
+        uint32 GetAsyncBatchSize() const { return m_asyncBatchSize; }
+        uint32 GetAsyncStatsInterval() const { return m_asyncStatsIntervalms; }
+
+        // sums the statistics of every worker since the previous call and resets them
+        void CollectAsyncStats(SqlAsyncStats& stats);
+        void LogAsyncStats();
+
+        // number of extra connections the queries of a single holder are spread over
+        uint32 GetHolderConnectionCount() const { return uint32(m_holderThreads.size()); }
+        // queues job on up to `count` holder connections, job has to cope with being run after its caller moved on
+        void RunOnHolderConnections(uint32 count, std::function<void(SqlConnection*)> const& job);
+
         // Frees data, cancels scheduled queries, closes connection
         void StopServer();
     protected:
         Database() : m_nQueryConnPoolSize(1), m_delayQueue(new SqlQueue()), m_pAsyncConn(nullptr),
                      m_pResultQueue(nullptr), m_numAsyncWorkers(0),
+                     m_asyncQueueDepth(0), m_asyncBatchSize(1), m_asyncStatsIntervalms(0), m_holderStopping(false),
                      m_bAllowAsyncTransactions(false), m_iStmtIndex(-1), m_logSQL(false), m_pingIntervallms(0)
         {
             m_nQueryCounter = -1;
@@ -338,6 +365,19 @@ class Database
         uint32              m_numAsyncWorkers;
         std::vector<std::shared_ptr<SqlDelayThread>>    m_threadsBodies;                  ///< Pointer to delay sql executer (owned by m_delayThread)
         std::vector<std::thread> m_delayThreads;                   ///< Pointer to executer thread
+        std::atomic<uint32> m_asyncQueueDepth;
+        uint32 m_asyncBatchSize;
+        uint32 m_asyncStatsIntervalms;
+
+        void OnAsyncOperationQueued(SqlOperation* op);
+
+        // every holder thread owns one connection and runs the jobs queued by RunOnHolderConnections
+        void HolderThreadLoop(SqlConnection* conn);
+        std::vector<std::thread> m_holderThreads;
+        std::deque<std::function<void(SqlConnection*)>> m_holderJobs;
+        std::mutex m_holderLock;
+        std::condition_variable m_holderWakeUp;
+        bool m_holderStopping;
 
         bool m_bAllowAsyncTransactions;                      ///< flag which specifies if async transactions are enabled
 
@@ -328,6 +328,18 @@ bool MySQLConnection::RollbackTransaction()
     return _TransactionCmd("ROLLBACK");
 }
 
+uint32 MySQLConnection::GetNonTransactionalTableCount()
+{
+    QueryResult* result = Query("SELECT COUNT(*) FROM information_schema.TABLES WHERE TABLE_SCHEMA = DATABASE() "
+                                "AND TABLE_TYPE = 'BASE TABLE' AND ENGINE NOT IN ('InnoDB', 'ndbcluster')");
+    if (!result)
+        return 0;
+
+    uint32 count = result->Fetch()[0].GetUInt32();
+    delete result;
+    return count;
+}
+
 unsigned long MySQLConnection::escape_string(char* to, char const* from, unsigned long length)
 {
     if (!mMysql || !to || !from || !length)
@@ -94,6 +94,7 @@ class MySQLConnection : public SqlConnection
         bool BeginTransaction() override;
         bool CommitTransaction() override;
         bool RollbackTransaction() override;
+        uint32 GetNonTransactionalTableCount() override;
 
     protected:
         SqlPreparedStatement* CreateStatement(std::string const& fmt) override;
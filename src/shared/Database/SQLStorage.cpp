@@ -18,6 +18,120 @@
 
 #include "SQLStorage.h"
 
+#if PLATFORM != PLATFORM_WINDOWS
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    uint32 const SNAPSHOT_MAGIC   = 0x534C5153;             // "SQLS"
+    uint32 const SNAPSHOT_VERSION = 1;
+
+    struct SnapshotHeader
+    {
+        uint32 magic;
+        uint32 version;
+        uint64 key;                                         // migrations, dependencies, table layout and row filter
+        uint32 maxEntry;
+        uint32 recordCount;
+        uint32 recordSize;
+        uint32 stringsSize;
+        uint64 checksum;                                    // of everything after the header
+    };
+
+    // Followed by recordCount record ids, the records with string pointers replaced by
+    // offsets into the strings block, then the strings block itself
+
+    std::string s_snapshotDirectory;                        // empty when snapshots are disabled
+    uint64 s_snapshotKey = 0;
+
+    // FNV-1a
+    uint64 HashBytes(void const* data, size_t size, uint64 hash = 14695981039346656037ULL)
+    {
+        uint8 const* bytes = static_cast<uint8 const*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    uint64 HashString(char const* str, uint64 hash)
+    {
+        // terminator included, so that "ab"+"c" and "a"+"bc" differ
+        return HashBytes(str, strlen(str) + 1, hash);
+    }
+
+    // Whole file contents, mapped where possible
+    class SnapshotFile
+    {
+        public:
+            explicit SnapshotFile(char const* filename) : m_data(nullptr), m_size(0), m_mapped(false)
+            {
+#if PLATFORM != PLATFORM_WINDOWS
+                int const fd = open(filename, O_RDONLY);
+                if (fd < 0)
+                    return;
+
+                struct stat fileStat;
+                if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+                {
+                    void* data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (data != MAP_FAILED)
+                    {
+                        m_data = static_cast<char const*>(data);
+                        m_size = fileStat.st_size;
+                        m_mapped = true;
+                    }
+                }
+                close(fd);
+#else
+                FILE* file = fopen(filename, "rb");
+                if (!file)
+                    return;
+
+                fseek(file, 0, SEEK_END);
+                long const size = ftell(file);
+                fseek(file, 0, SEEK_SET);
+                if (size > 0)
+                {
+                    m_buffer.resize(size);
+                    if (fread(&m_buffer[0], 1, size, file) == size_t(size))
+                    {
+                        m_data = &m_buffer[0];
+                        m_size = size;
+                    }
+                }
+                fclose(file);
+#endif
+            }
+
+            ~SnapshotFile()
+            {
+#if PLATFORM != PLATFORM_WINDOWS
+                if (m_mapped)
+                    munmap(const_cast<char*>(m_data), m_size);
+#endif
+            }
+
+            SnapshotFile(SnapshotFile const&) = delete;
+            SnapshotFile& operator=(SnapshotFile const&) = delete;
+
+            char const* data() const { return m_data; }
+            size_t size() const { return m_size; }
+
+        private:
+            char const* m_data;
+            size_t m_size;
+            bool m_mapped;
+            std::vector<char> m_buffer;
+    };
+}
+
 // -----------------------------------  SQLStorageBase  ---------------------------------------- //
 
 SQLStorageBase::SQLStorageBase() :
@@ -49,6 +163,9 @@ char* SQLStorageBase::createRecord(uint32 recordId)
     char* newRecord = &m_data[m_recordCount * m_recordSize];
     ++m_recordCount;
 
+    if (!s_snapshotDirectory.empty())
+        m_snapshotRecordIds.push_back(recordId);
+
     JustCreatedRecord(recordId, newRecord);
     return newRecord;
 }
@@ -63,6 +180,226 @@ void SQLStorageBase::prepareToLoad(uint32 maxEntry, uint32 recordCount, uint32 r
     memset(m_data, 0, recordCount * m_recordSize);
 
     m_recordCount = 0;
+    m_snapshotRecordIds.clear();
+}
+
+std::vector<uint32> SQLStorageBase::GetStringFieldOffsets() const
+{
+    std::vector<uint32> offsets;
+    uint32 offset = 0;
+    for (uint32 x = 0; x < m_dstFieldCount; ++x)
+    {
+        switch (m_dst_format[x])
+        {
+            case FT_LOGIC:
+                offset += sizeof(bool);
+                break;
+            case FT_STRING:
+            case FT_NA_POINTER:
+                offsets.push_back(offset);
+                offset += sizeof(char*);
+                break;
+            case FT_NA:
+            case FT_INT:
+                offset += sizeof(uint32);
+                break;
+            case FT_BYTE:
+            case FT_NA_BYTE:
+                offset += sizeof(char);
+                break;
+            case FT_FLOAT:
+            case FT_NA_FLOAT:
+                offset += sizeof(float);
+                break;
+            case FT_64BITINT:
+                offset += sizeof(uint64);
+                break;
+            default:
+                break;
+        }
+    }
+    return offsets;
+}
+
+void SQLStorageBase::EnableSnapshots(std::string const& directory)
+{
+    s_snapshotDirectory = directory;
+    if (s_snapshotDirectory.empty())
+        return;
+
+    if (s_snapshotDirectory.back() != '/' && s_snapshotDirectory.back() != '\\')
+        s_snapshotDirectory += '/';
+
+    // Any applied or removed migration invalidates every snapshot
+    s_snapshotKey = HashBytes(nullptr, 0);
+    if (QueryResult* result = WorldDatabase.Query("SELECT `id` FROM `migrations` ORDER BY `id`"))
+    {
+        do
+        {
+            s_snapshotKey = HashString(result->Fetch()[0].GetString(), s_snapshotKey);
+        }
+        while (result->NextRow());
+        delete result;
+    }
+
+    sLog.outString("Using world database snapshots in %s", s_snapshotDirectory.c_str());
+}
+
+void SQLStorageBase::AddSnapshotDependency(char const* value)
+{
+    s_snapshotKey = HashString(value, s_snapshotKey);
+}
+
+void SQLStorageBase::DisableSnapshots()
+{
+    s_snapshotDirectory.clear();
+}
+
+uint64 SQLStorageBase::GetSnapshotKey(std::string const& filter) const
+{
+    uint64 key = s_snapshotKey;
+    uint32 const pointerSize = sizeof(char*);
+    key = HashBytes(&pointerSize, sizeof(pointerSize), key);
+    key = HashString(m_tableName, key);
+    key = HashString(m_src_format, key);
+    key = HashString(m_dst_format, key);
+    return HashString(filter.c_str(), key);
+}
+
+std::string SQLStorageBase::GetSnapshotFileName() const
+{
+    return s_snapshotDirectory + m_tableName + ".snapshot";
+}
+
+bool SQLStorageBase::LoadSnapshot(uint32 maxEntry, uint32 recordCount, std::string const& filter)
+{
+    if (s_snapshotDirectory.empty() || !recordCount)
+        return false;
+
+    std::string const filename = GetSnapshotFileName();
+    SnapshotFile file(filename.c_str());
+    if (!file.data())
+        return false;
+
+    SnapshotHeader header;
+    if (file.size() < sizeof(header))
+        return false;
+    memcpy(&header, file.data(), sizeof(header));
+
+    // Row count and highest entry are queried anyway, they catch most changes made without a migration
+    uint64 const recordsSize = uint64(header.recordCount) * header.recordSize;
+    if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION ||
+            header.key != GetSnapshotKey(filter) ||
+            header.maxEntry != maxEntry || header.recordCount != recordCount ||
+            file.size() != sizeof(header) + header.recordCount * sizeof(uint32) + recordsSize + header.stringsSize ||
+            header.checksum != HashBytes(file.data() + sizeof(header), file.size() - sizeof(header)))
+    {
+        sLog.outString("Snapshot %s is out of date, loading `%s` from the database", filename.c_str(), m_tableName);
+        return false;
+    }
+
+    char const* ids = file.data() + sizeof(header);
+    char const* records = ids + header.recordCount * sizeof(uint32);
+    char const* strings = records + recordsSize;
+
+    std::vector<uint32> recordIds(header.recordCount);
+    memcpy(recordIds.data(), ids, recordIds.size() * sizeof(uint32));
+    for (uint32 recordId : recordIds)
+    {
+        if (recordId >= header.maxEntry)
+        {
+            sLog.outError("Snapshot %s has an invalid entry %u, loading `%s` from the database", filename.c_str(), recordId, m_tableName);
+            return false;
+        }
+    }
+
+    prepareToLoad(header.maxEntry, header.recordCount, header.recordSize);
+    memcpy(m_data, records, recordsSize);
+
+    std::vector<uint32> const stringOffsets = GetStringFieldOffsets();
+    for (uint32 recordId : recordIds)
+    {
+        char* record = createRecord(recordId);
+        for (uint32 offset : stringOffsets)
+        {
+            uintptr_t stringOffset;
+            memcpy(&stringOffset, record + offset, sizeof(stringOffset));
+            char const* src = stringOffset < header.stringsSize ? strings + stringOffset : "";
+            size_t const length = strnlen(src, header.stringsSize - std::min<uintptr_t>(stringOffset, header.stringsSize)) + 1;
+            char* dst = new char[length];
+            memcpy(dst, src, length - 1);
+            dst[length - 1] = 0;
+            memcpy(record + offset, &dst, sizeof(dst));
+        }
+    }
+    m_snapshotRecordIds.clear();
+
+    sLog.outString(">> Loaded `%s` from snapshot %s", m_tableName, filename.c_str());
+    return true;
+}
+
+void SQLStorageBase::SaveSnapshot(std::string const& filter)
+{
+    if (s_snapshotDirectory.empty() || m_snapshotRecordIds.size() != m_recordCount || !m_recordCount)
+    {
+        m_snapshotRecordIds.clear();
+        return;
+    }
+
+    std::vector<uint32> const stringOffsets = GetStringFieldOffsets();
+    std::vector<char> records(m_data, m_data + m_recordCount * m_recordSize);
+    std::string strings;
+    for (uint32 i = 0; i < m_recordCount; ++i)
+    {
+        char* record = &records[i * m_recordSize];
+        for (uint32 offset : stringOffsets)
+        {
+            char const* str;
+            memcpy(&str, record + offset, sizeof(str));
+            uintptr_t const stringOffset = strings.size();
+            strings.append(str ? str : "");
+            strings.push_back(0);
+            memcpy(record + offset, &stringOffset, sizeof(stringOffset));
+        }
+    }
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.key = GetSnapshotKey(filter);
+    header.maxEntry = m_maxEntry;
+    header.recordCount = m_recordCount;
+    header.recordSize = m_recordSize;
+    header.stringsSize = strings.size();
+    header.checksum = HashBytes(m_snapshotRecordIds.data(), m_snapshotRecordIds.size() * sizeof(uint32));
+    header.checksum = HashBytes(records.data(), records.size(), header.checksum);
+    header.checksum = HashBytes(strings.data(), strings.size(), header.checksum);
+
+    // Written aside then renamed, a crash never leaves a truncated snapshot behind
+    std::string const filename = GetSnapshotFileName();
+    std::string const tempFilename = filename + ".tmp";
+    FILE* file = fopen(tempFilename.c_str(), "wb");
+    if (!file)
+    {
+        sLog.outError("Can not write snapshot %s, check WorldDatabase.SnapshotDir", tempFilename.c_str());
+        m_snapshotRecordIds.clear();
+        return;
+    }
+
+    bool const written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                         fwrite(m_snapshotRecordIds.data(), sizeof(uint32), m_snapshotRecordIds.size(), file) == m_snapshotRecordIds.size() &&
+                         fwrite(records.data(), 1, records.size(), file) == records.size() &&
+                         fwrite(strings.data(), 1, strings.size(), file) == strings.size();
+    fclose(file);
+    std::vector<uint32>().swap(m_snapshotRecordIds);
+
+    remove(filename.c_str());
+    if (!written || rename(tempFilename.c_str(), filename.c_str()) != 0)
+    {
+        sLog.outError("Can not write snapshot %s", filename.c_str());
+        remove(tempFilename.c_str());
+    }
 }
 
 // Function to delete the data
@@ -118,6 +455,7 @@ void SQLStorageBase::Free()
     delete[] m_data;
     m_data = nullptr;
     m_recordCount = 0;
+    m_snapshotRecordIds.clear();
 }
 
 // -----------------------------------  SQLStorage  -------------------------------------------- //
@@ -66,6 +66,14 @@ class SQLStorageBase
         template<typename T>
         SQLSIterator<T> end() const { return SQLSIterator<T>(m_data + m_recordCount * m_recordSize, m_recordSize); }
 
+        // Tables loaded from now on are written to / read back from binary snapshots
+        // in directory, valid as long as the migrations applied to the world database do not change
+        static void EnableSnapshots(std::string const& directory);
+        // Data outside of the table that the loaded records depend on (eg. the script names
+        // resolved to ids), the snapshots of the tables loaded afterwards are valid for this value only
+        static void AddSnapshotDependency(char const* value);
+        static void DisableSnapshots();
+
     protected:
         SQLStorageBase();
         virtual ~SQLStorageBase() { Free(); }
@@ -80,9 +88,17 @@ class SQLStorageBase
         virtual void JustCreatedRecord(uint32 recordId, char* record) = 0;
         virtual void Free();
 
+        // filter identifies the rows selected from the table (eg. patch column and value)
+        bool LoadSnapshot(uint32 maxEntry, uint32 recordCount, std::string const& filter);
+        void SaveSnapshot(std::string const& filter);
+
     private:
         char* createRecord(uint32 recordId);
 
+        std::vector<uint32> GetStringFieldOffsets() const;
+        uint64 GetSnapshotKey(std::string const& filter) const;
+        std::string GetSnapshotFileName() const;
+
         // Information about the table
         char const* m_tableName;
         char const* m_entry_field;
@@ -98,6 +114,9 @@ class SQLStorageBase
 
         // Data Storage
         char* m_data;
+
+        // Ids passed to createRecord, kept only until the snapshot is written
+        std::vector<uint32> m_snapshotRecordIds;
 };
 
 class SQLStorage : public SQLStorageBase
@@ -211,6 +211,9 @@ void SQLStorageLoaderBase<DerivedLoader, StorageClass>::Load(StorageClass& store
         delete result;
     }
 
+    if (store.LoadSnapshot(maxRecordId, recordCount, ""))
+        return;
+
     result = WorldDatabase.PQuery("SELECT * FROM %s", store.GetTableName());
 
     if (!result)
@@ -329,6 +332,8 @@ void SQLStorageLoaderBase<DerivedLoader, StorageClass>::Load(StorageClass& store
     while (result->NextRow());
 
     delete result;
+
+    store.SaveSnapshot("");
 }
 
 template<class DerivedLoader, class StorageClass>
@@ -357,6 +362,10 @@ void SQLStorageLoaderBase<DerivedLoader, StorageClass>::LoadProgressive(StorageC
         delete result;
     }
 
+    std::string const snapshotFilter = column_name + "<=" + std::to_string(wow_patch);
+    if (store.LoadSnapshot(maxRecordId, recordCount, snapshotFilter))
+        return;
+
     result = WorldDatabase.PQuery("SELECT * FROM %s t1 WHERE %s=(SELECT max(%s) FROM %s t2 WHERE t1.%s=t2.%s && %s <= %u)", store.GetTableName(), column_name.c_str(), column_name.c_str(), store.GetTableName(), store.EntryFieldName(), store.EntryFieldName(), column_name.c_str(), wow_patch);
 
     if (!result)
@@ -480,6 +489,8 @@ void SQLStorageLoaderBase<DerivedLoader, StorageClass>::LoadProgressive(StorageC
     } while (result->NextRow());
 
     delete result;
+
+    store.SaveSnapshot(snapshotFilter);
 }
 
 #endif
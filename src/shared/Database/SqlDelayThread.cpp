@@ -22,9 +22,10 @@
 #include "Database/SqlDelayThread.h"
 #include "Database/SqlOperations.h"
 #include "DatabaseEnv.h"
+#include "Timer.h"
 
-SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn)
-    : m_dbEngine(db), m_dbConnection(conn), m_running(true)
+SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn, uint32 workerId)
+    : m_dbEngine(db), m_dbConnection(conn), m_running(true), m_workerId(workerId)
 {
 }
 
@@ -45,6 +46,13 @@ bool SqlDelayThread::HasAsyncQuery()
     return !m_serialDelayQueue.empty_unsafe();
 }
 
+void SqlDelayThread::CollectStats(SqlAsyncStats& stats)
+{
+    std::unique_lock<std::mutex> lock(m_statsLock);
+    stats.Add(m_stats);
+    m_stats = SqlAsyncStats();
+}
+
 void SqlDelayThread::run()
 {
     #ifndef DO_POSTGRESQL
@@ -53,24 +61,31 @@ void SqlDelayThread::run()
 
     uint32 const loopSleepms = 10;
 
-    uint32 const pingEveryLoop = m_dbEngine->GetPingIntervall() / loopSleepms;
-
-    uint32 loopCounter = 0;
+    uint32 lastPing = WorldTimer::getMSTime();
+    uint32 lastStats = lastPing;
     while (m_running)
     {
+        // keep going without sleeping as long as there is a backlog, so that
+        // save storms are not throttled to one queue drain every loopSleepms.
         // if the running state gets turned off while sleeping
         // empty the queue before exiting
-        std::this_thread::sleep_for(std::chrono::milliseconds(loopSleepms));
+        if (!ProcessRequests())
+            std::this_thread::sleep_for(std::chrono::milliseconds(loopSleepms));
 
-        ProcessRequests();
-
-        if((loopCounter++) >= pingEveryLoop)
+        if (WorldTimer::getMSTimeDiffToNow(lastPing) >= m_dbEngine->GetPingIntervall())
         {
-            loopCounter = 0;
+            lastPing = WorldTimer::getMSTime();
             m_dbEngine->Ping();
             if (QueryResult* res = m_dbConnection->Query("SELECT 1"))
                 delete res;
         }
+
+        // a single worker reports for the whole database
+        if (m_workerId == 0 && m_dbEngine->GetAsyncStatsInterval() && WorldTimer::getMSTimeDiffToNow(lastStats) >= m_dbEngine->GetAsyncStatsInterval())
+        {
+            lastStats = WorldTimer::getMSTime();
+            m_dbEngine->LogAsyncStats();
+        }
     }
 
     #ifndef DO_POSTGRESQL
@@ -83,19 +98,149 @@ void SqlDelayThread::Stop()
     m_running = false;
 }
 
-void SqlDelayThread::ProcessRequests()
+bool SqlDelayThread::ProcessRequests()
 {
+    uint32 const depth = m_dbEngine->GetAsyncQueueDepth();
+    if (depth)
+    {
+        std::unique_lock<std::mutex> lock(m_statsLock);
+        ++m_stats.queueDepth[SqlAsyncStats::GetBucket(depth)];
+    }
+
+    bool processed = false;
     SqlOperation* s = nullptr;
     while (m_dbEngine->NextDelayedOperation(s))
     {
-        s->Execute(m_dbConnection);
-        delete s;
+        Process(s);
+        processed = true;
     }
 
     // Process any serial operations for this worker
     while (m_serialDelayQueue.next(s))
     {
-        s->Execute(m_dbConnection);
-        delete s;
+        Process(s);
+        processed = true;
+    }
+
+    FlushBatch();
+    return processed;
+}
+
+void SqlDelayThread::Process(SqlOperation* op)
+{
+    if (m_dbEngine->GetAsyncBatchSize() > 1 && op->IsBatchable())
+    {
+        m_batch.push_back(op);
+        if (m_batch.size() >= m_dbEngine->GetAsyncBatchSize())
+            FlushBatch();
+        return;
+    }
+
+    // queries have to see the writes queued before them
+    FlushBatch();
+    op->Execute(m_dbConnection);
+    OnExecuted(op);
+}
+
+void SqlDelayThread::FlushBatch()
+{
+    if (m_batch.empty())
+        return;
+
+    if (m_batch.size() == 1)
+        m_batch.front()->Execute(m_dbConnection);
+    else
+    {
+        // one commit (and one log flush on the server) for the whole batch
+        // instead of one per statement. Each operation stays atomic: if anything
+        // fails, the batch is rolled back and every operation runs on its own,
+        // exactly as it would have without batching. Batches are only used when
+        // every table is transactional (see Database::Initialize) and never hold a
+        // statement committing implicitly (see SqlOperation::CommitsImplicitly),
+        // otherwise the rollback would leave some writes applied and the replay
+        // apply them twice.
+        SqlConnection::Lock guard(m_dbConnection);
+
+        bool success = m_dbConnection->BeginTransaction();
+        for (std::vector<SqlOperation*>::const_iterator itr = m_batch.begin(); success && itr != m_batch.end(); ++itr)
+            success = (*itr)->ExecuteInBatch(m_dbConnection);
+
+        if (success)
+            success = m_dbConnection->CommitTransaction();
+
+        if (!success)
+        {
+            m_dbConnection->RollbackTransaction();
+            for (SqlOperation* op : m_batch)
+                op->Execute(m_dbConnection);
+        }
+
+        std::unique_lock<std::mutex> lock(m_statsLock);
+        ++m_stats.batches;
+        m_stats.batchedOperations += m_batch.size();
+        if (!success)
+            m_stats.replayed += m_batch.size();
+    }
+
+    for (SqlOperation* op : m_batch)
+        OnExecuted(op);
+    m_batch.clear();
+}
+
+void SqlDelayThread::OnExecuted(SqlOperation* op)
+{
+    uint32 const latency = WorldTimer::getMSTimeDiffToNow(op->GetQueueTime());
+    delete op;
+    m_dbEngine->OnAsyncOperationDone();
+
+    std::unique_lock<std::mutex> lock(m_statsLock);
+    ++m_stats.executed;
+    ++m_stats.latency[SqlAsyncStats::GetBucket(latency)];
+    if (latency > m_stats.maxLatency)
+        m_stats.maxLatency = latency;
+}
+
+void SqlAsyncStats::Add(SqlAsyncStats const& other)
+{
+    executed += other.executed;
+    batches += other.batches;
+    batchedOperations += other.batchedOperations;
+    replayed += other.replayed;
+    if (other.maxLatency > maxLatency)
+        maxLatency = other.maxLatency;
+    for (uint32 i = 0; i < HISTOGRAM_SIZE; ++i)
+    {
+        latency[i] += other.latency[i];
+        queueDepth[i] += other.queueDepth[i];
+    }
+}
+
+uint32 SqlAsyncStats::GetBucket(uint32 value)
+{
+    uint32 bucket = 0;
+    while (value && bucket < HISTOGRAM_SIZE - 1)
+    {
+        value >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+uint32 SqlAsyncStats::GetPercentile(uint32 const* histogram, uint32 percent)
+{
+    uint64 total = 0;
+    for (uint32 i = 0; i < HISTOGRAM_SIZE; ++i)
+        total += histogram[i];
+    if (!total)
+        return 0;
+
+    uint64 const threshold = (total * percent + 99) / 100;
+    uint64 count = 0;
+    for (uint32 i = 0; i < HISTOGRAM_SIZE; ++i)
+    {
+        count += histogram[i];
+        if (count >= threshold)
+            return i ? (1 << i) - 1 : 0;
     }
+    return (1 << (HISTOGRAM_SIZE - 1)) - 1;
 }
@@ -23,12 +23,34 @@
 #define __SQLDELAYTHREAD_H
 
 #include "LockedQueue.h"
+#include "Platform/Define.h"
+#include <vector>
 
 
 class Database;
 class SqlOperation;
 class SqlConnection;
 
+struct SqlAsyncStats
+{
+    // bucket 0 counts zeros, bucket n counts values in [2^(n-1), 2^n), the last one everything above
+    static uint32 const HISTOGRAM_SIZE = 16;
+
+    uint32 executed = 0;                                    ///< operations done
+    uint32 batches = 0;                                     ///< transactions grouping several writes
+    uint32 batchedOperations = 0;                           ///< writes committed in one of those transactions
+    uint32 replayed = 0;                                    ///< writes run again one by one after their batch failed
+    uint32 maxLatency = 0;
+    uint32 latency[HISTOGRAM_SIZE] = {};                    ///< ms from queueing to the end of the execution
+    uint32 queueDepth[HISTOGRAM_SIZE] = {};                 ///< pending operations every time a worker wakes up with work
+
+    void Add(SqlAsyncStats const& other);
+
+    static uint32 GetBucket(uint32 value);
+    // upper bound of the bucket holding the given percentile
+    static uint32 GetPercentile(uint32 const* histogram, uint32 percent);
+};
+
 class SqlDelayThread
 {
     typedef LockedQueue<SqlOperation*, std::mutex> SqlQueue;
@@ -39,19 +61,27 @@ class SqlDelayThread
         SqlQueue m_serialDelayQueue;
         SqlConnection *m_dbConnection;                     ///< Pointer to DB connection
         volatile bool m_running;
+        uint32 m_workerId;
 
+        std::vector<SqlOperation*> m_batch;                 ///< Writes waiting to be committed together
+        std::mutex m_statsLock;
+        SqlAsyncStats m_stats;
 
-        //process all enqueued requests
-        void ProcessRequests();
+        //process all enqueued requests, returns false if there was none
+        bool ProcessRequests();
+        void Process(SqlOperation* op);
+        void FlushBatch();
+        void OnExecuted(SqlOperation* op);
 
     public:
-        SqlDelayThread(Database* db, SqlConnection* conn);
+        SqlDelayThread(Database* db, SqlConnection* conn, uint32 workerId);
         ~SqlDelayThread();
 
         ///< Put sql statement to delay queue
         bool Delay(SqlOperation* sql) { m_sqlQueue.add(sql); return true; }
         void addSerialOperation(SqlOperation *op);
         bool HasAsyncQuery();
+        void CollectStats(SqlAsyncStats& stats);
 
         virtual void Stop();                                ///< Stop event
         void run();                                 ///< Main Thread loop
@@ -26,8 +26,29 @@
 #include "Timer.h"
 #include "ThreadPool.h"
 
+#include <mutex>
+#include <condition_variable>
+
 #define LOCK_DB_CONN(conn) SqlConnection::Lock guard(conn)
 
+bool SqlOperation::CommitsImplicitly(char const* sql)
+{
+    static char const* const statements[] = { "ALTER", "ANALYZE", "BEGIN", "COMMIT", "CREATE", "DROP", "FLUSH", "GRANT",
+        "LOCK", "OPTIMIZE", "RENAME", "REPAIR", "REVOKE", "START", "TRUNCATE", "UNLOCK" };
+
+    while (isspace(static_cast<unsigned char>(*sql)) || *sql == '(')
+        ++sql;
+
+    for (char const* statement : statements)
+    {
+        size_t const length = strlen(statement);
+        if (strnicmp(sql, statement, length) == 0 && !isalnum(static_cast<unsigned char>(sql[length])) && sql[length] != '_')
+            return true;
+    }
+
+    return false;
+}
+
 /// ---- ASYNC STATEMENTS / TRANSACTIONS ----
 
 bool SqlPlainRequest::Execute(SqlConnection* conn)
@@ -70,7 +91,27 @@ bool SqlTransaction::Execute(SqlConnection* conn)
     return conn->CommitTransaction();
 }
 
-SqlPreparedRequest::SqlPreparedRequest(int nIndex, SqlStmtParameters* arg) : m_nIndex(nIndex), m_param(arg)
+bool SqlTransaction::ExecuteInBatch(SqlConnection* conn)
+{
+    LOCK_DB_CONN(conn);
+
+    // the enclosing batch is rolled back as a whole on failure, then replayed one operation at a time
+    for (SqlOperation* pStmt : m_queue)
+        if (!pStmt->Execute(conn))
+            return false;
+
+    return true;
+}
+
+size_t SqlTransaction::GetPayloadSize() const
+{
+    size_t size = 0;
+    for (SqlOperation const* pStmt : m_queue)
+        size += pStmt->GetPayloadSize();
+    return size;
+}
+
+SqlPreparedRequest::SqlPreparedRequest(int nIndex, SqlStmtParameters* arg, bool batchable) : m_nIndex(nIndex), m_param(arg), m_batchable(batchable)
 {
 }
 
@@ -85,6 +126,15 @@ bool SqlPreparedRequest::Execute(SqlConnection* conn)
     return conn->ExecuteStmt(m_nIndex, *m_param);
 }
 
+size_t SqlPreparedRequest::GetPayloadSize() const
+{
+    // the statement text was sent once, when it was prepared
+    size_t size = 0;
+    for (SqlStmtFieldData const& param : m_param->params())
+        size += param.size();
+    return size;
+}
+
 /// ---- ASYNC QUERIES ----
 
 bool SqlQuery::Execute(SqlConnection* conn)
@@ -291,15 +341,60 @@ bool SqlQueryHolderEx::Execute(SqlConnection* conn)
     if(!m_holder || !m_callback || !m_queue)
         return false;
 
-    LOCK_DB_CONN(conn);
     /// we can do this, we are friends
     std::vector<SqlQueryHolder::SqlResultPair> &queries = m_holder->m_queries;
-    for(size_t i = 0; i < queries.size(); i++)
+
+    /// the queries of a holder do not depend on each other: each connection
+    /// takes the next query not run yet, the holder connections of the database
+    /// helping this one. The holder is only complete once every helper that
+    /// started on it is done, helpers starting later find nothing left to do.
+    struct SharedState
+    {
+        std::atomic<size_t> next { 0 };
+        std::mutex lock;
+        std::condition_variable idle;
+        uint32 running = 0;
+        bool closed = false;
+    };
+    std::shared_ptr<SharedState> state = std::make_shared<SharedState>();
+    SqlQueryHolder* holder = m_holder;
+
+    auto runQueries = [state, holder, &queries](SqlConnection* c)
+    {
+        LOCK_DB_CONN(c);
+        for (size_t i = state->next++; i < queries.size(); i = state->next++)
+        {
+            /// execute all queries in the holder and pass the results
+            if (char const* sql = queries[i].first)
+                holder->SetResult(i, c->Query(sql));
+        }
+    };
+
+    uint32 const helpers = std::min(conn->DB().GetHolderConnectionCount(), uint32(queries.size() > 1 ? queries.size() - 1 : 0));
+    if (helpers)
+    {
+        conn->DB().RunOnHolderConnections(helpers, [state, runQueries](SqlConnection* c)
+        {
+            {
+                std::unique_lock<std::mutex> lock(state->lock);
+                if (state->closed)
+                    return;
+                ++state->running;
+            }
+            runQueries(c);
+            std::unique_lock<std::mutex> lock(state->lock);
+            if (!--state->running)
+                state->idle.notify_all();
+        });
+    }
+
+    runQueries(conn);
+
+    if (helpers)
     {
-        /// execute all queries in the holder and pass the results
-        char const *sql = queries[i].first;
-        if (sql)
-            m_holder->SetResult(i, conn->Query(sql));
+        std::unique_lock<std::mutex> lock(state->lock);
+        state->closed = true;
+        state->idle.wait(lock, [&state]() { return !state->running; });
     }
 
     /// sync with the caller thread
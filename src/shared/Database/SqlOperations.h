@@ -39,15 +39,32 @@ class SqlStmtParameters;
 class SqlOperation
 {
     public:
-        SqlOperation(uint32 id) : serialId(id) {}
-        SqlOperation() : serialId(0) {}
+        SqlOperation(uint32 id) : serialId(id), queueTime(0) {}
+        SqlOperation() : serialId(0), queueTime(0) {}
         uint32 GetSerialId() const { return serialId; }
         virtual void OnRemove() { delete this; }
         virtual bool Execute(SqlConnection* conn) = 0;
         virtual ~SqlOperation() {}
 
+        // writes without result may be committed together with other writes by the delay thread
+        virtual bool IsBatchable() const { return false; }
+        // executes inside a transaction opened by the caller
+        virtual bool ExecuteInBatch(SqlConnection* conn) { return Execute(conn); }
+
+        // bytes of SQL text and bound values sent to the server
+        virtual size_t GetPayloadSize() const { return 0; }
+
+        // DDL, LOCK TABLES and the like commit the open transaction: a batch holding
+        // one could only be rolled back partly, and its replay would apply twice
+        // the statements before it.
+        static bool CommitsImplicitly(char const* sql);
+
+        void SetQueueTime(uint32 time) { queueTime = time; }
+        uint32 GetQueueTime() const { return queueTime; }
+
     protected:
         uint32 serialId;
+        uint32 queueTime;
 };
 
 /// ---- ASYNC STATEMENTS / TRANSACTIONS ----
@@ -60,33 +77,43 @@ class SqlPlainRequest : public SqlOperation
         SqlPlainRequest(char const* sql) : m_sql(mangos_strdup(sql)){}
         ~SqlPlainRequest() { char* tofree = const_cast<char*>(m_sql); delete [] tofree; }
         bool Execute(SqlConnection* conn);
+        bool IsBatchable() const { return !CommitsImplicitly(m_sql); }
+        size_t GetPayloadSize() const { return strlen(m_sql); }
 };
 
 class SqlTransaction : public SqlOperation
 {
     private:
         std::vector<SqlOperation*> m_queue;
+        bool m_batchable;
 
     public:
-        SqlTransaction(uint32 serialId) : SqlOperation(serialId) {}
+        SqlTransaction(uint32 serialId) : SqlOperation(serialId), m_batchable(true) {}
         ~SqlTransaction();
 
-        void DelayExecute(SqlOperation* sql)   {   m_queue.push_back(sql); }
+        void DelayExecute(SqlOperation* sql)   {   m_queue.push_back(sql); m_batchable = m_batchable && sql->IsBatchable(); }
 
         bool Execute(SqlConnection* conn);
+        bool IsBatchable() const { return m_batchable; }
+        bool ExecuteInBatch(SqlConnection* conn);
+        size_t GetPayloadSize() const;
+        size_t GetOperationCount() const { return m_queue.size(); }
 };
 
 class SqlPreparedRequest : public SqlOperation
 {
     public:
-        SqlPreparedRequest(int nIndex, SqlStmtParameters* arg);
+        SqlPreparedRequest(int nIndex, SqlStmtParameters* arg, bool batchable);
         ~SqlPreparedRequest();
 
         bool Execute(SqlConnection* conn);
+        bool IsBatchable() const { return m_batchable; }
+        size_t GetPayloadSize() const;
 
     private:
         int const m_nIndex;
         SqlStmtParameters* m_param;
+        bool const m_batchable;
 };
 
 /// ---- ASYNC QUERIES ----
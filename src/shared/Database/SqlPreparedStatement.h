@@ -117,6 +117,16 @@ class SqlStmtFieldData
             }
         }
 
+        bool operator==(SqlStmtFieldData const& other) const
+        {
+            if (m_type != other.m_type)
+                return false;
+            if (m_type == FIELD_STRING)
+                return m_szStringData == other.m_szStringData;
+            return !memcmp(&m_binaryData, &other.m_binaryData, size());
+        }
+        bool operator!=(SqlStmtFieldData const& other) const { return !(*this == other); }
+
     private:
         SqlStmtFieldType m_type;
         SqlStmtField m_binaryData;
@@ -172,19 +182,21 @@ class SqlStmtParameters
 class SqlStatementID
 {
     public:
-        SqlStatementID() : m_bInitialized(false) {}
+        SqlStatementID() : m_bInitialized(false), m_bBatchable(false) {}
 
         int ID() const { return m_nIndex; }
         int arguments() const { return m_nArguments; }
         bool initialized() const { return m_bInitialized; }
+        bool batchable() const { return m_bBatchable; }
 
     private:
         friend class Database;
-        void init(int nID, int nArgs) { m_nIndex = nID; m_nArguments = nArgs; m_bInitialized = true; }
+        void init(int nID, int nArgs, bool batchable) { m_nIndex = nID; m_nArguments = nArgs; m_bBatchable = batchable; m_bInitialized = true; }
 
         int m_nIndex;
         int m_nArguments;
         bool m_bInitialized;
+        bool m_bBatchable;
 };
 
 //statement index
@@ -203,6 +215,8 @@ class SqlStatement
 
         int ID() const { return m_index.ID(); }
         int arguments() const { return m_index.arguments(); }
+        //get bound parameters, nullptr if none were added yet
+        SqlStmtParameters const* params() const { return m_pParams; }
 
         bool Execute();
         bool DirectExecute();
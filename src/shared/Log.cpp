@@ -27,9 +27,15 @@
 #include "ByteBuffer.h"
 #include "ProgressBar.h"
 
+#include "MPSCRingBuffer.h"
+
 #include <stdarg.h>
 #include <fstream>
 #include <iostream>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include "ace/OS_NS_unistd.h"
 
@@ -55,8 +61,284 @@ LogFilterData logFilterData[LOG_FILTER_COUNT] =
     { "honor",               "LogFilter_Honor",              true  },
 };
 
+static size_t FormatTimestamp(char* buffer, size_t size, time_t t)
+{
+    tm* aTm = localtime(&t);
+    //       YYYY   year
+    //       MM     month (2 digits 01-12)
+    //       DD     day (2 digits 01-31)
+    //       HH     hour (2 digits 00-23)
+    //       MM     minutes (2 digits 00-59)
+    //       SS     seconds (2 digits 00-59)
+    int const length = snprintf(buffer, size, "%-4d-%02d-%02d %02d:%02d:%02d ", aTm->tm_year+1900, aTm->tm_mon+1, aTm->tm_mday, aTm->tm_hour, aTm->tm_min, aTm->tm_sec);
+    return length > 0 ? std::min(size_t(length), size - 1) : 0;
+}
+
+static void AppendFormat(std::string& out, char const* format, va_list* ap)
+{
+    char buffer[1024];
+    va_list copy;
+    va_copy(copy, *ap);
+    int const length = vsnprintf(buffer, sizeof(buffer), format, copy);
+    va_end(copy);
+
+    if (length < 0)
+        return;
+
+    if (size_t(length) < sizeof(buffer))
+    {
+        out.append(buffer, length);
+        return;
+    }
+
+    size_t const offset = out.size();
+    out.resize(offset + length + 1);
+    vsnprintf(&out[offset], length + 1, format, *ap);
+    out.resize(offset + length);
+}
+
+/**
+ * @brief Writes the log files for the Log singleton when Log.Async.Enable is set.
+ *  Callers format their line into a record and push it to a lock-free ring,
+ *  a single thread pops the records, writes them and flushes every touched file once per batch.
+ */
+class LogWriter
+{
+    public:
+        struct Record
+        {
+            FILE* file = nullptr;                           // nullptr: per account GM log named by `path`
+            time_t time = 0;                                // 0: no timestamp prefix
+            bool packetDump = false;                        // `data` holds packet bytes, printed in hex after `text`
+            std::string path;
+            std::string text;
+            std::string data;
+        };
+
+        LogWriter(size_t queueSize, bool dropWhenFull, uint32 statsInterval)
+            : m_queue(queueSize), m_dropWhenFull(dropWhenFull), m_statsInterval(statsInterval),
+              m_statsFile(nullptr), m_stopping(false), m_sleeping(false) {}
+
+        ~LogWriter()
+        {
+            if (!m_thread.joinable())
+                return;
+
+            m_stopping.store(true);
+            WakeUp();
+            m_thread.join();
+        }
+
+        LogWriter(LogWriter const&) = delete;
+        LogWriter& operator=(LogWriter const&) = delete;
+
+        // Files have to be known before Start, the map is read without lock afterwards
+        void AddFile(FILE* file, char const* name)
+        {
+            m_files[file].name = name;
+        }
+
+        void Start(FILE* statsFile)
+        {
+            m_statsFile = statsFile;
+            m_files[nullptr].name = "GMLogFile (per account)";
+            m_thread = std::thread(&LogWriter::Run, this);
+        }
+
+        void Push(Record&& record)
+        {
+            while (!m_queue.push(std::move(record)))
+            {
+                if (m_dropWhenFull)
+                {
+                    auto itr = m_files.find(record.file);
+                    if (itr != m_files.end())
+                        ++itr->second.dropped;
+                    return;
+                }
+
+                WakeUp();
+                std::this_thread::yield();
+            }
+
+            if (m_sleeping.load())
+                WakeUp();
+        }
+
+        // Used for the synchronous mode too, returns the written size
+        static size_t Write(Record const& record, FILE* file)
+        {
+            size_t bytes = 0;
+            if (record.time)
+            {
+                char timestamp[32];
+                bytes += fwrite(timestamp, 1, FormatTimestamp(timestamp, sizeof(timestamp), record.time), file);
+            }
+
+            bytes += fwrite(record.text.data(), 1, record.text.size(), file);
+
+            if (record.packetDump)
+            {
+                static char const hexDigits[] = "0123456789ABCDEF";
+                char line[16 * 3 + 1];
+                for (size_t p = 0; p < record.data.size();)
+                {
+                    size_t length = 0;
+                    for (size_t j = 0; j < 16 && p < record.data.size(); ++j, ++p)
+                    {
+                        uint8 const byte = uint8(record.data[p]);
+                        line[length++] = hexDigits[byte >> 4];
+                        line[length++] = hexDigits[byte & 0xF];
+                        line[length++] = ' ';
+                    }
+                    line[length++] = '\n';
+                    bytes += fwrite(line, 1, length, file);
+                }
+                bytes += fwrite("\n\n", 1, 2, file);
+            }
+
+            return bytes;
+        }
+
+    private:
+        struct FileStats
+        {
+            std::string name;
+            uint64 lines = 0;                               // writer thread only
+            uint64 bytes = 0;
+            bool dirty = false;
+            std::atomic<uint64> dropped{0};
+        };
+
+        void WakeUp()
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_wakeUp.notify_one();
+        }
+
+        void Run()
+        {
+            std::vector<std::pair<FILE*, FileStats*>> dirtyFiles;
+            time_t nextStats = m_statsInterval ? time(nullptr) + m_statsInterval : 0;
+            Record record;
+
+            for (;;)
+            {
+                // read first, everything pushed before the destructor is written by the last round
+                bool const stopping = m_stopping.load();
+
+                // at most one ring worth of records between two flushes
+                for (size_t count = m_queue.capacity(); count && m_queue.pop(record); --count)
+                {
+                    // find, never insert: Push reads the map from the other threads
+                    auto itr = m_files.find(record.file);
+                    if (itr == m_files.end())
+                        continue;                           // not opened by Log::Initialize
+
+                    FileStats& stats = itr->second;
+                    if (record.file)
+                    {
+                        stats.bytes += Write(record, record.file);
+                        if (!stats.dirty)
+                        {
+                            stats.dirty = true;
+                            dirtyFiles.emplace_back(record.file, &stats);
+                        }
+                    }
+                    else if (FILE* file = fopen(record.path.c_str(), "a"))
+                    {
+                        stats.bytes += Write(record, file);
+                        fclose(file);
+                    }
+                    ++stats.lines;
+                }
+
+                for (auto const& file : dirtyFiles)
+                {
+                    fflush(file.first);
+                    file.second->dirty = false;
+                }
+                dirtyFiles.clear();
+
+                if (nextStats && time(nullptr) >= nextStats)
+                {
+                    WriteStats();
+                    nextStats = time(nullptr) + m_statsInterval;
+                }
+
+                if (stopping)
+                    break;
+
+                std::unique_lock<std::mutex> guard(m_lock);
+                m_sleeping.store(true);
+                if (!m_queue.size() && !m_stopping.load())
+                    m_wakeUp.wait_for(guard, std::chrono::milliseconds(100));
+                m_sleeping.store(false);
+            }
+        }
+
+        void WriteStats()
+        {
+            if (!m_statsFile)
+                return;
+
+            time_t const now = time(nullptr);
+            for (auto& file : m_files)
+            {
+                FileStats& stats = file.second;
+                uint64 const dropped = stats.dropped.exchange(0);
+                if (!stats.lines && !dropped)
+                    continue;
+
+                Record record;
+                record.time = now;
+                char buffer[256];
+                snprintf(buffer, sizeof(buffer), "Log: %s: " UI64FMTD " lines, " UI64FMTD " bytes written, " UI64FMTD " dropped in the last %u s\n",
+                         stats.name.c_str(), stats.lines, stats.bytes, dropped, m_statsInterval);
+                record.text = buffer;
+                Write(record, m_statsFile);
+
+                stats.lines = 0;
+                stats.bytes = 0;
+            }
+            fflush(m_statsFile);
+        }
+
+        MPSCRingBuffer<Record> m_queue;
+        bool const m_dropWhenFull;
+        uint32 const m_statsInterval;
+        FILE* m_statsFile;
+        std::map<FILE*, FileStats> m_files;
+
+        std::thread m_thread;
+        std::mutex m_lock;
+        std::condition_variable m_wakeUp;
+        std::atomic<bool> m_stopping;
+        std::atomic<bool> m_sleeping;
+};
+
+static void SubmitRecord(LogWriter* writer, LogWriter::Record&& record)
+{
+    if (writer)
+    {
+        writer->Push(std::move(record));
+        return;
+    }
+
+    if (record.file)
+    {
+        LogWriter::Write(record, record.file);
+        fflush(record.file);
+    }
+    else if (FILE* file = fopen(record.path.c_str(), "a"))
+    {
+        LogWriter::Write(record, file);
+        fclose(file);
+    }
+}
+
 Log::Log() :
-    logfile(nullptr), gmLogfile(nullptr), dberLogfile(nullptr),
+    m_writer(nullptr), logfile(nullptr), gmLogfile(nullptr), dberLogfile(nullptr),
     wardenLogfile(nullptr), anticheatLogfile(nullptr), honorLogfile(nullptr), m_colored(false), m_includeTime(false), m_wardenDebug(false), m_gmlog_per_account(false)
 {
     for (int i = 0; i < LOG_MAX_FILES; ++i)
@@ -67,6 +349,46 @@ Log::Log() :
     Initialize();
 }
 
+Log::~Log()
+{
+    // writes whatever is still queued, the files have to stay open until then
+    delete m_writer;
+    m_writer = nullptr;
+
+    if(logfile != nullptr)
+        fclose(logfile);
+    logfile = nullptr;
+
+    if(gmLogfile != nullptr)
+        fclose(gmLogfile);
+    gmLogfile = nullptr;
+
+    if(dberLogfile != nullptr)
+        fclose(dberLogfile);
+    dberLogfile = nullptr;
+
+    if (worldLogfile != nullptr)
+        fclose(worldLogfile);
+    worldLogfile = nullptr;
+
+    if (nostalriusLogFile != nullptr)
+        fclose(nostalriusLogFile);
+    nostalriusLogFile = nullptr;
+
+    if (honorLogfile != nullptr)
+        fclose(honorLogfile);
+    honorLogfile = nullptr;
+
+    for (auto& logFile : logFiles)
+    {
+        if (logFile != nullptr)
+        {
+            fclose(logFile);
+            logFile = nullptr;
+        }
+    } 
+}
+
 void Log::InitColors(std::string const& str)
 {
     if (str.empty())
@@ -246,6 +568,15 @@ void Log::SetLogFileLevel(char* level)
 
 void Log::Initialize()
 {
+    delete m_writer;
+    m_writer = nullptr;
+
+    /// Asynchronous writing, created first so that the opened files get registered
+    if (sConfig.GetBoolDefault("Log.Async.Enable", false))
+        m_writer = new LogWriter(std::max(sConfig.GetIntDefault("Log.Async.QueueSize", 65536), 2),
+                                 sConfig.GetBoolDefault("Log.Async.DropWhenFull", false),
+                                 std::max(sConfig.GetIntDefault("Log.Async.StatsInterval", 0), 0));
+
     /// Common log files data
     m_logsDir = sConfig.GetStringDefault("LogsDir","");
     if (!m_logsDir.empty())
@@ -333,6 +664,9 @@ void Log::Initialize()
 
     // Char log settings
     m_charLog_Dump = sConfig.GetBoolDefault("CharLogDump", false);
+
+    if (m_writer)
+        m_writer->Start(logfile);
 }
 
 FILE* Log::openLogFile(char const* configFileName,char const* configTimeStampFlag, char const* mode)
@@ -350,30 +684,46 @@ FILE* Log::openLogFile(char const* configFileName,char const* configTimeStampFla
             logfn += m_logsTimestamp;
     }
 
-    return fopen((m_logsDir+logfn).c_str(), mode);
+    FILE* file = fopen((m_logsDir+logfn).c_str(), mode);
+    if (file && m_writer)
+        m_writer->AddFile(file, configFileName);
+    return file;
 }
 
-FILE* Log::openGmlogPerAccount(uint32 account)
+std::string Log::getGmlogPerAccountFileName(uint32 account) const
 {
     if (m_gmlog_filename_format.empty())
-        return nullptr;
+        return std::string();
 
     char namebuf[MANGOS_PATH_MAX];
     snprintf(namebuf,MANGOS_PATH_MAX,m_gmlog_filename_format.c_str(),account);
-    return fopen(namebuf, "a");
+    return namebuf;
+}
+
+void Log::writeLine(FILE* file, bool timestamp, char const* prefix, char const* format, va_list* ap)
+{
+    std::string text;
+    if (prefix)
+        text = prefix;
+    if (format)
+        AppendFormat(text, format, ap);
+    writeLine(file, timestamp, std::move(text));
+}
+
+void Log::writeLine(FILE* file, bool timestamp, std::string&& text)
+{
+    LogWriter::Record record;
+    record.file = file;
+    record.time = timestamp ? time(nullptr) : 0;
+    record.text = std::move(text);
+    record.text += '\n';
+    SubmitRecord(m_writer, std::move(record));
 }
 
 void Log::outTimestamp(FILE* file)
 {
-    time_t t = time(nullptr);
-    tm* aTm = localtime(&t);
-    //       YYYY   year
-    //       MM     month (2 digits 01-12)
-    //       DD     day (2 digits 01-31)
-    //       HH     hour (2 digits 00-23)
-    //       MM     minutes (2 digits 00-59)
-    //       SS     seconds (2 digits 00-59)
-    fprintf(file,"%-4d-%02d-%02d %02d:%02d:%02d ",aTm->tm_year+1900,aTm->tm_mon+1,aTm->tm_mday,aTm->tm_hour,aTm->tm_min,aTm->tm_sec);
+    char timestamp[32];
+    fwrite(timestamp, 1, FormatTimestamp(timestamp, sizeof(timestamp), time(nullptr)), file);
 }
 
 void Log::outTime(FILE* where)
@@ -410,11 +760,7 @@ void Log::outString()
         outTime(stdout);
     printf("\n");
     if (logfile)
-    {
-        outTimestamp(logfile);
-        fprintf(logfile, "\n");
-        fflush(logfile);
-    }
+        writeLine(logfile, true, std::string());
 
     fflush(stdout);
 }
@@ -443,14 +789,9 @@ void Log::outString(char const* str, ...)
 
     if (logfile)
     {
-        outTimestamp(logfile);
-
         va_start(ap, str);
-        vfprintf(logfile, str, ap);
-        fprintf(logfile, "\n");
+        writeLine(logfile, true, nullptr, str, &ap);
         va_end(ap);
-
-        fflush(logfile);
     }
 
     fflush(stdout);
@@ -468,15 +809,9 @@ void Log::outInfo(char const* str, ...)
     printf ("\n");
     if (nostalriusLogFile)
     {
-        outTimestamp(nostalriusLogFile);
-
         va_start(ap, str);
-        vfprintf(nostalriusLogFile, str, ap);
-        fprintf(nostalriusLogFile, "\n");
-        fflush(nostalriusLogFile);
+        writeLine(nostalriusLogFile, true, nullptr, str, &ap);
         va_end(ap);
-
-        fflush(nostalriusLogFile);
     }
     fflush(stdout);
 }
@@ -509,17 +844,11 @@ void Log::outHonor(char const* str, ...)
 
     if (honorLogfile)
     {
-        outTimestamp(honorLogfile);
-        fprintf(honorLogfile, "%s", "");
-
         va_list ap;
 
         va_start(ap, str);
-        vfprintf(honorLogfile, str, ap);
+        writeLine(honorLogfile, true, nullptr, str, &ap);
         va_end(ap);
-
-        fprintf(honorLogfile, "\n");
-        fflush(honorLogfile);
     }
 }
 
@@ -531,17 +860,10 @@ void Log::out(LogFile type, char const* str, ...)
 
     if (logFiles[type])
     {
-        if (timestampPrefix[type])
-            outTimestamp(logFiles[type]);
-
         va_list ap;
         va_start(ap, str);
-        vfprintf(logFiles[type], str, ap);
-        fprintf(logFiles[type], "\n");
-        fflush(logFiles[type]);
+        writeLine(logFiles[type], timestampPrefix[type], nullptr, str, &ap);
         va_end(ap);
-
-        fflush(logFiles[type]);
     }
     fflush(stdout);
 }
@@ -569,15 +891,9 @@ void Log::outError(char const* err, ...)
     fprintf(stderr, "\n");
     if (logfile)
     {
-        outTimestamp(logfile);
-        fprintf(logfile, "ERROR:");
-
         va_start(ap, err);
-        vfprintf(logfile, err, ap);
+        writeLine(logfile, true, "ERROR:", err, &ap);
         va_end(ap);
-
-        fprintf(logfile, "\n");
-        fflush(logfile);
     }
 
     fflush(stderr);
@@ -591,18 +907,10 @@ void Log::outErrorDb()
     fprintf(stderr, "\n");
 
     if (logfile)
-    {
-        outTimestamp(logfile);
-        fprintf(logfile, "ERROR:\n");
-        fflush(logfile);
-    }
+        writeLine(logfile, true, "ERROR:");
 
     if (dberLogfile)
-    {
-        outTimestamp(dberLogfile);
-        fprintf(dberLogfile, "\n");
-        fflush(dberLogfile);
-    }
+        writeLine(dberLogfile, true, std::string());
 
     fflush(stderr);
 }
@@ -631,28 +939,16 @@ void Log::outErrorDb(char const* err, ...)
 
     if (logfile)
     {
-        outTimestamp(logfile);
-        fprintf(logfile, "ERROR:");
-
         va_start(ap, err);
-        vfprintf(logfile, err, ap);
+        writeLine(logfile, true, "ERROR:", err, &ap);
         va_end(ap);
-
-        fprintf(logfile, "\n");
-        fflush(logfile);
     }
 
     if (dberLogfile)
     {
-        outTimestamp(dberLogfile);
-
-        va_list ap;
         va_start(ap, err);
-        vfprintf(dberLogfile, err, ap);
+        writeLine(dberLogfile, true, nullptr, err, &ap);
         va_end(ap);
-
-        fprintf(dberLogfile, "\n");
-        fflush(dberLogfile);
     }
 
     fflush(stderr);
@@ -685,12 +981,9 @@ void Log::outBasic(char const* str, ...)
     if (logfile && m_logFileLevel >= LOG_LVL_BASIC)
     {
         va_list ap;
-        outTimestamp(logfile);
         va_start(ap, str);
-        vfprintf(logfile, str, ap);
-        fprintf(logfile, "\n");
+        writeLine(logfile, true, nullptr, str, &ap);
         va_end(ap);
-        fflush(logfile);
     }
 
     fflush(stdout);
@@ -723,15 +1016,10 @@ void Log::outDetail(char const* str, ...)
 
     if (logfile && m_logFileLevel >= LOG_LVL_DETAIL)
     {
-        outTimestamp(logfile);
-
         va_list ap;
         va_start(ap, str);
-        vfprintf(logfile, str, ap);
+        writeLine(logfile, true, nullptr, str, &ap);
         va_end(ap);
-
-        fprintf(logfile, "\n");
-        fflush(logfile);
     }
 
     fflush(stdout);
@@ -763,15 +1051,10 @@ void Log::outDebug(char const* str, ...)
 
     if (logfile && m_logFileLevel >= LOG_LVL_DEBUG)
     {
-        outTimestamp(logfile);
-
         va_list ap;
         va_start(ap, str);
-        vfprintf(logfile, str, ap);
+        writeLine(logfile, true, nullptr, str, &ap);
         va_end(ap);
-
-        fprintf(logfile, "\n");
-        fflush(logfile);
     }
 
     fflush(stdout);
@@ -803,16 +1086,9 @@ void Log::outWarden(char const* wrd, ...)
 
     if (wardenLogfile)
     {
-        outTimestamp(wardenLogfile);
-        fprintf(wardenLogfile, "[Warden] ");
-
-        va_list ap;
         va_start(ap, wrd);
-        vfprintf(wardenLogfile, wrd, ap);
+        writeLine(wardenLogfile, true, "[Warden] ", wrd, &ap);
         va_end(ap);
-
-        fprintf(wardenLogfile, "\n");
-        fflush(wardenLogfile);
     }
 
     fflush(stdout);
@@ -847,16 +1123,9 @@ void Log::outWardenDebug(char const* wrd, ...)
 
     if (wardenLogfile)
     {
-        outTimestamp(wardenLogfile);
-        fprintf(wardenLogfile, "[Warden] ");
-
-        va_list ap;
         va_start(ap, wrd);
-        vfprintf(wardenLogfile, wrd, ap);
+        writeLine(wardenLogfile, true, "[Warden] ", wrd, &ap);
         va_end(ap);
-
-        fprintf(wardenLogfile, "\n");
-        fflush(wardenLogfile);
     }
 
     fflush(stdout);
@@ -882,10 +1151,11 @@ void Log::outAnticheat(char const* detector, char const* player, char const* rea
 
     if (anticheatLogfile)
     {
-        outTimestamp(anticheatLogfile);
-        fprintf(anticheatLogfile, "[%s] Player %s, Cheat: %s, Penalty: %s", detector, player, reason, penalty);
-        fprintf(anticheatLogfile, "\n");
-        fflush(anticheatLogfile);
+        std::string text;
+        text.reserve(64);
+        text.append("[").append(detector).append("] Player ").append(player)
+            .append(", Cheat: ").append(reason).append(", Penalty: ").append(penalty);
+        writeLine(anticheatLogfile, true, std::move(text));
     }
 
     fflush(stdout);
@@ -918,36 +1188,35 @@ void Log::outCommand(uint32 account, char const* str, ...)
     if (logfile && m_logFileLevel >= LOG_LVL_DETAIL)
     {
         va_list ap;
-        outTimestamp(logfile);
         va_start(ap, str);
-        vfprintf(logfile, str, ap);
-        fprintf(logfile, "\n");
+        writeLine(logfile, true, nullptr, str, &ap);
         va_end(ap);
-        fflush(logfile);
     }
 
     if (m_gmlog_per_account)
     {
-        if (FILE* per_file = openGmlogPerAccount (account))
+        std::string fileName = getGmlogPerAccountFileName(account);
+        if (!fileName.empty())
         {
+            LogWriter::Record record;
+            record.path = std::move(fileName);
+            record.time = time(nullptr);
+
             va_list ap;
-            outTimestamp(per_file);
             va_start(ap, str);
-            vfprintf(per_file, str, ap);
-            fprintf(per_file, "\n");
+            AppendFormat(record.text, str, &ap);
             va_end(ap);
-            fclose(per_file);
+            record.text += '\n';
+
+            SubmitRecord(m_writer, std::move(record));
         }
     }
     else if (gmLogfile)
     {
         va_list ap;
-        outTimestamp(gmLogfile);
         va_start(ap, str);
-        vfprintf(gmLogfile, str, ap);
-        fprintf(gmLogfile, "\n");
+        writeLine(gmLogfile, true, nullptr, str, &ap);
         va_end(ap);
-        fflush(gmLogfile);
     }
 
     fflush(stdout);
@@ -960,24 +1229,23 @@ void Log::outWorldPacketDump(ACE_HANDLE socketHandle, uint32 opcode,
     if (!worldLogfile)
         return;
 
-    outTimestamp(worldLogfile);
-
-    fprintf(worldLogfile,
-            "\n%s:\nSOCKET: %p\nLENGTH: %zu\nOPCODE: %s (0x%.4X)\nDATA:\n",
-            incoming ? "CLIENT" : "SERVER", socketHandle, packet->size(),
-            opcodeName, opcode);
+    // only the raw bytes are copied here, the hex dump is formatted when written
+    LogWriter::Record record;
+    record.file = worldLogfile;
+    record.time = time(nullptr);
+    record.packetDump = true;
 
-    size_t p = 0;
-    while (p < packet->size())
-    {
-        for (size_t j = 0; j < 16 && p < packet->size(); ++j)
-            fprintf(worldLogfile, "%.2X ", (*packet)[p++]);
+    char header[256];
+    snprintf(header, sizeof(header),
+             "\n%s:\nSOCKET: %p\nLENGTH: %zu\nOPCODE: %s (0x%.4X)\nDATA:\n",
+             incoming ? "CLIENT" : "SERVER", socketHandle, packet->size(),
+             opcodeName, opcode);
+    record.text = header;
 
-        fprintf(worldLogfile, "\n");
-    }
+    if (packet->size())
+        record.data.assign(reinterpret_cast<char const*>(packet->contents()), packet->size());
 
-    fprintf(worldLogfile, "\n\n");
-    fflush(worldLogfile);
+    SubmitRecord(m_writer, std::move(record));
 }
 
 void Log::WaitBeforeContinueIfNeed()
@@ -25,8 +25,11 @@
 #include "Common.h"
 #include "Policies/Singleton.h"
 
+#include <stdarg.h>
+
 class Config;
 class ByteBuffer;
+class LogWriter;
 
 enum LogLevel
 {
@@ -122,41 +125,8 @@ class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, std::m
     friend class MaNGOS::OperatorNew<Log>;
     Log();
 
-    ~Log()
-    {
-        if(logfile != nullptr)
-            fclose(logfile);
-        logfile = nullptr;
-
-        if(gmLogfile != nullptr)
-            fclose(gmLogfile);
-        gmLogfile = nullptr;
-
-        if(dberLogfile != nullptr)
-            fclose(dberLogfile);
-        dberLogfile = nullptr;
-
-        if (worldLogfile != nullptr)
-            fclose(worldLogfile);
-        worldLogfile = nullptr;
-
-        if (nostalriusLogFile != nullptr)
-            fclose(nostalriusLogFile);
-        nostalriusLogFile = nullptr;
-
-        if (honorLogfile != nullptr)
-            fclose(honorLogfile);
-        honorLogfile = nullptr;
-
-        for (auto& logFile : logFiles)
-        {
-            if (logFile != nullptr)
-            {
-                fclose(logFile);
-                logFile = nullptr;
-            }
-        } 
-    }
+    ~Log();
+
     public:
         void Initialize();
         void InitColors(std::string const& init_str);
@@ -203,6 +173,7 @@ class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, std::m
         void SetLogFilter(LogFilters filter, bool on) { if (on) m_logFilter |= filter; else m_logFilter &= ~filter; }
         bool HasLogLevelOrHigher(LogLevel loglvl) const { return m_logLevel >= loglvl || (m_logFileLevel >= loglvl && logfile); }
         bool IsIncludeTime() const { return m_includeTime; }
+        std::string const& GetLogsDir() const { return m_logsDir; }
 
         static void WaitBeforeContinueIfNeed();
 
@@ -211,7 +182,13 @@ class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, std::m
 
     private:
         FILE* openLogFile(char const* configFileName,char const* configTimeStampFlag, char const* mode);
-        FILE* openGmlogPerAccount(uint32 account);
+        std::string getGmlogPerAccountFileName(uint32 account) const;
+
+        // Appends one line to a log file, the line is written by the writer thread when Log.Async.Enable is set
+        void writeLine(FILE* file, bool timestamp, char const* prefix, char const* format, va_list* ap);
+        void writeLine(FILE* file, bool timestamp, std::string&& text);
+
+        LogWriter* m_writer;
 
         FILE* logfile;
         FILE* gmLogfile;
@@ -0,0 +1,118 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MPSCRINGBUFFER_H
+#define MPSCRINGBUFFER_H
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Bounded lock-free queue: any number of threads may push, a single
+ *  thread at a time may pop. Every slot carries a sequence number telling
+ *  whether it is free for the producer of a given round or ready for the consumer.
+ */
+template <class T>
+class MPSCRingBuffer
+{
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    public:
+
+        //! Create a ring holding at least `capacity` items (rounded up to a power of 2).
+        explicit MPSCRingBuffer(size_t capacity)
+            : _mask(RoundUp(capacity) - 1), _slots(new Slot[_mask + 1]), _enqueuePos(0), _dequeuePos(0)
+        {
+            for (size_t i = 0; i <= _mask; ++i)
+                _slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        MPSCRingBuffer(MPSCRingBuffer const&) = delete;
+        MPSCRingBuffer& operator=(MPSCRingBuffer const&) = delete;
+
+        //! Adds an item, returns false without touching it if the ring is full.
+        bool push(T&& item)
+        {
+            Slot* slot;
+            size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                slot = &_slots[pos & _mask];
+                size_t const sequence = slot->sequence.load(std::memory_order_acquire);
+                intptr_t const diff = intptr_t(sequence) - intptr_t(pos);
+                if (diff == 0)
+                {
+                    if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                    return false;
+                else
+                    pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+
+            slot->value = std::move(item);
+            slot->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        //! Gets the oldest item, returns false if there is none. Consumer thread only.
+        bool pop(T& result)
+        {
+            size_t const pos = _dequeuePos.load(std::memory_order_relaxed);
+            Slot& slot = _slots[pos & _mask];
+            if (slot.sequence.load(std::memory_order_acquire) != pos + 1)
+                return false;
+
+            result = std::move(slot.value);
+            slot.value = T();
+            slot.sequence.store(pos + _mask + 1, std::memory_order_release);
+            _dequeuePos.store(pos + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        //! Approximate number of queued items, may be read from any thread.
+        size_t size() const
+        {
+            size_t const enqueued = _enqueuePos.load(std::memory_order_relaxed);
+            size_t const dequeued = _dequeuePos.load(std::memory_order_relaxed);
+            return enqueued > dequeued ? enqueued - dequeued : 0;
+        }
+
+        size_t capacity() const { return _mask + 1; }
+
+    private:
+        static size_t RoundUp(size_t capacity)
+        {
+            size_t size = 2;
+            while (size < capacity)
+                size <<= 1;
+            return size;
+        }
+
+        size_t const _mask;
+        std::unique_ptr<Slot[]> _slots;
+        std::atomic<size_t> _enqueuePos;
+        std::atomic<size_t> _dequeuePos;
+};
+
+#endif
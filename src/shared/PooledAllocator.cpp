@@ -0,0 +1,231 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "PooledAllocator.h"
+#include "Log.h"
+#include "Errors.h"
+
+#include <new>
+#include <algorithm>
+
+namespace
+{
+    uint32 const MAX_POOLED_ALLOCATORS = 16;
+    size_t const CHUNK_SIZE = 64 * 1024;
+    size_t const MIN_BLOCKS_PER_CHUNK = 16;
+
+    // in front of every block, keeps the payload aligned like ::operator new does
+    size_t const HEADER_SIZE = std::max(sizeof(void*), alignof(std::max_align_t));
+
+    size_t RoundUp(size_t size, size_t alignment)
+    {
+        return (size + alignment - 1) / alignment * alignment;
+    }
+
+    // counters written by the owner thread only, read by the statistics
+    void Increment(std::atomic<uint64>& counter)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    std::mutex& GetRegistryLock()
+    {
+        static std::mutex lock;
+        return lock;
+    }
+
+    std::vector<PooledAllocator*>& GetRegistry()
+    {
+        static std::vector<PooledAllocator*> registry;
+        return registry;
+    }
+}
+
+struct PooledAllocator::FreeBlock
+{
+    FreeBlock* next;
+};
+
+struct PooledAllocator::Cache
+{
+    FreeBlock* freeList = nullptr;                          // owner thread only
+    std::atomic<FreeBlock*> remoteFreeList{nullptr};        // pushed by the other threads
+    std::atomic<uint64> chunks{0};
+    std::atomic<uint64> allocations{0};
+    std::atomic<uint64> localFrees{0};
+    std::atomic<uint64> remoteFrees{0};
+};
+
+// Caches used by the current thread, given back to their allocator when it exits
+struct PooledAllocatorThreadCaches
+{
+    PooledAllocator::Cache* caches[MAX_POOLED_ALLOCATORS] = {};
+    PooledAllocator* allocators[MAX_POOLED_ALLOCATORS] = {};
+
+    ~PooledAllocatorThreadCaches()
+    {
+        for (uint32 i = 0; i < MAX_POOLED_ALLOCATORS; ++i)
+        {
+            if (!caches[i])
+                continue;
+
+            std::lock_guard<std::mutex> guard(allocators[i]->m_cachesLock);
+            allocators[i]->m_orphanCaches.push_back(caches[i]);
+            caches[i] = nullptr;
+        }
+    }
+};
+
+static thread_local PooledAllocatorThreadCaches t_caches;
+
+PooledAllocator::PooledAllocator(char const* name, size_t blockSize) :
+    m_name(name), m_blockSize(blockSize),
+    m_stride(HEADER_SIZE + RoundUp(std::max(blockSize, sizeof(FreeBlock)), HEADER_SIZE)),
+    m_blocksPerChunk(std::max(MIN_BLOCKS_PER_CHUNK, CHUNK_SIZE / m_stride)),
+    m_index(0), m_oversized(0)
+{
+    std::lock_guard<std::mutex> guard(GetRegistryLock());
+    MANGOS_ASSERT(GetRegistry().size() < MAX_POOLED_ALLOCATORS);
+    m_index = uint32(GetRegistry().size());
+    GetRegistry().push_back(this);
+}
+
+PooledAllocator::Cache* PooledAllocator::getThreadCache()
+{
+    Cache*& cache = t_caches.caches[m_index];
+    if (!cache)
+    {
+        cache = acquireCache();
+        t_caches.allocators[m_index] = this;
+    }
+    return cache;
+}
+
+PooledAllocator::Cache* PooledAllocator::acquireCache()
+{
+    std::lock_guard<std::mutex> guard(m_cachesLock);
+    if (!m_orphanCaches.empty())
+    {
+        Cache* cache = m_orphanCaches.back();
+        m_orphanCaches.pop_back();
+        return cache;
+    }
+
+    m_caches.push_back(new Cache());
+    return m_caches.back();
+}
+
+void PooledAllocator::allocateChunk(Cache* cache)
+{
+    char* memory = static_cast<char*>(::operator new(m_stride * m_blocksPerChunk));
+    for (size_t i = m_blocksPerChunk; i > 0; --i)
+    {
+        char* header = memory + (i - 1) * m_stride;
+        *reinterpret_cast<Cache**>(header) = cache;
+        FreeBlock* block = new (header + HEADER_SIZE) FreeBlock;
+        block->next = cache->freeList;
+        cache->freeList = block;
+    }
+    Increment(cache->chunks);
+}
+
+void* PooledAllocator::allocate(size_t size)
+{
+    if (size > m_blockSize)
+    {
+        m_oversized.fetch_add(1, std::memory_order_relaxed);
+        char* header = static_cast<char*>(::operator new(HEADER_SIZE + size));
+        *reinterpret_cast<Cache**>(header) = nullptr;
+        return header + HEADER_SIZE;
+    }
+
+    Cache* cache = getThreadCache();
+    if (!cache->freeList)
+    {
+        cache->freeList = cache->remoteFreeList.exchange(nullptr, std::memory_order_acquire);
+        if (!cache->freeList)
+            allocateChunk(cache);
+    }
+
+    FreeBlock* block = cache->freeList;
+    cache->freeList = block->next;
+    Increment(cache->allocations);
+    return block;
+}
+
+void PooledAllocator::deallocate(void* pointer)
+{
+    if (!pointer)
+        return;
+
+    char* header = static_cast<char*>(pointer) - HEADER_SIZE;
+    Cache* owner = *reinterpret_cast<Cache**>(header);
+    if (!owner)
+    {
+        ::operator delete(header);
+        return;
+    }
+
+    FreeBlock* block = new (pointer) FreeBlock;
+    if (owner == t_caches.caches[m_index])
+    {
+        block->next = owner->freeList;
+        owner->freeList = block;
+        Increment(owner->localFrees);
+        return;
+    }
+
+    // deferred free, the owner takes the whole list back once it runs out of blocks
+    FreeBlock* head = owner->remoteFreeList.load(std::memory_order_relaxed);
+    do
+    {
+        block->next = head;
+    }
+    while (!owner->remoteFreeList.compare_exchange_weak(head, block, std::memory_order_release, std::memory_order_relaxed));
+    owner->remoteFrees.fetch_add(1, std::memory_order_relaxed);
+}
+
+PooledAllocator::Stats PooledAllocator::getStats() const
+{
+    Stats stats;
+    stats.name = m_name;
+    stats.blockSize = m_blockSize;
+    stats.oversized = m_oversized.load(std::memory_order_relaxed);
+
+    uint64 frees = 0;
+    std::lock_guard<std::mutex> guard(m_cachesLock);
+    stats.caches = uint32(m_caches.size());
+    for (Cache const* cache : m_caches)
+    {
+        stats.chunks += cache->chunks.load(std::memory_order_relaxed);
+        stats.allocations += cache->allocations.load(std::memory_order_relaxed);
+        stats.remoteFrees += cache->remoteFrees.load(std::memory_order_relaxed);
+        frees += cache->localFrees.load(std::memory_order_relaxed);
+    }
+    stats.capacity = stats.chunks * m_blocksPerChunk;
+    frees += stats.remoteFrees;
+    stats.inUse = stats.allocations > frees ? stats.allocations - frees : 0;
+    return stats;
+}
+
+std::vector<PooledAllocator::Stats> PooledAllocator::getAllStats()
+{
+    std::vector<Stats> stats;
+    std::lock_guard<std::mutex> guard(GetRegistryLock());
+    for (PooledAllocator const* allocator : GetRegistry())
+        stats.push_back(allocator->getStats());
+    return stats;
+}
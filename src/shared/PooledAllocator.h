@@ -0,0 +1,93 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef POOLEDALLOCATOR_H
+#define POOLEDALLOCATOR_H
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+
+#include "Platform/Define.h"
+
+/**
+ * @brief Fixed size block allocator with one cache per thread, meant for the
+ *  class level operator new/delete of objects created and destroyed at a high
+ *  rate by the map threads (spells, auras).
+ *  A thread allocates from its own cache without any lock. A block freed by
+ *  another thread is pushed to a lock-free list of its owner cache, the owner
+ *  takes the whole list back when its own free list is empty.
+ *  Memory is never returned to the system, the cache of a thread that exits
+ *  is kept with its blocks and handed to the next thread that needs one.
+ *  Requests bigger than the block size go to the global allocator.
+ */
+class PooledAllocator
+{
+public:
+    struct Stats
+    {
+        std::string name;
+        size_t blockSize = 0;
+        uint32 caches = 0;        // threads that allocated from this allocator
+        uint64 chunks = 0;        // chunks requested from the global allocator
+        uint64 capacity = 0;      // blocks in those chunks
+        uint64 allocations = 0;
+        uint64 inUse = 0;
+        uint64 remoteFrees = 0;   // blocks freed by a thread that does not own them
+        uint64 oversized = 0;     // requests sent to the global allocator
+    };
+
+    /**
+     * @param name shown in the statistics
+     * @param blockSize biggest object served from the pool, usually the biggest class of a hierarchy
+     */
+    PooledAllocator(char const* name, size_t blockSize);
+    PooledAllocator(PooledAllocator const&) = delete;
+    PooledAllocator& operator=(PooledAllocator const&) = delete;
+
+    void* allocate(size_t size);
+    void deallocate(void* pointer);
+
+    Stats getStats() const;
+
+    /// Statistics of every allocator created so far.
+    static std::vector<Stats> getAllStats();
+
+private:
+    struct Cache;
+    struct FreeBlock;
+
+    Cache* getThreadCache();
+    Cache* acquireCache();
+    void allocateChunk(Cache* cache);
+
+    std::string const m_name;
+    size_t const m_blockSize;
+    size_t const m_stride;
+    size_t const m_blocksPerChunk;
+    uint32 m_index;                                         // slot in the per thread cache table
+
+    mutable std::mutex m_cachesLock;
+    std::vector<Cache*> m_caches;                           // never deleted
+    std::vector<Cache*> m_orphanCaches;                     // left by a thread that exited
+    std::atomic<uint64> m_oversized;
+
+    friend struct PooledAllocatorThreadCaches;
+};
+
+#endif
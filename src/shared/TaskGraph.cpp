@@ -0,0 +1,183 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "TaskGraph.h"
+#include "Timer.h"
+#include "Errors.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+size_t TaskGraph::find(char const* name) const
+{
+    for (size_t i = 0; i < m_tasks.size(); ++i)
+        if (m_tasks[i].name == name)
+            return i;
+    return m_tasks.size();
+}
+
+void TaskGraph::add(char const* name, std::initializer_list<char const*> dependencies, Callable function)
+{
+    MANGOS_ASSERT(find(name) == m_tasks.size());
+
+    size_t const index = m_tasks.size();
+    Task task;
+    task.name = name;
+    task.function = std::move(function);
+    for (char const* dependency : dependencies)
+    {
+        size_t const dependencyIndex = find(dependency);
+        if (dependencyIndex == m_tasks.size())
+        {
+            sLog.outError("TaskGraph: task '%s' depends on '%s' which is not declared before it", name, dependency);
+            MANGOS_ASSERT(false);
+        }
+        task.dependencies.push_back(dependencyIndex);
+        m_tasks[dependencyIndex].dependents.push_back(index);
+    }
+    m_tasks.push_back(std::move(task));
+}
+
+void TaskGraph::execute(size_t index, uint32 runStart)
+{
+    Task& task = m_tasks[index];
+    uint32 const start = WorldTimer::getMSTime();
+    task.startMs = WorldTimer::getMSTimeDiff(runStart, start);
+    task.function();
+    task.durationMs = WorldTimer::getMSTimeDiffToNow(start);
+}
+
+void TaskGraph::run(int numThreads, Callable initThread, Callable exitThread)
+{
+    m_numThreads = std::max(1, std::min(numThreads, int(m_tasks.size())));
+    uint32 const runStart = WorldTimer::getMSTime();
+
+    if (m_numThreads == 1)
+    {
+        for (size_t i = 0; i < m_tasks.size(); ++i)
+            execute(i, runStart);
+        m_wallClockMs = WorldTimer::getMSTimeDiffToNow(runStart);
+        return;
+    }
+
+    std::mutex lock;
+    std::condition_variable taskDone;
+    std::vector<size_t> pendingDependencies(m_tasks.size());
+    std::set<size_t> ready;                                 // lowest declaration index first
+    size_t remaining = m_tasks.size();
+
+    for (size_t i = 0; i < m_tasks.size(); ++i)
+    {
+        pendingDependencies[i] = m_tasks[i].dependencies.size();
+        if (!pendingDependencies[i])
+            ready.insert(i);
+    }
+
+    auto worker = [&]()
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        while (remaining)
+        {
+            if (ready.empty())
+            {
+                taskDone.wait(guard);
+                continue;
+            }
+
+            size_t const index = *ready.begin();
+            ready.erase(ready.begin());
+
+            guard.unlock();
+            execute(index, runStart);
+            guard.lock();
+
+            --remaining;
+            for (size_t dependent : m_tasks[index].dependents)
+                if (!--pendingDependencies[dependent])
+                    ready.insert(dependent);
+            taskDone.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(m_numThreads - 1);
+    for (int i = 1; i < m_numThreads; ++i)
+    {
+        threads.emplace_back([&]()
+        {
+            if (initThread)
+                initThread();
+            worker();
+            if (exitThread)
+                exitThread();
+        });
+    }
+
+    worker();
+
+    for (auto& thread : threads)
+        thread.join();
+
+    m_wallClockMs = WorldTimer::getMSTimeDiffToNow(runStart);
+}
+
+void TaskGraph::logTimings(char const* title) const
+{
+    if (m_tasks.empty())
+        return;
+
+    uint32 totalMs = 0;
+    for (auto const& task : m_tasks)
+        totalMs += task.durationMs;
+
+    sLog.outString();
+    sLog.outString("%s: %u tasks in %u ms on %d thread(s), %u ms if run one after another", title, uint32(m_tasks.size()), m_wallClockMs, m_numThreads, totalMs);
+    for (auto const& task : m_tasks)
+        sLog.outString("  %-40s %7u ms  (started at +%u ms)", task.name.c_str(), task.durationMs, task.startMs);
+
+    // Longest chain of dependent tasks, tasks are declared after their dependencies
+    std::vector<uint32> pathMs(m_tasks.size());
+    std::vector<size_t> previous(m_tasks.size(), m_tasks.size());
+    size_t last = 0;
+    for (size_t i = 0; i < m_tasks.size(); ++i)
+    {
+        uint32 longestDependency = 0;
+        for (size_t dependency : m_tasks[i].dependencies)
+        {
+            if (pathMs[dependency] >= longestDependency)
+            {
+                longestDependency = pathMs[dependency];
+                previous[i] = dependency;
+            }
+        }
+        pathMs[i] = longestDependency + m_tasks[i].durationMs;
+        if (pathMs[i] > pathMs[last])
+            last = i;
+    }
+
+    std::vector<size_t> path;
+    for (size_t i = last; i < m_tasks.size(); i = previous[i])
+        path.push_back(i);
+
+    sLog.outString("Critical path: %u ms", pathMs[last]);
+    for (auto itr = path.rbegin(); itr != path.rend(); ++itr)
+        sLog.outString("  %-40s %7u ms", m_tasks[*itr].name.c_str(), m_tasks[*itr].durationMs);
+    sLog.outString();
+}
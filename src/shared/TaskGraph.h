@@ -0,0 +1,84 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <initializer_list>
+
+#include "Platform/Define.h"
+
+/**
+ * @brief Set of named tasks with dependencies between them, run once.
+ *  A task may only depend on tasks declared before it, so the declaration
+ *  order is always a valid sequential order and the graph can not have cycles.
+ *  With more than one thread, every task whose dependencies are done may run
+ *  concurrently with the others.
+ */
+class TaskGraph
+{
+public:
+    using Callable = std::function<void()>;
+
+    TaskGraph() = default;
+    TaskGraph(TaskGraph const&) = delete;
+    TaskGraph& operator=(TaskGraph const&) = delete;
+
+    /**
+     * @brief add declares a task.
+     * @param name unique name, used by later tasks to refer to this one and in the timings
+     * @param dependencies names of previously declared tasks that must be done first
+     */
+    void add(char const* name, std::initializer_list<char const*> dependencies, Callable function);
+
+    /**
+     * @brief run executes every task and returns once all of them are done.
+     * @param numThreads threads running tasks, the calling thread included.
+     *  With 1 (or less) the tasks run on the calling thread in declaration order.
+     * @param initThread called once in every additional thread before it takes any task (eg. mysql_thread_init)
+     * @param exitThread called once in every additional thread before it exits
+     */
+    void run(int numThreads, Callable initThread = Callable(), Callable exitThread = Callable());
+
+    /**
+     * @brief logTimings prints the duration of every task, the wall clock time
+     *  of the whole run and the chain of tasks it could not go below (critical path).
+     */
+    void logTimings(char const* title) const;
+
+private:
+    struct Task
+    {
+        std::string name;
+        Callable function;
+        std::vector<size_t> dependencies;
+        std::vector<size_t> dependents;
+        uint32 startMs = 0;                                 // relative to the start of run()
+        uint32 durationMs = 0;
+    };
+
+    size_t find(char const* name) const;
+    void execute(size_t index, uint32 runStart);
+
+    std::vector<Task> m_tasks;
+    uint32 m_wallClockMs = 0;
+    int m_numThreads = 1;
+};
+
+#endif
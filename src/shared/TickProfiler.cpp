@@ -0,0 +1,208 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "TickProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> TickProfiler::m_recording(false);
+
+namespace
+{
+    struct Event
+    {
+        char const* name;
+        char const* argName;
+        uint64 start;
+        uint32 duration;                                    // nanoseconds
+        uint32 arg;
+    };
+
+    struct ThreadRing
+    {
+        explicit ThreadRing(uint32 size) : events(size) {}
+
+        uint32 index = 0;
+        std::string name;
+        std::vector<Event> events;
+        std::atomic<uint64> head{0};                        // number of events ever written
+    };
+
+    std::mutex& GetRingsLock()
+    {
+        static std::mutex lock;
+        return lock;
+    }
+
+    // rings of exited threads are kept, their events can still be exported
+    std::vector<std::unique_ptr<ThreadRing>>& GetRings()
+    {
+        static std::vector<std::unique_ptr<ThreadRing>> rings;
+        return rings;
+    }
+
+    std::atomic<uint32> s_bufferSize(1 << 18);
+
+    thread_local ThreadRing* t_ring = nullptr;
+    thread_local std::string t_threadName;
+
+    ThreadRing* GetThreadRing()
+    {
+        if (t_ring)
+            return t_ring;
+
+        std::lock_guard<std::mutex> guard(GetRingsLock());
+        auto& rings = GetRings();
+        rings.emplace_back(new ThreadRing(s_bufferSize));
+        t_ring = rings.back().get();
+        t_ring->index = uint32(rings.size());
+        t_ring->name = t_threadName.empty() ? "Thread " + std::to_string(t_ring->index) : t_threadName;
+        return t_ring;
+    }
+
+    void WriteJsonString(FILE* file, char const* str)
+    {
+        fputc('"', file);
+        for (; *str; ++str)
+        {
+            if (*str == '"' || *str == '\\')
+                fputc('\\', file);
+            fputc(*str, file);
+        }
+        fputc('"', file);
+    }
+}
+
+void TickProfiler::SetBufferSize(uint32 events)
+{
+    s_bufferSize = std::max<uint32>(events, 1024);
+}
+
+void TickProfiler::SetThreadName(char const* name)
+{
+    t_threadName = name;
+    if (t_ring)
+    {
+        std::lock_guard<std::mutex> guard(GetRingsLock());
+        t_ring->name = name;
+    }
+}
+
+uint64 TickProfiler::Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TickProfiler::Record(char const* name, char const* argName, uint32 arg, uint64 start)
+{
+    // recording stopped while in the scope
+    if (!IsRecording())
+        return;
+
+    uint64 const duration = Now() - start;
+    ThreadRing* ring = GetThreadRing();
+    uint64 const head = ring->head.load(std::memory_order_relaxed);
+    Event& event = ring->events[head % ring->events.size()];
+    event.name = name;
+    event.argName = argName;
+    event.start = start;
+    event.duration = uint32(std::min<uint64>(duration, UINT32_MAX));
+    event.arg = arg;
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+int64 TickProfiler::ExportChromeTrace(std::string const& fileName, uint32 window)
+{
+    struct ThreadEvents
+    {
+        uint32 index;
+        std::string name;
+        std::vector<Event> events;
+    };
+
+    uint64 const end = Now();
+    uint64 const begin = end - std::min<uint64>(uint64(window) * 1000000, end);
+
+    // Copy first, the owners keep writing. An event overwritten during the
+    // copy is detected from the head moving by more than the ring size, the
+    // slot of the next event may be written already too.
+    std::vector<ThreadEvents> threads;
+    {
+        std::lock_guard<std::mutex> guard(GetRingsLock());
+        for (auto const& ring : GetRings())
+        {
+            uint64 const size = ring->events.size();
+            uint64 const head = ring->head.load(std::memory_order_acquire);
+            uint64 const first = head > size ? head - size : 0;
+
+            ThreadEvents copy = { ring->index, ring->name, {} };
+            copy.events.reserve(size_t(head - first));
+            for (uint64 i = first; i < head; ++i)
+                copy.events.push_back(ring->events[i % size]);
+
+            uint64 const newHead = ring->head.load(std::memory_order_acquire);
+            if (newHead + 1 > first + size)
+                copy.events.erase(copy.events.begin(), copy.events.begin() + size_t(std::min<uint64>(newHead + 1 - first - size, copy.events.size())));
+
+            copy.events.erase(std::remove_if(copy.events.begin(), copy.events.end(),
+                [begin](Event const& e) { return e.start + e.duration < begin; }), copy.events.end());
+            if (!copy.events.empty())
+                threads.push_back(std::move(copy));
+        }
+    }
+
+    FILE* file = fopen(fileName.c_str(), "w");
+    if (!file)
+        return -1;
+
+    int64 count = 0;
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    for (ThreadEvents const& thread : threads)
+    {
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", first ? "" : ",\n", thread.index);
+        WriteJsonString(file, thread.name.c_str());
+        fprintf(file, "}}");
+        first = false;
+
+        for (Event const& e : thread.events)
+        {
+            // timestamps in microseconds from the start of the window
+            int64 const ts = int64(e.start) - int64(begin);
+            fprintf(file, ",\n{\"name\":");
+            WriteJsonString(file, e.name);
+            fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f", thread.index, ts / 1000.0, e.duration / 1000.0);
+            if (e.argName)
+            {
+                fprintf(file, ",\"args\":{");
+                WriteJsonString(file, e.argName);
+                fprintf(file, ":%u}", e.arg);
+            }
+            fputc('}', file);
+            ++count;
+        }
+    }
+    fprintf(file, "\n]}\n");
+
+    bool const written = !ferror(file);
+    fclose(file);
+    return written ? count : -1;
+}
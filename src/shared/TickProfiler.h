@@ -0,0 +1,88 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TICKPROFILER_H
+#define TICKPROFILER_H
+
+#include <atomic>
+#include <string>
+
+#include "Platform/Define.h"
+
+/**
+ * @brief Scoped timers for the phases of a server tick.
+ *  While recording, every TICK_PROFILE_SCOPE appends one event (name, start,
+ *  duration) to a ring buffer owned by the current thread, without any lock.
+ *  Nested scopes nest in time, so the hierarchy needs no extra bookkeeping.
+ *  The last milliseconds of every ring can be exported as Chrome trace-event
+ *  JSON (chrome://tracing, Perfetto, speedscope).
+ *  When not recording a scope costs one relaxed atomic load.
+ *  Names must be string literals, they are stored as pointers.
+ */
+class TickProfiler
+{
+    public:
+        class Scope
+        {
+            public:
+                explicit Scope(char const* name, char const* argName = nullptr, uint32 arg = 0) :
+                    m_name(name), m_argName(argName), m_arg(arg), m_start(IsRecording() ? Now() : 0) {}
+                ~Scope()
+                {
+                    if (m_start)
+                        Record(m_name, m_argName, m_arg, m_start);
+                }
+
+                Scope(Scope const&) = delete;
+                Scope& operator=(Scope const&) = delete;
+
+            private:
+                char const* m_name;
+                char const* m_argName;
+                uint32 m_arg;
+                uint64 m_start;
+        };
+
+        static bool IsRecording() { return m_recording.load(std::memory_order_relaxed); }
+        static void SetRecording(bool recording) { m_recording = recording; }
+
+        /// Number of events kept per thread, for the rings created afterwards
+        static void SetBufferSize(uint32 events);
+
+        /// Name of the current thread in the exported traces
+        static void SetThreadName(char const* name);
+
+        /// Nanoseconds, steady clock
+        static uint64 Now();
+
+        static void Record(char const* name, char const* argName, uint32 arg, uint64 start);
+
+        /// Writes the events that ended during the last `window` milliseconds, returns the number of events or -1 on error.
+        static int64 ExportChromeTrace(std::string const& fileName, uint32 window);
+
+    private:
+        static std::atomic<bool> m_recording;
+};
+
+#define TICK_PROFILE_CONCAT_(a, b) a##b
+#define TICK_PROFILE_CONCAT(a, b) TICK_PROFILE_CONCAT_(a, b)
+
+#define TICK_PROFILE_SCOPE(name) \
+    TickProfiler::Scope TICK_PROFILE_CONCAT(tickProfileScope, __LINE__)(name)
+#define TICK_PROFILE_SCOPE_ARG(name, argName, arg) \
+    TickProfiler::Scope TICK_PROFILE_CONCAT(tickProfileScope, __LINE__)(name, argName, arg)
+
+#endif
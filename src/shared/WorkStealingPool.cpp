@@ -0,0 +1,228 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "WorkStealingPool.h"
+
+namespace
+{
+    // Pool and queue index of the current thread, if it is a worker
+    thread_local WorkStealingPool const* t_pool = nullptr;
+    thread_local int t_index = -1;
+    thread_local unsigned int t_victim = 0;
+}
+
+WorkStealingPool::WorkStealingPool(int numThreads) :
+    m_sleeping(0), m_queued(0), m_stopping(false), m_executed(0), m_stolen(0), m_helped(0)
+{
+    if (numThreads < 0)
+        numThreads = 0;
+    m_queues.reserve(numThreads + 1);
+    for (int i = 0; i < numThreads + 1; ++i)
+        m_queues.emplace_back(new Queue);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_sleepLock);
+        m_stopping = true;
+    }
+    m_wakeUp.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+void WorkStealingPool::start(Callable initThread, Callable exitThread)
+{
+    if (!m_threads.empty())
+        return;
+    m_threads.reserve(size());
+    for (int i = 0; i < int(size()); ++i)
+        m_threads.emplace_back([this, i, initThread, exitThread]() { loop(i, initThread, exitThread); });
+}
+
+int WorkStealingPool::localIndex() const
+{
+    return t_pool == this ? t_index : int(size());
+}
+
+void WorkStealingPool::push(Task&& task)
+{
+    Queue& queue = *m_queues[localIndex()];
+    {
+        std::unique_lock<std::mutex> lock(queue.lock);
+        queue.tasks.emplace_back(std::move(task));
+    }
+    ++m_queued;
+    if (m_sleeping.load(std::memory_order_relaxed))
+        m_wakeUp.notify_one();
+}
+
+bool WorkStealingPool::popLocal(Task& task, bool subTasksOnly, TaskGroup const* group)
+{
+    if (t_pool != this)
+        return false;
+    Queue& queue = *m_queues[t_index];
+    std::unique_lock<std::mutex> lock(queue.lock);
+    if (queue.tasks.empty() || !canRun(queue.tasks.back(), subTasksOnly, group))
+        return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::popInjected(Task& task, bool subTasksOnly, TaskGroup const* group)
+{
+    Queue& queue = *m_queues.back();
+    std::unique_lock<std::mutex> lock(queue.lock);
+    for (auto itr = queue.tasks.begin(); itr != queue.tasks.end(); ++itr)
+    {
+        if (!canRun(*itr, subTasksOnly, group))
+            continue;
+        task = std::move(*itr);
+        queue.tasks.erase(itr);
+        return true;
+    }
+    return false;
+}
+
+bool WorkStealingPool::steal(Task& task, bool subTasksOnly, TaskGroup const* group)
+{
+    size_t const workers = size();
+    if (!workers)
+        return false;
+    unsigned int const first = t_victim++;
+    for (size_t i = 0; i < workers; ++i)
+    {
+        int const victim = int((first + i) % workers);
+        if (t_pool == this && victim == t_index)
+            continue;
+        Queue& queue = *m_queues[victim];
+        std::unique_lock<std::mutex> lock(queue.lock, std::try_to_lock);
+        if (!lock.owns_lock() || queue.tasks.empty())
+            continue;
+        for (auto itr = queue.tasks.begin(); itr != queue.tasks.end(); ++itr)
+        {
+            if (!canRun(*itr, subTasksOnly, group))
+                continue;
+            task = std::move(*itr);
+            queue.tasks.erase(itr);
+            ++m_stolen;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::execute(Task& task)
+{
+    --m_queued;
+    task.function();
+    ++m_executed;
+    // Must be the last access to the group: the waiter may destroy it right after
+    task.group->m_pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+bool WorkStealingPool::runOne(bool subTasksOnly)
+{
+    return runOne(subTasksOnly, nullptr);
+}
+
+bool WorkStealingPool::runOne(bool subTasksOnly, TaskGroup const* group)
+{
+    Task task;
+    if (!popLocal(task, subTasksOnly, group) && !popInjected(task, subTasksOnly, group) && !steal(task, subTasksOnly, group))
+        return false;
+    execute(task);
+    return true;
+}
+
+bool WorkStealingPool::helpUntil(Clock::time_point deadline, std::function<bool()> const& done)
+{
+    while (!done())
+    {
+        if (Clock::now() >= deadline)
+            return false;
+        if (runOne(false))
+            ++m_helped;
+        else
+            std::this_thread::yield();
+    }
+    return true;
+}
+
+WorkStealingPool::Stats WorkStealingPool::collectStats()
+{
+    Stats stats;
+    stats.executed = m_executed.exchange(0);
+    stats.stolen = m_stolen.exchange(0);
+    stats.helped = m_helped.exchange(0);
+    return stats;
+}
+
+void WorkStealingPool::loop(int index, Callable const& initThread, Callable const& exitThread)
+{
+    t_pool = this;
+    t_index = index;
+    t_victim = index + 1;
+
+    if (initThread)
+        initThread();
+
+    while (!m_stopping)
+    {
+        if (runOne(false))
+            continue;
+
+        std::unique_lock<std::mutex> lock(m_sleepLock);
+        ++m_sleeping;
+        // Timeout as a safety net: a push may slip between our last check and the wait
+        m_wakeUp.wait_for(lock, std::chrono::milliseconds(1), [this]() { return m_stopping || m_queued > 0; });
+        --m_sleeping;
+    }
+
+    if (exitThread)
+        exitThread();
+}
+
+void WorkStealingPool::TaskGroup::run(Callable function, bool subTask)
+{
+    m_pending.fetch_add(1, std::memory_order_relaxed);
+    m_pool.push({ std::move(function), this, subTask });
+}
+
+void WorkStealingPool::TaskGroup::wait(bool subTasksOnly)
+{
+    // Without workers the sub-tasks and the tasks of this group are run here,
+    // never another top-level task: it could wait on the caller's own map.
+    while (!done())
+    {
+        if (m_pool.runOne(subTasksOnly, this))
+            ++m_pool.m_helped;
+        else
+            std::this_thread::yield();
+    }
+}
+
+void WorkStealingPool::TaskGroup::wait()
+{
+    wait(true);
+}
+
+void WorkStealingPool::TaskGroup::waitAny()
+{
+    wait(false);
+}
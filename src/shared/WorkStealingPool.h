@@ -0,0 +1,185 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#include "Platform/Define.h"
+
+/**
+ * @brief Thread pool where every worker owns a task deque.
+ *  Workers pop their own tasks LIFO and steal from the other deques FIFO
+ *  when they run dry, so a single heavy job that spawns sub-tasks gets
+ *  spread over every idle thread.
+ *  Threads that are not workers (eg. the world thread) push into a shared
+ *  injection queue and may lend a hand while they wait.
+ */
+class WorkStealingPool
+{
+public:
+    using Callable = std::function<void()>;
+    using Clock = std::chrono::steady_clock;
+
+    class TaskGroup;
+
+    struct Stats
+    {
+        uint64 executed = 0;      // tasks run since the last reset
+        uint64 stolen = 0;        // tasks taken from another worker's deque
+        uint64 helped = 0;        // tasks run by a thread waiting on a group
+    };
+
+    /**
+     * @brief WorkStealingPool allocates the queues, use WorkStealingPool::start() to spawn the threads.
+     * @param numThreads the number of worker threads. 0 is valid: tasks are then run by the waiting thread.
+     */
+    explicit WorkStealingPool(int numThreads);
+    WorkStealingPool() = delete;
+    WorkStealingPool(WorkStealingPool const&) = delete;
+    WorkStealingPool& operator=(WorkStealingPool const&) = delete;
+    ~WorkStealingPool();
+
+    /**
+     * @brief start creates and starts the worker threads.
+     * @param initThread called once in every worker before it takes any task (eg. mysql_thread_init)
+     * @param exitThread called once in every worker before it exits
+     */
+    void start(Callable initThread = Callable(), Callable exitThread = Callable());
+
+    /**
+     * @brief size
+     * @return the number of worker threads
+     */
+    size_t size() const { return m_queues.size() - 1; }
+
+    /**
+     * @brief runOne executes at most one pending task on the calling thread.
+     * @param subTasksOnly do not pick top-level tasks (those that may block for a long time)
+     * @return true if a task was run
+     */
+    bool runOne(bool subTasksOnly);
+
+    /**
+     * @brief helpUntil runs pending tasks on the calling thread until `done` returns true
+     *  or the deadline is reached.
+     * @return the value of `done` when returning
+     */
+    bool helpUntil(Clock::time_point deadline, std::function<bool()> const& done);
+
+    /**
+     * @brief collectStats returns the counters accumulated since the previous call and resets them.
+     */
+    Stats collectStats();
+
+private:
+    struct Task
+    {
+        Callable function;
+        TaskGroup* group;
+        bool subTask;
+    };
+
+    struct Queue
+    {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    // a thread waiting for sub-tasks may still run the top-level tasks of the group it waits for
+    static bool canRun(Task const& task, bool subTasksOnly, TaskGroup const* group)
+    {
+        return !subTasksOnly || task.subTask || task.group == group;
+    }
+
+    void push(Task&& task);
+    bool runOne(bool subTasksOnly, TaskGroup const* group);
+    bool popLocal(Task& task, bool subTasksOnly, TaskGroup const* group);
+    bool popInjected(Task& task, bool subTasksOnly, TaskGroup const* group);
+    bool steal(Task& task, bool subTasksOnly, TaskGroup const* group);
+    void execute(Task& task);
+    void loop(int index, Callable const& initThread, Callable const& exitThread);
+
+    int localIndex() const;
+
+    // one queue per worker, the last one is the injection queue of external threads
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_sleepLock;
+    std::condition_variable m_wakeUp;
+    std::atomic<int> m_sleeping;
+    std::atomic<int> m_queued;
+    std::atomic<bool> m_stopping;
+
+    std::atomic<uint64> m_executed;
+    std::atomic<uint64> m_stolen;
+    std::atomic<uint64> m_helped;
+};
+
+/**
+ * @brief Set of tasks that can be waited on together.
+ *  wait() does not block the calling thread: it runs pending tasks until
+ *  every task of the group has been executed.
+ */
+class WorkStealingPool::TaskGroup
+{
+    friend class WorkStealingPool;
+public:
+    explicit TaskGroup(WorkStealingPool& pool) : m_pool(pool), m_pending(0) {}
+    TaskGroup(TaskGroup const&) = delete;
+    TaskGroup& operator=(TaskGroup const&) = delete;
+    ~TaskGroup() { wait(); }
+
+    /**
+     * @brief run queues a task of this group.
+     * @param subTask sub-tasks are short jobs spawned from a running task, top-level
+     *  tasks (whole map updates) are never picked by a thread waiting for a sub-task group
+     */
+    void run(Callable function, bool subTask = true);
+
+    /**
+     * @brief wait returns once every task of the group has completed.
+     *  Threads waiting on sub-tasks only help with sub-tasks and the tasks of
+     *  this group, so a cell update never ends up running another map's full
+     *  update, even without any worker thread.
+     */
+    void wait();
+
+    /**
+     * @brief waitAny same as wait, but lets the calling thread run any pending task.
+     */
+    void waitAny();
+
+    bool done() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    void wait(bool subTasksOnly);
+
+    WorkStealingPool& m_pool;
+    std::atomic<int> m_pending;
+};
+
+#endif